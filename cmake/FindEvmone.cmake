@@ -2,6 +2,7 @@
 # EVMONE_FOUND
 # EVMONE_INCLUDE_DIR
 # EVMONE_LIBRARY
+# EVMONE_ANALYSIS_FOUND (evmone's internal analysis headers and intx are installed)
 
 include(SelectLibraryConfigurations)
 include(FindPackageHandleStandardArgs)
@@ -9,6 +10,15 @@ include(FindPackageHandleStandardArgs)
 find_path(EVMONE_INCLUDE_DIR NAMES evmone.h PATH_SUFFIXES evmone)
 find_library(EVMONE_LIBRARY NAMES libevmone.a)
 
+# Optional, not installed by evmone itself (see scripts/deps.sh)
+find_path(EVMONE_ANALYSIS_INCLUDE_DIR NAMES evmone/baseline.hpp)
+find_path(INTX_INCLUDE_DIR NAMES intx/intx.hpp)
+if(EVMONE_ANALYSIS_INCLUDE_DIR AND INTX_INCLUDE_DIR)
+  set(EVMONE_ANALYSIS_FOUND TRUE)
+else()
+  set(EVMONE_ANALYSIS_FOUND FALSE)
+endif()
+
 SELECT_LIBRARY_CONFIGURATIONS(Evmone)
 
 FIND_PACKAGE_HANDLE_STANDARD_ARGS(
@@ -16,5 +26,5 @@ FIND_PACKAGE_HANDLE_STANDARD_ARGS(
   EVMONE_LIBRARY EVMONE_INCLUDE_DIR
 )
 
-mark_as_advanced(EVMONE_INCLUDE_DIR EVMONE_LIBRARY)
+mark_as_advanced(EVMONE_INCLUDE_DIR EVMONE_LIBRARY EVMONE_ANALYSIS_INCLUDE_DIR INTX_INCLUDE_DIR)
 
@@ -118,6 +118,9 @@ HAS_EVMC_INSTRUCTIONS=$(check_lib "libevmc-instructions.a")
 HAS_EVMC_LOADER=$(check_lib "libevmc-loader.a")
 HAS_EVMONE=$(check_lib "libevmone.a")
 HAS_SPEEDB=$(check_lib "libspeedb.a")
+# Speedb must be built with ZSTD support (used by the database's compression settings),
+# older installs only had LZ4 and have to be rebuilt
+if [ -n "$HAS_SPEEDB" ] && nm "$HAS_SPEEDB" 2> /dev/null | grep -q "ZSTD_compress"; then SPEEDB_HAS_ZSTD="yes"; else SPEEDB_HAS_ZSTD=""; fi
 HAS_SQLITECPP=$(check_lib "libSQLiteCpp.a")
 
 if [ "${1:-}" == "--check" ]; then
@@ -164,6 +167,7 @@ if [ "${1:-}" == "--check" ]; then
   echo -n "libevmc-loader: " && [ -n "$HAS_EVMC_LOADER" ] && echo "$HAS_EVMC_LOADER" || echo "not found"
   echo -n "libevmone: " && [ -n "$HAS_EVMONE" ] && echo "$HAS_EVMONE" || echo "not found"
   echo -n "libspeedb: " && [ -n "$HAS_SPEEDB" ] && echo "$HAS_SPEEDB" || echo "not found"
+  echo -n "libspeedb with ZSTD: " && [ -n "$SPEEDB_HAS_ZSTD" ] && echo "$SPEEDB_HAS_ZSTD" || echo "no"
   echo -n "libSQLiteCpp: " && [ -n "$HAS_SQLITECPP" ] && echo "$HAS_SQLITECPP" || echo "not found"
 elif [ "${1:-}" == "--install" ]; then
   # Anti-anti-sudo prevention
@@ -249,15 +253,20 @@ elif [ "${1:-}" == "--install" ]; then
     cmake --build . -- -j$(nproc)
     ./bin/evmc-vmtester /usr/local/src/evmone/build/lib/libevmone.so && ./bin/evmone-unittests
     cmake --install .
+    # Internal headers used by the code analysis cache, evmone doesn't install them
+    cp ../lib/evmone/*.hpp /usr/local/include/evmone/
+    INTX_HEADER="$(find /usr/local/src/evmone -path '*/include/intx/intx.hpp' | head -n 1)"
+    if [ -n "$INTX_HEADER" ]; then cp -r "$(dirname "$INTX_HEADER")" /usr/local/include/; fi
   fi
-  if [ -z "$HAS_SPEEDB" ]; then
+  if [ -z "$HAS_SPEEDB" ] || [ -z "$SPEEDB_HAS_ZSTD" ]; then
     echo "-- Installing speedb..."
+    rm -rf "/usr/local/src/speedb"
     cd /usr/local/src && git clone --depth 1 --branch "speedb/v${SPEEDB_VERSION}" https://github.com/speedb-io/speedb
     cd speedb && mkdir build && cd build
     cmake -DCMAKE_INSTALL_PREFIX="/usr/local" -DCMAKE_BUILD_TYPE=Release \
       -DROCKSDB_BUILD_SHARED=OFF -DFAIL_ON_WARNINGS=OFF -DWITH_GFLAGS=OFF -DWITH_RUNTIME_DEBUG=OFF \
       -DWITH_BENCHMARK_TOOLS=OFF -DWITH_CORE_TOOLS=OFF -DWITH_TOOLS=OFF -DWITH_TRACE_TOOLS=OFF \
-      -DWITH_LZ4=ON ..
+      -DWITH_LZ4=ON -DWITH_ZSTD=ON ..
     cmake --build . -- -j$(nproc) && cmake --install .
   fi
   if [ -z "$HAS_SQLITECPP" ]; then
@@ -9,6 +9,7 @@ BlockObservers::BlockObservers(
   Contracts& contracts,
   Accounts& accounts,
   VmStorage& vmStorage,
+  ExecutionContext::DirtyKeys& dirtyKeys,
   const Options& options)
     : vm_(vm),
       manager_(manager),
@@ -16,6 +17,7 @@ BlockObservers::BlockObservers(
       contracts_(contracts),
       accounts_(accounts),
       vmStorage_(vmStorage),
+      dirtyKeys_(dirtyKeys),
       options_(options) {}
 
 void BlockObservers::add(BlockNumberObserver observer) {
@@ -59,6 +61,7 @@ void BlockObservers::notifyNumberQueue(const FinalizedBlock& block) {
       .blockGasLimit(10'000'000)
       .txGasPrice(0)
       .chainId(this->options_.getChainID())
+      .dirtyKeys(dirtyKeys_)
       .build();
 
       ContractHost host(
@@ -106,6 +109,7 @@ void BlockObservers::notifyTimestampQueue(const FinalizedBlock& block) {
       .blockGasLimit(10'000'000)
       .txGasPrice(0)
       .chainId(this->options_.getChainID())
+      .dirtyKeys(dirtyKeys_)
       .build();
 
       ContractHost host(
@@ -4,6 +4,7 @@
 #include "utils/tx.h"
 #include "utils/finalizedblock.h"
 #include "contract/contract.h"
+#include "contract/executioncontext.h"
 #include <queue>
 #include <functional>
 
@@ -49,6 +50,7 @@ public:
     Contracts& contracts,
     Accounts& accounts,
     VmStorage& vmStorage,
+    ExecutionContext::DirtyKeys& dirtyKeys,
     const Options& options);
 
   void add(BlockNumberObserver observer);
@@ -70,6 +72,7 @@ private:
   Contracts& contracts_;
   Accounts& accounts_;
   VmStorage& vmStorage_;
+  ExecutionContext::DirtyKeys& dirtyKeys_;
   const Options& options_;
 };
 
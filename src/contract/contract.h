@@ -101,6 +101,9 @@ class BaseContract : public ContractLocals, public Dumpable {
       return batch;
     }
 
+    /// Every key of a contract lives under its own DB prefix.
+    Bytes getDumpPrefix() const override { return this->getDBPrefix(); }
+
     /**
      * Constructor from load.
      * @param address The address where the contract will be deployed.
@@ -24,25 +24,33 @@ ContractHost::~ContractHost() {
     for (auto& var : this->stack_.getUsedVars())
       var.get().commit();
 
+    // Contracts whose variables were committed have to be written on the next dump
+    for (const Dumpable* contract : this->stack_.getUsedContracts())
+      this->manager_.markDirty(*contract);
+
+    bool newCppContracts = false;
     for (auto& [address, contract] : context_.getNewContracts()) {
       if (contract == nullptr) {
         continue;
       }
 
       this->manager_.pushBack(dynamic_cast<Dumpable*>(contract));
+      this->manager_.markDirty(*contract);
+      newCppContracts = true;
     }
 
-    auto transaction = this->storage_.events().transaction();
-
-    for (const auto& event : context_.getEvents()) {
-      this->storage_.events().putEvent(event);
+    // ContractManager dumps the list of deployed contracts
+    if (newCppContracts) {
+      this->manager_.markDirty(context_.getContract(ProtocolContractAddresses.at("ContractManager")));
     }
 
-    transaction->commit();
+    // Written along with the block, in a single transaction
+    if (!context_.getEvents().empty()) this->storage_.putEvents(context_.getEvents());
     context_.commit();
   }
 
-  if (messageHandler_.hasCallTrace()) {
+  // Simulations are discarded, there is no transaction to attach their trace to
+  if (messageHandler_.hasCallTrace() && !context_.isOverlay()) {
     storage_.putCallTrace(Hash(context_.getTxHash()), messageHandler_.getCallTrace());
   }
 }
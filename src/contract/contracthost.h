@@ -58,13 +58,14 @@ class ContractHost {
                  Storage& storage,
                  const Hash& randomnessSeed,
                  ExecutionContext& context,
-                 BlockObservers *blockObservers = nullptr) :
+                 BlockObservers *blockObservers = nullptr,
+                 EvmCodeCache *codeCache = nullptr) :
     manager_(manager),
     storage_(storage),
     stack_(),
     context_(context),
     blockObservers_(blockObservers),
-    messageHandler_(MessageDispatcher(context_, CppContractExecutor(context_, *this), EvmContractExecutor(context_, vm, storage.getIndexingMode()), PrecompiledContractExecutor(RandomGen(randomnessSeed))), storage.getIndexingMode()) {
+    messageHandler_(MessageDispatcher(context_, CppContractExecutor(context_, *this), EvmContractExecutor(context_, vm, storage.getIndexingMode(), codeCache), PrecompiledContractExecutor(RandomGen(randomnessSeed))), storage.getIndexingMode()) {
       messageHandler_.handler().evmExecutor().setMessageHandler(AnyEncodedMessageHandler::from(messageHandler_)); // TODO: is this really required?
     }
 
@@ -225,7 +226,7 @@ class ContractHost {
 
     const ExecutionContext& context() const { return context_; }
 
-    void registerVariableUse(SafeBase& var) { stack_.registerVariableUse(var); }
+    void registerVariableUse(const Dumpable& owner, SafeBase& var) { stack_.registerVariableUse(owner, var); }
 
     uint256_t getRandomValue();
 
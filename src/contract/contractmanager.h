@@ -173,6 +173,9 @@ class ContractManager : public BaseContract {
 
     /// Dump override
     DBBatch dump() const override;
+
+    /// Deployed contracts are dumped under DBPrefix::contractManager.
+    Bytes getDumpPrefix() const override { return DBPrefix::contractManager; }
 };
 
 #endif // CONTRACTMANAGER_H
@@ -19,13 +19,19 @@ See the LICENSE.txt file in the project root for more information.
 class ContractStack {
   private:
     std::vector<std::reference_wrapper<SafeBase>> usedVars_;
+    std::vector<const Dumpable*> usedContracts_; ///< Contracts that own the used variables, needed for incremental dumps.
 
   public:
-    inline void registerVariableUse(SafeBase& var) {
+    inline void registerVariableUse(const Dumpable& owner, SafeBase& var) {
       this->usedVars_.emplace_back(var);
+      if (this->usedContracts_.empty() || this->usedContracts_.back() != &owner) {
+        this->usedContracts_.emplace_back(&owner);
+      }
     }
 
     inline const std::vector<std::reference_wrapper<SafeBase>>& getUsedVars() const { return this->usedVars_; }
+
+    inline const std::vector<const Dumpable*>& getUsedContracts() const { return this->usedContracts_; }
     ///@}
 };
 
@@ -9,6 +9,7 @@
 #include "utils/evmcconv.h"
 #include "utils/contractreflectioninterface.h"
 #include "contract/costs.h"
+#include "utils/transactional.h"
 
 struct ContractHost;
 
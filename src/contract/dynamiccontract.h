@@ -104,7 +104,7 @@ class DynamicContract : public BaseContract {
       if (this->host_ == nullptr) {
         throw DynamicException("Contracts going haywire! trying to register variable use without a host_!");
       }
-      host_->registerVariableUse(variable);
+      host_->registerVariableUse(*this, variable);
     }
 
     /**
@@ -611,7 +611,7 @@ class DynamicContract : public BaseContract {
       if (this->host_ == nullptr) {
         throw DynamicException("Contracts going haywire! trying to get balance without a host!");
       }
-      return host_->context().getAccount(address).getBalance();
+      return uint256_t(host_->context().getAccount(address).getBalance());
     }
 
     /**
@@ -0,0 +1,106 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "evmcodecache.h"
+
+#include <evmone/evmone.h>
+
+#include "utils/dynamicexception.h"
+
+#ifdef BDK_EVMONE_ANALYSIS
+#include <variant>
+#include <evmone/vm.hpp>
+#include <evmone/baseline.hpp>
+#include <evmone/advanced_analysis.hpp>
+#include <evmone/advanced_execution.hpp>
+
+struct EvmCodeCache::Analysis {
+  std::variant<evmone::baseline::CodeAnalysis, evmone::advanced::AdvancedCodeAnalysis> value;
+};
+#else
+struct EvmCodeCache::Analysis {};
+#endif
+
+EvmCodeCache::EvmCodeCache(EvmInterpreter interpreter, uint64_t capacity)
+  : interpreter_(interpreter), capacity_(capacity) {}
+
+EvmCodeCache::~EvmCodeCache() = default;
+
+evmc_vm* EvmCodeCache::createVm(EvmInterpreter interpreter) {
+  evmc_vm* vm = evmc_create_evmone();
+  if (interpreter == EvmInterpreter::ADVANCED &&
+    evmc_set_option(vm, "advanced", "") != EVMC_SET_OPTION_SUCCESS
+  ) {
+    evmc_destroy(vm);
+    throw DynamicException("evmone does not support the advanced interpreter");
+  }
+  return vm;
+}
+
+uint64_t EvmCodeCache::size() const {
+  std::lock_guard lock(this->mutex_);
+  return this->entries_.size();
+}
+
+std::shared_ptr<const EvmCodeCache::Analysis> EvmCodeCache::getAnalysis(
+  const Hash& codeHash, View<Bytes> code, evmc_revision rev
+) {
+  {
+    std::lock_guard lock(this->mutex_);
+    if (auto it = this->entries_.find(codeHash); it != this->entries_.end()) {
+      this->lru_.splice(this->lru_.begin(), this->lru_, it->second.lruIt);
+      ++this->hits_;
+      return it->second.analysis;
+    }
+  }
+  ++this->misses_;
+
+  // Analyze outside the lock, other threads may keep hitting the cache meanwhile
+  auto analysis = std::make_shared<Analysis>();
+#ifdef BDK_EVMONE_ANALYSIS
+  const evmc::bytes_view codeView(code.data(), code.size());
+  if (this->interpreter_ == EvmInterpreter::ADVANCED) {
+    analysis->value = evmone::advanced::analyze(rev, codeView);
+  } else {
+    analysis->value = evmone::baseline::analyze(codeView, false); // EOF is not enabled up to Prague
+  }
+#endif
+
+  std::lock_guard lock(this->mutex_);
+  auto [it, inserted] = this->entries_.try_emplace(codeHash);
+  if (!inserted) return it->second.analysis; // Another thread analyzed the same code first
+  this->lru_.push_front(codeHash);
+  it->second = Entry{analysis, this->lru_.begin()};
+  if (this->entries_.size() > this->capacity_) {
+    this->entries_.erase(this->lru_.back());
+    this->lru_.pop_back();
+  }
+  return analysis;
+}
+
+evmc::Result EvmCodeCache::execute(
+  evmc_vm* vm, const evmc_host_interface* host, evmc_host_context* context, evmc_revision rev,
+  const evmc_message& msg, const Hash& codeHash, View<Bytes> code
+) {
+#ifdef BDK_EVMONE_ANALYSIS
+  if (this->capacity_ != 0 && !code.empty()) {
+    const auto analysis = this->getAnalysis(codeHash, code, rev);
+    if (const auto* baseline = std::get_if<evmone::baseline::CodeAnalysis>(&analysis->value)) {
+      return evmc::Result(evmone::baseline::execute(
+        *static_cast<evmone::VM*>(vm), *host, context, rev, msg, *baseline
+      ));
+    }
+    evmone::advanced::AdvancedExecutionState state(
+      msg, rev, *host, context, evmc::bytes_view(code.data(), code.size())
+    );
+    return evmc::Result(evmone::advanced::execute(
+      state, std::get<evmone::advanced::AdvancedCodeAnalysis>(analysis->value)
+    ));
+  }
+#endif
+  return evmc::Result(::evmc_execute(vm, host, context, rev, &msg, code.data(), code.size()));
+}
@@ -0,0 +1,95 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef BDK_CONTRACT_EVMCODECACHE_H
+#define BDK_CONTRACT_EVMCODECACHE_H
+
+#include <atomic>
+#include <list>
+#include <mutex>
+
+#include <evmc/evmc.hpp>
+#include <boost/unordered/unordered_flat_map.hpp>
+
+#include "utils/hash.h"
+#include "utils/safehash.h"
+#include "utils/options.h"
+
+/**
+ * Bounded, thread-safe LRU cache of evmone code analyses, keyed by code hash.
+ * evmc_execute() analyzes the bytecode on every call (jumpdest map for the baseline
+ * interpreter, instruction blocks for the advanced one), so hot contracts would be
+ * analyzed again on every call. Code never changes for a given hash, so entries never
+ * go stale and are only evicted. Analyses are made for a single EVM revision.
+ * When the node is built without evmone's analysis API (BDK_EVMONE_ANALYSIS undefined),
+ * execute() falls back to evmc_execute() and nothing is cached.
+ */
+class EvmCodeCache {
+  public:
+    /**
+     * Constructor.
+     * @param interpreter The interpreter the analyses are made for.
+     * @param capacity Maximum number of analyses kept, 0 disables the cache.
+     */
+    EvmCodeCache(EvmInterpreter interpreter, uint64_t capacity);
+
+    ~EvmCodeCache(); ///< Destructor.
+
+    EvmCodeCache(const EvmCodeCache&) = delete;
+    EvmCodeCache& operator=(const EvmCodeCache&) = delete;
+
+    /**
+     * Create an evmone VM instance that runs the given interpreter.
+     * The caller owns the instance and must destroy it with evmc_destroy().
+     */
+    static evmc_vm* createVm(EvmInterpreter interpreter);
+
+    /// Getter for the interpreter the analyses are made for.
+    EvmInterpreter getInterpreter() const { return this->interpreter_; }
+
+    /**
+     * Execute code through the given VM, reusing its cached analysis if there is one.
+     * @param vm The VM to use, created by createVm() with the same interpreter.
+     * @param host The host interface.
+     * @param context The host context.
+     * @param rev The EVM revision, must be the same for every call.
+     * @param msg The message to execute.
+     * @param codeHash The hash of the code.
+     * @param code The code to execute.
+     * @return The execution result.
+     */
+    evmc::Result execute(
+      evmc_vm* vm, const evmc_host_interface* host, evmc_host_context* context, evmc_revision rev,
+      const evmc_message& msg, const Hash& codeHash, View<Bytes> code
+    );
+
+    uint64_t size() const; ///< Number of cached analyses.
+    uint64_t getHits() const { return this->hits_; } ///< Number of executions that reused an analysis.
+    uint64_t getMisses() const { return this->misses_; } ///< Number of executions that had to analyze the code.
+
+  private:
+    struct Analysis; ///< Interpreter-specific analysis, defined in the source file.
+
+    /// Cached analysis and its position in the LRU list.
+    struct Entry {
+      std::shared_ptr<const Analysis> analysis;
+      std::list<Hash>::iterator lruIt;
+    };
+
+    const EvmInterpreter interpreter_; ///< The interpreter the analyses are made for.
+    const uint64_t capacity_; ///< Maximum number of cached analyses.
+    mutable std::mutex mutex_; ///< Mutex for managing access to the entries and the LRU list.
+    std::list<Hash> lru_; ///< Code hashes from the most to the least recently used.
+    boost::unordered_flat_map<Hash, Entry, SafeHash> entries_; ///< Cached analyses.
+    std::atomic<uint64_t> hits_ = 0; ///< Hit counter.
+    std::atomic<uint64_t> misses_ = 0; ///< Miss counter.
+
+    /// Get the analysis of the given code, analyzing and caching it if needed.
+    std::shared_ptr<const Analysis> getAnalysis(const Hash& codeHash, View<Bytes> code, evmc_revision rev);
+};
+
+#endif // BDK_CONTRACT_EVMCODECACHE_H
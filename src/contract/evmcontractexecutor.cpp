@@ -6,6 +6,7 @@
 #include "outofgas.h"
 #include "utils/evmcconv.h"
 #include "contract/costs.h"
+#include "utils/transactional.h"
 
 constexpr decltype(auto) getAndThen(auto&& map, const auto& key, auto&& andThen, auto&& orElse) {
   const auto it = map.find(key);
@@ -81,15 +82,18 @@ constexpr evmc_message makeEvmcMessage(const M& msg, uint64_t depth, View<Addres
   };
 }
 
-Bytes EvmContractExecutor::executeEvmcMessage(evmc_vm* vm, const evmc_host_interface* host, evmc_host_context* context, const evmc_message& msg, Gas& gas, View<Bytes> code) {
-  evmc::Result result(::evmc_execute(
-    vm,
-    host,
-    context,
-    evmc_revision::EVMC_PRAGUE,
-    &msg,
-    code.data(),
-    code.size()));
+Bytes EvmContractExecutor::executeEvmcMessage(evmc_vm* vm, const evmc_host_interface* host, evmc_host_context* context, const evmc_message& msg, Gas& gas, View<Bytes> code, const Hash* codeHash) {
+  // Deployed code is analyzed once and cached by its hash, init code only runs once so it isn't
+  evmc::Result result = (this->codeCache_ != nullptr && codeHash != nullptr && *codeHash != Hash())
+    ? this->codeCache_->execute(vm, host, context, evmc_revision::EVMC_PRAGUE, msg, *codeHash, code)
+    : evmc::Result(::evmc_execute(
+      vm,
+      host,
+      context,
+      evmc_revision::EVMC_PRAGUE,
+      &msg,
+      code.data(),
+      code.size()));
 
   gas = Gas(result.gas_left);
 
@@ -157,8 +161,10 @@ Bytes EvmContractExecutor::execute(EncodedCallMessage& msg) {
   auto depthGuard = transactional::copy(depth_); // TODO: checkpoint (and deprecate copy)
   ++depth_;
 
+  const auto account = context_.getAccount(msg.to());
+  const Hash codeHash(account.getCodeHash());
   const Bytes output = executeEvmcMessage(this->vm_, &this->get_interface(), this->to_context(),
-    makeEvmcMessage(msg, depth_), msg.gas(), context_.getAccount(msg.to()).getCode());
+    makeEvmcMessage(msg, depth_), msg.gas(), account.getCode(), &codeHash);
 
   return output;
 }
@@ -166,13 +172,14 @@ Bytes EvmContractExecutor::execute(EncodedCallMessage& msg) {
 Bytes EvmContractExecutor::execute(EncodedStaticCallMessage& msg) {
   // msg.gas().use(EVM_CONTRACT_CALL_COST); When executing a EVM contract
   // We let the VM handle the gas usage
-  View<Bytes> code = context_.getAccount(msg.to()).getCode();
+  const auto account = context_.getAccount(msg.to());
+  const Hash codeHash(account.getCodeHash());
 
   auto depthGuard = transactional::copy(depth_);
   ++depth_;
 
   return executeEvmcMessage(this->vm_, &this->get_interface(), this->to_context(),
-    makeEvmcMessage(msg, depth_), msg.gas(), code);
+    makeEvmcMessage(msg, depth_), msg.gas(), account.getCode(), &codeHash);
 }
 
 Bytes EvmContractExecutor::execute(EncodedDelegateCallMessage& msg) {
@@ -181,8 +188,10 @@ Bytes EvmContractExecutor::execute(EncodedDelegateCallMessage& msg) {
   auto depthGuard = transactional::copy(depth_);
   ++depth_;
 
+  const auto account = context_.getAccount(msg.codeAddress());
+  const Hash codeHash(account.getCodeHash());
   const Bytes output = executeEvmcMessage(this->vm_, &this->get_interface(), this->to_context(),
-    makeEvmcMessage(msg, depth_), msg.gas(), context_.getAccount(msg.codeAddress()).getCode());
+    makeEvmcMessage(msg, depth_), msg.gas(), account.getCode(), &codeHash);
 
   return output;
 }
@@ -228,7 +237,7 @@ evmc_storage_status EvmContractExecutor::set_storage(const evmc::address& addr,
 
 evmc::uint256be EvmContractExecutor::get_balance(const evmc::address& addr) const noexcept {
   try {
-    return EVMCConv::uint256ToEvmcUint256(context_.getAccount(addr).getBalance());
+    return context_.getAccount(addr).getBalance().toEvmc();
   } catch (const std::exception&) {
     return evmc::uint256be{};
   }
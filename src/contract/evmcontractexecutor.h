@@ -7,16 +7,17 @@
 #include "contract/contractstack.h"
 #include "anyencodedmessagehandler.h"
 #include "executioncontext.h"
+#include "evmcodecache.h"
 #include "traits.h"
 
 class EvmContractExecutor : public evmc::Host {
 public:
   EvmContractExecutor(
-    AnyEncodedMessageHandler messageHandler, ExecutionContext& context, evmc_vm *vm, IndexingMode indexingMode)
-      : messageHandler_(messageHandler), context_(context), vm_(vm), transientStorage_(), depth_(0), indexingMode_(indexingMode), deepestError_(nullptr) {}
+    AnyEncodedMessageHandler messageHandler, ExecutionContext& context, evmc_vm *vm, IndexingMode indexingMode, EvmCodeCache* codeCache = nullptr)
+      : messageHandler_(messageHandler), context_(context), vm_(vm), codeCache_(codeCache), transientStorage_(), depth_(0), indexingMode_(indexingMode), deepestError_(nullptr) {}
 
-  EvmContractExecutor(ExecutionContext& context, evmc_vm *vm, IndexingMode indexingMode)
-      : context_(context), vm_(vm), transientStorage_(), depth_(0), indexingMode_(indexingMode), deepestError_(nullptr) {}
+  EvmContractExecutor(ExecutionContext& context, evmc_vm *vm, IndexingMode indexingMode, EvmCodeCache* codeCache = nullptr)
+      : context_(context), vm_(vm), codeCache_(codeCache), transientStorage_(), depth_(0), indexingMode_(indexingMode), deepestError_(nullptr) {}
 
   void setMessageHandler(AnyEncodedMessageHandler messageHandler) { messageHandler_ = messageHandler; }
 
@@ -92,11 +93,12 @@ private:
   AnyEncodedMessageHandler messageHandler_;
   ExecutionContext& context_;
   evmc_vm *vm_;
+  EvmCodeCache* codeCache_; ///< Analyses of deployed code, nullptr to let the VM analyze on every call.
   boost::unordered_flat_map<StorageKey, Hash, SafeHash, SafeCompare> transientStorage_;
   IndexingMode indexingMode_;
   uint64_t depth_;
   std::unique_ptr<VMExecutionError> deepestError_;
-  Bytes executeEvmcMessage(evmc_vm* vm, const evmc_host_interface* host, evmc_host_context* context, const evmc_message& msg, Gas& gas, View<Bytes> code);
+  Bytes executeEvmcMessage(evmc_vm* vm, const evmc_host_interface* host, evmc_host_context* context, const evmc_message& msg, Gas& gas, View<Bytes> code, const Hash* codeHash = nullptr);
   void createContractImpl(auto& msg, ExecutionContext& context, View<Address> contractAddress, evmc_vm *vm, evmc::Host& host, uint64_t depth);
 };
 
@@ -1,8 +1,8 @@
 #include "executioncontext.h"
 
 void ExecutionContext::addEvent(Event event) {
-  transactional::AnyTransactional emplaceTransaction(transactional::emplaceBack(events_, std::move(event)));
-  transactions_.push(std::move(emplaceTransaction));
+  events_.emplace_back(std::move(event));
+  journal_.record(Journal::EventPush{&events_});
 }
 
 void ExecutionContext::addEvent(View<Address> address, View<Bytes> data, std::vector<Hash> topics) {
@@ -11,10 +11,39 @@ void ExecutionContext::addEvent(View<Address> address, View<Bytes> data, std::ve
 
 
 ExecutionContext::AccountPointer ExecutionContext::getAccount(View<Address> accountAddress) {
-  return ExecutionContext::AccountPointer(*accounts_[accountAddress], transactions_);
+  if (overlay_ != nullptr) {
+    return ExecutionContext::AccountPointer(getOverlayAccount(accountAddress), journal_);
+  }
+  // Accounts are created on first access and may be written through the pointer
+  if (dirtyKeys_ != nullptr) dirtyKeys_->accounts.emplace(accountAddress);
+  return ExecutionContext::AccountPointer(*accounts_[accountAddress], journal_);
+}
+
+Account& ExecutionContext::getOverlayAccount(View<Address> accountAddress) {
+  auto it = overlay_->accounts.find(accountAddress);
+  if (it == overlay_->accounts.end()) {
+    // Copy on first access, so the account can be written without touching the shared map
+    const auto baseIt = accounts_.find(accountAddress);
+    it = (baseIt != accounts_.end())
+      ? overlay_->accounts.try_emplace(Address(accountAddress), *baseIt->second).first
+      : overlay_->accounts.try_emplace(Address(accountAddress)).first;
+  }
+  return *it->second;
+}
+
+const BaseContract* ExecutionContext::findOverlayContract(View<Address> contractAddress) const {
+  if (!overlay_->contractsLock.owns_lock()) overlay_->contractsLock.lock();
+  const auto it = overlay_->contracts.find(contractAddress);
+  return (it != overlay_->contracts.end()) ? it->second.get() : nullptr;
 }
 
 BaseContract& ExecutionContext::getContract(View<Address> contractAddress) {
+  if (overlay_ != nullptr) {
+    if (const BaseContract* contract = findOverlayContract(contractAddress)) {
+      return const_cast<BaseContract&>(*contract);
+    }
+  }
+
   const auto it = contracts_.find(contractAddress);
 
   if (it == contracts_.end()) {
@@ -29,6 +58,10 @@ BaseContract& ExecutionContext::getContract(View<Address> contractAddress) {
 }
 
 const BaseContract& ExecutionContext::getContract(View<Address> contractAddress) const {
+  if (overlay_ != nullptr) {
+    if (const BaseContract* contract = findOverlayContract(contractAddress)) return *contract;
+  }
+
   const auto it = contracts_.find(contractAddress);
 
   if (it == contracts_.end()) {
@@ -43,20 +76,32 @@ const BaseContract& ExecutionContext::getContract(View<Address> contractAddress)
 }
 
 std::shared_ptr<Bytes> ExecutionContext::checkEVMContract(const Hash& codeHash, View<Bytes> code) {
-  const auto itContract = evmContracts_.find(codeHash);
-  if (itContract == evmContracts_.end()) {
-    auto itInsert = this->evmContracts_.emplace(codeHash, std::make_shared<Bytes>(code));
+  if (overlay_ != nullptr) {
+    if (const auto itShared = evmContracts_.find(codeHash); itShared != evmContracts_.end()) {
+      return itShared->second;
+    }
+  }
+  EVMContracts& evmContracts = (overlay_ != nullptr) ? overlay_->evmContracts : evmContracts_;
+  const auto itContract = evmContracts.find(codeHash);
+  if (itContract == evmContracts.end()) {
+    auto itInsert = evmContracts.emplace(codeHash, std::make_shared<Bytes>(code));
+    if (dirtyKeys_ != nullptr) dirtyKeys_->evmContracts.emplace(codeHash);
     // As it is the first contract with this code hash, we need
-    // to add a transaction to delete it from the map in case of revert
-    transactions_.push(transactional::AnyTransactional(transactional::BasicTransactional(evmContracts_, [codeHash] (auto& evmContracts) {
-      evmContracts.erase(codeHash);
-    })));
+    // to journal its insertion to delete it from the map in case of revert
+    journal_.record(Journal::EVMContractInsertion{&evmContracts, codeHash});
     return itInsert.first->second;
   }
   return itContract->second;
 }
 
 Account& ExecutionContext::getMutableAccount(View<Address> accountAddress) {
+  if (overlay_ != nullptr) {
+    if (!accountExists(accountAddress)) {
+      throw DynamicException("account not found");
+    }
+    return getOverlayAccount(accountAddress);
+  }
+
   const auto iterator = accounts_.find(accountAddress);
 
   if (iterator == accounts_.end()) {
@@ -67,6 +112,9 @@ Account& ExecutionContext::getMutableAccount(View<Address> accountAddress) {
 }
 
 bool ExecutionContext::accountExists(View<Address> accountAddress) const {
+  if (overlay_ != nullptr && overlay_->accounts.contains(accountAddress)) {
+    return true;
+  }
   return accounts_.contains(accountAddress);
 }
 
@@ -75,7 +123,12 @@ void ExecutionContext::addContract(View<Address> address, std::unique_ptr<BaseCo
     throw DynamicException("attempt to insert null contract");
   }
 
-  const auto [iterator, inserted] = contracts_.emplace(address, std::move(contract));
+  if (overlay_ != nullptr && contracts_.contains(address)) {
+    throw DynamicException("contract already exists");
+  }
+
+  Contracts& contracts = (overlay_ != nullptr) ? overlay_->contracts : contracts_;
+  const auto [iterator, inserted] = contracts.emplace(address, std::move(contract));
 
   if (!inserted) {
     throw DynamicException("contract already exists");
@@ -89,20 +142,14 @@ void ExecutionContext::addContract(View<Address> address, std::unique_ptr<BaseCo
 }
 
 void ExecutionContext::notifyNewContract(View<Address> address, BaseContract* contract) {
-  using ContractsTuple = std::tuple<ExecutionContext::Contracts&, std::vector<std::pair<Address, BaseContract*>>&>;
-
   newContracts_.emplace_back(address, contract);
 
-  transactions_.push(transactional::AnyTransactional(transactional::BasicTransactional(contracts_, [contractAddress = Address(address)] (auto& contracts) {
-    contracts.erase(contractAddress);
-  })));
-
-  transactions_.push(transactional::AnyTransactional(transactional::BasicTransactional(newContracts_, [] (auto& newContracts) {
-    newContracts.pop_back();
-  })));
+  Contracts& contractsMap = (overlay_ != nullptr) ? overlay_->contracts : contracts_;
+  journal_.record(Journal::ContractInsertion{&contractsMap, Address(address)});
+  journal_.record(Journal::NewContractPush{&newContracts_});
 }
 
-void ExecutionContext::transferBalance(View<Address> fromAddress, View<Address> toAddress, const uint256_t& amount) {
+void ExecutionContext::transferBalance(View<Address> fromAddress, View<Address> toAddress, const Uint256& amount) {
   auto sender = getAccount(fromAddress);
   auto recipient = getAccount(toAddress);
 
@@ -115,42 +162,49 @@ void ExecutionContext::transferBalance(View<Address> fromAddress, View<Address>
 }
 
 void ExecutionContext::store(View<Address> addr, View<Hash> slot, View<Hash> data) {
-  transactional::AnyTransactional transaction(transactional::emplaceOrAssign(storage_, StorageKeyView(addr, slot), data));
-  transactions_.push(std::move(transaction));
+  if (dirtyKeys_ != nullptr) dirtyKeys_->storage.emplace(StorageKeyView(addr, slot));
+  Storage& storage = (overlay_ != nullptr) ? overlay_->storage : storage_;
+  const auto [iterator, inserted] = storage.try_emplace(StorageKeyView(addr, slot), data);
+  if (inserted) {
+    journal_.record(Journal::StorageChange{&storage, iterator->first, std::nullopt});
+  } else {
+    journal_.record(Journal::StorageChange{&storage, iterator->first, iterator->second});
+    iterator->second = Hash(data);
+  }
 }
 
 Hash ExecutionContext::retrieve(View<Address> addr, View<Hash> slot) const {
+  if (overlay_ != nullptr) {
+    if (const auto iterator = overlay_->storage.find(StorageKeyView(addr, slot)); iterator != overlay_->storage.end()) {
+      return iterator->second;
+    }
+  }
   const auto iterator = storage_.find(StorageKeyView(addr, slot));
   return (iterator == storage_.end()) ? Hash() : iterator->second;
 }
 
-void ExecutionContext::commit() {  
-  while (!transactions_.empty()) {
-    transactions_.top().commit();
-    transactions_.pop();
-  }
+void ExecutionContext::commit() {
+  journal_.commit(journalBase_);
 
   events_.clear();
   newContracts_.clear();
 }
 
 void ExecutionContext::revert() {
-  while (!transactions_.empty()) {
-    transactions_.pop(); // transactions revert on destructor (by default)
-  }
+  journal_.revert(journalBase_);
 
   events_.clear();
   newContracts_.clear();
 }
 
 ExecutionContext::Checkpoint ExecutionContext::checkpoint() {
-  return ExecutionContext::Checkpoint(transactions_);
+  return ExecutionContext::Checkpoint(journal_);
 }
 
-ExecutionContext::AccountPointer::AccountPointer(Account& account, std::stack<transactional::AnyTransactional>& transactions)
-  : account_(account), transactions_(transactions) {}
+ExecutionContext::AccountPointer::AccountPointer(Account& account, Journal& journal)
+  : account_(account), journal_(journal) {}
 
-const uint256_t& ExecutionContext::AccountPointer::getBalance() const{
+const Uint256& ExecutionContext::AccountPointer::getBalance() const{
   return account_.balance;
 }
 
@@ -173,41 +227,39 @@ ContractType ExecutionContext::AccountPointer::getContractType() const {
   return account_.contractType;
 }
 
-void ExecutionContext::AccountPointer::setBalance(const uint256_t& amount) {
-  transactions_.push(transactional::AnyTransactional(transactional::copy(account_.balance)));
+void ExecutionContext::AccountPointer::setBalance(const Uint256& amount) {
+  journal_.record(Journal::BalanceChange{&account_, account_.balance});
   account_.balance = amount;
 }
 
 void ExecutionContext::AccountPointer::setNonce(uint64_t nonce) {
-  transactions_.push(transactional::AnyTransactional(transactional::copy(account_.nonce)));
+  journal_.record(Journal::NonceChange{&account_, account_.nonce});
   account_.nonce = nonce;
 }
 
 void ExecutionContext::AccountPointer::setCode(std::shared_ptr<Bytes> code, const Hash& codeHash) {
-  transactions_.push(transactional::AnyTransactional(transactional::copy(account_.codeHash)));
-  transactions_.push(transactional::AnyTransactional(transactional::copy(account_.code)));
+  journal_.record(Journal::CodeChange{&account_, account_.codeHash, account_.code});
   account_.codeHash = codeHash;
   account_.code = std::move(code);
 }
 
 void ExecutionContext::AccountPointer::setContractType(ContractType type) {
-  transactions_.push(transactional::AnyTransactional(transactional::copy(account_.contractType)));
+  journal_.record(Journal::ContractTypeChange{&account_, account_.contractType});
   account_.contractType = type;
 }
 
-ExecutionContext::Checkpoint::Checkpoint(std::stack<transactional::AnyTransactional>& transactions)
-  : transactions_(&transactions), checkpoint_(transactions.size()) {}
+ExecutionContext::Checkpoint::Checkpoint(Journal& journal)
+  : journal_(&journal), checkpoint_(journal.size()) {}
 
 void ExecutionContext::Checkpoint::commit() {
-  transactions_ = nullptr;
+  journal_ = nullptr;
 }
 
 void ExecutionContext::Checkpoint::revert() {
-  if (transactions_ == nullptr)
+  if (journal_ == nullptr)
     return;
-  
-  while (transactions_->size() > checkpoint_)
-    transactions_->pop();
 
-  transactions_ = nullptr;
+  journal_->revert(checkpoint_);
+
+  journal_ = nullptr;
 }
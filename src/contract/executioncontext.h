@@ -1,11 +1,14 @@
 #ifndef BDK_EXECUTIONCONTEXT_H
 #define BDK_EXECUTIONCONTEXT_H
 
-#include <stack>
+#include <mutex>
+#include <optional>
+#include <variant>
+#include <vector>
+#include <boost/unordered/unordered_flat_set.hpp>
 #include "utils/hash.h"
 #include "utils/address.h"
 #include "utils/utils.h"
-#include "utils/transactional.h"
 #include "utils/safehash.h"
 #include "contract/contract.h"
 #include "contract/event.h"
@@ -24,15 +27,110 @@ public:
 
   class AccountPointer;
 
+  class DirtyKeys;
+
+  /**
+   * Typed undo log of the changes made through an execution context.
+   * Entries are plain values stored contiguously, and truncating the log keeps its capacity,
+   * so a journal reused across the transactions of a block stops allocating once it has
+   * grown to fit the largest of them. Entries are undone in reverse order.
+   */
+  class Journal {
+  public:
+    struct BalanceChange {
+      Account* account;
+      Uint256 balance;
+      void undo() { account->balance = balance; }
+    };
+
+    struct NonceChange {
+      Account* account;
+      uint64_t nonce;
+      void undo() { account->nonce = nonce; }
+    };
+
+    struct CodeChange {
+      Account* account;
+      Hash codeHash;
+      std::shared_ptr<Bytes> code;
+      void undo() { account->codeHash = codeHash; account->code = std::move(code); }
+    };
+
+    struct ContractTypeChange {
+      Account* account;
+      ContractType contractType;
+      void undo() { account->contractType = contractType; }
+    };
+
+    struct StorageChange {
+      Storage* storage;
+      StorageKey key;
+      std::optional<Hash> previous; ///< Empty if the slot did not exist before.
+      void undo() {
+        if (previous.has_value()) storage->at(key) = *previous; else storage->erase(key);
+      }
+    };
+
+    struct EVMContractInsertion {
+      EVMContracts* evmContracts;
+      Hash codeHash;
+      void undo() { evmContracts->erase(codeHash); }
+    };
+
+    struct ContractInsertion {
+      Contracts* contracts;
+      Address address;
+      void undo() { contracts->erase(address); }
+    };
+
+    struct NewContractPush {
+      std::vector<std::pair<Address, BaseContract*>>* newContracts;
+      void undo() { newContracts->pop_back(); }
+    };
+
+    struct EventPush {
+      std::vector<Event>* events;
+      void undo() { events->pop_back(); }
+    };
+
+    using Entry = std::variant<
+      BalanceChange, NonceChange, CodeChange, ContractTypeChange, StorageChange,
+      EVMContractInsertion, ContractInsertion, NewContractPush, EventPush
+    >;
+
+    size_t size() const { return entries_.size(); }
+
+    template<typename T> void record(T&& entry) {
+      entries_.emplace_back(std::in_place_type<std::remove_cvref_t<T>>, std::forward<T>(entry));
+    }
+
+    /// Keep the changes recorded after the given size, dropping their entries.
+    void commit(size_t size) { entries_.erase(entries_.begin() + size, entries_.end()); }
+
+    /// Undo the changes recorded after the given size, latest first.
+    void revert(size_t size) {
+      while (entries_.size() > size) {
+        std::visit([] (auto& entry) { entry.undo(); }, entries_.back());
+        entries_.pop_back();
+      }
+    }
+
+  private:
+    std::vector<Entry> entries_;
+  };
+
   ExecutionContext(
     Accounts& accounts, Storage& storage, Contracts& contracts, EVMContracts& evmContracts,
     int64_t blockGasLimit,  int64_t blockNumber, int64_t blockTimestamp, int64_t txIndex,
     View<Address> blockCoinbase, View<Address> txOrigin, View<Hash> blockHash, View<Hash> txHash,
-    const uint256_t& chainId, const uint256_t& txGasPrice) :
+    const uint256_t& chainId, const uint256_t& txGasPrice, DirtyKeys* dirtyKeys = nullptr,
+    std::mutex* overlayContractsMutex = nullptr, Journal* journal = nullptr) :
     accounts_(accounts), storage_(storage), contracts_(contracts), evmContracts_(evmContracts), newContracts_(),
     blockGasLimit_(blockGasLimit), blockNumber_(blockNumber), blockTimestamp_(blockTimestamp), txIndex_(txIndex),
     blockCoinbase_(blockCoinbase), txOrigin_(txOrigin), blockHash_(blockHash), txHash_(txHash),
-    chainId_(chainId), txGasPrice_(txGasPrice) {}
+    chainId_(chainId), txGasPrice_(txGasPrice), dirtyKeys_(dirtyKeys),
+    overlay_(overlayContractsMutex != nullptr ? std::make_unique<Overlay>(*overlayContractsMutex) : nullptr),
+    journal_(journal != nullptr ? *journal : ownJournal_), journalBase_(journal_.size()) {}
 
   ~ExecutionContext() { revert(); }
 
@@ -93,7 +191,7 @@ public:
 
   void notifyNewContract(View<Address> address, BaseContract* contract);
 
-  void transferBalance(View<Address> fromAddress, View<Address> toAddress, const uint256_t& amount);
+  void transferBalance(View<Address> fromAddress, View<Address> toAddress, const Uint256& amount);
 
   void store(View<Address> addr, View<Hash> slot, View<Hash> data);
 
@@ -105,9 +203,31 @@ public:
 
   Checkpoint checkpoint();
 
+  bool isOverlay() const { return overlay_ != nullptr; }
+
 private:
+  /**
+   * Writes of an overlay context. The shared maps are only read and everything
+   * written lands here, to be thrown away along with the context.
+   * C++ contracts keep their variables inside themselves, so overlay contexts
+   * take turns using them through a mutex that is held until the context is destroyed.
+   */
+  struct Overlay {
+    Accounts accounts;
+    Storage storage;
+    Contracts contracts;
+    EVMContracts evmContracts;
+    std::unique_lock<std::mutex> contractsLock;
+
+    explicit Overlay(std::mutex& contractsMutex) : contractsLock(contractsMutex, std::defer_lock) {}
+  };
+
   Account& getMutableAccount(View<Address> accountAddress);
 
+  Account& getOverlayAccount(View<Address> accountAddress);
+
+  const BaseContract* findOverlayContract(View<Address> contractAddress) const;
+
   Accounts& accounts_;
   Storage& storage_;
   Contracts& contracts_;
@@ -125,14 +245,40 @@ private:
   size_t eventIndex_ = 0;
   std::vector<Event> events_;
   std::vector<std::pair<Address, BaseContract*>> newContracts_;
-  std::stack<transactional::AnyTransactional> transactions_;
+  DirtyKeys* dirtyKeys_;
+  std::unique_ptr<Overlay> overlay_;
+  Journal ownJournal_; ///< Used when no journal is given.
+  Journal& journal_;
+  size_t journalBase_; ///< Size of the journal when the context was built, this context only commits or reverts past it.
+};
+
+/**
+ * Set of state keys that may have changed since the last state dump.
+ * Keys are recorded as soon as they are touched, reverted changes included,
+ * so the set is a superset of the keys that actually changed.
+ */
+class ExecutionContext::DirtyKeys {
+public:
+  boost::unordered_flat_set<Address, SafeHash, SafeCompare> accounts; ///< Touched accounts.
+  boost::unordered_flat_set<StorageKey, SafeHash, SafeCompare> storage; ///< Touched EVM storage slots.
+  boost::unordered_flat_set<Hash, SafeHash, SafeCompare> evmContracts; ///< Inserted EVM contract code hashes.
+
+  bool empty() const { return accounts.empty() && storage.empty() && evmContracts.empty(); }
+
+  void clear() { accounts.clear(); storage.clear(); evmContracts.clear(); }
+
+  void merge(const DirtyKeys& other) {
+    accounts.insert(other.accounts.begin(), other.accounts.end());
+    storage.insert(other.storage.begin(), other.storage.end());
+    evmContracts.insert(other.evmContracts.begin(), other.evmContracts.end());
+  }
 };
 
 class ExecutionContext::AccountPointer {
 public:
-  AccountPointer(Account& account, std::stack<transactional::AnyTransactional>& transactions);
+  AccountPointer(Account& account, Journal& journal);
 
-  const uint256_t& getBalance() const;
+  const Uint256& getBalance() const;
 
   uint64_t getNonce() const;
 
@@ -142,7 +288,7 @@ public:
 
   ContractType getContractType() const;
 
-  void setBalance(const uint256_t& amount);
+  void setBalance(const Uint256& amount);
 
   void setNonce(uint64_t nonce);
 
@@ -152,12 +298,12 @@ public:
 
 private:
   Account& account_;
-  std::stack<transactional::AnyTransactional>& transactions_;
+  Journal& journal_;
 };
 
 class ExecutionContext::Checkpoint {
 public:
-  explicit Checkpoint(std::stack<transactional::AnyTransactional>& transactions);
+  explicit Checkpoint(Journal& journal);
 
   Checkpoint(const Checkpoint&) = delete;
   Checkpoint(Checkpoint&&) noexcept = delete;
@@ -171,7 +317,7 @@ public:
   void revert();
 
 private:
-  std::stack<transactional::AnyTransactional>* transactions_;
+  Journal* journal_;
   size_t checkpoint_;
 };
 
@@ -208,16 +354,22 @@ public:
 
   Builder& chainId(const uint256_t& chainId) { chainId_ = chainId; return *this; }
 
+  Builder& dirtyKeys(ExecutionContext::DirtyKeys& dirtyKeys) { dirtyKeys_ = &dirtyKeys; return *this; }
+
+  Builder& overlay(std::mutex& contractsMutex) { overlayContractsMutex_ = &contractsMutex; return *this; }
+
+  Builder& journal(ExecutionContext::Journal& journal) { journal_ = &journal; return *this; }
+
   ExecutionContext build() {
     return ExecutionContext(
       *accounts_, *storage_, *contracts_, *evmContracts_, blockGasLimit_, blockNumber_, blockTimestamp_, txIndex_,
-      blockCoinbase_, txOrigin_, blockHash_, txHash_, chainId_, txGasPrice_);
+      blockCoinbase_, txOrigin_, blockHash_, txHash_, chainId_, txGasPrice_, dirtyKeys_, overlayContractsMutex_, journal_);
   }
 
   std::unique_ptr<ExecutionContext> buildPtr() {
     return std::make_unique<ExecutionContext>(
       *accounts_, *storage_, *contracts_, *evmContracts_, blockGasLimit_, blockNumber_, blockTimestamp_, txIndex_,
-      blockCoinbase_, txOrigin_, blockHash_, txHash_, chainId_, txGasPrice_);
+      blockCoinbase_, txOrigin_, blockHash_, txHash_, chainId_, txGasPrice_, dirtyKeys_, overlayContractsMutex_, journal_);
   }
 
 private:
@@ -235,6 +387,9 @@ private:
   Hash txHash_;
   uint256_t chainId_;
   uint256_t txGasPrice_;
+  ExecutionContext::DirtyKeys* dirtyKeys_ = nullptr;
+  std::mutex* overlayContractsMutex_ = nullptr;
+  ExecutionContext::Journal* journal_ = nullptr;
 };
 
 #endif // BDK_EXECUTIONCONTEXT_H
@@ -40,7 +40,7 @@ Bytes PrecompiledContractExecutor::execute(EncodedStaticCallMessage& msg) {
   }
 }
 
-bool PrecompiledContractExecutor::isPrecompiled(View<Address> address) const {
+bool PrecompiledContractExecutor::isPrecompiled(View<Address> address) {
   if (address == RANDOM_GENERATOR_ADDRESS) {
     return true;
   }
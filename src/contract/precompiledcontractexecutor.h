@@ -37,7 +37,7 @@ public:
 
   RandomGen& randomGenerator() { return randomGen_; }
 
-  bool isPrecompiled(View<Address> address) const;
+  static bool isPrecompiled(View<Address> address);
 
 private:
   RandomGen randomGen_;
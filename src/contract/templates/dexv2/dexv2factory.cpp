@@ -24,6 +24,7 @@ DEXV2Factory::DEXV2Factory(const Address &address, const DB& db
     View<Bytes> valueView(dbEntry.value);
     this->getPair_[Address(dbEntry.key)][Address(valueView.subspan(0, 20))] = Address(valueView.subspan(20));
   }
+  this->dumpedPairs_ = this->allPairs_.size();
 
   this->feeTo_.commit();
   this->feeToSetter_.commit();
@@ -36,6 +37,7 @@ DEXV2Factory::DEXV2Factory(const Address &address, const DB& db
   this->feeToSetter_.enableRegister();
   this->allPairs_.enableRegister();
   this->getPair_.enableRegister();
+  this->getPair_.enableChangeTracking();
 }
 
 DEXV2Factory::DEXV2Factory(
@@ -57,6 +59,7 @@ DEXV2Factory::DEXV2Factory(
   this->feeToSetter_.enableRegister();
   this->allPairs_.enableRegister();
   this->getPair_.enableRegister();
+  this->getPair_.enableChangeTracking();
 }
 
 DEXV2Factory::~DEXV2Factory() {};
@@ -138,3 +141,48 @@ DBBatch DEXV2Factory::dump() const {
   return dbBatch;
 }
 
+
+std::function<DBBatch()> DEXV2Factory::snapshot() const {
+  // Copy the pairs while the state is locked, serialize them after
+  auto batch = std::make_shared<DBBatch>(BaseContract::dump());
+  batch->push_back(StrConv::stringToBytes("feeTo_"), this->feeTo_.get().view(), this->getDBPrefix());
+  batch->push_back(StrConv::stringToBytes("feeToSetter_"), this->feeToSetter_.get().view(), this->getDBPrefix());
+  this->dumpedPairs_ = this->allPairs_.size();
+  this->getPair_.clearChanges();
+  return [
+    batch, allPairs = this->allPairs_.get(), getPair = this->getPair_.get(),
+    allPairsPrefix = this->getNewPrefix("allPairs_"), getPairPrefix = this->getNewPrefix("getPair_")
+  ]() {
+    for (uint32_t i = 0; i < allPairs.size(); ++i) batch->push_back(UintConv::uint32ToBytes(i), allPairs[i].view(), allPairsPrefix);
+    for (const auto& [tokenA, tokensB] : getPair) {
+      for (const auto& [tokenB, pair] : tokensB) {
+        Bytes value = tokenB.asBytes();
+        Utils::appendBytes(value, pair.asBytes());
+        batch->push_back(tokenA, value, getPairPrefix);
+      }
+    }
+    return std::move(*batch);
+  };
+}
+
+std::function<DBBatch()> DEXV2Factory::snapshotDelta() const {
+  auto batch = std::make_shared<DBBatch>();
+  batch->push_back(StrConv::stringToBytes("feeTo_"), this->feeTo_.get().view(), this->getDBPrefix());
+  batch->push_back(StrConv::stringToBytes("feeToSetter_"), this->feeToSetter_.get().view(), this->getDBPrefix());
+  for (uint64_t i = this->dumpedPairs_; i < this->allPairs_.size(); ++i) {
+    batch->push_back(UintConv::uint32ToBytes(static_cast<uint32_t>(i)), this->allPairs_[i].view(), this->getNewPrefix("allPairs_"));
+  }
+  this->dumpedPairs_ = this->allPairs_.size();
+  return [batch, pairs = this->getPair_.takeChanges(), getPairPrefix = this->getNewPrefix("getPair_")]() {
+    // Pairs are never removed, so a token's current pairs are all there is to write
+    for (const auto& [tokenA, tokensB] : pairs) {
+      if (!tokensB.has_value()) continue;
+      for (const auto& [tokenB, pair] : *tokensB) {
+        Bytes value = tokenB.asBytes();
+        Utils::appendBytes(value, pair.asBytes());
+        batch->push_back(tokenA, value, getPairPrefix);
+      }
+    }
+    return std::move(*batch);
+  };
+}
@@ -32,6 +32,9 @@ class DEXV2Factory : public DynamicContract {
     /// Solidity: mapping(address => mapping(address => address)) public getPair;
     SafeUnorderedMap<Address, boost::unordered_flat_map<Address, Address, SafeHash>> getPair_;
 
+    /// Number of allPairs_ entries captured by the last dump. Pairs are only ever appended.
+    mutable uint64_t dumpedPairs_ = 0;
+
     /// Function for calling the register functions for contracts.
     void registerContractFunctions() override;
 
@@ -117,6 +120,22 @@ class DEXV2Factory : public DynamicContract {
     }
   /// Dump method
   DBBatch dump() const override;
+
+  /**
+   * Capture the whole factory, which includes the pairs created so far.
+   * The pairs are copied while the state is locked, and serialized by the returned function.
+   * @return A function that returns the dump.
+   */
+  std::function<DBBatch()> snapshot() const override;
+
+  /**
+   * Capture the fee addresses and the pairs created since the last dump.
+   * @return A function that returns the changed entries.
+   */
+  std::function<DBBatch()> snapshotDelta() const override;
+
+  /// Pairs are dumped as deltas.
+  bool hasDeltaDump() const override { return true; }
 };
 
 #endif  // DEXFACTORY_H
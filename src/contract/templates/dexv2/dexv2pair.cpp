@@ -267,16 +267,33 @@ DBBatch DEXV2Pair::dump() const {
   DBBatch erc20Batch = ERC20::dump();
   for (const auto& dbItem : erc20Batch.getPuts()) dbBatch.push_back(dbItem);
   for (const auto& dbItem : erc20Batch.getDels()) dbBatch.delete_key(dbItem);
-
-  dbBatch.push_back(StrConv::stringToBytes("factory_"), this->factory_.get().view(), this->getDBPrefix());
-  dbBatch.push_back(StrConv::stringToBytes("token0_"), this->token0_.get().view(), this->getDBPrefix());
-  dbBatch.push_back(StrConv::stringToBytes("token1_"), this->token1_.get().view(), this->getDBPrefix());
-  dbBatch.push_back(StrConv::stringToBytes("reserve0_"), UintConv::uint112ToBytes(this->reserve0_.get()), this->getDBPrefix());
-  dbBatch.push_back(StrConv::stringToBytes("reserve1_"), UintConv::uint112ToBytes(this->reserve1_.get()), this->getDBPrefix());
-  dbBatch.push_back(StrConv::stringToBytes("blockTimestampLast_"), UintConv::uint32ToBytes(this->blockTimestampLast_.get()), this->getDBPrefix());
-  dbBatch.push_back(StrConv::stringToBytes("price0CumulativeLast_"), UintConv::uint256ToBytes(this->price0CumulativeLast_.get()), this->getDBPrefix());
-  dbBatch.push_back(StrConv::stringToBytes("price1CumulativeLast_"), UintConv::uint256ToBytes(this->price1CumulativeLast_.get()), this->getDBPrefix());
-  dbBatch.push_back(StrConv::stringToBytes("kLast_"), UintConv::uint256ToBytes(this->kLast_.get()), this->getDBPrefix());
+  this->dumpPair(dbBatch);
   return dbBatch;
 }
 
+void DEXV2Pair::dumpPair(DBBatch& batch) const {
+  batch.push_back(StrConv::stringToBytes("factory_"), this->factory_.get().view(), this->getDBPrefix());
+  batch.push_back(StrConv::stringToBytes("token0_"), this->token0_.get().view(), this->getDBPrefix());
+  batch.push_back(StrConv::stringToBytes("token1_"), this->token1_.get().view(), this->getDBPrefix());
+  batch.push_back(StrConv::stringToBytes("reserve0_"), UintConv::uint112ToBytes(this->reserve0_.get()), this->getDBPrefix());
+  batch.push_back(StrConv::stringToBytes("reserve1_"), UintConv::uint112ToBytes(this->reserve1_.get()), this->getDBPrefix());
+  batch.push_back(StrConv::stringToBytes("blockTimestampLast_"), UintConv::uint32ToBytes(this->blockTimestampLast_.get()), this->getDBPrefix());
+  batch.push_back(StrConv::stringToBytes("price0CumulativeLast_"), UintConv::uint256ToBytes(this->price0CumulativeLast_.get()), this->getDBPrefix());
+  batch.push_back(StrConv::stringToBytes("price1CumulativeLast_"), UintConv::uint256ToBytes(this->price1CumulativeLast_.get()), this->getDBPrefix());
+  batch.push_back(StrConv::stringToBytes("kLast_"), UintConv::uint256ToBytes(this->kLast_.get()), this->getDBPrefix());
+}
+
+std::function<DBBatch()> DEXV2Pair::withPair(std::function<DBBatch()> tokenCapture) const {
+  // The pair's own variables are a handful of keys, dumped right away
+  auto pairBatch = std::make_shared<DBBatch>();
+  this->dumpPair(*pairBatch);
+  return [tokenCapture = std::move(tokenCapture), pairBatch]() {
+    DBBatch batch = tokenCapture();
+    for (const auto& dbItem : pairBatch->getPuts()) batch.push_back(dbItem);
+    return batch;
+  };
+}
+
+std::function<DBBatch()> DEXV2Pair::snapshot() const { return this->withPair(ERC20::snapshot()); }
+
+std::function<DBBatch()> DEXV2Pair::snapshotDelta() const { return this->withPair(ERC20::snapshotDelta()); }
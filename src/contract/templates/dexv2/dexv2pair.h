@@ -82,6 +82,19 @@ class DEXV2Pair : public ERC20 {
      */
     bool _mintFee(uint112_t reserve0, uint112_t reserve1);
 
+    /**
+     * Add the pair's own variables (tokens, reserves and price accumulators) to a dump.
+     * @param batch The batch to add the variables to.
+     */
+    void dumpPair(DBBatch& batch) const;
+
+    /**
+     * Add the pair's own variables to a capture of the token.
+     * @param tokenCapture The capture of the token (see ERC20::snapshot() and ERC20::snapshotDelta()).
+     * @return A function that returns the token's batch along with the pair's variables.
+     */
+    std::function<DBBatch()> withPair(std::function<DBBatch()> tokenCapture) const;
+
   public:
     /**
      * ConstructorArguments is a tuple of the contract constructor arguments in the order they appear in the constructor.
@@ -222,6 +235,18 @@ class DEXV2Pair : public ERC20 {
     }
     /// Dump method
     DBBatch dump() const override;
+
+    /**
+     * Capture the whole token along with the pair's own variables.
+     * @return A function that returns the dump.
+     */
+    std::function<DBBatch()> snapshot() const override;
+
+    /**
+     * Capture the token delta along with the pair's own variables.
+     * @return A function that returns the changed entries.
+     */
+    std::function<DBBatch()> snapshotDelta() const override;
 };
 
 #endif // DEXV2PAIR_H
@@ -34,6 +34,19 @@ DBBatch ERC20Mintable::dump() const {
   return batch;
 }
 
+std::function<DBBatch()> ERC20Mintable::withOwner(std::function<DBBatch()> tokenCapture) const {
+  auto ownableBatch = std::make_shared<DBBatch>(Ownable::dump());
+  return [tokenCapture = std::move(tokenCapture), ownableBatch]() {
+    DBBatch batch = tokenCapture();
+    for (const auto& dbItem : ownableBatch->getPuts()) batch.push_back(dbItem);
+    return batch;
+  };
+}
+
+std::function<DBBatch()> ERC20Mintable::snapshot() const { return this->withOwner(ERC20::snapshot()); }
+
+std::function<DBBatch()> ERC20Mintable::snapshotDelta() const { return this->withOwner(ERC20::snapshotDelta()); }
+
 void ERC20Mintable::registerContractFunctions() {
   registerContract();
   this->registerMemberFunctions(
@@ -25,6 +25,13 @@ class ERC20Mintable : virtual public ERC20, virtual public Ownable {
     /// Function for calling the register functions for contracts
     void registerContractFunctions() override;
 
+    /**
+     * Add the owner to a capture of the token.
+     * @param tokenCapture The capture of the token (see ERC20::snapshot() and ERC20::snapshotDelta()).
+     * @return A function that returns the token's batch along with the owner.
+     */
+    std::function<DBBatch()> withOwner(std::function<DBBatch()> tokenCapture) const;
+
   public:
     /// ConstructorArguments is a tuple of the contract constructor arguments in the order they appear in the constructor.
     using ConstructorArguments = std::tuple<
@@ -74,6 +81,18 @@ class ERC20Mintable : virtual public ERC20, virtual public Ownable {
 
     /// Dump method
     DBBatch dump() const override;
+
+    /**
+     * Capture the whole token along with the owner.
+     * @return A function that returns the dump.
+     */
+    std::function<DBBatch()> snapshot() const override;
+
+    /**
+     * Capture the token delta along with the owner.
+     * @return A function that returns the changed entries.
+     */
+    std::function<DBBatch()> snapshotDelta() const override;
 };
 
 #endif // MINTABLEERC20_H
@@ -10,6 +10,24 @@ See the LICENSE.txt file in the project root for more information.
 #include "../../../utils/uintconv.h"
 #include "../../../utils/strconv.h"
 
+namespace {
+  /// Add balances to a dump. Works on the contract's map as well as on a copy of it.
+  void dumpBalances(DBBatch& batch, const auto& balances, const Bytes& prefix) {
+    for (auto it = balances.cbegin(); it != balances.cend(); ++it) {
+      batch.push_back(it->first, Utils::uintToBytes(it->second), prefix);
+    }
+  }
+
+  /// Add an owner's allowances to a dump (Key = Address + Address, Value = uint256_t).
+  void dumpAllowances(DBBatch& batch, const Address& owner, const auto& spenders, const Bytes& prefix) {
+    for (auto it = spenders.cbegin(); it != spenders.cend(); ++it) {
+      Bytes key = owner.asBytes();
+      Utils::appendBytes(key, it->first.asBytes());
+      batch.push_back(key, UintConv::uint256ToBytes(it->second), prefix);
+    }
+  }
+}
+
 ERC20::ERC20(const Address& address, const DB& db)
 : DynamicContract(address, db), name_(this), symbol_(this), decimals_(this),
   totalSupply_(this), balances_(this), allowed_(this)
@@ -51,6 +69,8 @@ ERC20::ERC20(const Address& address, const DB& db)
   this->totalSupply_.enableRegister();
   this->balances_.enableRegister();
   this->allowed_.enableRegister();
+  this->balances_.enableChangeTracking();
+  this->allowed_.enableChangeTracking();
   #ifndef BUILD_TESTNET
     this->counter_.enableRegister();
     this->values_.enableRegister();
@@ -93,6 +113,8 @@ ERC20::ERC20(
   this->totalSupply_.enableRegister();
   this->balances_.enableRegister();
   this->allowed_.enableRegister();
+  this->balances_.enableChangeTracking();
+  this->allowed_.enableChangeTracking();
   #ifndef BUILD_TESTNET
     this->counter_.enableRegister();
     this->values_.enableRegister();
@@ -135,6 +157,8 @@ ERC20::ERC20(
   this->totalSupply_.enableRegister();
   this->balances_.enableRegister();
   this->allowed_.enableRegister();
+  this->balances_.enableChangeTracking();
+  this->allowed_.enableChangeTracking();
   #ifndef BUILD_TESTNET
     this->counter_.enableRegister();
     this->values_.enableRegister();
@@ -253,30 +277,61 @@ bool ERC20::transferFrom(
   return true;
 }
 
+void ERC20::dumpMetadata(DBBatch& batch) const {
+  batch.push_back(StrConv::stringToBytes("name_"), StrConv::stringToBytes(name_.get()), this->getDBPrefix());
+  batch.push_back(StrConv::stringToBytes("symbol_"), StrConv::stringToBytes(symbol_.get()), this->getDBPrefix());
+  batch.push_back(StrConv::stringToBytes("decimals_"), UintConv::uint8ToBytes(decimals_.get()), this->getDBPrefix());
+  batch.push_back(StrConv::stringToBytes("totalSupply_"), UintConv::uint256ToBytes(totalSupply_.get()), this->getDBPrefix());
+}
+
 DBBatch ERC20::dump() const
 {
   DBBatch dbBatch = BaseContract::dump();
 
   // Name, Symbol, Decimals, Total Supply
-  dbBatch.push_back(StrConv::stringToBytes("name_"), StrConv::stringToBytes(name_.get()), this->getDBPrefix());
-  dbBatch.push_back(StrConv::stringToBytes("symbol_"), StrConv::stringToBytes(symbol_.get()), this->getDBPrefix());
-  dbBatch.push_back(StrConv::stringToBytes("decimals_"), UintConv::uint8ToBytes(decimals_.get()), this->getDBPrefix());
-  dbBatch.push_back(StrConv::stringToBytes("totalSupply_"), UintConv::uint256ToBytes(totalSupply_.get()), this->getDBPrefix());
+  this->dumpMetadata(dbBatch);
   // Balances
-  for (auto it = balances_.cbegin(); it != balances_.cend(); ++it) {
-    const auto& key = it->first;
-    Bytes value = Utils::uintToBytes(it->second);
-    dbBatch.push_back(key, value, this->getNewPrefix("balances_"));
-  }
+  dumpBalances(dbBatch, this->balances_, this->getNewPrefix("balances_"));
   // Allowed
-  for (auto i = allowed_.cbegin(); i != allowed_.cend(); ++i) {
-    for (auto j = i->second.cbegin(); j != i->second.cend(); ++j) {
-      // Key = Address + Address, Value = uint256_t
-      auto key = i->first.asBytes();
-      Utils::appendBytes(key, j->first.asBytes());
-      dbBatch.push_back(key, UintConv::uint256ToBytes(j->second), this->getNewPrefix("allowed_"));
-    }
-  }
+  const Bytes allowedPrefix = this->getNewPrefix("allowed_");
+  for (auto it = allowed_.cbegin(); it != allowed_.cend(); ++it) dumpAllowances(dbBatch, it->first, it->second, allowedPrefix);
   return dbBatch;
 }
 
+std::function<DBBatch()> ERC20::snapshot() const {
+  // Copying the maps is much cheaper than serializing them, which is left for after the state is unlocked
+  auto batch = std::make_shared<DBBatch>(BaseContract::dump());
+  this->dumpMetadata(*batch);
+  this->balances_.clearChanges();
+  this->allowed_.clearChanges();
+  return [
+    batch, balances = this->balances_.get(), allowed = this->allowed_.get(),
+    balancesPrefix = this->getNewPrefix("balances_"), allowedPrefix = this->getNewPrefix("allowed_")
+  ]() {
+    dumpBalances(*batch, balances, balancesPrefix);
+    for (const auto& [owner, spenders] : allowed) dumpAllowances(*batch, owner, spenders, allowedPrefix);
+    return std::move(*batch);
+  };
+}
+
+std::function<DBBatch()> ERC20::snapshotDelta() const {
+  auto batch = std::make_shared<DBBatch>();
+  this->dumpMetadata(*batch);
+  return [
+    batch, balances = this->balances_.takeChanges(), allowed = this->allowed_.takeChanges(),
+    balancesPrefix = this->getNewPrefix("balances_"), allowedPrefix = this->getNewPrefix("allowed_")
+  ]() {
+    for (const auto& [owner, balance] : balances) {
+      if (balance.has_value()) {
+        batch->push_back(owner, Utils::uintToBytes(*balance), balancesPrefix);
+      } else {
+        batch->delete_key(owner, balancesPrefix);
+      }
+    }
+    // Allowances are set to zero but never removed, so an owner's current ones are all there is to write
+    for (const auto& [owner, spenders] : allowed) {
+      if (spenders.has_value()) dumpAllowances(*batch, owner, *spenders, allowedPrefix);
+    }
+    return std::move(*batch);
+  };
+}
@@ -69,6 +69,12 @@ class ERC20 : virtual public DynamicContract {
     /// Function for calling the register functions for contracts.
     void registerContractFunctions() override;
 
+    /**
+     * Add the token's metadata (name, symbol, decimals and total supply) to a dump.
+     * @param batch The batch to add the metadata to.
+     */
+    void dumpMetadata(DBBatch& batch) const;
+
 
     #ifndef BUILD_TESTNET
       SafeUnorderedMap<uint256_t, std::unordered_map<Address, uint256_t, SafeHash>> values_;
@@ -240,6 +246,25 @@ class ERC20 : virtual public DynamicContract {
 
   /// Dump method
   DBBatch dump() const override;
+
+  /**
+   * Capture the whole token, which includes the balance and allowance changes tracked so far.
+   * The balances and allowances are copied while the state is locked, and serialized by the returned function.
+   * Derived contracts with variables of their own must add them to the snapshot (see DEXV2Pair).
+   * @return A function that returns the dump.
+   */
+  std::function<DBBatch()> snapshot() const override;
+
+  /**
+   * Capture the token's metadata and the balances and allowances changed since the last dump.
+   * The changed entries are copied while the state is locked, and serialized by the returned function.
+   * Derived contracts with variables of their own must add them to the delta (see DEXV2Pair).
+   * @return A function that returns the changed entries.
+   */
+  std::function<DBBatch()> snapshotDelta() const override;
+
+  /// Balances and allowances are dumped as deltas.
+  bool hasDeltaDump() const override { return true; }
 };
 
 #endif /// ERC20_H
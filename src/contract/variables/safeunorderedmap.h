@@ -9,7 +9,12 @@ See the LICENSE.txt file in the project root for more information.
 #define SAFEUNORDEREDMAP_H
 
 #include <memory>
+#include <optional>
 #include <unordered_set>
+#include <vector>
+
+#include <boost/unordered/unordered_flat_set.hpp>
+
 #include "safebase.h"
 #include "../../utils/safehash.h"
 
@@ -24,6 +29,8 @@ template <typename Key, typename T> class SafeUnorderedMap : public SafeBase {
   private:
     boost::unordered_flat_map<Key, T, SafeHash> value_; ///< Current ("original") value.
     boost::unordered_flat_map<Key, std::optional<T>, SafeHash> copy_; ///< Previous ("temporary") value. Stores changed keys only.
+    mutable boost::unordered_flat_set<Key, SafeHash> changed_; ///< Keys committed since the last takeChanges(), if tracked.
+    bool trackChanges_ = false; ///< Indicates whether committed keys are kept in `changed_`.
 
   public:
     /**
@@ -573,8 +580,39 @@ template <typename Key, typename T> class SafeUnorderedMap : public SafeBase {
     inline bool operator==(const SafeUnorderedMap& other) const { return this->value_ == other.get(); }
     ///@}
 
+    /**
+     * Keep track of the keys changed by every commit from now on, so the contract
+     * can dump only the entries that changed (see takeChanges()).
+     */
+    void enableChangeTracking() { this->trackChanges_ = true; }
+
+    /**
+     * Take the entries changed by the commits since the last call, and stop tracking them.
+     * Must be called while no transaction is using the map (e.g. while the state is locked).
+     * @return The changed keys with their current values, or empty optionals for erased keys.
+     */
+    std::vector<std::pair<Key, std::optional<T>>> takeChanges() const {
+      std::vector<std::pair<Key, std::optional<T>>> ret;
+      ret.reserve(this->changed_.size());
+      for (const Key& key : this->changed_) {
+        if (auto it = this->value_.find(key); it != this->value_.end()) {
+          ret.emplace_back(key, it->second);
+        } else {
+          ret.emplace_back(key, std::nullopt);
+        }
+      }
+      this->changed_.clear();
+      return ret;
+    }
+
+    /// Forget the changes tracked so far, e.g. when the whole map was dumped.
+    void clearChanges() const { this->changed_.clear(); }
+
     /// Commit the value.
-    void commit() override { this->copy_.clear(); this->registered_ = false; }
+    void commit() override {
+      if (this->trackChanges_) for (const auto& [key, value] : this->copy_) this->changed_.emplace(key);
+      this->copy_.clear(); this->registered_ = false;
+    }
 
     /// Revert the value.
     void revert() override {
@@ -0,0 +1,106 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "blockbuilder.h"
+
+#include <algorithm>
+#include <queue>
+
+#include <boost/unordered/unordered_flat_map.hpp>
+
+#include "../utils/safehash.h"
+
+std::vector<size_t> BlockBuilder::select(
+  const std::vector<TxBlock>& candidates, const AccountLookup& account, const Limits& limits
+) {
+  const auto deadline = std::chrono::steady_clock::now() + limits.maxTime;
+
+  // Group the candidates per sender, in nonce order. With repeated nonces, the best paying goes first
+  boost::unordered_flat_map<Address, std::vector<size_t>, SafeHash> senders;
+  for (size_t i = 0; i < candidates.size(); ++i) senders[candidates[i].getFrom()].emplace_back(i);
+
+  // Cut each sender's executable chain: consecutive nonces its balance can pay for
+  struct Chain {
+    std::vector<size_t> txs;  // Indices of the chain's candidates, in nonce order.
+    size_t next = 0;          // Position of the next transaction to be selected.
+  };
+  std::vector<Chain> chains;
+  chains.reserve(senders.size());
+  for (auto& [sender, txs] : senders) {
+    std::ranges::sort(txs, [&candidates](size_t a, size_t b) {
+      const TxBlock& txA = candidates[a];
+      const TxBlock& txB = candidates[b];
+      if (txA.getNonce() != txB.getNonce()) return txA.getNonce() < txB.getNonce();
+      return txA.getMaxFeePerGas() > txB.getMaxFeePerGas();
+    });
+    auto [nonce, balance] = account(sender);
+    Chain chain;
+    for (const size_t i : txs) {
+      const TxBlock& tx = candidates[i];
+      if (tx.getNonce() < nonce) continue; // Already used, or a cheaper tx with the same nonce
+      if (tx.getNonce() != nonce) break; // Nonce gap
+      const uint256_t cost = tx.getValue() + (tx.getGasLimit() * tx.getMaxFeePerGas());
+      if (cost > balance) break;
+      balance -= cost;
+      ++nonce;
+      chain.txs.emplace_back(i);
+    }
+    if (!chain.txs.empty()) chains.emplace_back(std::move(chain));
+  }
+
+  // Merge the chains by the fee of their next transaction. bdk charges maxFeePerGas as the
+  // gas price (there is no base fee burn), so it is the whole tip the block creator gets
+  const auto head = [&](size_t c) -> const TxBlock& { return candidates[chains[c].txs[chains[c].next]]; };
+  const auto cheaper = [&head](size_t a, size_t b) {
+    const TxBlock& txA = head(a);
+    const TxBlock& txB = head(b);
+    if (txA.getMaxFeePerGas() != txB.getMaxFeePerGas()) return txA.getMaxFeePerGas() < txB.getMaxFeePerGas();
+    return txA.getMaxPriorityFeePerGas() < txB.getMaxPriorityFeePerGas();
+  };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(cheaper)> heads(cheaper);
+  for (size_t c = 0; c < chains.size(); ++c) heads.push(c);
+
+  std::vector<size_t> selected;
+  uint64_t gas = 0;
+  uint64_t bytes = 0;
+  for (uint64_t round = 0; !heads.empty(); ++round) {
+    // Checking the clock every round would cost more than the selection itself
+    if (round % 64 == 0 && std::chrono::steady_clock::now() >= deadline) break;
+    const size_t c = heads.top();
+    heads.pop();
+    const TxBlock& tx = head(c);
+    const uint256_t txGas = tx.getGasLimit();
+    const uint64_t txBytes = tx.rlpSize();
+    if (txGas > limits.maxGas - gas || txBytes > limits.maxBytes - bytes) continue; // Drops the rest of the chain
+    gas += static_cast<uint64_t>(txGas);
+    bytes += txBytes;
+    selected.emplace_back(chains[c].txs[chains[c].next]);
+    if (++chains[c].next < chains[c].txs.size()) heads.push(c);
+  }
+  return selected;
+}
+
+std::vector<size_t> BlockBuilder::selectRaw(
+  const std::vector<Bytes>& candidates, const uint64_t& chainId,
+  const AccountLookup& account, const Limits& limits
+) {
+  std::vector<TxBlock> txs;
+  std::vector<size_t> rawIndices;
+  txs.reserve(candidates.size());
+  rawIndices.reserve(candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    try {
+      txs.emplace_back(candidates[i], chainId);
+      rawIndices.emplace_back(i);
+    } catch (const std::exception&) {
+      // Not a valid transaction, leave it out of the block
+    }
+  }
+  std::vector<size_t> selected = BlockBuilder::select(txs, account, limits);
+  for (size_t& i : selected) i = rawIndices[i];
+  return selected;
+}
@@ -0,0 +1,65 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef BLOCKBUILDER_H
+#define BLOCKBUILDER_H
+
+#include <chrono>
+#include <functional>
+
+#include "../utils/tx.h" // ecdsa.h -> utils.h -> strings.h, bytes/view.h
+
+/**
+ * Selects the transactions of a new block out of a set of candidates.
+ * Candidates are grouped per sender into chains of consecutive nonces starting at the
+ * sender's account nonce, cut where the sender's balance stops covering their maximum cost
+ * (the same rule block validation applies). Chains are then merged by fee: the next
+ * transaction of the sender paying the most per gas goes in first, so each sender's
+ * transactions stay in nonce order. A transaction that doesn't fit the remaining gas or
+ * byte budget drops the rest of its sender's chain, as later nonces can't go in without it.
+ * Selection stops at the time deadline with whatever was selected so far.
+ */
+class BlockBuilder {
+  public:
+    /// Budget of a block being built.
+    struct Limits {
+      uint64_t maxGas;                    ///< Maximum sum of the selected transactions' gas limits.
+      uint64_t maxBytes;                  ///< Maximum sum of the selected transactions' serialized sizes.
+      std::chrono::microseconds maxTime;  ///< Maximum time spent selecting transactions.
+    };
+
+    /// Function that returns the nonce and balance of an account before the block.
+    using AccountLookup = std::function<std::pair<uint64_t, uint256_t>(const Address&)>;
+
+    /**
+     * Select the transactions of a block.
+     * @param candidates The candidate transactions, in any order.
+     * @param account Lookup for the senders' nonces and balances.
+     * @param limits The budget of the block.
+     * @return The indices of the selected candidates, in block order.
+     */
+    static std::vector<size_t> select(
+      const std::vector<TxBlock>& candidates, const AccountLookup& account, const Limits& limits
+    );
+
+    /**
+     * Select the transactions of a block out of raw candidates, e.g. the ones
+     * CometBFT proposes in CometListener::buildBlockProposal() (which calls it by default).
+     * Candidates that can't be decoded are left out.
+     * @param candidates The raw candidate transactions, in any order.
+     * @param chainId The chain ID the transactions must be signed for.
+     * @param account Lookup for the senders' nonces and balances.
+     * @param limits The budget of the block.
+     * @return The indices of the selected candidates, in block order.
+     */
+    static std::vector<size_t> selectRaw(
+      const std::vector<Bytes>& candidates, const uint64_t& chainId,
+      const AccountLookup& account, const Limits& limits
+    );
+};
+
+#endif // BLOCKBUILDER_H
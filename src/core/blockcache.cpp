@@ -0,0 +1,60 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "blockcache.h"
+
+std::shared_ptr<const FinalizedBlock> BlockCache::touch(Entry& entry) {
+  this->lru_.splice(this->lru_.begin(), this->lru_, entry.lruIt);
+  ++this->hits_;
+  return entry.block;
+}
+
+std::shared_ptr<const FinalizedBlock> BlockCache::get(const Hash& hash) {
+  std::lock_guard lock(this->mutex_);
+  if (auto it = this->entries_.find(hash); it != this->entries_.end()) return this->touch(it->second);
+  ++this->misses_;
+  return nullptr;
+}
+
+std::shared_ptr<const FinalizedBlock> BlockCache::get(uint64_t height) {
+  std::lock_guard lock(this->mutex_);
+  if (auto heightIt = this->heights_.find(height); heightIt != this->heights_.end()) {
+    return this->touch(this->entries_.find(heightIt->second)->second);
+  }
+  ++this->misses_;
+  return nullptr;
+}
+
+void BlockCache::put(std::shared_ptr<const FinalizedBlock> block) {
+  if (block == nullptr || block->getSize() > this->capacity_) return;
+  std::lock_guard lock(this->mutex_);
+  auto [it, inserted] = this->entries_.try_emplace(block->getHash());
+  if (!inserted) return; // Another reader decoded the same block first
+  this->lru_.push_front(block->getHash());
+  this->heights_.insert_or_assign(block->getNHeight(), block->getHash());
+  this->bytes_ += block->getSize();
+  it->second = Entry{std::move(block), this->lru_.begin()};
+  while (this->bytes_ > this->capacity_) {
+    auto evicted = this->entries_.find(this->lru_.back());
+    this->bytes_ -= evicted->second.block->getSize();
+    if (auto heightIt = this->heights_.find(evicted->second.block->getNHeight());
+      heightIt != this->heights_.end() && heightIt->second == evicted->first
+    ) this->heights_.erase(heightIt);
+    this->entries_.erase(evicted);
+    this->lru_.pop_back();
+  }
+}
+
+uint64_t BlockCache::size() const {
+  std::lock_guard lock(this->mutex_);
+  return this->entries_.size();
+}
+
+uint64_t BlockCache::bytes() const {
+  std::lock_guard lock(this->mutex_);
+  return this->bytes_;
+}
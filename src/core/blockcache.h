@@ -0,0 +1,89 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef BLOCKCACHE_H
+#define BLOCKCACHE_H
+
+#include <atomic>
+#include <list>
+#include <mutex>
+
+#include <boost/unordered/unordered_flat_map.hpp>
+
+#include "../utils/finalizedblock.h"
+#include "../utils/safehash.h"
+
+/**
+ * Bounded, thread-safe LRU cache of decoded blocks, keyed by hash and indexed by height.
+ * Decoding a block recovers the sender of every transaction, so serving the same recent
+ * blocks over and over (e.g. explorers polling the latest blocks) would otherwise be
+ * bound by signature recovery instead of memory. Blocks are final once stored,
+ * so entries never go stale and are only evicted.
+ * The bound is on the total serialized size of the cached blocks.
+ */
+class BlockCache {
+  public:
+    /**
+     * Constructor.
+     * @param capacity Maximum total size of the cached blocks, in bytes. 0 disables the cache.
+     */
+    explicit BlockCache(uint64_t capacity) : capacity_(capacity) {}
+
+    BlockCache(const BlockCache&) = delete;
+    BlockCache& operator=(const BlockCache&) = delete;
+
+    /**
+     * Get a block by its hash.
+     * @param hash The block's hash.
+     * @return The block, or `nullptr` if it is not cached.
+     */
+    std::shared_ptr<const FinalizedBlock> get(const Hash& hash);
+
+    /**
+     * Get a block by its height.
+     * @param height The block's height.
+     * @return The block, or `nullptr` if it is not cached.
+     */
+    std::shared_ptr<const FinalizedBlock> get(uint64_t height);
+
+    /**
+     * Add a block to the cache, evicting the least recently used ones if needed.
+     * Blocks larger than the whole cache are not added.
+     * @param block The block to add.
+     */
+    void put(std::shared_ptr<const FinalizedBlock> block);
+
+    uint64_t size() const; ///< Number of cached blocks.
+    uint64_t bytes() const; ///< Total serialized size of the cached blocks.
+    uint64_t getHits() const { return this->hits_; } ///< Number of lookups that found their block.
+    uint64_t getMisses() const { return this->misses_; } ///< Number of lookups that didn't.
+
+  private:
+    /// Cached block and its position in the LRU list.
+    struct Entry {
+      std::shared_ptr<const FinalizedBlock> block;
+      std::list<Hash>::iterator lruIt;
+    };
+
+    const uint64_t capacity_; ///< Maximum total size of the cached blocks.
+    mutable std::mutex mutex_; ///< Mutex for managing access to the entries and the LRU list.
+    std::list<Hash> lru_; ///< Block hashes from the most to the least recently used.
+    boost::unordered_flat_map<Hash, Entry, SafeHash> entries_; ///< Cached blocks.
+    boost::unordered_flat_map<uint64_t, Hash> heights_; ///< Hashes of the cached blocks, by height.
+    uint64_t bytes_ = 0; ///< Total serialized size of the cached blocks.
+    std::atomic<uint64_t> hits_ = 0; ///< Hit counter.
+    std::atomic<uint64_t> misses_ = 0; ///< Miss counter.
+
+    /**
+     * Mark a cached block as the most recently used one. Must be called with mutex_ locked.
+     * @param entry The block's entry.
+     * @return The block.
+     */
+    std::shared_ptr<const FinalizedBlock> touch(Entry& entry);
+};
+
+#endif // BLOCKCACHE_H
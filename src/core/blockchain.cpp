@@ -10,7 +10,7 @@ See the LICENSE.txt file in the project root for more information.
 Blockchain::Blockchain(const std::string& blockchainPath) :
   options_(Options::fromFile(blockchainPath)),
   p2p_(options_.getP2PIp(), options_, storage_, state_),
-  db_(std::get<0>(DumpManager::getBestStateDBPath(options_))),
+  db_(std::get<0>(DumpManager::getBestStateDBPath(options_)), options_.getDBSettings()),
   storage_(p2p_.getLogicalLocation(), options_),
   state_(db_, storage_, p2p_, std::get<1>(DumpManager::getBestStateDBPath(options_)), options_),
   http_(state_, storage_, p2p_, options_),
@@ -64,6 +64,8 @@ bool Syncer::sync(uint64_t blocksPerRequest, uint64_t bytesPerRequestLimit, int
   while (true) {
     if (!syncLoop(blocksPerRequest, bytesPerRequestLimit, waitForPeersSecs, tries, highestNode)) break;
   }
+  if (this->nextRequest_.valid()) this->nextRequest_.wait(); // Blocks past the target height, if any, are left to the network
+  this->nextRequest_ = {};
   this->synced_ = true;
   LOGINFOP("Synced with the network; my latest block height: " + std::to_string(this->storage_.latest()->getNHeight()));
   return true;
@@ -113,10 +115,18 @@ bool Syncer::syncLoop(
     + " bytes limit) from " + toString(highestNode.first)
   );
 
-  // Request the next block we need from the chosen peer
-  std::vector<FinalizedBlock> result = this->p2p_.requestBlock(
-    highestNode.first, downloadNHeight, downloadNHeightEnd, bytesPerRequestLimit
-  );
+  // Take the range that was downloaded while the previous one was processed, or request it now
+  std::vector<FinalizedBlock> result;
+  if (
+    this->nextRequest_.valid() &&
+    this->nextRequestNode_ == highestNode.first && this->nextRequestHeight_ == downloadNHeight
+  ) {
+    result = this->nextRequest_.get();
+  } else {
+    if (this->nextRequest_.valid()) this->nextRequest_.wait();
+    this->nextRequest_ = {};
+    result = this->p2p_.requestBlock(highestNode.first, downloadNHeight, downloadNHeightEnd, bytesPerRequestLimit);
+  }
 
   // If the request failed, retry it (unless we set a finite number of tries and we've just run out of them)
   if (result.empty()) {
@@ -131,17 +141,32 @@ bool Syncer::syncLoop(
 
   // Validate and connect the blocks
   try {
-    for (auto& block : result) {
-      // Blocks in the response must be all a contiguous range
-      if (block.getNHeight() != downloadNHeight) throw DynamicException(
-        "Peer sent block with wrong height " + std::to_string(block.getNHeight()) + " instead of " + std::to_string(downloadNHeight)
+    // Blocks in the response must be all a contiguous range
+    for (uint64_t i = 0; i < result.size(); i++) {
+      if (result[i].getNHeight() != downloadNHeight + i) throw DynamicException(
+        "Peer sent block with wrong height " + std::to_string(result[i].getNHeight()) + " instead of " + std::to_string(downloadNHeight + i)
       );
-      // This call validates the block first (throws exception if the block invalid).
-      // Note that the "result" vector's element data is being consumed (moved) by this call.
-      this->state_.processNextBlock(std::move(block));
-      LOGINFOP("Processed block " + std::to_string(downloadNHeight) + " from " + toString(highestNode.first));
-      downloadNHeight++;
     }
+    // Download (and decode, which verifies every signature) the next range while this one is executed
+    const uint64_t resultEnd = downloadNHeight + result.size();
+    if (resultEnd <= highestNode.second) {
+      this->nextRequestNode_ = highestNode.first;
+      this->nextRequestHeight_ = resultEnd;
+      this->nextRequest_ = std::async(std::launch::async, [this, node = highestNode.first, resultEnd, blocksPerRequest, bytesPerRequestLimit]() {
+        return this->p2p_.requestBlock(node, resultEnd, resultEnd + blocksPerRequest - 1, bytesPerRequestLimit);
+      });
+    }
+    // Catch-up mode: the whole range is validated and executed at once, the mempool is refreshed once
+    // for all of it and the storage writes of all of its blocks are committed together.
+    // Note that the "result" vector's element data is being consumed (moved) by this call.
+    const uint64_t expected = result.size();
+    const uint64_t processed = this->state_.tryProcessNextBlocks(std::move(result));
+    if (processed != 0) LOGINFOP("Processed blocks [" + std::to_string(downloadNHeight) + ","
+      + std::to_string(downloadNHeight + processed - 1) + "] from " + toString(highestNode.first)
+    );
+    if (processed != expected) throw DynamicException(
+      "Invalid block at height " + std::to_string(downloadNHeight + processed)
+    );
   } catch (std::exception &e) {
     LOGERROR("Invalid RequestBlock Answer from "
       + toString(highestNode.first) + " , error: " + e.what() + " closing session."
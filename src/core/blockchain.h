@@ -23,6 +23,11 @@ class Syncer : public Log::LogicalLocationProvider {
     State& state_;             ///< reference to the blockchain state.
     std::atomic<bool> synced_ = false;  ///< Indicates whether or not the syncer is synced.
 
+    /// Download of the range after the one being processed, so the next blocks are downloaded and decoded meanwhile.
+    std::future<std::vector<FinalizedBlock>> nextRequest_;
+    P2P::NodeID nextRequestNode_; ///< Peer the next range was requested from.
+    uint64_t nextRequestHeight_ = 0; ///< First block height of the next range.
+
   public:
     /**
      * Constructor.
@@ -78,7 +83,7 @@ class Blockchain : public Log::LogicalLocationProvider {
   private:
     Options options_;           ///< Options singleton.
     P2P::ManagerNormal p2p_;    ///< P2P connection manager. NOTE: must be initialized first due to getLogicalLocation()
-    const DB db_;               ///< Database.
+    DB db_;                     ///< State database, dumps are written into it.
     Storage storage_;           ///< Blockchain storage.
     State state_;               ///< Blockchain state.
     HTTPServer http_;           ///< HTTP server.
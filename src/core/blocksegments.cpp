@@ -0,0 +1,244 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "blocksegments.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <mutex>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/crc.hpp>
+
+#include "../utils/uintconv.h"
+
+namespace {
+  /// Size of the buffer that records are gathered in before being written.
+  constexpr size_t writeBufferBytes = 4 * 1024 * 1024;
+
+  /**
+   * Write a whole buffer to a file at a given offset.
+   * @param fd The file.
+   * @param data The data to write.
+   * @param offset The offset to write at.
+   * @param path The file's path, for error messages.
+   * @throw DynamicException on failure.
+   */
+  void writeAt(int fd, View<Bytes> data, uint64_t offset, const std::filesystem::path& path) {
+    while (!data.empty()) {
+      const ssize_t written = ::pwrite(fd, data.data(), data.size(), offset);
+      if (written < 0 && errno == EINTR) continue;
+      if (written <= 0) {
+        throw DynamicException("Failed to write block segment " + path.string() + ": " + std::strerror(errno));
+      }
+      data = data.subspan(written);
+      offset += written;
+    }
+  }
+
+  /**
+   * Flush a file's data to disk.
+   * @param fd The file.
+   * @param path The file's path, for error messages.
+   * @throw DynamicException on failure.
+   */
+  void sync(int fd, const std::filesystem::path& path) {
+    if (::fsync(fd) != 0) {
+      throw DynamicException("Failed to sync " + path.string() + ": " + std::strerror(errno));
+    }
+  }
+}
+
+BlockSegments::BlockSegments(std::filesystem::path dir, uint64_t segmentBlocks)
+  : dir_(std::move(dir)), segmentBlocks_(segmentBlocks)
+{
+  if (this->segmentBlocks_ == 0) throw DynamicException("Block segments must hold at least one block");
+  if (!std::filesystem::exists(this->dir_)) return;
+  std::vector<uint64_t> firstHeights;
+  for (const auto& entry : std::filesystem::directory_iterator(this->dir_)) {
+    const std::filesystem::path& path = entry.path();
+    // Leftover of a segment that was being written when the node stopped
+    if (path.extension() == ".tmp") {
+      std::filesystem::remove(path);
+    } else if (path.extension() == ".seg") {
+      firstHeights.push_back(std::stoull(path.stem().string()));
+    }
+  }
+  std::ranges::sort(firstHeights);
+  try {
+    for (uint64_t i = 0; i < firstHeights.size(); i++) {
+      if (firstHeights[i] != i * this->segmentBlocks_) throw DynamicException(
+        "Missing block segment at height " + std::to_string(i * this->segmentBlocks_) + " in " + this->dir_.string()
+      );
+      this->segments_.push_back(this->map(this->segmentPath(firstHeights[i]), firstHeights[i]));
+    }
+  } catch (...) {
+    for (const Segment& segment : this->segments_) ::munmap(const_cast<Byte*>(segment.data), segment.size);
+    throw;
+  }
+}
+
+BlockSegments::~BlockSegments() {
+  for (const Segment& segment : this->segments_) ::munmap(const_cast<Byte*>(segment.data), segment.size);
+}
+
+std::filesystem::path BlockSegments::segmentPath(uint64_t firstHeight) const {
+  // Zero-padded, so the files list in height order
+  std::string name = std::to_string(firstHeight);
+  name.insert(0, 20 - name.size(), '0');
+  return this->dir_ / (name + ".seg");
+}
+
+BlockSegments::Segment BlockSegments::map(const std::filesystem::path& path, uint64_t firstHeight) const {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw DynamicException("Failed to open block segment " + path.string() + ": " + std::strerror(errno));
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    throw DynamicException("Failed to stat block segment " + path.string() + ": " + std::strerror(errno));
+  }
+  const uint64_t size = st.st_size;
+  const uint64_t indexEnd = headerSize_ + (this->segmentBlocks_ + 1) * 8;
+  if (size < indexEnd) {
+    ::close(fd);
+    throw DynamicException("Malformed block segment " + path.string() + ": truncated header");
+  }
+  void* addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd); // The mapping keeps the file open
+  if (addr == MAP_FAILED) throw DynamicException("Failed to map block segment " + path.string() + ": " + std::strerror(errno));
+  const Segment segment{static_cast<const Byte*>(addr), size};
+
+  // Records are checksummed on every read, only the layout is checked here
+  const View<Bytes> view(segment.data, segment.size);
+  std::string error;
+  if (std::memcmp(segment.data, magic_.data(), magic_.size()) != 0) {
+    error = "bad magic";
+  } else if (UintConv::bytesToUint64(view.subspan(8, 8)) != firstHeight) {
+    error = "unexpected first height";
+  } else if (UintConv::bytesToUint64(view.subspan(16, 8)) != this->segmentBlocks_) {
+    error = "unexpected number of blocks";
+  } else {
+    uint64_t prev = UintConv::bytesToUint64(view.subspan(headerSize_, 8));
+    if (prev != indexEnd) error = "records don't follow the height index";
+    for (uint64_t i = 1; i <= this->segmentBlocks_ && error.empty(); i++) {
+      const uint64_t offset = UintConv::bytesToUint64(view.subspan(headerSize_ + i * 8, 8));
+      if (offset < prev + 8 || offset > size) error = "bad offset for record " + std::to_string(i - 1);
+      prev = offset;
+    }
+    if (error.empty() && prev != size) error = "trailing bytes";
+  }
+  if (!error.empty()) {
+    ::munmap(addr, size);
+    throw DynamicException("Malformed block segment " + path.string() + ": " + error);
+  }
+  return segment;
+}
+
+uint64_t BlockSegments::endHeight() const {
+  std::shared_lock lock(this->mutex_);
+  return this->segments_.size() * this->segmentBlocks_;
+}
+
+void BlockSegments::append(const std::function<Record(uint64_t height)>& read) {
+  const uint64_t firstHeight = this->endHeight();
+  const std::filesystem::path path = this->segmentPath(firstHeight);
+  std::filesystem::path tmpPath = path;
+  tmpPath += ".tmp";
+  std::filesystem::create_directories(this->dir_);
+
+  int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) throw DynamicException("Failed to create block segment " + tmpPath.string() + ": " + std::strerror(errno));
+  try {
+    // The height index goes right after the header, but offsets are only known once every
+    // record is written, so its space is reserved and it is written last
+    const uint64_t indexEnd = headerSize_ + (this->segmentBlocks_ + 1) * 8;
+    Bytes index;
+    index.reserve((this->segmentBlocks_ + 1) * 8);
+    Bytes buffer(magic_.begin(), magic_.end());
+    Utils::appendBytes(buffer, UintConv::uint64ToBytes(firstHeight));
+    Utils::appendBytes(buffer, UintConv::uint64ToBytes(this->segmentBlocks_));
+    buffer.resize(indexEnd);
+    uint64_t written = 0;
+    for (uint64_t i = 0; i < this->segmentBlocks_; i++) {
+      const Record record = read(firstHeight + i);
+      if (record.block.size() > std::numeric_limits<uint32_t>::max()) throw DynamicException(
+        "Block " + std::to_string(firstHeight + i) + " is too large for a block segment"
+      );
+      Utils::appendBytes(index, UintConv::uint64ToBytes(written + buffer.size()));
+      const BytesArr<4> blockSize = UintConv::uint32ToBytes(uint32_t(record.block.size()));
+      boost::crc_32_type crc;
+      crc.process_bytes(blockSize.data(), blockSize.size());
+      crc.process_bytes(record.block.data(), record.block.size());
+      crc.process_bytes(record.sidecar.data(), record.sidecar.size());
+      Utils::appendBytes(buffer, UintConv::uint32ToBytes(crc.checksum()));
+      Utils::appendBytes(buffer, blockSize);
+      buffer.insert(buffer.end(), record.block.begin(), record.block.end());
+      buffer.insert(buffer.end(), record.sidecar.begin(), record.sidecar.end());
+      if (buffer.size() >= writeBufferBytes) {
+        writeAt(fd, buffer, written, tmpPath);
+        written += buffer.size();
+        buffer.clear();
+      }
+    }
+    writeAt(fd, buffer, written, tmpPath);
+    written += buffer.size();
+    Utils::appendBytes(index, UintConv::uint64ToBytes(written));
+    writeAt(fd, index, headerSize_, tmpPath);
+    sync(fd, tmpPath);
+    ::close(fd);
+    fd = -1;
+
+    // Only complete segments ever get their final name
+    std::filesystem::rename(tmpPath, path);
+    const int dirFd = ::open(this->dir_.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dirFd < 0) throw DynamicException("Failed to open " + this->dir_.string() + ": " + std::strerror(errno));
+    try {
+      sync(dirFd, this->dir_);
+    } catch (...) {
+      ::close(dirFd);
+      throw;
+    }
+    ::close(dirFd);
+  } catch (...) {
+    if (fd >= 0) ::close(fd);
+    std::filesystem::remove(tmpPath);
+    throw;
+  }
+
+  const Segment segment = this->map(path, firstHeight);
+  std::unique_lock lock(this->mutex_);
+  this->segments_.push_back(segment);
+}
+
+std::optional<BlockSegments::Record> BlockSegments::get(uint64_t height) const {
+  Segment segment;
+  {
+    std::shared_lock lock(this->mutex_);
+    const uint64_t index = height / this->segmentBlocks_;
+    if (index >= this->segments_.size()) return std::nullopt;
+    segment = this->segments_[index];
+  }
+  // Offsets were checked when the segment was mapped
+  const View<Bytes> view(segment.data, segment.size);
+  const uint64_t entry = headerSize_ + (height % this->segmentBlocks_) * 8;
+  const uint64_t begin = UintConv::bytesToUint64(view.subspan(entry, 8));
+  const uint64_t end = UintConv::bytesToUint64(view.subspan(entry + 8, 8));
+  const View<Bytes> record = view.subspan(begin, end - begin);
+  boost::crc_32_type crc;
+  crc.process_bytes(record.data() + 4, record.size() - 4);
+  const uint32_t blockSize = UintConv::bytesToUint32(record.subspan(4, 4));
+  if (crc.checksum() != UintConv::bytesToUint32(record.subspan(0, 4)) || blockSize > record.size() - 8) {
+    throw DynamicException("Corrupted block record at height " + std::to_string(height) + " in " + this->dir_.string());
+  }
+  return Record{record.subspan(8, blockSize), record.subspan(8 + blockSize)};
+}
@@ -0,0 +1,109 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef BLOCKSEGMENTS_H
+#define BLOCKSEGMENTS_H
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <shared_mutex>
+
+#include "../utils/utils.h"
+
+/**
+ * Append-only store of old blocks ("cold tier"), kept outside of the database so
+ * compactions never rewrite them again.
+ * Blocks are grouped in segment files of a fixed number of consecutive heights, starting at 0.
+ * Each segment is written once, sequentially, and only becomes visible once it is complete and
+ * synced to disk. Segments are then memory-mapped, so reads are served from the page cache
+ * without copying, and scanning a range of heights reads the file sequentially.
+ *
+ * Segment layout (integers are big-endian):
+ * - Header: the magic "BDKSEG01" (8 bytes), the first height (8 bytes) and the number of blocks (8 bytes).
+ * - Height index: the absolute offset of each record, plus the end of the last one (8 bytes each).
+ * - Records: a CRC-32 of the rest of the record (4 bytes), the size of the block (4 bytes),
+ *   the block (see FinalizedBlock::serializeBlockV2()) and its sidecar (see FinalizedBlock::serializeSidecar()).
+ */
+class BlockSegments {
+  public:
+    /// A stored block. Views stay valid for as long as the store lives.
+    struct Record {
+      View<Bytes> block; ///< The serialized block.
+      View<Bytes> sidecar; ///< The block's sidecar.
+    };
+
+    /**
+     * Constructor. Maps the segments found in the directory, checking their headers and height index.
+     * The directory is only created once the first segment is written.
+     * @param dir The directory of the segment files.
+     * @param segmentBlocks Number of blocks in each segment.
+     * @throw DynamicException if a segment is missing or malformed.
+     */
+    BlockSegments(std::filesystem::path dir, uint64_t segmentBlocks);
+
+    ~BlockSegments(); ///< Destructor. Unmaps every segment.
+
+    BlockSegments(const BlockSegments&) = delete;
+    BlockSegments& operator=(const BlockSegments&) = delete;
+
+    /// Get the number of blocks in each segment.
+    uint64_t getSegmentBlocks() const { return this->segmentBlocks_; }
+
+    /// Get the height after the last stored block (every lower height is stored).
+    uint64_t endHeight() const;
+
+    /**
+     * Write the next segment, covering the getSegmentBlocks() heights from endHeight() on.
+     * Blocks are streamed to a temporary file, which is synced and renamed into place,
+     * so a crash never leaves a partial segment behind.
+     * @param read Called once per height, in order, to get the block to store and its sidecar.
+     *             The views only have to stay valid until the next call.
+     * @throw DynamicException if the segment can't be written.
+     */
+    void append(const std::function<Record(uint64_t height)>& read);
+
+    /**
+     * Get a stored block, checking its checksum.
+     * @param height The block's height.
+     * @return The block and its sidecar, or an empty optional if the height is not stored.
+     * @throw DynamicException if the record is corrupted.
+     */
+    std::optional<Record> get(uint64_t height) const;
+
+  private:
+    /// A memory-mapped segment file.
+    struct Segment {
+      const Byte* data; ///< Start of the mapping.
+      size_t size; ///< Size of the mapping.
+    };
+
+    static constexpr std::string_view magic_ = "BDKSEG01"; ///< Magic bytes at the start of every segment.
+    static constexpr uint64_t headerSize_ = 24; ///< Size of the segment header.
+
+    const std::filesystem::path dir_; ///< The directory of the segment files.
+    const uint64_t segmentBlocks_; ///< Number of blocks in each segment.
+    mutable std::shared_mutex mutex_; ///< Mutex for managing access to the segment list.
+    std::vector<Segment> segments_; ///< Mapped segments, the first one starting at height 0.
+
+    /**
+     * Get the path of a segment file.
+     * @param firstHeight The first height of the segment.
+     */
+    std::filesystem::path segmentPath(uint64_t firstHeight) const;
+
+    /**
+     * Map a segment file and check its header and height index.
+     * @param path The segment's path.
+     * @param firstHeight The expected first height of the segment.
+     * @return The mapped segment.
+     * @throw DynamicException if the file can't be mapped or is malformed.
+     */
+    Segment map(const std::filesystem::path& path, uint64_t firstHeight) const;
+};
+
+#endif // BLOCKSEGMENTS_H
@@ -13,6 +13,8 @@ See the LICENSE.txt file in the project root for more information.
 #include "../utils/options.h"
 #include "../utils/logger.h"
 
+#include "blockbuilder.h"
+
 /// Comet driver states
 enum class CometState {
   STOPPED          =  0, ///< Comet is in stopped state (no worker thread started)
@@ -89,6 +91,17 @@ struct CometBlock {
   Bytes prevHash; ///< [OPTIONAL] the "hash" param of the *previous* block (synth by the driver, not from ABCI).
 };
 
+/**
+ * What the default CometListener::buildBlockProposal() needs to pick and order the proposed
+ * transactions with BlockBuilder::selectRaw(). The byte budget is always the `maxTxBytes` given by CometBFT.
+ */
+struct CometProposalLimits {
+  uint64_t chainId = 0; ///< Chain ID the transactions must be signed for.
+  BlockBuilder::AccountLookup account; ///< Lookup for the senders' nonces and balances before the block (unset == no selection).
+  uint64_t maxGas = 0; ///< Maximum sum of the selected transactions' gas limits.
+  std::chrono::microseconds maxTime{0}; ///< Maximum time spent selecting transactions.
+};
+
 /**
  * The Comet class notifies its user of events through the CometListener interface.
  * Users of the Comet class must implement a CometListener class and pass a pointer
@@ -183,12 +196,29 @@ class CometListener {
       const uint64_t maxTxBytes, const CometBlock& block, bool& noChange, std::vector<size_t>& txIds,
       std::vector<Bytes>& injectTxs
     ) {
-      // This requires all block size and limit related params to be set in such a way that the
-      // total byte size of txs in the request don't exceed the total byte size allowed for a block.
-      // By default, this just copies the recommended `txs` from the mempool into the proposal.
-      noChange = true;
+      // By default, the transactions are picked and ordered by fee out of the ones recommended by the
+      // mempool, within `maxTxBytes` and the gas and time limits set by getProposalLimits().
+      // Without an account lookup there's nothing to select with, so they're copied unmodified instead.
+      CometProposalLimits limits;
+      this->getProposalLimits(limits);
+      if (!limits.account) {
+        noChange = true;
+        return;
+      }
+      txIds = BlockBuilder::selectRaw(
+        block.txs, limits.chainId, limits.account, BlockBuilder::Limits{limits.maxGas, maxTxBytes, limits.maxTime}
+      );
+      noChange = false;
     }
 
+    /**
+     * Validator node that is the block proposer needs the limits to select the transactions of its proposal.
+     * Only called by the default buildBlockProposal().
+     * @param limits Outparam to be filled in with the proposal limits; leaving `limits.account` unset (the default)
+     * forwards the transactions recommended by the mempool unmodified.
+     */
+    virtual void getProposalLimits(CometProposalLimits& limits) {}
+
     /**
      * Validator node receives a block proposal from the block proposer, and must check if the proposal is a valid one.
      * @param block The block being proposed (for reading; if you need to keep it, you must copy it explicitly).
@@ -116,41 +116,17 @@ void Consensus::validatorLoop() {
       }
     }
 
-    auto waitForTxs = std::chrono::high_resolution_clock::now();
-    bool logged = false;
-    while (this->state_.getMempoolSize() < 1) {
-      if (!logged) {
-        logged = true;
-        Utils::safePrint("Waiting for at least one transaction in the mempool.");
-      }
-      if (this->stopConsensus_) return;
-      std::this_thread::sleep_for(std::chrono::microseconds(10));
+    if (this->state_.getPendingTxsSize() < 1) {
+      Utils::safePrint("Waiting for at least one transaction in the mempool.");
     }
+    if (!this->waitUntil([this]() { return this->state_.getPendingTxsSize() >= 1; })) return;
 
     // Finally, create the block
     Utils::safePrint("Creating block.");
 
-    // Get a copy of the mempool and current timestamp
-    auto chainTxs = this->state_.getMempool();
-    // We need to filter chainTxs to only allow one transaction per address
-    // Otherwise we will have a nonce mismatch
-    std  ::unordered_map<Address, TxBlock, SafeHash> chainTxsMap;
-    for (const auto& tx : chainTxs) {
-      // We need to actually check which tx has the greatest fee spent
-      auto txIt = chainTxsMap.find(tx.getFrom());
-      if (txIt == chainTxsMap.end()) {
-        chainTxsMap.insert({tx.getFrom(), tx});
-      } else {
-        if (tx.getMaxFeePerGas() > txIt->second.getMaxFeePerGas()) {
-          chainTxsMap.insert_or_assign(tx.getFrom(), tx);
-        }
-      }
-    }
-    chainTxs.clear();
-    // Now copy the map back to the vector
-    for (const auto& [addr, tx] : chainTxsMap) {
-      chainTxs.emplace_back(tx);
-    }
+    // Select the block's transactions from the mempool and get the current timestamp.
+    // Senders' consecutive nonces go in together, best paying first, within the block's budget
+    auto chainTxs = this->state_.buildBlockTxs(this->blockLimits_);
 
     uint64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
       std::chrono::system_clock::now().time_since_epoch()
@@ -187,25 +163,23 @@ void Consensus::validatorLoop() {
     this->p2p_.getBroadcaster().broadcastBlock(this->storage_.latest());
 
 
-    // Keep looping while we don't reach the latest block
-    logged = false;
-    while (latestBlockHeight == this->storage_.latest()->getNHeight() && !this->stopConsensus_) {
-      if (!logged) {
-        Utils::safePrint("Waiting for next block to be created.");
-        Utils::safePrint("Validator: " + me.hex(true).get() + " Waiting for next block to be created.");
-        logged = true;
-      }
-      // Wait for next block to be created.
-      std::this_thread::sleep_for(std::chrono::microseconds(10));
+    // Wait until we reach the latest block
+    if (latestBlockHeight == this->storage_.latest()->getNHeight()) {
+      Utils::safePrint("Waiting for next block to be created.");
+      Utils::safePrint("Validator: " + me.hex(true).get() + " Waiting for next block to be created.");
     }
+    this->waitUntil([&]() { return latestBlockHeight != this->storage_.latest()->getNHeight(); });
   }
 }
 
 void Consensus::pullerLoop() {
   // List of all current existing requests towards other nodes. A list for TxBlock and a list for TxValidator.
   std::unordered_map<P2P::NodeID, std::future<std::vector<TxBlock>>, SafeHash> txBlockRequests;
+  uint64_t heightChanges = this->p2p_.getNodeConns().getHeightChanges();
   while (!this->stopPuller_) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    // Wake up as soon as a peer reports a new block, or to pull transactions again
+    heightChanges = this->p2p_.getNodeConns().waitForHeightChange(heightChanges, txPullInterval_);
+    if (this->stopPuller_) break;
     // First, lets get a list of all nodes we are connected to.
     auto nodes = this->p2p_.getSessionsIDs(P2P::NodeType::NORMAL_NODE);
     // Now, we remove from the requests map all nodes that are not connected anymore.
@@ -256,13 +230,10 @@ void Consensus::pullerLoop() {
             );
             Utils::safePrint("Received " + std::to_string(result.size()));
 
-            // If we got blocks, process them
+            // If we got blocks, process them all at once (see State::tryProcessNextBlocks())
             if (!result.empty()) {
               try {
-                for (auto & block : result) {
-                  this->state_.tryProcessNextBlock(std::move(block));
-                  ++downloadNHeight;
-                }
+                this->state_.tryProcessNextBlocks(std::move(result));
               } catch (std::exception &e) {
                 // We actually don't do anything here, because broadcast might have received a block
               }
@@ -310,29 +281,22 @@ void Consensus::doValidatorBlock() {
   // Wait until we are ready to create the block
   auto start = std::chrono::high_resolution_clock::now();
   LOGDEBUG("Block creator: waiting for txs");
-  uint64_t validatorMempoolSize = 0;
-  std::unique_ptr<uint64_t> lastLog = nullptr;
-  while (validatorMempoolSize != this->state_.rdposGetMinValidators() * 2 && !this->stopConsensus_) {
-    if (lastLog == nullptr || *lastLog != validatorMempoolSize) {
-      lastLog = std::make_unique<uint64_t>(validatorMempoolSize);
+  std::optional<uint64_t> lastLog;
+  const bool gotValidatorTxs = this->waitUntil([&]() {
+    const uint64_t validatorMempoolSize = this->state_.rdposGetMempoolSize();
+    if (lastLog != validatorMempoolSize) {
+      lastLog = validatorMempoolSize;
       LOGDEBUG("Block creator has: " + std::to_string(validatorMempoolSize) + " transactions in mempool");
     }
-    validatorMempoolSize = this->state_.rdposGetMempoolSize();
-    std::this_thread::sleep_for(std::chrono::microseconds(10));
-  }
+    return validatorMempoolSize == this->state_.rdposGetMinValidators() * 2;
+  });
+  if (!gotValidatorTxs) return;
   LOGDEBUG("Validator ready to create a block");
 
   // Wait until we have all required transactions to create the block.
   auto waitForTxs = std::chrono::high_resolution_clock::now();
-  bool logged = false;
-  while (this->state_.getMempoolSize() < 1) {
-    if (!logged) {
-      logged = true;
-      LOGDEBUG("Waiting for at least one transaction in the mempool.");
-    }
-    if (this->stopConsensus_) return;
-    std::this_thread::sleep_for(std::chrono::microseconds(10));
-  }
+  if (this->state_.getPendingTxsSize() < 1) LOGDEBUG("Waiting for at least one transaction in the mempool.");
+  if (!this->waitUntil([this]() { return this->state_.getPendingTxsSize() >= 1; })) return;
 
   auto creatingBlock = std::chrono::high_resolution_clock::now();
 
@@ -379,27 +343,9 @@ void Consensus::doValidatorBlock() {
   for (const auto& tx: randomnessTxs) validatorTxs.emplace_back(tx);
   if (this->stopConsensus_) return;
 
-  // Get a copy of the mempool and current timestamp
-  auto chainTxs = this->state_.getMempool();
-  // We need to filter chainTxs to only allow one transaction per address
-  // Otherwise we will have a nonce mismatch
-  std::unordered_map<Address, TxBlock, SafeHash> chainTxsMap;
-  for (const auto& tx : chainTxs) {
-    // We need to actually check which tx has the greatest fee spent
-    auto txIt = chainTxsMap.find(tx.getFrom());
-    if (txIt == chainTxsMap.end()) {
-      chainTxsMap.insert({tx.getFrom(), tx});
-    } else {
-      if (tx.getMaxFeePerGas() > txIt->second.getMaxFeePerGas()) {
-        chainTxsMap.insert_or_assign(tx.getFrom(), tx);
-      }
-    }
-  }
-  chainTxs.clear();
-  // Now copy the map back to the vector
-  for (const auto& [addr, tx] : chainTxsMap) {
-    chainTxs.emplace_back(tx);
-  }
+  // Select the block's transactions from the mempool and get the current timestamp.
+  // Senders' consecutive nonces go in together, best paying first, within the block's budget
+  auto chainTxs = this->state_.buildBlockTxs(this->blockLimits_);
 
   uint64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
     std::chrono::system_clock::now().time_since_epoch()
@@ -486,16 +432,16 @@ void Consensus::doValidatorTx(const uint64_t& nHeight, const Validator& me) {
 
   // Wait until we received all randomHash transactions to broadcast the randomness transaction
   LOGDEBUG("Waiting for randomHash transactions to be broadcasted");
-  uint64_t validatorMempoolSize = 0;
-  std::unique_ptr<uint64_t> lastLog = nullptr;
-  while (validatorMempoolSize < this->state_.rdposGetMinValidators() && !this->stopConsensus_) {
-    if (lastLog == nullptr || *lastLog != validatorMempoolSize) {
-      lastLog = std::make_unique<uint64_t>(validatorMempoolSize);
+  std::optional<uint64_t> lastLog;
+  const bool gotHashTxs = this->waitUntil([&]() {
+    const uint64_t validatorMempoolSize = this->state_.rdposGetMempoolSize();
+    if (lastLog != validatorMempoolSize) {
+      lastLog = validatorMempoolSize;
       LOGDEBUG("Validator has: " + std::to_string(validatorMempoolSize) + " transactions in mempool");
     }
-    validatorMempoolSize = this->state_.rdposGetMempoolSize();
-    std::this_thread::sleep_for(std::chrono::microseconds(10));
-  }
+    return validatorMempoolSize >= this->state_.rdposGetMinValidators();
+  });
+  if (!gotHashTxs) return;
 
   LOGDEBUG("Broadcasting random transaction");
   // Append and broadcast the randomness transaction.
@@ -516,6 +462,7 @@ void Consensus::stop() {
   if (this->loopFuture_.valid()) {
     Utils::safePrint("Stopping this->loopFuture_");
     this->stopConsensus_ = true;
+    this->state_.notifyChange(); // Wake up the loop if it is waiting for transactions or blocks
     this->loopFuture_.wait();
     this->loopFuture_.get();
   }
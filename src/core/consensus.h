@@ -19,12 +19,31 @@ class Consensus : public Log::LogicalLocationProvider {
     P2P::ManagerNormal& p2p_; ///< Reference to the P2P connection manager.
     const Storage& storage_; ///< Reference to the blockchain storage.
     const Options& options_; ///< Reference to the Options singleton.
+    const BlockBuilder::Limits blockLimits_; ///< Budget of the blocks this node creates.
 
     std::future<void> loopFuture_;  ///< Future object holding the thread for the consensus loop.
     std::future<void> pullFuture_; ///< Future object to keep pulling transactions from nodes on the network.
     std::atomic<bool> stopConsensus_ = false; ///< Flag for stopping the consensus processing.
     std::atomic<bool> stopPuller_ = false; ///< Flag for stopping the puller processing.
 
+    /// How often the puller asks peers for their transactions when no peer reports a new block.
+    static constexpr std::chrono::milliseconds txPullInterval_{25};
+
+    /**
+     * Block the consensus thread until a condition holds, waking up whenever the state
+     * accepts a transaction, a validator transaction or a block (see State::waitForChange()).
+     * @param ready The condition to wait for.
+     * @return `true` if the condition holds, `false` if the consensus was stopped first.
+     */
+    template <typename Pred> bool waitUntil(Pred&& ready) {
+      while (!this->stopConsensus_) {
+        if (this->state_.waitForChange([&]() { return this->stopConsensus_ || ready(); }, std::chrono::seconds(1))) {
+          return !this->stopConsensus_;
+        }
+      }
+      return false;
+    }
+
     /**
      * Create and broadcast a Validator block (called by validatorLoop()).
      * If the node is a Validator and it has to create a new block,
@@ -56,7 +75,9 @@ class Consensus : public Log::LogicalLocationProvider {
      * @param options Reference to the Options singleton.
      */
     explicit Consensus(State& state, P2P::ManagerNormal& p2p, const Storage& storage, const Options& options) :
-      state_(state), p2p_(p2p), storage_(storage), options_(options) {}
+      state_(state), p2p_(p2p), storage_(storage), options_(options),
+      blockLimits_{options.getBlockGasLimit(), options.getBlockMaxBytes(), std::chrono::milliseconds(options.getBlockBuildTimeMs())}
+    {}
 
     std::string getLogicalLocation() const override { return p2p_.getLogicalLocation(); } ///< Log instance from P2P
 
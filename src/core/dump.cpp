@@ -7,9 +7,32 @@ See the LICENSE.txt file in the project root for more information.
 
 #include "dump.h"
 
+#include "../utils/uintconv.h"
+
+namespace {
+  /**
+   * Add to a batch the deletion of every stored key under a prefix that the batch doesn't write again.
+   * @param db The state DB.
+   * @param prefix The prefix that owns all the keys written by the batch.
+   * @param keys The full keys written by the batch.
+   * @param batch The batch to be written.
+   */
+  void deleteStaleKeys(
+    const DB& db, const Bytes& prefix, const boost::unordered_flat_set<Bytes, SafeHash>& keys, DBBatch& batch
+  ) {
+    for (const auto& key : db.getKeys(prefix)) {
+      Bytes fullKey = prefix;
+      Utils::appendBytes(fullKey, key);
+      if (!keys.contains(fullKey)) batch.delete_key(fullKey);
+    }
+  }
+}
+
 DumpManager::DumpManager(
-  const Storage& storage, const Options& options, std::shared_mutex& stateMutex
-) : options_(options), storage_(storage), stateMutex_(stateMutex) {}
+  const Storage& storage, const Options& options, DB& db,
+  std::shared_mutex& stateMutex, std::mutex& contractsMutex
+) : options_(options), storage_(storage), db_(db), stateMutex_(stateMutex), contractsMutex_(contractsMutex),
+  fullDumpPending_(!DumpManager::getDumpHeight(db).has_value()) {}
 
 void DumpManager::pushBack(Dumpable* dumpable) {
   // Check if latest Dumpable* is the same as the one we trying to append
@@ -17,10 +40,13 @@ void DumpManager::pushBack(Dumpable* dumpable) {
   dumpables_.push_back(dumpable);
 }
 
-std::vector<DBBatch> DumpManager::dumpToBatch(unsigned int threadOffset, unsigned int threadItems) const {
-  std::vector<DBBatch> ret;
+std::vector<std::pair<Bytes, std::function<DBBatch()>>> DumpManager::snapshotToBatch(
+  const std::vector<const Dumpable*>& dumpables, const std::vector<bool>& whole,
+  unsigned int threadOffset, unsigned int threadItems
+) {
+  std::vector<std::pair<Bytes, std::function<DBBatch()>>> ret;
   for (auto i = threadOffset; i < (threadOffset + threadItems); i++) {
-    ret.emplace_back(this->dumpables_[i]->dump());
+    ret.emplace_back(dumpables[i]->getDumpPrefix(), whole[i] ? dumpables[i]->snapshot() : dumpables[i]->snapshotDelta());
   }
   return ret;
 }
@@ -28,22 +54,43 @@ std::vector<DBBatch> DumpManager::dumpToBatch(unsigned int threadOffset, unsigne
 std::pair<std::vector<DBBatch>, uint64_t> DumpManager::dumpState() const {
   std::pair<std::vector<DBBatch>, uint64_t> ret;
   auto& [batches, blockHeight] = ret;
+  std::vector<std::pair<Bytes, std::function<DBBatch()>>> snapshots;
+  std::vector<const Dumpable*> toCapture;
+  std::vector<bool> whole;
+  bool full;
   {
     // state mutex lock
-    std::unique_lock lock(stateMutex_);
-    // We can only safely get the nHeight that we are dumping after **uniquely locking** the state (making ASBOLUTELY sure that no new blocks
+    // A shared lock is enough to get a consistent view, as every state change (including new blocks)
+    // happens under a unique lock. RPC reads can keep going while the snapshots are captured.
+    std::shared_lock lock(stateMutex_);
+    // Simulations also run under a shared lock, and the C++ contracts they use hold uncommitted
+    // values until the simulation is done, so they must not be captured in the middle of one
+    std::lock_guard contractsLock(this->contractsMutex_);
+    // We can only safely get the nHeight that we are dumping after locking the state (making ASBOLUTELY sure that no new blocks
     // or state changes are happening)
     blockHeight = storage_.latest()->getNHeight();
-    // Emplace DBBatch operations
-    LOGDEBUG("Emplace DBBatch operations");
+    // A full dump captures every Dumpable, an incremental one only those changed since the last dump
+    full = this->fullDumpPending_;
+    if (full) {
+      toCapture.assign(this->dumpables_.begin(), this->dumpables_.end());
+    } else {
+      toCapture.assign(this->dirty_.begin(), this->dirty_.end());
+    }
+    this->dirty_.clear();
+    // Delta dumps need the whole object in the DB first
+    whole.reserve(toCapture.size());
+    for (const Dumpable* dumpable : toCapture) {
+      whole.push_back(full || (dumpable->hasDeltaDump() && !this->dumpedKeys_.contains(dumpable)));
+    }
+    // Capture the snapshots
+    LOGDEBUG("Capturing Dumpable snapshots");
 
     const auto nThreads = std::thread::hardware_concurrency();
-    auto requiredOffset = this->dumpables_.size() / nThreads;
-    auto remaining = (this->dumpables_.size() - (requiredOffset * nThreads));
+    auto requiredOffset = toCapture.size() / nThreads;
+    auto remaining = (toCapture.size() - (requiredOffset * nThreads));
     auto currentOffset = 0;
-    std::vector<std::future<std::vector<DBBatch>>> futures(nThreads);
-    std::vector<std::vector<DBBatch>> outputs(nThreads);
-    Utils::safePrint("this->dumpables_.size() = " + std::to_string(this->dumpables_.size()));
+    std::vector<std::future<std::vector<std::pair<Bytes, std::function<DBBatch()>>>>> futures(nThreads);
+    Utils::safePrint("toCapture.size() = " + std::to_string(toCapture.size()) + " of " + std::to_string(this->dumpables_.size()));
     Utils::safePrint("nThreads = " + std::to_string(nThreads));
     Utils::safePrint("requiredOffset = " + std::to_string(requiredOffset));
     Utils::safePrint("remaining = " + std::to_string(remaining));
@@ -55,47 +102,106 @@ std::pair<std::vector<DBBatch>, uint64_t> DumpManager::dumpState() const {
         ++nItems;
         --remaining;
       }
-      futures[i] = std::async(&DumpManager::dumpToBatch, this, currentOffset, nItems);
+      futures[i] = std::async(&DumpManager::snapshotToBatch, std::cref(toCapture), std::cref(whole), currentOffset, nItems);
       currentOffset += nItems;
     }
-    // get futures output (wait thread, implicit)
+    // get futures output (wait thread, implicit), keeping the dumpables order
     for (auto i = 0; i < nThreads; ++i)
-      outputs[i] = futures[i].get();
+      for (auto& snapshot : futures[i].get())
+        snapshots.emplace_back(std::move(snapshot));
+  }
 
-    // emplace futures return into batches
-    for (auto i = 0; i < nThreads; ++i)
-      for (auto j = 0; j < outputs[i].size(); ++j)
-        batches.emplace_back(outputs[i][j]);
+  // State is unlocked from here on, serialize the captured snapshots in parallel.
+  // Objects that own a prefix are rewritten as a whole, so the keys they dropped
+  // since the last dump have to be deleted from the DB as well. Snapshots are in
+  // the same order as toCapture, and each thread only touches its own entries.
+  LOGDEBUG("Emplace DBBatch operations");
+  this->captured_ = toCapture;
+  this->capturedKeys_.clear();
+  this->capturedKeys_.resize(snapshots.size());
+  const uint64_t nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  const uint64_t chunkSize = (snapshots.size() + nThreads - 1) / nThreads;
+  std::vector<std::future<std::vector<DBBatch>>> futures;
+  for (uint64_t begin = 0; begin < snapshots.size(); begin += chunkSize) {
+    const uint64_t end = std::min<uint64_t>(begin + chunkSize, snapshots.size());
+    futures.emplace_back(std::async(std::launch::async, [this, &snapshots, &toCapture, &whole, full, begin, end]() {
+      std::vector<DBBatch> output;
+      for (uint64_t i = begin; i < end; ++i) {
+        const auto& [prefix, snapshot] = snapshots[i];
+        DBBatch& batch = output.emplace_back(snapshot());
+        if (prefix.empty()) continue;
+        // Deltas delete the keys they drop themselves
+        if (!whole[i] && toCapture[i]->hasDeltaDump()) continue;
+        auto& [dumpable, keys] = this->capturedKeys_[i];
+        dumpable = toCapture[i];
+        for (const auto& entry : batch.getPuts()) keys.emplace(entry.key);
+        // The DB may not match the last dump if a dump failed, full dumps always check the DB itself
+        const auto previous = this->dumpedKeys_.find(dumpable);
+        if (full || previous == this->dumpedKeys_.end()) {
+          deleteStaleKeys(this->db_, prefix, keys, batch);
+        } else {
+          for (const Bytes& key : previous->second) if (!keys.contains(key)) batch.delete_key(key);
+        }
+        // Only the fact that it was dumped matters from now on
+        if (dumpable->hasDeltaDump()) keys = {};
+      }
+      return output;
+    }));
   }
+  // emplace futures return into batches
+  for (auto& future : futures)
+    for (auto& batch : future.get())
+      batches.emplace_back(std::move(batch));
   return ret;
 }
 
 std::tuple<uint64_t, uint64_t, uint64_t> DumpManager::dumpToDB() const {
+  std::lock_guard dumpLock(this->dumpMutex_);
   std::tuple<uint64_t, uint64_t, uint64_t> ret;
   auto& [dumpedBlockHeight, serializeTime, dumpTime] = ret;
   auto now = std::chrono::system_clock::now();
-  Utils::safePrint("Dumping state to DB...");
+  const bool fullDump = this->fullDumpPending_;
+  Utils::safePrint(std::string("Dumping ") + (fullDump ? "full" : "changed") + " state to DB...");
   auto toDump = this->dumpState();
   serializeTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - now).count();
   Utils::safePrint("Dumping state at height " + std::to_string(toDump.second) + " took " + std::to_string(serializeTime) + "ms");
-  const auto& [batches, blockHeight] = toDump;
-  std::string dbName = options_.getRootPath() + "/stateDb/" + std::to_string(blockHeight);
+  auto& [batches, blockHeight] = toDump;
   dumpedBlockHeight = blockHeight;
-  Utils::safePrint("Dumping the new state at height " + std::to_string(blockHeight) + " to " + dbName);
-  now = std::chrono::system_clock::now();
-  DB stateDb(dbName, true); // Compressed
+  // The height goes in the same write, so the stored state always matches the stored height
+  DBBatch heightBatch;
+  heightBatch.push_back(dumpHeightKey_, UintConv::uint64ToBytes(blockHeight), DBPrefix::stateDump);
+  batches.emplace_back(std::move(heightBatch));
   Utils::safePrint("Total Batches to process: " + std::to_string(batches.size()));
-  for (uint64_t i = 0; i < batches.size(); i++) {
-    Utils::safePrint("Processing batch: " + std::to_string(i) + " of " + std::to_string(batches.size()));
-    stateDb.putBatch(batches[i]);
-  }
-  dumpTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - now).count();
-  if (stateDb.close())
+  now = std::chrono::system_clock::now();
+  // Blocks are written in the background, the stored state can't get ahead of the stored blocks,
+  // not even after a power loss, so they have to be on disk before the state is written
+  if (this->storage_.waitDurable() && this->db_.putBatches(batches)) {
+    this->fullDumpPending_ = false;
+    for (const Dumpable* dumpable : this->captured_) dumpable->dumpStored();
+    this->captured_.clear();
+    for (auto& [dumpable, keys] : this->capturedKeys_) {
+      if (dumpable != nullptr) this->dumpedKeys_.insert_or_assign(dumpable, std::move(keys));
+    }
+    this->capturedKeys_.clear();
+    dumpTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - now).count();
     Utils::safePrint("State dumped at height " + std::to_string(blockHeight) + " took " + std::to_string(dumpTime) + "ms");
-
+  } else {
+    // The dirty set was already consumed, so everything has to be written again next time
+    this->fullDumpPending_ = true;
+    this->captured_.clear();
+    this->dumpedKeys_.clear();
+    this->capturedKeys_.clear();
+    dumpTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - now).count();
+    LOGERROR("Failed to dump state at height " + std::to_string(blockHeight));
+  }
   return ret;
 }
 
+std::optional<uint64_t> DumpManager::getDumpHeight(const DB& db) {
+  if (!db.has(dumpHeightKey_, DBPrefix::stateDump)) return std::nullopt;
+  return UintConv::bytesToUint64(db.get(dumpHeightKey_, DBPrefix::stateDump));
+}
+
 DumpWorker::DumpWorker(const Options& options, const Storage& storage, DumpManager& dumpManager)
   : options_(options), storage_(storage), dumpManager_(dumpManager)
 {
@@ -10,6 +10,9 @@ See the LICENSE.txt file in the project root for more information.
 
 #include <shared_mutex>
 
+#include <boost/unordered/unordered_flat_map.hpp>
+#include <boost/unordered/unordered_flat_set.hpp>
+
 #include "storage.h" // utils/db.h, ... -> utils.h -> libs/json.hpp -> functional, vector
 
 /// Abstraction of a dumpable object (an object that can be dumped to the database).
@@ -20,6 +23,48 @@ class Dumpable {
      * The function should dump implemented by the methods that are dumpable.
      */
     virtual DBBatch dump() const = 0;
+
+    /**
+     * Capture a point-in-time view of the object, to be serialized later without holding the state lock.
+     * Called by DumpManager while the state is locked. The default implementation serializes
+     * right away through dump(). Objects with large but cheaply copyable state should override it
+     * and defer the serialization to the returned function.
+     * @return A function that returns the dump of the captured view. Called only once.
+     */
+    virtual std::function<DBBatch()> snapshot() const {
+      return [batch = std::make_shared<DBBatch>(this->dump())]() { return std::move(*batch); };
+    }
+
+    /**
+     * Get the prefix that holds every key written by dump().
+     * When an object with a non-empty prefix is dumped incrementally, it is dumped as a whole,
+     * and the keys it wrote last time but not this time are deleted in the same write.
+     * @return The dump prefix, or an empty prefix if the object implements snapshotDelta() instead.
+     */
+    virtual Bytes getDumpPrefix() const { return {}; }
+
+    /**
+     * Capture only the entries that changed since the last dump.
+     * Called by DumpManager while the state is locked, for objects marked as dirty.
+     * The default implementation captures the whole object through snapshot().
+     * @return A function that returns the changed entries. Called only once.
+     */
+    virtual std::function<DBBatch()> snapshotDelta() const { return this->snapshot(); }
+
+    /**
+     * Whether snapshotDelta() captures only the changes of an object that has a dump prefix.
+     * Its batches delete the keys it drops themselves, so such an object is only captured as
+     * a whole (and checked for stale keys) on full dumps and on its first dump since startup.
+     * @return `true` if the object dumps deltas under its prefix, `false` (the default) otherwise.
+     */
+    virtual bool hasDeltaDump() const { return false; }
+
+    /**
+     * Called once a dump that captured the object is stored in the database.
+     * Objects that track their own changes can forget the ones captured so far, which a failed
+     * dump would have left out of the database. Called without the state lock, but never during a capture.
+     */
+    virtual void dumpStored() const {}
 };
 
 /// Class that manages dumping to the database. Used to store dumpable objects in memory.
@@ -27,25 +72,52 @@ class DumpManager : public Log::LogicalLocationProvider {
   private:
     const Options& options_; ///< Reference to the options object.
     const Storage& storage_; ///< Reference to the storage object
+    DB& db_; ///< Reference to the state database, dumps are written into it in place.
     std::shared_mutex& stateMutex_; ///< Mutex for managing read/write access to the state object.
+    std::mutex& contractsMutex_; ///< Mutex held by every reader of C++ contracts under a shared state lock, as simulations write them in place.
     std::vector<Dumpable*> dumpables_; ///< List of Dumpable objects.
+    /// Dumpables changed since the last dump. Written under a unique state lock, taken under a shared one.
+    mutable boost::unordered_flat_set<const Dumpable*> dirty_;
+    /// Full keys written by the last stored dump of each Dumpable with a dump prefix, so the keys
+    /// it drops are known without scanning the DB. Dumpables not dumped since startup aren't in it,
+    /// and the ones with a delta dump are kept without keys, as they delete what they drop themselves.
+    mutable boost::unordered_flat_map<const Dumpable*, boost::unordered_flat_set<Bytes, SafeHash>> dumpedKeys_;
+    /// Dumpables captured by the dump being written, told once it's stored (see Dumpable::dumpStored()).
+    mutable std::vector<const Dumpable*> captured_;
+    /// Keys written by each prefixed Dumpable of the dump being written, moved to `dumpedKeys_` once it's stored.
+    mutable std::vector<std::pair<const Dumpable*, boost::unordered_flat_set<Bytes, SafeHash>>> capturedKeys_;
+    mutable bool fullDumpPending_; ///< Whether the next dump must rewrite every Dumpable (first dump, or last dump failed).
+    mutable std::mutex dumpMutex_; ///< Mutex that serializes dumps, as each one consumes the dirty set.
+
+    /// Key (under DBPrefix::stateDump) of the height of the block the stored state corresponds to.
+    static inline const Bytes dumpHeightKey_ = DB::keyFromStr("dumpHeight");
 
     /**
-     * Auxiliary function used by async calls that processes a little slice of dumps in a separate thread.
+     * Auxiliary function used by async calls that captures a little slice of snapshots in a separate thread.
+     * @param dumpables The list of Dumpable objects to capture.
+     * @param whole For each Dumpable, `true` to capture it as a whole, `false` to capture only its changes.
      * @param threadOffset Offset for the dumpables list.
-     * @param threadItems How many items to dump from the dumpables list.
-     * @return A list of DBBatch dump operations.
+     * @param threadItems How many items to capture from the dumpables list.
+     * @return A list of prefixes to be dropped and snapshot functions.
      */
-    std::vector<DBBatch> dumpToBatch(unsigned int threadOffset, unsigned int threadItems) const;
+    static std::vector<std::pair<Bytes, std::function<DBBatch()>>> snapshotToBatch(
+      const std::vector<const Dumpable*>& dumpables, const std::vector<bool>& whole,
+      unsigned int threadOffset, unsigned int threadItems
+    );
 
   public:
     /**
      * Constructor.
      * @param storage Reference to the Storage object.
      * @param options Reference to the Options singleton.
+     * @param db Reference to the state database the state was loaded from.
      * @param stateMutex Reference to the state mutex.
+     * @param contractsMutex Reference to the mutex that simulations hold while using C++ contracts.
      */
-    DumpManager(const Storage& storage, const Options& options, std::shared_mutex& stateMutex);
+    DumpManager(
+      const Storage& storage, const Options& options, DB& db,
+      std::shared_mutex& stateMutex, std::mutex& contractsMutex
+    );
 
     /// Log instance from Storage.
     std::string getLogicalLocation() const override { return storage_.getLogicalLocation(); }
@@ -57,20 +129,44 @@ class DumpManager : public Log::LogicalLocationProvider {
     void pushBack(Dumpable* dumpable);
 
     /**
-     * Call dump functions contained in the dumpable list.
+     * Mark a Dumpable object as changed, so it's written on the next dump.
+     * Must be called with the state uniquely locked.
+     * @param dumpable The changed object.
+     */
+    void markDirty(const Dumpable& dumpable) { this->dirty_.emplace(&dumpable); }
+
+    /**
+     * Call dump functions of the Dumpables that changed since the last dump (or of all of them on the first dump).
+     * The state is only (shared) locked while each Dumpable captures its snapshot,
+     * the serialization itself runs after the lock is released, so blocks can keep being processed.
+     * Simulations are kept out of C++ contracts during the capture, as they write contract
+     * variables in place and only revert them once done.
+     * Keys dropped by Dumpables with a dump prefix are deleted, found by comparing with the
+     * Dumpable's last dump, or by scanning its prefix in the DB on full dumps and on its first dump since startup.
+     * Dumpables with a delta dump (see Dumpable::hasDeltaDump()) are only captured as a whole in the latter cases.
+     * Consumes the dirty set, so it's only called through dumpToDB(), which serializes dumps.
      * @returns A vector of DBBatch objects and the nHeight of the last block.
      */
     std::pair<std::vector<DBBatch>, uint64_t> dumpState() const;
 
-    /// Dump the state to DB.
+    /// Dump the changed state to the state DB in one atomic write, along with the dumped block height.
     /// Returns 0 - Block Height, 1 - Time taken to serialize, 2 - Time taken to dump to DB
     std::tuple<uint64_t, uint64_t, uint64_t> dumpToDB() const;
 
+    /**
+     * Get the block height of the state stored in a state DB.
+     * @param db The state DB.
+     * @return The stored height, or an empty optional if nothing was dumped into the DB incrementally yet.
+     */
+    static std::optional<uint64_t> getDumpHeight(const DB& db);
+
     /// Get the size of the dupables list.
     size_t size() const { return this->dumpables_.size(); }
 
     /**
      * Get the best state DB patch.
+     * Dumps are written in place, so the directory name is only the height the DB was created at.
+     * The height it currently holds is given by getDumpHeight().
      * @param options the options object
      * @return a pair of the best state DB patch and the nHeight of the last block.
      */
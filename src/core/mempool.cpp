@@ -0,0 +1,195 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "mempool.h"
+
+Mempool::Mempool(Limits limits) : limits_(limits) {}
+
+void Mempool::updatePending(Sender& sender) {
+  uint64_t run = 0;
+  uint64_t expected = sender.nonce;
+  for (auto it = sender.txs.find(expected); it != sender.txs.end() && it->first == expected; ++it, ++expected) ++run;
+  this->pendingCount_ = this->pendingCount_ - sender.pending + run;
+  sender.pending = run;
+}
+
+void Mempool::dropStale(Sender& sender) {
+  auto end = sender.txs.lower_bound(sender.nonce);
+  for (auto it = sender.txs.begin(); it != end; ++it) this->index_.erase(it->second.hash());
+  sender.txs.erase(sender.txs.begin(), end);
+}
+
+void Mempool::updateTail(const Address& address, Sender& sender) {
+  if (sender.tail.has_value()) this->tails_.erase(*sender.tail);
+  sender.tail.reset();
+  if (!sender.txs.empty()) sender.tail = this->tails_.emplace(sender.txs.rbegin()->second.getMaxFeePerGas(), address);
+}
+
+void Mempool::removeIfEmpty(const Address& address) {
+  auto it = this->senders_.find(address);
+  if (it != this->senders_.end() && it->second.txs.empty()) this->senders_.erase(it);
+}
+
+bool Mempool::evictCheapest(const uint256_t& maxFeePerGas, const Address& from) {
+  // Each sender has a single tail, so at most one entry is skipped
+  auto tail = this->tails_.begin();
+  if (tail != this->tails_.end() && tail->second == from) ++tail;
+  if (tail == this->tails_.end() || tail->first >= maxFeePerGas) return false;
+  const Address address = tail->second;
+  Sender& sender = this->senders_.find(address)->second;
+  this->index_.erase(sender.txs.rbegin()->second.hash());
+  sender.txs.erase(std::prev(sender.txs.end()));
+  this->updatePending(sender);
+  this->updateTail(address, sender);
+  this->removeIfEmpty(address);
+  return true;
+}
+
+TxStatus Mempool::add(TxBlock tx, uint64_t accountNonce) {
+  const Hash txHash = tx.hash();
+  if (this->index_.contains(txHash)) return TxStatus::ValidExisting;
+  if (tx.getNonce() < accountNonce) return TxStatus::InvalidNonce;
+  if (tx.getNonce() - accountNonce >= this->limits_.maxNonceGap) return TxStatus::InvalidPoolLimit;
+  if (this->limits_.maxTxsPerSender == 0) return TxStatus::InvalidPoolLimit;
+  const Address from = tx.getFrom();
+  const uint64_t nonce = static_cast<uint64_t>(tx.getNonce());
+
+  // Stale transactions don't count towards the sender's limit
+  if (auto senderIt = this->senders_.find(from); senderIt != this->senders_.end() && senderIt->second.nonce != accountNonce) {
+    this->setAccountNonce(from, accountNonce);
+  }
+
+  // Replace-by-fee: both fee caps must be raised by the minimum bump
+  if (auto senderIt = this->senders_.find(from); senderIt != this->senders_.end()) {
+    if (auto txIt = senderIt->second.txs.find(nonce); txIt != senderIt->second.txs.end()) {
+      const TxBlock& old = txIt->second;
+      const uint256_t bump = 100 + this->limits_.priceBumpPercent;
+      if (tx.getMaxFeePerGas() * 100 < old.getMaxFeePerGas() * bump ||
+        tx.getMaxPriorityFeePerGas() * 100 < old.getMaxPriorityFeePerGas() * bump
+      ) {
+        return TxStatus::InvalidUnderpriced;
+      }
+      this->index_.erase(old.hash());
+      this->index_.emplace(txHash, std::make_pair(from, nonce));
+      txIt->second = std::move(tx);
+      this->updateTail(from, senderIt->second);
+      return TxStatus::ValidNew;
+    }
+    if (senderIt->second.txs.size() >= this->limits_.maxTxsPerSender) return TxStatus::InvalidPoolLimit;
+  }
+
+  if (this->index_.size() >= this->limits_.maxTxs) {
+    if (this->limits_.maxTxs == 0) return TxStatus::InvalidPoolLimit;
+    if (!this->evictCheapest(tx.getMaxFeePerGas(), from)) return TxStatus::InvalidUnderpriced;
+  }
+
+  Sender& sender = this->senders_[from];
+  if (sender.nonce != accountNonce) {
+    sender.nonce = accountNonce;
+    this->dropStale(sender);
+  }
+  sender.txs.emplace(nonce, std::move(tx));
+  this->index_.emplace(txHash, std::make_pair(from, nonce));
+  this->updatePending(sender);
+  this->updateTail(from, sender);
+  return TxStatus::ValidNew;
+}
+
+const TxBlock* Mempool::find(const Hash& txHash) const {
+  auto it = this->index_.find(txHash);
+  if (it == this->index_.end()) return nullptr;
+  const auto& [address, nonce] = it->second;
+  return &this->senders_.find(address)->second.txs.find(nonce)->second;
+}
+
+uint256_t Mempool::getCostBefore(const Address& sender, uint64_t nonce) const {
+  uint256_t cost = 0;
+  auto senderIt = this->senders_.find(sender);
+  if (senderIt == this->senders_.end()) return cost;
+  const auto& txs = senderIt->second.txs;
+  for (auto it = txs.begin(); it != txs.end() && it->first < nonce; ++it) {
+    cost += it->second.getValue() + (it->second.getGasLimit() * it->second.getMaxFeePerGas());
+  }
+  return cost;
+}
+
+bool Mempool::erase(const Hash& txHash) {
+  auto it = this->index_.find(txHash);
+  if (it == this->index_.end()) return false;
+  const auto [address, nonce] = it->second;
+  this->index_.erase(it);
+  Sender& sender = this->senders_.find(address)->second;
+  sender.txs.erase(nonce);
+  this->updatePending(sender);
+  this->updateTail(address, sender);
+  this->removeIfEmpty(address);
+  return true;
+}
+
+void Mempool::setAccountNonce(const Address& sender, uint64_t nonce) {
+  auto it = this->senders_.find(sender);
+  if (it == this->senders_.end()) return;
+  it->second.nonce = nonce;
+  this->dropStale(it->second);
+  this->updatePending(it->second);
+  this->updateTail(sender, it->second);
+  this->removeIfEmpty(sender);
+}
+
+void Mempool::eraseIf(const Address& sender, const std::function<bool(const TxBlock&)>& pred) {
+  auto senderIt = this->senders_.find(sender);
+  if (senderIt == this->senders_.end()) return;
+  auto& txs = senderIt->second.txs;
+  for (auto it = txs.begin(); it != txs.end();) {
+    if (pred(it->second)) {
+      this->index_.erase(it->second.hash());
+      it = txs.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  this->updatePending(senderIt->second);
+  this->updateTail(sender, senderIt->second);
+  this->removeIfEmpty(sender);
+}
+
+std::vector<TxBlock> Mempool::getPending() const {
+  std::vector<TxBlock> txs;
+  txs.reserve(this->pendingCount_);
+  for (const auto& [address, sender] : this->senders_) {
+    auto it = sender.txs.begin();
+    for (uint64_t i = 0; i < sender.pending; ++i, ++it) txs.emplace_back(it->second);
+  }
+  return txs;
+}
+
+std::vector<TxBlock> Mempool::getQueued() const {
+  std::vector<TxBlock> txs;
+  txs.reserve(this->queuedSize());
+  for (const auto& [address, sender] : this->senders_) {
+    for (auto it = std::next(sender.txs.begin(), sender.pending); it != sender.txs.end(); ++it) {
+      txs.emplace_back(it->second);
+    }
+  }
+  return txs;
+}
+
+std::vector<TxBlock> Mempool::getAll() const {
+  std::vector<TxBlock> txs;
+  txs.reserve(this->index_.size());
+  for (const auto& [address, sender] : this->senders_) {
+    for (const auto& [nonce, tx] : sender.txs) txs.emplace_back(tx);
+  }
+  return txs;
+}
+
+void Mempool::clear() {
+  this->senders_.clear();
+  this->index_.clear();
+  this->tails_.clear();
+  this->pendingCount_ = 0;
+}
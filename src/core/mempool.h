@@ -0,0 +1,150 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef MEMPOOL_H
+#define MEMPOOL_H
+
+#include <functional>
+#include <map>
+#include <optional>
+
+#include "rdpos.h" // TxStatus, utils/tx.h, boost/unordered/unordered_flat_map.hpp
+
+/**
+ * Pool of native transactions waiting to be included in a block, organized per sender.
+ * The transactions of each sender are kept ordered by nonce. The ones that form a
+ * contiguous run starting at the sender's account nonce are "pending" (executable in
+ * that order), the ones after a gap are "queued" and are promoted to pending as soon
+ * as the gap is filled, either by a new transaction or by a change of the account nonce.
+ * A transaction with the same sender and nonce as an existing one replaces it only if
+ * it pays a high enough fee bump (replace-by-fee). When the pool is full, the cheapest
+ * transaction at the end of a sender's queue is evicted to make room for a better paying one.
+ * Not thread-safe, the owner (State) guards it with its own mutex.
+ */
+class Mempool {
+  public:
+    /// Size and replacement limits of the pool.
+    struct Limits {
+      uint64_t maxTxs = 16384;          ///< Maximum number of transactions in the pool.
+      uint64_t maxTxsPerSender = 64;    ///< Maximum number of transactions per sender.
+      uint64_t priceBumpPercent = 10;   ///< Minimum fee increase (in percent) required to replace a transaction.
+      uint64_t maxNonceGap = 64;        ///< How far ahead of the account nonce a transaction can be.
+    };
+
+    /**
+     * Constructor.
+     * @param limits The limits of the pool.
+     */
+    explicit Mempool(Limits limits = {});
+
+    /**
+     * Add a transaction to the pool.
+     * Balance and signature checks are up to the caller, only nonces and limits are checked here.
+     * @param tx The transaction to add.
+     * @param accountNonce The current nonce of the transaction's sender.
+     * @return ValidNew if the transaction was added (or replaced another one), ValidExisting if
+     *         it was already in the pool, InvalidNonce if its nonce was already used,
+     *         InvalidPoolLimit if its nonce is too far ahead, its sender already has the maximum
+     *         number of transactions or the pool can't hold any transaction, InvalidUnderpriced if
+     *         it doesn't pay enough to replace an existing transaction or to evict one from a full pool.
+     */
+    TxStatus add(TxBlock tx, uint64_t accountNonce);
+
+    /// Check if a transaction is in the pool.
+    bool contains(const Hash& txHash) const { return this->index_.contains(txHash); }
+
+    /**
+     * Find a transaction in the pool.
+     * @param txHash The hash of the transaction.
+     * @return A pointer to the transaction, or nullptr if it is not in the pool.
+     *         Invalidated by any change to the pool.
+     */
+    const TxBlock* find(const Hash& txHash) const;
+
+    size_t size() const { return this->index_.size(); } ///< Total number of transactions in the pool.
+    size_t pendingSize() const { return this->pendingCount_; } ///< Number of executable transactions in the pool.
+    size_t queuedSize() const { return this->index_.size() - this->pendingCount_; } ///< Number of transactions waiting for a nonce gap to be filled.
+
+    /**
+     * Get the total maximum cost (value plus gas limit times max fee) of a sender's
+     * transactions that come before a given nonce, which the account has to pay first.
+     * @param sender The sender.
+     * @param nonce The nonce to stop at (excluded).
+     * @return The total cost.
+     */
+    uint256_t getCostBefore(const Address& sender, uint64_t nonce) const;
+
+    /**
+     * Remove a transaction from the pool. Transactions of the same sender with
+     * higher nonces stay in the pool, queued if they are no longer executable.
+     * @param txHash The hash of the transaction.
+     * @return `true` if the transaction was in the pool, `false` otherwise.
+     */
+    bool erase(const Hash& txHash);
+
+    /**
+     * Update the nonce of a sender's account, dropping its transactions that use
+     * an older nonce and promoting the ones that became executable.
+     * @param sender The sender.
+     * @param nonce The new account nonce.
+     */
+    void setAccountNonce(const Address& sender, uint64_t nonce);
+
+    /**
+     * Remove the transactions of a sender that match a predicate.
+     * @param sender The sender.
+     * @param pred Called for each transaction of the sender, in nonce order.
+     */
+    void eraseIf(const Address& sender, const std::function<bool(const TxBlock&)>& pred);
+
+    std::vector<TxBlock> getPending() const; ///< Get the executable transactions, each sender's in nonce order.
+    std::vector<TxBlock> getQueued() const; ///< Get the transactions waiting for a nonce gap to be filled, each sender's in nonce order.
+    std::vector<TxBlock> getAll() const; ///< Get all transactions in the pool, each sender's in nonce order.
+
+    void clear(); ///< Remove all transactions from the pool.
+
+  private:
+    /// Transactions of a single sender.
+    struct Sender {
+      uint64_t nonce = 0; ///< Last known nonce of the sender's account.
+      uint64_t pending = 0; ///< Length of the contiguous run of transactions starting at `nonce`.
+      std::map<uint64_t, TxBlock> txs; ///< Transactions ordered by nonce.
+      std::optional<std::multimap<uint256_t, Address>::iterator> tail; ///< Entry of the last transaction in `tails_`.
+    };
+
+    const Limits limits_; ///< The limits of the pool.
+    boost::unordered_flat_map<Address, Sender, SafeHash> senders_; ///< Transactions per sender.
+    boost::unordered_flat_map<Hash, std::pair<Address, uint64_t>, SafeHash> index_; ///< Sender and nonce of each transaction, by hash.
+    size_t pendingCount_ = 0; ///< Sum of the pending run lengths of all senders.
+    std::multimap<uint256_t, Address> tails_; ///< Senders by the max fee of their last transaction, the eviction candidates.
+
+    /// Recompute a sender's pending run after its transactions or nonce changed.
+    void updatePending(Sender& sender);
+
+    /// Drop a sender's transactions that use a nonce older than its account nonce.
+    void dropStale(Sender& sender);
+
+    /// Update a sender's entry in `tails_` after its last transaction may have changed.
+    void updateTail(const Address& address, Sender& sender);
+
+    /// Remove a sender that has no transactions left.
+    void removeIfEmpty(const Address& address);
+
+    /**
+     * Evict the transaction with the lowest fee among the last ones of each sender's queue
+     * (so no other transaction is left behind a gap), if it pays less than the given fee.
+     * The sender of the transaction that needs room is skipped, as its last transaction may be
+     * the one the new transaction follows.
+     * Found through `tails_`, so it doesn't depend on the number of senders.
+     * @param maxFeePerGas The fee of the transaction that needs room.
+     * @param from The sender of the transaction that needs room.
+     * @return `true` if a transaction was evicted, `false` otherwise.
+     */
+    bool evictCheapest(const uint256_t& maxFeePerGas, const Address& from);
+};
+
+#endif // MEMPOOL_H
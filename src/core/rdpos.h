@@ -31,7 +31,9 @@ enum class TxStatus {
   InvalidBalance,     // Tx only
   InvalidUnexpected,  // ValidatorTx only
   InvalidDuplicate,   // ValidatorTx only
-  InvalidRedundant    // ValidatorTx only
+  InvalidRedundant,   // ValidatorTx only
+  InvalidUnderpriced, // Tx only
+  InvalidPoolLimit    // Tx only
 };
 
 inline bool isTxStatusValid(const TxStatus& txStatus) { return txStatus <= TxStatus::ValidExisting; }
@@ -161,6 +163,9 @@ class rdPoS : public BaseContract, public Log::LogicalLocationProvider {
 
     /// Dump overriden function.
     DBBatch dump() const override;
+
+    /// Validators are dumped under DBPrefix::rdPoS.
+    Bytes getDumpPrefix() const override { return DBPrefix::rdPoS; }
 };
 
 #endif // RDPOS_H
@@ -16,21 +16,31 @@ See the LICENSE.txt file in the project root for more information.
 #include "../net/http/jsonrpc/error.h"
 
 State::State(
-  const DB& db,
+  DB& db,
   Storage& storage,
   P2P::ManagerNormal& p2pManager,
-  const uint64_t& snapshotHeight,
+  const uint64_t& dbSnapshotHeight,
   const Options& options
-) : vm_(evmc_create_evmone()),
+) : vm_(EvmCodeCache::createVm(options.getEvmInterpreter())),
   options_(options),
   storage_(storage),
-  dumpManager_(storage_, options_, this->stateMutex_),
+  dumpManager_(storage_, options_, db, this->stateMutex_, this->simulationContractsMutex_),
   dumpWorker_(options_, storage_, dumpManager_),
   p2pManager_(p2pManager),
   rdpos_(db, dumpManager_, storage, p2pManager, options),
-  blockObservers_(vm_, dumpManager_, storage_, contracts_, accounts_, vmStorage_, options_)
+  mempool_(Mempool::Limits{
+    .maxTxs = options_.getMempoolMaxTxs(),
+    .maxTxsPerSender = options_.getMempoolMaxTxsPerSender(),
+    .maxNonceGap = options_.getMempoolMaxNonceGap()
+  }),
+  evmCodeCache_(options_.getEvmInterpreter(), options_.getEvmCodeCacheSize()),
+  blockObservers_(vm_, dumpManager_, storage_, contracts_, accounts_, vmStorage_, dirtyKeys_, options_),
+  // Call traces can only be produced by a ContractHost, so tracing nodes always execute sequentially
+  parallelExecution_(options_.getParallelExecution() && options_.getIndexingMode() != IndexingMode::RPC_TRACE)
 {
   std::unique_lock lock(this->stateMutex_);
+  // Dumps are written in place, so the DB itself knows which height it holds
+  const uint64_t snapshotHeight = DumpManager::getDumpHeight(db).value_or(dbSnapshotHeight);
   if (snapshotHeight != 0) {
     Utils::safePrint("Loading state from snapshot height: " + std::to_string(snapshotHeight));
   }
@@ -41,13 +51,16 @@ State::State(
     if (snapshotHeight != 0) {
       throw DynamicException("Snapshot height is higher than 0, but no accounts found in DB");
     }
+    // Genesis accounts are only in memory, so the first dump has to write them
     for (const auto& [addr, balance] : options_.getGenesisBalances()) {
       this->accounts_[addr]->balance = balance;
+      this->dirtyKeys_.accounts.emplace(addr);
     }
     // Also append the ContractManager account
     auto& contractManagerAcc = *this->accounts_[ProtocolContractAddresses.at("ContractManager")];
     contractManagerAcc.nonce = 1;
     contractManagerAcc.contractType = ContractType::CPP;
+    this->dirtyKeys_.accounts.emplace(ProtocolContractAddresses.at("ContractManager"));
   } else {
 
 #ifdef BUILD_TESTNET
@@ -55,9 +68,11 @@ State::State(
     // to the evmContracts_ map, so we can save up memory and avoid duplicated code
     if (!db.hasPrefix(DBPrefix::evmContracts)) {
       Utils::safePrint("No EVM Contracts found in DB, importing from Accounts...");
+      // Accounts are written again without their code, along with the code itself
       for (const auto& dbEntry : accountsFromDB) {
         Address addr(dbEntry.key);
         this->accounts_.emplace(addr, dbEntry.value);
+        this->dirtyKeys_.accounts.emplace(addr);
         auto& account = this->accounts_.at(addr);
         if (account->contractType == ContractType::EVM) {
           auto contractIt = this->evmContracts_.find(account->codeHash);
@@ -67,6 +82,7 @@ State::State(
               throw DynamicException("Account " + addr.hex().get() + " is marked as EVM contract but has invalid serialized size");
             }
             this->evmContracts_[account->codeHash] = std::make_shared<Bytes>(dbEntry.value.begin() + 73, dbEntry.value.end());
+            this->dirtyKeys_.evmContracts.emplace(account->codeHash);
           } else {
             // Point the account code to the already existing code
             account->code = contractIt->second;
@@ -188,14 +204,11 @@ State::State(
     ContractGlobals::blockTimestamp_ = block->getTimestamp();
 
     // Process transactions of the block within the current state
-    uint64_t txIndex = 0;
-    for (const auto& tx : block->getTxs()) {
-      this->processTransaction(tx, blockHash, txIndex, block->getBlockRandomness());
-      txIndex++;
-    }
+    this->processBlockTransactions(*block);
     blockObservers_.notify(*block);
     // Process rdPoS State
     this->rdpos_.processBlock(*block);
+    this->dumpManager_.markDirty(this->rdpos_);
   }
   if (reindexedTxs->getPuts().size() > 0) {
     LOGINFOP("Reindexing remaining transactions");
@@ -209,7 +222,26 @@ State::State(
 
 }
 
-State::~State() { evmc_destroy(this->vm_); }
+State::~State() {
+  evmc_destroy(this->vm_);
+  for (evmc_vm* vm : this->simulationVms_) evmc_destroy(vm);
+}
+
+std::shared_ptr<evmc_vm> State::getSimulationVm() {
+  evmc_vm* vm = nullptr;
+  {
+    std::lock_guard lock(this->simulationVmsMutex_);
+    if (!this->simulationVms_.empty()) {
+      vm = this->simulationVms_.back();
+      this->simulationVms_.pop_back();
+    }
+  }
+  if (vm == nullptr) vm = EvmCodeCache::createVm(this->evmCodeCache_.getInterpreter());
+  return std::shared_ptr<evmc_vm>(vm, [this](evmc_vm* vm) {
+    std::lock_guard lock(this->simulationVmsMutex_);
+    this->simulationVms_.push_back(vm);
+  });
+}
 
 void State::contractSanityCheck(const Address& addr, const Account& acc) {
   switch (acc.contractType) {
@@ -242,35 +274,68 @@ void State::contractSanityCheck(const Address& addr, const Account& acc) {
   }
 }
 
+namespace {
+  const Account& derefAccount(const Account& account) { return account; }
+  const Account& derefAccount(const NonNullUniquePtr<Account>& account) { return *account; }
+
+  /// Serialize the State maps into a batch. Shared by State::dump() and State::snapshot().
+  DBBatch dumpStateMaps(const auto& accounts, const auto& vmStorage, const auto& evmContracts) {
+    // DB is stored as following
+    // Under the DBPrefix::nativeAccounts
+    // Each key == Address
+    // Each Value == Account.serialize()
+    DBBatch stateBatch;
+    for (const auto& [address, account] : accounts) {
+      stateBatch.push_back(address, derefAccount(account).serialize(), DBPrefix::nativeAccounts);
+    }
+    // There is also the need to dump the vmStorage_ map
+    for (const auto& [storageKey, storageValue] : vmStorage) {
+      const auto key = Utils::makeBytes(bytes::join(storageKey.first, storageKey.second));
+      stateBatch.push_back(key, storageValue, DBPrefix::vmStorage);
+    }
+    // Also make sure to dump all the EVM Contracts
+    for (const auto& [codeHash, code] : evmContracts) {
+      stateBatch.push_back(codeHash, *code, DBPrefix::evmContracts);
+    }
+    return stateBatch;
+  }
+}
+
 DBBatch State::dump() const {
-  // DB is stored as following
-  // Under the DBPrefix::nativeAccounts
-  // Each key == Address
-  // Each Value == Account.serialize()
-  DBBatch stateBatch;
-  for (const auto& [address, account] : this->accounts_) {
-    stateBatch.push_back(address, account->serialize(), DBPrefix::nativeAccounts);
-  }
-  // There is also the need to dump the vmStorage_ map
-  for (const auto& [storageKey, storageValue] : this->vmStorage_) {
-    const auto key = Utils::makeBytes(bytes::join(storageKey.first, storageKey.second));
-    stateBatch.push_back(key, storageValue, DBPrefix::vmStorage);
-  }
-  // Also make sure to dump all the EVM Contracts
-  for (const auto& [codeHash, code] : this->evmContracts_) {
-    stateBatch.push_back(codeHash, *code, DBPrefix::evmContracts);
+  return dumpStateMaps(this->accounts_, this->vmStorage_, this->evmContracts_);
+}
+
+std::function<DBBatch()> State::snapshot() const {
+  return this->snapshotDelta();
+}
+
+std::function<DBBatch()> State::snapshotDelta() const {
+  // Only DumpManager consumes the dirty keys, and it never runs two dumps at once
+  this->unstoredKeys_.merge(this->dirtyKeys_);
+  this->dirtyKeys_.clear();
+  auto accounts = std::make_shared<std::vector<std::pair<Address, Account>>>();
+  accounts->reserve(this->unstoredKeys_.accounts.size());
+  for (const auto& address : this->unstoredKeys_.accounts) {
+    if (auto it = this->accounts_.find(address); it != this->accounts_.end()) accounts->emplace_back(address, *it->second);
+  }
+  auto vmStorage = std::make_shared<std::vector<std::pair<StorageKey, Hash>>>();
+  vmStorage->reserve(this->unstoredKeys_.storage.size());
+  for (const auto& storageKey : this->unstoredKeys_.storage) {
+    if (auto it = this->vmStorage_.find(storageKey); it != this->vmStorage_.end()) vmStorage->emplace_back(storageKey, it->second);
+  }
+  auto evmContracts = std::make_shared<std::vector<std::pair<Hash, std::shared_ptr<Bytes>>>>();
+  evmContracts->reserve(this->unstoredKeys_.evmContracts.size());
+  for (const auto& codeHash : this->unstoredKeys_.evmContracts) {
+    if (auto it = this->evmContracts_.find(codeHash); it != this->evmContracts_.end()) evmContracts->emplace_back(codeHash, it->second);
   }
+  return [accounts, vmStorage, evmContracts]() { return dumpStateMaps(*accounts, *vmStorage, *evmContracts); };
+}
 
-  return stateBatch;
+void State::dumpStored() const {
+  this->unstoredKeys_.clear();
 }
 
 TxStatus State::validateTransactionInternal(const TxBlock& tx) const {
-  /**
-   * Rules for a transaction to be accepted within the current state:
-   * Transaction value + txFee (gas * gasPrice) needs to be lower than account balance
-   * Transaction nonce must match account nonce
-   */
-
   // Verify if transaction already exists within the mempool, if on mempool, it has been validated previously.
   if (this->mempool_.contains(tx.hash())) {
     LOGTRACE("Transaction: " + tx.hash().hex().get() + " already in mempool");
@@ -281,8 +346,17 @@ TxStatus State::validateTransactionInternal(const TxBlock& tx) const {
     LOGERROR("Account doesn't exist (0 balance and 0 nonce)");
     return TxStatus::InvalidBalance;
   }
-  const auto& accBalance = accountIt->second->balance;
-  const auto& accNonce = accountIt->second->nonce;
+  return this->validateTransactionInternal(tx, accountIt->second->nonce, accountIt->second->balance);
+}
+
+TxStatus State::validateTransactionInternal(
+  const TxBlock& tx, const uint64_t& accNonce, const Uint256& accBalance
+) const {
+  /**
+   * Rules for a transaction to be accepted within the current state:
+   * Transaction value + txFee (gas * gasPrice) needs to be lower than account balance
+   * Transaction nonce must match account nonce
+   */
   if (
     uint256_t txWithFees = tx.getValue() + (tx.getGasLimit() * tx.getMaxFeePerGas());
     txWithFees > accBalance
@@ -293,7 +367,6 @@ TxStatus State::validateTransactionInternal(const TxBlock& tx) const {
     );
     return TxStatus::InvalidBalance;
   }
-  // TODO: The blockchain is able to store higher nonce transactions until they are valid. Handle this case.
   if (accNonce != tx.getNonce()) {
     LOGERROR("Transaction: " + tx.hash().hex().get()
       + " nonce mismatch, expected: " + std::to_string(accNonce)
@@ -311,6 +384,7 @@ void State::processTransaction(
   // processNextBlock already calls validateTransaction in every tx,
   // as it calls validateNextBlock as a sanity check.
   Account& accountFrom = *this->accounts_[tx.getFrom()];
+  this->dirtyKeys_.accounts.emplace(tx.getFrom());
   auto& fromNonce = accountFrom.nonce;
   auto& fromBalance = accountFrom.balance;
   if (fromBalance < (tx.getValue() + tx.getGasLimit() * tx.getMaxFeePerGas())) {
@@ -347,6 +421,8 @@ void State::processTransaction(
       .blockGasLimit(10'000'000)
       .txGasPrice(tx.getMaxFeePerGas())
       .chainId(this->options_.getChainID())
+      .dirtyKeys(this->dirtyKeys_)
+      .journal(this->journal_)
       .build();
 
     ContractHost host(
@@ -355,7 +431,8 @@ void State::processTransaction(
       this->storage_,
       randomSeed,
       context,
-      &blockObservers_);
+      &blockObservers_,
+      &this->evmCodeCache_);
 
     std::visit([&] (auto&& msg) {
       if constexpr (concepts::CreateMessage<decltype(msg)>) {
@@ -381,35 +458,195 @@ void State::processTransaction(
   fromBalance -= (txData.gasUsed * tx.getMaxFeePerGas());
 }
 
-void State::refreshMempool(const FinalizedBlock& block) {
-  // No need to lock mutex as function caller (this->processNextBlock) already lock mutex.
-  // Remove all transactions within the block that exists on the unordered_map.
-  for (const auto& tx : block.getTxs()) {
-    const auto it = this->mempool_.find(tx.hash());
-    if (it != this->mempool_.end()) {
-      this->mempool_.erase(it);
+bool State::isIndependentTransfer(const TxBlock& tx) const {
+  // Contract creations and calls with data can touch arbitrary state
+  if (tx.getTo() == Address() || !tx.getData().empty()) return false;
+  // Transfers that run out of gas before being dispatched (or whose gas limit
+  // would be truncated by Gas) have different side effects, leave them to processTransaction()
+  if (tx.getGasLimit() < CONTRACT_EXECUTION_COST || tx.getGasLimit() > std::numeric_limits<uint64_t>::max()) return false;
+  if (PrecompiledContractExecutor::isPrecompiled(tx.getTo()) || this->contracts_.contains(tx.getTo())) return false;
+  const auto it = this->accounts_.find(tx.getTo());
+  return (it == this->accounts_.end() || !it->second->isContract());
+}
+
+bool State::processTransfersParallel(std::span<const TxBlock> txs) {
+  // Group the transfers by the accounts they touch (union-find over sender/recipient).
+  // Transfers in different groups never read or write the same account, so each group
+  // can be executed independently, as long as it keeps its own canonical order.
+  boost::unordered_flat_map<Address, uint64_t, SafeHash> addrToNode;
+  std::vector<uint64_t> parents;
+  auto findRoot = [&parents](uint64_t node) {
+    while (parents[node] != node) {
+      parents[node] = parents[parents[node]];
+      node = parents[node];
+    }
+    return node;
+  };
+  auto getNode = [&addrToNode, &parents](const Address& addr) {
+    auto [it, inserted] = addrToNode.try_emplace(addr, parents.size());
+    if (inserted) parents.push_back(parents.size());
+    return it->second;
+  };
+  for (const auto& tx : txs) {
+    const uint64_t fromRoot = findRoot(getNode(tx.getFrom()));
+    const uint64_t toRoot = findRoot(getNode(tx.getTo()));
+    if (fromRoot != toRoot) parents[toRoot] = fromRoot;
+  }
+  boost::unordered_flat_map<uint64_t, uint64_t> rootToGroup;
+  std::vector<std::vector<uint64_t>> groups;
+  for (uint64_t i = 0; i < txs.size(); ++i) {
+    auto [it, inserted] = rootToGroup.try_emplace(findRoot(addrToNode.at(txs[i].getFrom())), groups.size());
+    if (inserted) groups.emplace_back();
+    groups[it->second].emplace_back(i);
+  }
+  if (groups.size() < 2) return false; // Everything conflicts, nothing to gain
+
+  // Result of a group executed against its private overlay (Address -> {balance, nonce}).
+  // Only reads are done on accounts_ while the workers are running.
+  using Overlay = boost::unordered_flat_map<Address, std::pair<Uint256, uint64_t>, SafeHash>;
+  auto executeGroups = [&](uint64_t groupOffset, uint64_t groupItems) -> std::optional<std::vector<Overlay>> {
+    std::vector<Overlay> overlays;
+    overlays.reserve(groupItems);
+    try {
+      for (uint64_t g = groupOffset; g < groupOffset + groupItems; ++g) {
+        Overlay& overlay = overlays.emplace_back();
+        auto loadEntry = [&](const Address& addr) {
+          auto [it, inserted] = overlay.try_emplace(addr, 0, 0);
+          if (!inserted) return;
+          if (auto accIt = this->accounts_.find(addr); accIt != this->accounts_.end()) {
+            it->second = {accIt->second->balance, accIt->second->nonce};
+          }
+        };
+        for (const uint64_t i : groups[g]) {
+          const TxBlock& tx = txs[i];
+          // Load both entries first, as inserting into the overlay invalidates references.
+          // Sender and recipient may be the same entry, which is fine as the operations are applied in order.
+          loadEntry(tx.getFrom());
+          loadEntry(tx.getTo());
+          auto& from = overlay.find(tx.getFrom())->second;
+          auto& to = overlay.find(tx.getTo())->second;
+          // Same checks and operations, in the same order, as processTransaction() and ContractHost
+          if (from.first < (tx.getValue() + tx.getGasLimit() * tx.getMaxFeePerGas())) return std::nullopt;
+          if (from.second != tx.getNonce()) return std::nullopt;
+          from.first -= tx.getValue();
+          to.first += tx.getValue();
+          ++from.second;
+          from.first -= (CONTRACT_EXECUTION_COST * tx.getMaxFeePerGas());
+        }
+      }
+    } catch (const std::exception&) {
+      return std::nullopt; // e.g. overflow, let the sequential path reproduce the exact behaviour
+    }
+    return overlays;
+  };
+
+  const uint64_t nThreads = std::min<uint64_t>(std::max(std::thread::hardware_concurrency(), 1u), groups.size());
+  const uint64_t requiredOffset = groups.size() / nThreads;
+  uint64_t remaining = groups.size() - (requiredOffset * nThreads);
+  uint64_t currentOffset = 0;
+  std::vector<std::future<std::optional<std::vector<Overlay>>>> futures;
+  futures.reserve(nThreads);
+  for (uint64_t i = 0; i < nThreads; ++i) {
+    uint64_t nItems = requiredOffset;
+    if (remaining != 0) { ++nItems; --remaining; }
+    futures.emplace_back(std::async(std::launch::async, executeGroups, currentOffset, nItems));
+    currentOffset += nItems;
+  }
+  std::vector<std::optional<std::vector<Overlay>>> results;
+  results.reserve(nThreads);
+  for (auto& future : futures) results.emplace_back(future.get());
+  for (const auto& result : results) {
+    if (!result.has_value()) {
+      LOGDEBUG("Parallel execution aborted, falling back to sequential execution for " + std::to_string(txs.size()) + " transfers");
+      return false;
     }
   }
 
-  // Copy mempool over
-  auto mempoolCopy = this->mempool_;
-  this->mempool_.clear();
+  // Every transfer succeeded, commit the overlays and the receipts in canonical order.
+  // The recipient account is always created, just like ExecutionContext::getAccount() does.
+  for (const auto& result : results) {
+    for (const auto& overlay : *result) {
+      for (const auto& [addr, entry] : overlay) {
+        auto& account = *this->accounts_[addr];
+        account.balance = entry.first;
+        account.nonce = entry.second;
+        this->dirtyKeys_.accounts.emplace(addr);
+      }
+    }
+  }
+  if (storage_.getIndexingMode() != IndexingMode::DISABLED) {
+    for (const auto& tx : txs) {
+      storage_.putTxAdditionalData({.hash = tx.hash(), .gasUsed = CONTRACT_EXECUTION_COST, .succeeded = true});
+    }
+  }
+  this->parallelExecutedTxs_ += txs.size();
+  return true;
+}
 
-  // Verify if the transactions within the old mempool
-  // not added to the block are valid given the current state
-  for (const auto& [hash, tx] : mempoolCopy) {
-    // Calls internal function which doesn't lock mutex.
-    if (isTxStatusValid(this->validateTransactionInternal(tx))) {
-      this->mempool_.insert({hash, tx});
+void State::processBlockTransactions(const FinalizedBlock& block) {
+  this->dumpManager_.markDirty(*this);
+  const Hash blockHash = block.getHash();
+  const auto& txs = block.getTxs();
+  uint64_t txIndex = 0;
+  while (txIndex < txs.size()) {
+    uint64_t runEnd = txIndex + 1;
+    if (this->parallelExecution_) {
+      // Find the run of independent transfers starting at the current tx.
+      // Anything else acts as a barrier and is executed sequentially, as the
+      // transfers after it have to be classified against its resulting state.
+      runEnd = txIndex;
+      while (runEnd < txs.size() && this->isIndependentTransfer(txs[runEnd])) ++runEnd;
+      if (runEnd - txIndex >= parallelExecutionMinTxs_ &&
+        this->processTransfersParallel(std::span<const TxBlock>(txs).subspan(txIndex, runEnd - txIndex))
+      ) {
+        txIndex = runEnd;
+        continue;
+      }
+      if (runEnd == txIndex) runEnd = txIndex + 1;
+    }
+    for (; txIndex < runEnd; ++txIndex) {
+      this->processTransaction(txs[txIndex], blockHash, txIndex, block.getBlockRandomness());
     }
   }
 }
 
+void State::refreshMempool(const FinalizedBlock& block) {
+  // No need to lock mutex as function caller (this->processNextBlock) already lock mutex.
+  // Remove all transactions within the block from the mempool, and take note of their senders.
+  // Only a transaction's sender gets its nonce bumped, and an account's balance can only be
+  // spent by itself, so no other sender in the mempool can have lost a valid transaction.
+  boost::unordered_flat_set<Address, SafeHash, SafeCompare> senders;
+  for (const auto& tx : block.getTxs()) {
+    this->mempool_.erase(tx.hash());
+    senders.emplace(tx.getFrom());
+  }
+  this->refreshMempoolSenders(senders);
+}
+
+void State::refreshMempoolSenders(const boost::unordered_flat_set<Address, SafeHash, SafeCompare>& senders) {
+  // Bring the senders up to date in the mempool: transactions with a nonce that was
+  // already used are dropped, queued ones that became executable are promoted, and the ones
+  // the sender can no longer pay for on top of the ones before them are removed.
+  for (const Address& sender : senders) {
+    const auto accountIt = this->accounts_.find(sender);
+    const uint64_t nonce = (accountIt != this->accounts_.end()) ? accountIt->second->nonce : 0;
+    const Uint256 balance = (accountIt != this->accounts_.end()) ? accountIt->second->balance : Uint256();
+    this->mempool_.setAccountNonce(sender, nonce);
+    uint256_t cost = 0;
+    this->mempool_.eraseIf(sender, [&balance, &cost](const TxBlock& tx) {
+      const uint256_t txCost = tx.getValue() + (tx.getGasLimit() * tx.getMaxFeePerGas());
+      if (cost + txCost > balance) return true;
+      cost += txCost;
+      return false;
+    });
+  }
+}
+
 uint256_t State::getNativeBalance(const Address &addr) const {
   std::shared_lock lock(this->stateMutex_);
   auto it = this->accounts_.find(addr);
   if (it == this->accounts_.end()) return 0;
-  return it->second->balance;
+  return uint256_t(it->second->balance);
 }
 
 uint64_t State::getNativeNonce(const Address& addr) const {
@@ -421,12 +658,21 @@ uint64_t State::getNativeNonce(const Address& addr) const {
 
 std::vector<TxBlock> State::getMempool() const {
   std::shared_lock lock(this->stateMutex_);
-  std::vector<TxBlock> mempoolCopy;
-  mempoolCopy.reserve(this->mempool_.size());
-  for (const auto& [hash, tx] : this->mempool_) {
-    mempoolCopy.emplace_back(tx);
-  }
-  return mempoolCopy;
+  return this->mempool_.getAll();
+}
+
+std::vector<TxBlock> State::buildBlockTxs(const BlockBuilder::Limits& limits) const {
+  std::shared_lock lock(this->stateMutex_);
+  std::vector<TxBlock> candidates = this->mempool_.getPending();
+  const std::vector<size_t> selected = BlockBuilder::select(candidates, [this](const Address& sender) {
+    const auto accountIt = this->accounts_.find(sender);
+    if (accountIt == this->accounts_.end()) return std::make_pair(uint64_t(0), uint256_t(0));
+    return std::make_pair(accountIt->second->nonce, uint256_t(accountIt->second->balance));
+  }, limits);
+  std::vector<TxBlock> txs;
+  txs.reserve(selected.size());
+  for (const size_t i : selected) txs.emplace_back(std::move(candidates[i]));
+  return txs;
 }
 
 BlockValidationStatus State::validateNextBlockInternal(const FinalizedBlock& block) const {
@@ -466,11 +712,28 @@ BlockValidationStatus State::validateNextBlockInternal(const FinalizedBlock& blo
     return BlockValidationStatus::invalidErroneous;
   }
 
+  // Transactions of the same sender must have consecutive nonces, and the sender's balance
+  // before the block must cover all of them at their maximum cost.
+  boost::unordered_flat_map<Address, std::pair<uint64_t, Uint256>, SafeHash> senders;
   for (const auto& tx : block.getTxs()) {
-    if (!isTxStatusValid(this->validateTransactionInternal(tx))) {
+    auto senderIt = senders.find(tx.getFrom());
+    if (senderIt == senders.end()) {
+      auto accountIt = this->accounts_.find(tx.getFrom());
+      if (accountIt == this->accounts_.end()) {
+        LOGERROR("Transaction " + tx.hash().hex().get() + " within block is from an account that doesn't exist");
+        return BlockValidationStatus::invalidErroneous;
+      }
+      senderIt = senders.emplace(
+        tx.getFrom(), std::make_pair(accountIt->second->nonce, accountIt->second->balance)
+      ).first;
+    }
+    auto& [nonce, balance] = senderIt->second;
+    if (!isTxStatusValid(this->validateTransactionInternal(tx, nonce, balance))) {
       LOGERROR("Transaction " + tx.hash().hex().get() + " within block is invalid");
       return BlockValidationStatus::invalidErroneous;
     }
+    ++nonce;
+    balance -= tx.getValue() + (tx.getGasLimit() * tx.getMaxFeePerGas());
   }
 
   LOGTRACE("Block " + block.getHash().hex().get() + " is valid. (Sanity Check Passed)");
@@ -491,7 +754,52 @@ void State::processNextBlock(FinalizedBlock&& block) {
 
 BlockValidationStatus State::tryProcessNextBlock(FinalizedBlock&& block) {
   std::unique_lock lock(this->stateMutex_);
+  const BlockValidationStatus vStatus = this->processNextBlockInternal(std::move(block), nullptr);
+  if (vStatus == BlockValidationStatus::valid) this->notifyChange();
+  return vStatus;
+}
 
+uint64_t State::tryProcessNextBlocks(std::vector<FinalizedBlock>&& blocks) {
+  uint64_t processed = 0;
+  bool stopped = false;
+  while (processed < blocks.size() && !stopped) {
+    std::unique_lock lock(this->stateMutex_);
+    boost::unordered_flat_set<Address, SafeHash, SafeCompare> senders;
+    const uint64_t groupEnd = std::min<uint64_t>(processed + State::blocksPerLock_, blocks.size());
+    const uint64_t groupBegin = processed;
+    while (processed < groupEnd) {
+      FinalizedBlock& block = blocks[processed];
+      if (block.getNHeight() > this->storage_.latest()->getNHeight()) {
+        if (this->processNextBlockInternal(std::move(block), &senders) != BlockValidationStatus::valid) {
+          stopped = true;
+          break;
+        }
+      } else {
+        // Blocks are final, one that is already in the chain arrived another way (e.g. a broadcast),
+        // unless the peer sent a different block for that height
+        const auto stored = this->storage_.getBlock(block.getNHeight());
+        if (stored == nullptr || stored->getHash() != block.getHash()) {
+          LOGERROR("Block " + block.getHash().hex().get() + " at height " + std::to_string(block.getNHeight())
+            + " conflicts with the block already in the chain"
+          );
+          stopped = true;
+          break;
+        }
+      }
+      ++processed;
+    }
+    this->refreshMempoolSenders(senders);
+    if (processed != groupBegin) this->notifyChange();
+  }
+  if (processed != 0) {
+    LOGINFO("Processed blocks up to height " + std::to_string(this->storage_.latest()->getNHeight()));
+  }
+  return processed;
+}
+
+BlockValidationStatus State::processNextBlockInternal(
+  FinalizedBlock&& block, boost::unordered_flat_set<Address, SafeHash, SafeCompare>* deferredSenders
+) {
   // Sanity check - if it passes, the block is valid and will be processed
   BlockValidationStatus vStatus = this->validateNextBlockInternal(block);
   if (vStatus != BlockValidationStatus::valid) {
@@ -506,21 +814,25 @@ BlockValidationStatus State::tryProcessNextBlock(FinalizedBlock&& block) {
   ContractGlobals::blockTimestamp_ = block.getTimestamp();
 
   // Process transactions of the block within the current state
-  uint64_t txIndex = 0;
-  for (auto const& tx : block.getTxs()) {
-    this->processTransaction(tx, blockHash, txIndex, block.getBlockRandomness());
-    txIndex++;
-  }
+  this->processBlockTransactions(block);
 
   // Process rdPoS State
   this->rdpos_.processBlock(block);
-
-  // Refresh the mempool based on the block transactions
-  this->refreshMempool(block);
-  LOGINFO("Block " + block.getHash().hex().get() + " processed successfully.");
-  Utils::safePrint("Block: " + block.getHash().hex().get() + " height: " + std::to_string(block.getNHeight()) + " was added to the blockchain");
-  for (const auto& tx : block.getTxs()) {
-    Utils::safePrint("Transaction: " + tx.hash().hex().get() + " was accepted in the blockchain");
+  this->dumpManager_.markDirty(this->rdpos_);
+
+  // Refresh the mempool based on the block transactions, or leave the senders to the caller
+  if (deferredSenders == nullptr) {
+    this->refreshMempool(block);
+    LOGINFO("Block " + block.getHash().hex().get() + " processed successfully.");
+    Utils::safePrint("Block: " + block.getHash().hex().get() + " height: " + std::to_string(block.getNHeight()) + " was added to the blockchain");
+    for (const auto& tx : block.getTxs()) {
+      Utils::safePrint("Transaction: " + tx.hash().hex().get() + " was accepted in the blockchain");
+    }
+  } else {
+    for (const auto& tx : block.getTxs()) {
+      this->mempool_.erase(tx.hash());
+      deferredSenders->emplace(tx.getFrom());
+    }
   }
 
   blockObservers_.notify(block);
@@ -536,18 +848,57 @@ TxStatus State::validateTransaction(const TxBlock& tx) const {
 }
 
 TxStatus State::addTx(TxBlock&& tx) {
-  const auto txResult = this->validateTransaction(tx);
-  if (txResult != TxStatus::ValidNew) return txResult;
   std::unique_lock lock(this->stateMutex_);
-  auto txHash = tx.hash();
-  this->mempool_.insert({txHash, std::move(tx)});
-  LOGTRACE("Transaction: " + txHash.hex().get() + " was added to the mempool");
-  return txResult; // should be TxStatus::ValidNew
+  const Hash txHash = tx.hash();
+  if (this->mempool_.contains(txHash)) {
+    LOGTRACE("Transaction: " + txHash.hex().get() + " already in mempool");
+    return TxStatus::ValidExisting;
+  }
+  auto accountIt = this->accounts_.find(tx.getFrom());
+  if (accountIt == this->accounts_.end()) {
+    LOGERROR("Account doesn't exist (0 balance and 0 nonce)");
+    return TxStatus::InvalidBalance;
+  }
+  // The sender's queued transactions with lower nonces are paid for first
+  const auto& accBalance = accountIt->second->balance;
+  const Address from = tx.getFrom();
+  if (
+    uint256_t txWithFees = this->mempool_.getCostBefore(from, static_cast<uint64_t>(tx.getNonce()))
+      + tx.getValue() + (tx.getGasLimit() * tx.getMaxFeePerGas());
+    txWithFees > accBalance
+  ) {
+    LOGERROR("Transaction sender: " + from.hex().get()
+      + " doesn't have balance to send transaction"
+      + " expected: " + txWithFees.str() + " has: " + accBalance.str()
+    );
+    return TxStatus::InvalidBalance;
+  }
+  // Nonce, replacement and pool limits are up to the mempool, a nonce ahead of the account's is queued
+  const auto txResult = this->mempool_.add(std::move(tx), accountIt->second->nonce);
+  if (txResult == TxStatus::ValidNew) {
+    // Transactions after it may no longer be affordable if it filled a gap or replaced a cheaper one
+    this->refreshMempoolSenders({from});
+    LOGTRACE("Transaction: " + txHash.hex().get() + " was added to the mempool");
+    this->notifyChange();
+  } else {
+    LOGTRACE("Transaction: " + txHash.hex().get() + " was rejected by the mempool");
+  }
+  return txResult;
 }
 
 TxStatus State::addValidatorTx(const TxValidator& tx) {
   std::unique_lock lock(this->stateMutex_);
-  return this->rdpos_.addValidatorTx(tx);
+  const TxStatus txResult = this->rdpos_.addValidatorTx(tx);
+  if (txResult == TxStatus::ValidNew) this->notifyChange();
+  return txResult;
+}
+
+void State::notifyChange() {
+  {
+    std::lock_guard lock(this->changesMutex_);
+    ++this->changes_;
+  }
+  this->changesCv_.notify_all();
 }
 
 bool State::isTxInMempool(const Hash& txHash) const {
@@ -557,20 +908,22 @@ bool State::isTxInMempool(const Hash& txHash) const {
 
 std::unique_ptr<TxBlock> State::getTxFromMempool(const Hash &txHash) const {
   std::shared_lock lock(this->stateMutex_);
-  auto it = this->mempool_.find(txHash);
-  if (it == this->mempool_.end()) return nullptr;
-  return std::make_unique<TxBlock>(it->second);
+  const TxBlock* tx = this->mempool_.find(txHash);
+  if (tx == nullptr) return nullptr;
+  return std::make_unique<TxBlock>(*tx);
 }
 
 void State::addBalance(const Address& addr) {
   std::unique_lock lock(this->stateMutex_);
   this->accounts_[addr]->balance += uint256_t("1000000000000000000000");
+  this->dirtyKeys_.accounts.emplace(addr);
+  this->dumpManager_.markDirty(*this);
 }
 
 Bytes State::ethCall(EncodedStaticCallMessage& msg) {
-  // We actually need to lock uniquely here
-  // As the contract host will modify (reverting in the end) the state.
-  std::unique_lock lock(this->stateMutex_);
+  // Everything the call writes goes to the context overlay and is thrown away,
+  // so the state is only read and a shared lock is enough.
+  std::shared_lock lock(this->stateMutex_);
   const auto& accIt = this->accounts_.find(msg.to());
   if (accIt == this->accounts_.end()) {
     return {};
@@ -593,18 +946,22 @@ Bytes State::ethCall(EncodedStaticCallMessage& msg) {
       .blockGasLimit(10'000'000)
       .txGasPrice(0)
       .chainId(this->options_.getChainID())
+      .overlay(this->simulationContractsMutex_)
       .build();
 
       // As we are simulating, the randomSeed can be anything
       const Hash randomSeed = bytes::random();
+      const auto vm = this->getSimulationVm();
 
       return ContractHost(
-        this->vm_,
+        vm.get(),
         this->dumpManager_,
         this->storage_,
         randomSeed,
-        context
-      ).execute(msg);
+        context,
+        nullptr,
+        &this->evmCodeCache_
+      ).simulate(msg);
     } else {
       return {};
     }
@@ -616,7 +973,8 @@ Bytes State::ethCall(EncodedStaticCallMessage& msg) {
 }
 
 int64_t State::estimateGas(EncodedMessageVariant msg) {
-  std::unique_lock lock(this->stateMutex_);
+  // Same as ethCall(), the simulation only writes to the context overlay
+  std::shared_lock lock(this->stateMutex_);
   auto latestBlock = this->storage_.latest();
   try {
     std::unique_ptr<ExecutionContext> context;
@@ -638,6 +996,7 @@ int64_t State::estimateGas(EncodedMessageVariant msg) {
         .blockGasLimit(10'000'000)
         .txGasPrice(0)
         .chainId(this->options_.getChainID())
+        .overlay(this->simulationContractsMutex_)
         .buildPtr();
     } else {
       createMessage = std::get_if<EncodedCreateMessage>(&msg);
@@ -659,16 +1018,20 @@ int64_t State::estimateGas(EncodedMessageVariant msg) {
         .blockGasLimit(10'000'000)
         .txGasPrice(0)
         .chainId(this->options_.getChainID())
+        .overlay(this->simulationContractsMutex_)
         .buildPtr();
     }
 
     const Hash randomSeed = bytes::random();
+    const auto vm = this->getSimulationVm();
     ContractHost host(
-      this->vm_,
+      vm.get(),
       this->dumpManager_,
       this->storage_,
       randomSeed,
-      *context
+      *context,
+      nullptr,
+      &this->evmCodeCache_
     );
     return std::visit([&host] (auto&& msg) {
       const Gas& gas = msg.gas();
@@ -685,6 +1048,7 @@ int64_t State::estimateGas(EncodedMessageVariant msg) {
 
 std::vector<std::pair<std::string, Address>> State::getCppContracts() const {
   std::shared_lock lock(this->stateMutex_);
+  std::lock_guard contractsLock(this->simulationContractsMutex_);
   std::vector<std::pair<std::string, Address>> contracts;
   for (const auto& [address, contract] : this->contracts_) {
     contracts.emplace_back(contract->getContractName(), address);
@@ -710,6 +1074,7 @@ Bytes State::getContractCode(const Address &addr) const {
   // If its a PRECOMPILE contract, we need to return "PrecompileContract-CONTRACTNAME"
   // yes, inside a Bytes object, not a string object.
   if (it->second->contractType == ContractType::CPP) {
+    std::lock_guard contractsLock(this->simulationContractsMutex_);
     auto contractIt = this->contracts_.find(addr);
     if (contractIt == this->contracts_.end()) {
       return {};
@@ -8,11 +8,16 @@ See the LICENSE.txt file in the project root for more information.
 #ifndef STATE_H
 #define STATE_H
 
+#include <condition_variable>
+
 #include "../contract/contract.h"
 
 #include "rdpos.h" // set, boost/unordered/unordered_flat_map.hpp
+#include "mempool.h"
+#include "blockbuilder.h"
 #include "dump.h" // utils/db.h, storage.h -> utils/randomgen.h -> utils.h -> logger.h, (strings.h -> evmc/evmc.hpp), (libs/json.hpp -> boost/unordered/unordered_flat_map.hpp)
 #include "contract/blockobservers.h"
+#include "contract/evmcodecache.h"
 
 // TODO: We could possibly change the bool functions into an enum function,
 // to be able to properly return each error case. We need this in order to slash invalid rdPoS blocks.
@@ -34,9 +39,29 @@ class State : public Dumpable, public Log::LogicalLocationProvider {
     boost::unordered_flat_map<Address, std::unique_ptr<BaseContract>, SafeHash, SafeCompare> contracts_; ///< Map with information about blockchain contracts (Address -> Contract).
     boost::unordered_flat_map<StorageKey, Hash, SafeHash, SafeCompare> vmStorage_; ///< Map with the storage of the EVM.
     boost::unordered_flat_map<Address, NonNullUniquePtr<Account>, SafeHash, SafeCompare> accounts_; ///< Map with information about blockchain accounts (Address -> Account).
-    boost::unordered_flat_map<Hash, TxBlock, SafeHash> mempool_; ///< TxBlock mempool.
+    Mempool mempool_; ///< TxBlock mempool, with per-sender nonce queues.
     boost::unordered_flat_map<Hash, std::shared_ptr<Bytes>, SafeHash, SafeCompare> evmContracts_; ///< Map with EVM contract code (Code Hash -> Code).
+    EvmCodeCache evmCodeCache_; ///< Analyses of deployed EVM code, shared by block execution and simulations.
+    mutable ExecutionContext::DirtyKeys dirtyKeys_; ///< State keys changed since the last dump, consumed by snapshotDelta().
+    mutable ExecutionContext::DirtyKeys unstoredKeys_; ///< State keys captured by dumps that aren't stored yet, captured again until one is.
+    ExecutionContext::Journal journal_; ///< Undo journal reused by every transaction processed, so its buffer is allocated once and not per transaction.
     BlockObservers blockObservers_;
+    const bool parallelExecution_; ///< Whether independent native transfers within a block can be executed in parallel.
+    uint64_t parallelExecutedTxs_ = 0; ///< Number of transactions committed by processTransfersParallel() since startup.
+    /// Mutex held by everything that reads C++ contracts under a shared state lock: simulations (which write
+    /// them in place until they're done), dumps and the contract getters. Taken after the state lock.
+    mutable std::mutex simulationContractsMutex_;
+    std::mutex simulationVmsMutex_; ///< Mutex for managing access to the idle simulation VMs.
+    std::vector<evmc_vm*> simulationVms_; ///< Idle EVM instances for simulations, as an instance can't run two executions at once.
+    mutable std::mutex changesMutex_; ///< Mutex for managing access to the change counter.
+    mutable std::condition_variable changesCv_; ///< Wakes up threads waiting for transactions or blocks to be accepted.
+    uint64_t changes_ = 0; ///< Number of changes notified so far, so waiters can tell whether they missed one.
+
+    /// Minimum number of consecutive independent transfers required to attempt parallel execution.
+    static constexpr uint64_t parallelExecutionMinTxs_ = 64;
+
+    /// Maximum number of blocks tryProcessNextBlocks() processes before releasing the state lock for others.
+    static constexpr uint64_t blocksPerLock_ = 8;
 
     /**
      * Verify if a transaction can be accepted within the current state.
@@ -45,6 +70,15 @@ class State : public Dumpable, public Log::LogicalLocationProvider {
      */
     TxStatus validateTransactionInternal(const TxBlock& tx) const;
 
+    /**
+     * Verify if a transaction can be executed right after the given sender nonce and balance.
+     * @param tx The transaction to check.
+     * @param accNonce The nonce the transaction must have.
+     * @param accBalance The balance available to the sender.
+     * @return An enum telling if the transaction is valid or not.
+     */
+    TxStatus validateTransactionInternal(const TxBlock& tx, const uint64_t& accNonce, const Uint256& accBalance) const;
+
     /**
      * Validate the next block given the current state and its transactions. Does NOT update the state.
      * The block will be rejected if there are invalid transactions in it
@@ -65,15 +99,67 @@ class State : public Dumpable, public Log::LogicalLocationProvider {
      */
     void processTransaction(const TxBlock& tx, const Hash& blockHash, const uint64_t& txIndex, const Hash& randomnessHash);
 
+    /**
+     * Check if a transaction is a plain native transfer, which only touches the sender and recipient accounts.
+     * Such transactions can be executed without a ContractHost and grouped by the accounts they touch.
+     * NOTE: This method does not perform synchronization.
+     * @param tx The transaction to check.
+     * @return `true` if the transaction is an independent native transfer, `false` otherwise.
+     */
+    bool isIndependentTransfer(const TxBlock& tx) const;
+
+    /**
+     * Speculatively execute a run of independent native transfers in parallel.
+     * Transfers are split into groups that share no accounts, each group is executed
+     * in canonical order against a private overlay on a separate thread, and the overlays
+     * are only committed to the state if every transfer in the run succeeded exactly as it
+     * would when executed sequentially. Otherwise nothing is applied.
+     * NOTE: This method does not perform synchronization.
+     * @param txs The run of transfers to execute (all of them must pass isIndependentTransfer()).
+     * @return `true` if the transfers were executed and committed, `false` if the caller has to execute them sequentially.
+     */
+    bool processTransfersParallel(std::span<const TxBlock> txs);
+
+    /**
+     * Process all transactions of a block within the current state, in canonical order.
+     * Uses processTransfersParallel() for runs of independent transfers if parallel execution
+     * is enabled, and processTransaction() for everything else.
+     * NOTE: This method does not perform synchronization.
+     * @param block The block whose transactions will be processed.
+     */
+    void processBlockTransactions(const FinalizedBlock& block);
+
     /**
      * Update the mempool, remove transactions that are in the given block, and leave only valid transactions in it.
      * Called by processNewBlock(), used to filter the current mempool based on transactions that have been
      * accepted on the block, and verify if transactions on the mempool are valid given the new state after
-     * processing the block itself.
+     * processing the block itself. Only the senders of the block's transactions are revalidated,
+     * so the cost depends on the block's size and not on the mempool's.
      * @param block The block to use for pruning transactions from the mempool.
      */
     void refreshMempool(const FinalizedBlock& block);
 
+    /**
+     * Bring the given senders up to date in the mempool, after the blocks holding their transactions were processed.
+     * Used by refreshMempool(), and by tryProcessNextBlocks() once for all the blocks it processed.
+     * NOTE: This method does not perform synchronization.
+     * @param senders The senders whose account nonce or balance may have changed.
+     */
+    void refreshMempoolSenders(const boost::unordered_flat_set<Address, SafeHash, SafeCompare>& senders);
+
+    /**
+     * Process the next block. Does the work of tryProcessNextBlock() and tryProcessNextBlocks().
+     * NOTE: This method does not perform synchronization.
+     * @param block The block to process.
+     * @param deferredSenders If null, the mempool is refreshed right away. Otherwise the block's
+     *                        transactions are only removed from it, and their senders added to this
+     *                        set, so the caller can refresh them once for many blocks.
+     * @return A status code from BlockValidationStatus.
+     */
+    BlockValidationStatus processNextBlockInternal(
+      FinalizedBlock&& block, boost::unordered_flat_set<Address, SafeHash, SafeCompare>* deferredSenders
+    );
+
     /**
      * Helper function that does a sanity check on all contracts in the accounts_ map.
      * Used exclusively by the constructor.
@@ -84,22 +170,57 @@ class State : public Dumpable, public Log::LogicalLocationProvider {
      */
     void contractSanityCheck(const Address& addr, const Account& acc);
 
+    /**
+     * Take an idle EVM instance for a simulation (eth_call/eth_estimateGas), creating one if there are none.
+     * @return The instance. It goes back to the pool when released.
+     */
+    std::shared_ptr<evmc_vm> getSimulationVm();
+
   public:
     /**
      * Constructor.
-     * @param db Pointer to the database.
+     * @param db Pointer to the state database. State dumps are written back into it.
      * @param storage Pointer to the blockchain's storage.
      * @param p2pManager Pointer to the P2P connection manager.
-     * @param snapshotHeight The block height to start from.
+     * @param snapshotHeight The block height to start from, if the database doesn't store its own dump height.
      * @param options Pointer to the options singleton.
      * @throw DynamicException on any database size mismatch.
      */
-    State(const DB& db, Storage& storage, P2P::ManagerNormal& p2pManager, const uint64_t& snapshotHeight, const Options& options);
+    State(DB& db, Storage& storage, P2P::ManagerNormal& p2pManager, const uint64_t& snapshotHeight, const Options& options);
 
     ~State(); ///< Destructor.
 
     std::string getLogicalLocation() const override { return p2pManager_.getLogicalLocation(); } ///< Log instance from P2P
 
+    /**
+     * Wake up every thread blocked in waitForChange().
+     * Called whenever a transaction, a validator transaction or a block is accepted,
+     * and by threads that need the waiters to check their stop flags.
+     */
+    void notifyChange();
+
+    /**
+     * Block until a condition on the state holds, re-checking it every time the state notifies a change.
+     * The condition is always checked without holding any internal lock, so it can use the state's getters.
+     * @param ready The condition to wait for.
+     * @param timeout How long to wait at most.
+     * @return `true` if the condition holds, `false` if the timeout elapsed first.
+     */
+    template <typename Pred> bool waitForChange(Pred&& ready, std::chrono::milliseconds timeout) const {
+      const auto deadline = std::chrono::steady_clock::now() + timeout;
+      std::unique_lock lock(this->changesMutex_);
+      uint64_t seen = this->changes_;
+      lock.unlock();
+      // Checking after reading the counter means a change made in between is not missed
+      while (!ready()) {
+        lock.lock();
+        if (!this->changesCv_.wait_until(lock, deadline, [&]() { return this->changes_ != seen; })) return false;
+        seen = this->changes_;
+        lock.unlock();
+      }
+      return true;
+    }
+
     // ----------------------------------------------------------------------
     // RDPOS WRAPPER FUNCTIONS
     // ----------------------------------------------------------------------
@@ -116,7 +237,7 @@ class State : public Dumpable, public Log::LogicalLocationProvider {
     void rdposClearMempool() { std::unique_lock lock(this->stateMutex_); return this->rdpos_.clearMempool(); }
     bool rdposValidateBlock(const FinalizedBlock& block) const { std::shared_lock lock(this->stateMutex_); return this->rdpos_.validateBlock(block); }
     Hash rdposProcessBlock(const FinalizedBlock& block) { std::unique_lock lock(this->stateMutex_); return this->rdpos_.processBlock(block); }
-    TxStatus rdposAddValidatorTx(const TxValidator& tx) { std::unique_lock lock(this->stateMutex_); return this->rdpos_.addValidatorTx(tx); }
+    TxStatus rdposAddValidatorTx(const TxValidator& tx) { return this->addValidatorTx(tx); }
     void dumpStartWorker() { this->dumpWorker_.startWorker(); }
     void dumpStopWorker() { this->dumpWorker_.stopWorker(); }
     size_t getDumpManagerSize() const { std::shared_lock lock(this->stateMutex_); return this->dumpManager_.size(); }
@@ -154,6 +275,18 @@ class State : public Dumpable, public Log::LogicalLocationProvider {
       return this->mempool_.size();
     }
 
+    /// Get the number of transactions in the mempool that can be executed right away.
+    inline size_t getPendingTxsSize() const {
+      std::shared_lock<std::shared_mutex> lock (this->stateMutex_);
+      return this->mempool_.pendingSize();
+    }
+
+    /// Get the number of block transactions that were executed in parallel since startup.
+    inline uint64_t getParallelExecutedTxs() const {
+      std::shared_lock<std::shared_mutex> lock (this->stateMutex_);
+      return this->parallelExecutedTxs_;
+    }
+
     /**
      * Validate the next block given the current state and its transactions. Does NOT update the state.
      * The block will be rejected if there are invalid transactions in it
@@ -180,6 +313,20 @@ class State : public Dumpable, public Log::LogicalLocationProvider {
      */
     BlockValidationStatus tryProcessNextBlock(FinalizedBlock&& block);
 
+    /**
+     * Process a contiguous range of blocks while catching up with the network. DOES update the state.
+     * Same as calling tryProcessNextBlock() for each block, but blocks are processed in groups of up to
+     * blocksPerLock_ under a single lock, and the mempool is only refreshed once per group, for every
+     * sender in it. The lock is released between groups, so RPC calls and new transactions aren't held up
+     * for the whole range.
+     * Blocks that are already in the chain (e.g. received from a broadcast meanwhile) are skipped,
+     * as long as they match the stored block at their height.
+     * @param blocks The blocks to process, in order.
+     * @return The number of leading blocks of the range that are now in the chain.
+     *         Stops at the first invalid block, or the first one that conflicts with the chain.
+     */
+    uint64_t tryProcessNextBlocks(std::vector<FinalizedBlock>&& blocks);
+
     /**
      * Verify if a transaction can be accepted within the current state.
      * Calls validateTransactionInternal(), but locks the mutex in a shared manner.
@@ -190,6 +337,8 @@ class State : public Dumpable, public Log::LogicalLocationProvider {
 
     /**
      * Add a transaction to the mempool, if valid.
+     * Transactions with a nonce ahead of the sender's are kept queued until the gap is filled,
+     * and a transaction with the same sender and nonce as a pooled one replaces it if it pays more.
      * @param tx The transaction to add.
      * @return An enum telling if the transaction is valid or not.
      */
@@ -235,6 +384,7 @@ class State : public Dumpable, public Log::LogicalLocationProvider {
 
     /**
      * Simulate an `eth_call` to a contract.
+     * Runs under a shared lock against a discardable overlay, so calls run in parallel with each other.
      * @param callInfo Tuple with info about the call (from, to, gasLimit, gasPrice, value, data).
      * @return The return of the called function as a data string.
      */
@@ -243,6 +393,7 @@ class State : public Dumpable, public Log::LogicalLocationProvider {
     /**
      * Estimate gas for callInfo in RPC.
      * Doesn't really "estimate" gas, but rather tells if the transaction is valid or not.
+     * Runs under a shared lock against a discardable overlay, like ethCall().
      * @param callInfo Tuple with info about the call (from, to, gasLimit, gasPrice, value, data).
      * @return The used gas limit of the transaction.
      */
@@ -256,10 +407,41 @@ class State : public Dumpable, public Log::LogicalLocationProvider {
 
     DBBatch dump() const final; ///< State dumping function.
 
-    /// Get the pending transactions from the mempool.
-    auto getPendingTxs() const {
+    /**
+     * Capture the state for a full dump. Every entry that differs from the database is tracked
+     * (entries loaded from genesis included), so this is the same as snapshotDelta(): copying
+     * every map under the state lock is never needed.
+     * @return A function that returns the batch of entries missing from the database.
+     */
+    std::function<DBBatch()> snapshot() const final;
+
+    /**
+     * Capture a copy of the accounts, EVM storage slots and EVM code changed since the last stored dump.
+     * Keys captured by a dump that then failed are captured again, until dumpStored() is called.
+     * Entries are never removed from the state, so the changed entries are all that has to be written.
+     * @return A function that returns the batch of changed entries.
+     */
+    std::function<DBBatch()> snapshotDelta() const final;
+
+    void dumpStored() const final; ///< Forget the keys captured so far, now that they are in the database.
+
+    /// Get the transactions from the mempool that can be executed right away, each sender's in nonce order.
+    std::vector<TxBlock> getPendingTxs() const {
+      std::shared_lock lock(this->stateMutex_);
+      return this->mempool_.getPending();
+    }
+
+    /**
+     * Select the transactions of the next block out of the mempool's pending ones.
+     * @param limits The budget of the block.
+     * @return The selected transactions, in block order.
+     */
+    std::vector<TxBlock> buildBlockTxs(const BlockBuilder::Limits& limits) const;
+
+    /// Get the transactions from the mempool that wait for a nonce gap to be filled, each sender's in nonce order.
+    std::vector<TxBlock> getQueuedTxs() const {
       std::shared_lock lock(this->stateMutex_);
-      return this->mempool_;
+      return this->mempool_.getQueued();
     }
 
     /**
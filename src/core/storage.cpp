@@ -20,7 +20,13 @@ bool Storage::topicsMatch(const Event& event, const std::vector<Hash>& topics) {
 
 void Storage::storeBlock(DB& db, const FinalizedBlock& block, bool indexingEnabled) {
   DBBatch batch;
-  batch.push_back(block.getHash(), block.serializeBlock(), DBPrefix::blocks);
+  appendBlock(batch, block, indexingEnabled);
+  db.putBatch(batch);
+}
+
+void Storage::appendBlock(DBBatch& batch, const FinalizedBlock& block, bool indexingEnabled) {
+  batch.push_back(block.getHash(), block.serializeBlockV2(), DBPrefix::blocks);
+  batch.push_back(block.getHash(), block.serializeSidecar(), DBPrefix::blockSidecars);
   batch.push_back(UintConv::uint64ToBytes(block.getNHeight()), block.getHash(), DBPrefix::heightToBlock);
 
   if (indexingEnabled) {
@@ -33,7 +39,6 @@ void Storage::storeBlock(DB& db, const FinalizedBlock& block, bool indexingEnabl
       batch.push_back(TxHash, value, DBPrefix::txToBlock);
     }
   }
-  db.putBatch(batch);
 }
 
 void Storage::reindexTransactions(const FinalizedBlock& block, DBBatch& batch) {
@@ -51,10 +56,21 @@ void Storage::dumpToDisk(DBBatch &batch) {
 }
 
 Storage::Storage(std::string instanceIdStr, const Options& options)
-  : blocksDb_(options.getRootPath() + "/blocksDb/"),  // Uncompressed
+  : blocksDb_(options.getRootPath() + "/blocksDb/", options.getDBSettings()),
+    segments_(options.getRootPath() + "/blockSegments/", options.getColdSegmentBlocks()),
     eventsDb_(options.getRootPath() + "/newEventsDb/"),
-    options_(options), instanceIdStr_(std::move(instanceIdStr))
+    options_(options), coldBlockDepth_(options.getColdBlockDepth()), instanceIdStr_(std::move(instanceIdStr)),
+    blockCache_(options.getBlockCacheBytes())
 {
+  // Blocks moved out of the database can only be read from their segments
+  if (
+    const Bytes coldHeight = blocksDb_.get(coldHeightKey_, DBPrefix::metadata);
+    !coldHeight.empty() && UintConv::bytesToUint64(coldHeight) >= segments_.endHeight()
+  ) {
+    throw DynamicException("Block segments are missing blocks that were moved out of the database");
+  }
+  this->stubUnfinishedSegments();
+
   // Initialize the blockchain if latest block doesn't exist.
   LOGINFO("Loading blockchain from DB");
   initializeBlockchain();
@@ -64,10 +80,11 @@ Storage::Storage(std::string instanceIdStr, const Options& options)
   const Bytes latestBlockHash = blocksDb_.getLastByPrefix(DBPrefix::heightToBlock);
   if (latestBlockHash.empty()) throw DynamicException("Latest block hash not found in DB");
 
-  const Bytes latestBlockBytes = blocksDb_.get(latestBlockHash, DBPrefix::blocks);
+  const StoredBlock latestBlockBytes = this->readBlock(Hash(latestBlockHash));
   if (latestBlockBytes.empty()) throw DynamicException("Latest block bytes not found in DB");
 
-  latest_ = std::make_shared<const FinalizedBlock>(FinalizedBlock::fromBytes(latestBlockBytes, this->options_.getChainID()));
+  latest_ = this->decodeBlock(latestBlockBytes.blockView(), latestBlockBytes.sidecarView());
+  this->blockCache_.put(latest_.load());
   LOGINFO("Latest block successfully loaded");
 
   // If the legacy events folder exists, migrate them to the new folder
@@ -97,6 +114,249 @@ Storage::Storage(std::string instanceIdStr, const Options& options)
 
     std::filesystem::rename(legacyEventsPath, options.getRootPath() + "/legacyEventsDb/");
   }
+
+  this->writerFuture_ = std::async(std::launch::async, &Storage::writerLoop, this);
+  this->archiverFuture_ = std::async(std::launch::async, &Storage::archiverLoop, this, latest_.load()->getNHeight());
+}
+
+Storage::~Storage() {
+  {
+    std::lock_guard lock(this->pendingMutex_);
+    this->stopArchiver_ = true;
+  }
+  this->persistedCv_.notify_all();
+  this->archiverFuture_.wait();
+  {
+    std::lock_guard lock(this->pendingMutex_);
+    this->stopWriter_ = true;
+  }
+  this->writerCv_.notify_all();
+  this->writerFuture_.wait();
+}
+
+void Storage::writerLoop() {
+  const bool indexingEnabled = this->options_.getIndexingMode() != IndexingMode::DISABLED;
+  std::unique_lock lock(this->pendingMutex_);
+  while (true) {
+    this->writerCv_.wait(lock, [this]() { return this->stopWriter_ || !this->pending_.empty(); });
+    if (this->pending_.empty()) return; // Only stops once every published block is written
+
+    // Every block published since the last write goes in the same commit, so a node catching up
+    // (or a writer that fell behind) does one write for many blocks instead of one per block.
+    // The blocks stay in pending_ while they are written so readers keep finding them,
+    // only the data that readers look up through the pending maps is moved out.
+    const size_t count = this->pending_.size();
+    std::vector<PendingBlock> toWrite(count);
+    for (size_t i = 0; i < count; i++) {
+      PendingBlock& pending = this->pending_[i];
+      toWrite[i].block = pending.block;
+      toWrite[i].txData = std::move(pending.txData);
+      toWrite[i].callTraces = std::move(pending.callTraces);
+      toWrite[i].events = std::move(pending.events);
+    }
+    lock.unlock();
+
+    // Retried until it succeeds, the blocks stay pending meanwhile so readers keep finding them.
+    // Blocks and events go to different databases, so each of them is only written once.
+    bool blocksWritten = false;
+    bool eventsWritten = false;
+    while (true) {
+      try {
+        if (!blocksWritten) {
+          DBBatch batch;
+          for (const PendingBlock& pending : toWrite) {
+            appendBlock(batch, *pending.block, indexingEnabled);
+            for (const TxAdditionalData& data : pending.txData) {
+              Bytes serialized;
+              zpp::bits::out out(serialized);
+              out(data).or_throw();
+              batch.push_back(data.hash, serialized, DBPrefix::txToAdditionalData);
+            }
+            for (const auto& [txHash, callTrace] : pending.callTraces) {
+              Bytes serialized;
+              zpp::bits::out out(serialized);
+              out(callTrace).or_throw();
+              batch.push_back(txHash, serialized, DBPrefix::txToCallTrace);
+            }
+          }
+          if (!this->blocksDb_.putBatch(batch)) throw DynamicException("the database write failed");
+          blocksWritten = true;
+        }
+        // A single transaction for all the blocks, instead of one per executed transaction
+        if (!eventsWritten && std::ranges::any_of(toWrite, [](const PendingBlock& pending) { return !pending.events.empty(); })) {
+          auto transaction = this->eventsDb_.transaction();
+          for (const PendingBlock& pending : toWrite) {
+            for (const Event& event : pending.events) this->eventsDb_.putEvent(event);
+          }
+          transaction->commit();
+        }
+        eventsWritten = true;
+        break;
+      } catch (const std::exception& e) {
+        LOGERROR("Failed to write " + std::to_string(count) + " blocks to the database, retrying: " + e.what());
+      }
+      lock.lock();
+      this->writeFailed_ = true;
+      this->persistedCv_.notify_all();
+      if (this->writerCv_.wait_for(lock, writeRetryDelay_, [this]() { return this->stopWriter_; })) {
+        LOGERROR("Stopping with " + std::to_string(this->pending_.size()) + " blocks not written to the database");
+        return;
+      }
+      lock.unlock();
+    }
+
+    lock.lock();
+    this->writeFailed_ = false;
+    for (const PendingBlock& pending : toWrite) {
+      for (const TxBlock& tx : pending.block->getTxs()) this->pendingTxs_.erase(tx.hash());
+      for (const TxAdditionalData& data : pending.txData) this->pendingTxData_.erase(data.hash);
+      for (const auto& [txHash, callTrace] : pending.callTraces) this->pendingCallTraces_.erase(txHash);
+      this->pending_.pop_front();
+    }
+    this->persistedCv_.notify_all();
+  }
+}
+
+bool Storage::convertBlocks(uint64_t toHeight) {
+  try {
+    uint64_t height = 0;
+    if (const Bytes converted = this->blocksDb_.get(convertedHeightKey_, DBPrefix::metadata); !converted.empty()) {
+      height = UintConv::bytesToUint64(converted) + 1;
+    }
+    if (height > toHeight) return true;
+    LOGINFO("Converting blocks " + std::to_string(height) + " to " + std::to_string(toHeight) + " to the v2 format");
+    while (height <= toHeight && !this->stopArchiver_) {
+      const uint64_t last = std::min(toHeight, height + archiverBatchBlocks_ - 1);
+      std::vector<Bytes> heightKeys;
+      for (uint64_t i = height; i <= last; i++) heightKeys.push_back(UintConv::uint64ToBytes(i));
+      const std::vector<Bytes> hashes = this->blocksDb_.multiGet(heightKeys, DBPrefix::heightToBlock);
+      const std::vector<Bytes> blocks = this->blocksDb_.multiGet(hashes, DBPrefix::blocks);
+      const std::vector<Bytes> sidecars = this->blocksDb_.multiGet(hashes, DBPrefix::blockSidecars);
+      DBBatch batch;
+      for (size_t i = 0; i < hashes.size(); i++) {
+        if (hashes[i].empty() || blocks[i].empty()) continue;
+        if (FinalizedBlock::getFormat(blocks[i]) == FinalizedBlock::formatV2 && !sidecars[i].empty()) continue;
+        // Blocks without a sidecar are fully validated once more, then never again
+        const auto block = this->decodeBlock(blocks[i], sidecars[i]);
+        batch.push_back(hashes[i], block->serializeBlockV2(), DBPrefix::blocks);
+        batch.push_back(hashes[i], block->serializeSidecar(), DBPrefix::blockSidecars);
+      }
+      batch.push_back(convertedHeightKey_, UintConv::uint64ToBytes(last), DBPrefix::metadata);
+      if (!this->blocksDb_.putBatch(batch)) {
+        LOGERROR("Failed to write converted blocks " + std::to_string(height) + " to " + std::to_string(last));
+        return false;
+      }
+      height = last + 1;
+    }
+    if (height <= toHeight) return false;
+    LOGINFO("Every stored block is in the v2 format");
+    return true;
+  } catch (const std::exception& e) {
+    LOGERROR(std::string("Failed to convert blocks to the v2 format: ") + e.what());
+    return false;
+  }
+}
+
+void Storage::archiverLoop(uint64_t convertToHeight) {
+  bool converted = false;
+  std::unique_lock lock(this->pendingMutex_);
+  while (!this->stopArchiver_) {
+    lock.unlock();
+    try {
+      // Only v2 blocks with a sidecar are moved, so blocks are converted first
+      if (!converted) converted = this->convertBlocks(convertToHeight);
+      if (converted) {
+        if (this->coldBlockDepth_ == 0) return;
+        // A failed move may have left the blocks of its segment in the database
+        this->stubUnfinishedSegments();
+        lock.lock();
+        while (true) {
+          // Wait for the whole next segment to be deep enough in the chain, and written to the database
+          const uint64_t lastHeight = this->segments_.endHeight() + this->segments_.getSegmentBlocks() - 1;
+          this->persistedCv_.wait(lock, [&]() {
+            return this->stopArchiver_ || this->persistedHeight() >= lastHeight + this->coldBlockDepth_;
+          });
+          if (this->stopArchiver_) return;
+          lock.unlock();
+          this->moveToSegments();
+          lock.lock();
+        }
+      }
+    } catch (const std::exception& e) {
+      LOGERROR(std::string("Failed to move blocks to the block segments, retrying: ") + e.what());
+    }
+    if (!lock.owns_lock()) lock.lock();
+    this->persistedCv_.wait_for(lock, archiverRetryDelay_, [this]() { return this->stopArchiver_.load(); });
+  }
+}
+
+void Storage::moveToSegments() {
+  const uint64_t fromHeight = this->segments_.endHeight();
+  const uint64_t toHeight = fromHeight + this->segments_.getSegmentBlocks() - 1;
+  LOGINFO("Moving blocks " + std::to_string(fromHeight) + " to " + std::to_string(toHeight) + " to the block segments");
+  // The segment is streamed to disk, only one batch of blocks is held in memory at a time
+  uint64_t batchHeight = 0;
+  std::vector<Bytes> blocks;
+  std::vector<Bytes> sidecars;
+  this->segments_.append([&](uint64_t height) {
+    if (height >= batchHeight + blocks.size()) {
+      batchHeight = height;
+      const uint64_t last = std::min(toHeight, height + archiverBatchBlocks_ - 1);
+      std::vector<Bytes> heightKeys;
+      for (uint64_t i = height; i <= last; i++) heightKeys.push_back(UintConv::uint64ToBytes(i));
+      const std::vector<Bytes> hashes = this->blocksDb_.multiGet(heightKeys, DBPrefix::heightToBlock);
+      blocks = this->blocksDb_.multiGet(hashes, DBPrefix::blocks);
+      sidecars = this->blocksDb_.multiGet(hashes, DBPrefix::blockSidecars);
+    }
+    const Bytes& block = blocks[height - batchHeight];
+    const Bytes& sidecar = sidecars[height - batchHeight];
+    if (block.empty() || sidecar.empty() || FinalizedBlock::getFormat(block) != FinalizedBlock::formatV2) {
+      throw DynamicException("Block " + std::to_string(height) + " can't be moved to the block segments");
+    }
+    return BlockSegments::Record{block, sidecar};
+  });
+  this->stubColdBlocks(fromHeight, toHeight);
+}
+
+void Storage::stubColdBlocks(uint64_t fromHeight, uint64_t toHeight) {
+  std::vector<Bytes> heightKeys;
+  for (uint64_t i = fromHeight; i <= toHeight; i++) heightKeys.push_back(UintConv::uint64ToBytes(i));
+  const std::vector<Bytes> hashes = this->blocksDb_.multiGet(heightKeys, DBPrefix::heightToBlock);
+  DBBatch batch;
+  for (size_t i = 0; i < hashes.size(); i++) {
+    if (hashes[i].empty()) continue;
+    batch.push_back(hashes[i], UintConv::uint64ToBytes(fromHeight + i), DBPrefix::coldBlocks);
+    batch.delete_key(hashes[i], DBPrefix::blocks);
+    batch.delete_key(hashes[i], DBPrefix::blockSidecars);
+  }
+  batch.push_back(coldHeightKey_, UintConv::uint64ToBytes(toHeight), DBPrefix::metadata);
+  if (!this->blocksDb_.putBatch(batch)) throw DynamicException(
+    "Failed to remove blocks " + std::to_string(fromHeight) + " to " + std::to_string(toHeight) + " from the database"
+  );
+}
+
+void Storage::stubUnfinishedSegments() {
+  const Bytes coldHeight = this->blocksDb_.get(coldHeightKey_, DBPrefix::metadata);
+  const uint64_t fromHeight = coldHeight.empty() ? 0 : UintConv::bytesToUint64(coldHeight) + 1;
+  if (fromHeight < this->segments_.endHeight()) this->stubColdBlocks(fromHeight, this->segments_.endHeight() - 1);
+}
+
+uint64_t Storage::persistedHeight() const {
+  // Blocks are written in order, so the block before the oldest pending one is the latest written one
+  if (!this->pending_.empty()) return this->pending_.front().block->getNHeight() - 1;
+  return this->latest_.load()->getNHeight();
+}
+
+bool Storage::waitPersisted() const {
+  std::unique_lock lock(this->pendingMutex_);
+  this->persistedCv_.wait(lock, [this]() { return this->pending_.empty() || this->writeFailed_; });
+  return !this->writeFailed_;
+}
+
+bool Storage::waitDurable() const {
+  // Syncing is pointless if the blocks didn't make it to the database in the first place
+  if (!this->waitPersisted()) return false;
+  return this->blocksDb_.syncWAL();
 }
 
 void Storage::initializeBlockchain() {
@@ -115,8 +375,8 @@ void Storage::initializeBlockchain() {
   // Sanity check for genesis block. (check if genesis in DB matches genesis in Options)
   const Hash genesisInDBHash(blocksDb_.get(UintConv::uint64ToBytes(0), DBPrefix::heightToBlock));
 
-  FinalizedBlock genesisInDB = FinalizedBlock::fromBytes(
-    blocksDb_.get(genesisInDBHash, DBPrefix::blocks), options_.getChainID()
+  FinalizedBlock genesisInDB = FinalizedBlock::fromStorageBytes(
+    this->readBlock(genesisInDBHash).blockView(), options_.getChainID()
   );
 
   if (genesis != genesisInDB) {
@@ -125,51 +385,187 @@ void Storage::initializeBlockchain() {
   }
 }
 
-TxBlock Storage::getTxFromBlockWithIndex(View<Bytes> blockData, uint64_t txIndex) const {
-  uint64_t index = 217; // Start of block tx range
-  // Count txs until index.
-  uint64_t currentTx = 0;
-  while (currentTx < txIndex) {
-    uint32_t txSize = UintConv::bytesToUint32(blockData.subspan(index, 4));
-    index += txSize + 4;
-    currentTx++;
+Storage::StoredBlock Storage::readBlock(const Hash& hash) const {
+  StoredBlock ret{
+    this->blocksDb_.getPinned(hash, DBPrefix::blocks),
+    this->blocksDb_.getPinned(hash, DBPrefix::blockSidecars),
+    std::nullopt
+  };
+  // Blocks moved to the block segments leave their height behind
+  if (ret.block.empty()) {
+    if (const Bytes height = this->blocksDb_.get(hash, DBPrefix::coldBlocks); !height.empty()) {
+      ret.cold = this->segments_.get(UintConv::bytesToUint64(height));
+      if (!ret.cold) throw DynamicException("Block " + hash.hex().get() + " is missing from the block segments");
+    }
+  }
+  return ret;
+}
+
+std::shared_ptr<const FinalizedBlock> Storage::decodeBlock(View<Bytes> blockData, View<Bytes> sidecar) const {
+  // Blocks written before sidecars existed go through the full validation
+  if (sidecar.empty()) {
+    return std::make_shared<const FinalizedBlock>(FinalizedBlock::fromStorageBytes(blockData, this->options_.getChainID()));
   }
-  uint64_t txSize = UintConv::bytesToUint32(blockData.subspan(index, 4));
-  index += 4;
-  return TxBlock(blockData.subspan(index, txSize), this->options_.getChainID());
+  return std::make_shared<const FinalizedBlock>(
+    FinalizedBlock::fromTrustedBytes(blockData, sidecar, this->options_.getChainID())
+  );
+}
+
+TxBlock Storage::getTxFromBlockWithIndex(View<Bytes> blockData, View<Bytes> sidecar, uint64_t txIndex) const {
+  const View<Bytes> rawTx = FinalizedBlock::getRawTx(blockData, txIndex);
+  if (const uint64_t entry = 65 + txIndex * 52; entry + 52 <= sidecar.size()) {
+    return TxBlock(rawTx, Hash(sidecar.subspan(entry, 32)), Address(sidecar.subspan(entry + 32, 20)));
+  }
+  return TxBlock(rawTx, this->options_.getChainID());
 }
 
 void Storage::pushBlock(FinalizedBlock block) {
   if (auto previousBlock = latest_.load(); previousBlock->getHash() != block.getPrevBlockHash()) {
     throw DynamicException("\"previous hash\" of new block does not match the latest block hash");
   }
-  auto newBlock = std::make_shared<FinalizedBlock>(std::move(block));
+  auto newBlock = std::make_shared<const FinalizedBlock>(std::move(block));
+  // The newest blocks are the most requested ones, and they're already decoded
+  this->blockCache_.put(newBlock);
+  {
+    std::unique_lock lock(this->pendingMutex_);
+    // Don't let the writer fall too far behind, pending blocks are held in memory
+    this->persistedCv_.wait(lock, [this]() { return this->pending_.size() < maxPendingBlocks_; });
+    const auto& txs = newBlock->getTxs();
+    for (uint32_t i = 0; i < txs.size(); i++) this->pendingTxs_.emplace(txs[i].hash(), std::make_pair(newBlock, i));
+    for (const TxAdditionalData& data : this->staged_.txData) this->pendingTxData_.insert_or_assign(data.hash, data);
+    for (const auto& [txHash, callTrace] : this->staged_.callTraces) this->pendingCallTraces_.insert_or_assign(txHash, callTrace);
+    this->staged_.block = newBlock;
+    this->pending_.emplace_back(std::move(this->staged_));
+    this->staged_ = PendingBlock();
+  }
+  this->writerCv_.notify_one();
+  // Published only after the block can be found, so a reader that sees the new height can also get the block
   latest_.store(newBlock);
-  storeBlock(blocksDb_, *newBlock, options_.getIndexingMode() != IndexingMode::DISABLED);
 }
 
-bool Storage::blockExists(const Hash& hash) const { return blocksDb_.has(hash, DBPrefix::blocks); }
+bool Storage::blockExists(const Hash& hash) const {
+  {
+    std::lock_guard lock(this->pendingMutex_);
+    if (this->findPendingBlock([&](const FinalizedBlock& pending) { return pending.getHash() == hash; })) return true;
+  }
+  return blocksDb_.has(hash, DBPrefix::blocks) || blocksDb_.has(hash, DBPrefix::coldBlocks);
+}
 
-bool Storage::blockExists(uint64_t height) const { return blocksDb_.has(UintConv::uint64ToBytes(height), DBPrefix::heightToBlock); }
+bool Storage::blockExists(uint64_t height) const {
+  {
+    std::lock_guard lock(this->pendingMutex_);
+    if (this->findPendingBlock([&](const FinalizedBlock& pending) { return pending.getNHeight() == height; })) return true;
+  }
+  return blocksDb_.has(UintConv::uint64ToBytes(height), DBPrefix::heightToBlock);
+}
 
-bool Storage::txExists(const Hash& tx) const { return blocksDb_.has(tx, DBPrefix::txToBlock); }
+bool Storage::txExists(const Hash& tx) const {
+  {
+    std::lock_guard lock(this->pendingMutex_);
+    if (this->pendingTxs_.contains(tx)) return true;
+  }
+  return blocksDb_.has(tx, DBPrefix::txToBlock);
+}
 
 std::shared_ptr<const FinalizedBlock> Storage::getBlock(const Hash& hash) const {
-  Bytes blockBytes = blocksDb_.get(hash, DBPrefix::blocks);
+  {
+    std::lock_guard lock(this->pendingMutex_);
+    auto block = this->findPendingBlock([&](const FinalizedBlock& pending) { return pending.getHash() == hash; });
+    if (block != nullptr) return block;
+  }
+  if (auto block = this->blockCache_.get(hash); block != nullptr) return block;
+  const StoredBlock blockBytes = this->readBlock(hash);
   if (blockBytes.empty()) return nullptr;
-  return std::make_shared<FinalizedBlock>(FinalizedBlock::fromBytes(blockBytes, this->options_.getChainID()));
+  auto block = this->decodeBlock(blockBytes.blockView(), blockBytes.sidecarView());
+  this->blockCache_.put(block);
+  return block;
 }
 
 std::shared_ptr<const FinalizedBlock> Storage::getBlock(uint64_t height) const {
+  {
+    std::lock_guard lock(this->pendingMutex_);
+    auto block = this->findPendingBlock([&](const FinalizedBlock& pending) { return pending.getNHeight() == height; });
+    if (block != nullptr) return block;
+  }
+  if (auto block = this->blockCache_.get(height); block != nullptr) return block;
+  // Old blocks are found by height in the block segments, without going through the database
+  if (const auto cold = this->segments_.get(height)) {
+    auto block = this->decodeBlock(cold->block, cold->sidecar);
+    this->blockCache_.put(block);
+    return block;
+  }
   Bytes blockHash = blocksDb_.get(UintConv::uint64ToBytes(height), DBPrefix::heightToBlock);
   if (blockHash.empty()) return nullptr;
-  Bytes blockBytes = blocksDb_.get(blockHash, DBPrefix::blocks);
-  return std::make_shared<FinalizedBlock>(FinalizedBlock::fromBytes(blockBytes, this->options_.getChainID()));
+  const StoredBlock blockBytes = this->readBlock(Hash(blockHash));
+  if (blockBytes.empty()) return nullptr;
+  auto block = this->decodeBlock(blockBytes.blockView(), blockBytes.sidecarView());
+  this->blockCache_.put(block);
+  return block;
+}
+
+std::vector<std::shared_ptr<const FinalizedBlock>> Storage::getBlocks(uint64_t fromHeight, uint64_t toHeight) const {
+  std::vector<std::shared_ptr<const FinalizedBlock>> ret;
+  if (toHeight < fromHeight) return ret;
+  const uint64_t count = toHeight - fromHeight + 1;
+  ret.resize(count);
+  // Pending blocks are checked first: they're only dropped from there once written,
+  // so any block that isn't pending by now can already be found in the database
+  {
+    std::lock_guard lock(this->pendingMutex_);
+    for (const PendingBlock& pending : this->pending_) {
+      const uint64_t height = pending.block->getNHeight();
+      if (height >= fromHeight && height <= toHeight) ret[height - fromHeight] = pending.block;
+    }
+  }
+  std::vector<uint64_t> missing;
+  std::vector<Bytes> heightKeys;
+  for (uint64_t i = 0; i < count; i++) {
+    if (ret[i] == nullptr) ret[i] = this->blockCache_.get(fromHeight + i);
+    if (ret[i] != nullptr) continue;
+    if (const auto cold = this->segments_.get(fromHeight + i)) {
+      ret[i] = this->decodeBlock(cold->block, cold->sidecar);
+      this->blockCache_.put(ret[i]);
+      continue;
+    }
+    missing.push_back(i);
+    heightKeys.push_back(UintConv::uint64ToBytes(fromHeight + i));
+  }
+  if (!missing.empty()) {
+    const std::vector<Bytes> hashes = blocksDb_.multiGet(heightKeys, DBPrefix::heightToBlock);
+    const std::vector<Bytes> blocks = blocksDb_.multiGet(hashes, DBPrefix::blocks);
+    const std::vector<Bytes> sidecars = blocksDb_.multiGet(hashes, DBPrefix::blockSidecars);
+    for (size_t i = 0; i < missing.size(); i++) {
+      if (hashes[i].empty()) continue;
+      if (blocks[i].empty()) {
+        // Moved to the block segments after they were checked
+        const auto cold = this->segments_.get(fromHeight + missing[i]);
+        if (!cold) continue;
+        ret[missing[i]] = this->decodeBlock(cold->block, cold->sidecar);
+      } else {
+        ret[missing[i]] = this->decodeBlock(blocks[i], sidecars[i]);
+      }
+      this->blockCache_.put(ret[missing[i]]);
+    }
+  }
+  // Only the blocks before the first missing one are returned
+  const auto firstMissing = std::ranges::find(ret, nullptr);
+  ret.erase(firstMissing, ret.end());
+  return ret;
 }
 
 std::tuple<
   const std::shared_ptr<const TxBlock>, const Hash, const uint64_t, const uint64_t
 > Storage::getTx(const Hash& tx) const {
+  {
+    std::lock_guard lock(this->pendingMutex_);
+    if (auto it = this->pendingTxs_.find(tx); it != this->pendingTxs_.end()) {
+      const auto& [block, blockIndex] = it->second;
+      return std::make_tuple(
+        std::make_shared<const TxBlock>(block->getTxs()[blockIndex]),
+        block->getHash(), uint64_t(blockIndex), block->getNHeight()
+      );
+    }
+  }
   const Bytes txData = blocksDb_.get(tx, DBPrefix::txToBlock);
   if (txData.empty()) return std::make_tuple(nullptr, Hash(), 0u, 0u);
 
@@ -177,10 +573,15 @@ std::tuple<
   const Hash blockHash(txDataView.subspan(0, 32));
   const uint64_t blockIndex = UintConv::bytesToUint32(txDataView.subspan(32, 4));
   const uint64_t blockHeight = UintConv::bytesToUint64(txDataView.subspan(36, 8));
-  const Bytes blockData = blocksDb_.get(blockHash, DBPrefix::blocks);
+  if (auto block = this->blockCache_.get(blockHash); block != nullptr) {
+    return std::make_tuple(
+      std::make_shared<const TxBlock>(block->getTxs()[blockIndex]), blockHash, blockIndex, blockHeight
+    );
+  }
+  const StoredBlock blockData = this->readBlock(blockHash);
 
   return std::make_tuple(
-    std::make_shared<const TxBlock>(getTxFromBlockWithIndex(blockData, blockIndex)),
+    std::make_shared<const TxBlock>(getTxFromBlockWithIndex(blockData.blockView(), blockData.sidecarView(), blockIndex)),
     blockHash, blockIndex, blockHeight
   );
 }
@@ -188,12 +589,28 @@ std::tuple<
 std::tuple<
   const std::shared_ptr<const TxBlock>, const Hash, const uint64_t, const uint64_t
 > Storage::getTxByBlockHashAndIndex(const Hash& blockHash, const uint64_t blockIndex) const {
-  const Bytes blockData = blocksDb_.get(blockHash, DBPrefix::blocks);
-  if (blockData.empty()) std::make_tuple(nullptr, Hash(), 0u, 0u);
+  {
+    std::lock_guard lock(this->pendingMutex_);
+    auto block = this->findPendingBlock([&](const FinalizedBlock& pending) { return pending.getHash() == blockHash; });
+    if (block != nullptr) {
+      if (blockIndex >= block->getTxs().size()) return std::make_tuple(nullptr, Hash(), 0u, 0u);
+      return std::make_tuple(
+        std::make_shared<const TxBlock>(block->getTxs()[blockIndex]), blockHash, blockIndex, block->getNHeight()
+      );
+    }
+  }
+  if (auto block = this->blockCache_.get(blockHash); block != nullptr) {
+    if (blockIndex >= block->getTxs().size()) return std::make_tuple(nullptr, Hash(), 0u, 0u);
+    return std::make_tuple(
+      std::make_shared<const TxBlock>(block->getTxs()[blockIndex]), blockHash, blockIndex, block->getNHeight()
+    );
+  }
+  const StoredBlock blockData = this->readBlock(blockHash);
+  if (blockData.empty()) return std::make_tuple(nullptr, Hash(), 0u, 0u);
 
-  const uint64_t blockHeight = UintConv::bytesToUint64(View<Bytes>(blockData).subspan(201, 8));
+  const uint64_t blockHeight = UintConv::bytesToUint64(blockData.blockView().subspan(201, 8));
   return std::make_tuple(
-    std::make_shared<TxBlock>(getTxFromBlockWithIndex(blockData, blockIndex)),
+    std::make_shared<TxBlock>(getTxFromBlockWithIndex(blockData.blockView(), blockData.sidecarView(), blockIndex)),
     blockHash, blockIndex, blockHeight
   );
 }
@@ -201,14 +618,30 @@ std::tuple<
 std::tuple<
   const std::shared_ptr<const TxBlock>, const Hash, const uint64_t, const uint64_t
 > Storage::getTxByBlockNumberAndIndex(uint64_t blockHeight, uint64_t blockIndex) const {
+  {
+    std::lock_guard lock(this->pendingMutex_);
+    auto block = this->findPendingBlock([&](const FinalizedBlock& pending) { return pending.getNHeight() == blockHeight; });
+    if (block != nullptr) {
+      if (blockIndex >= block->getTxs().size()) return std::make_tuple(nullptr, Hash(), 0u, 0u);
+      return std::make_tuple(
+        std::make_shared<const TxBlock>(block->getTxs()[blockIndex]), block->getHash(), blockIndex, blockHeight
+      );
+    }
+  }
+  if (auto block = this->blockCache_.get(blockHeight); block != nullptr) {
+    if (blockIndex >= block->getTxs().size()) return std::make_tuple(nullptr, Hash(), 0u, 0u);
+    return std::make_tuple(
+      std::make_shared<const TxBlock>(block->getTxs()[blockIndex]), block->getHash(), blockIndex, blockHeight
+    );
+  }
   const Bytes blockHash = blocksDb_.get(UintConv::uint64ToBytes(blockHeight), DBPrefix::heightToBlock);
   if (blockHash.empty()) return std::make_tuple(nullptr, Hash(), 0u, 0u);
 
-  const Bytes blockData = blocksDb_.get(blockHash, DBPrefix::blocks);
+  const StoredBlock blockData = this->readBlock(Hash(blockHash));
   if (blockData.empty()) return std::make_tuple(nullptr, Hash(), 0u, 0u);
 
   return std::make_tuple(
-    std::make_shared<TxBlock>(getTxFromBlockWithIndex(blockData, blockIndex)),
+    std::make_shared<TxBlock>(getTxFromBlockWithIndex(blockData.blockView(), blockData.sidecarView(), blockIndex)),
     Hash(blockHash), blockIndex, blockHeight
   );
 }
@@ -221,13 +654,15 @@ uint64_t Storage::currentChainSize() const {
 }
 
 void Storage::putCallTrace(const Hash& txHash, const trace::Call& callTrace) {
-  Bytes serial;
-  zpp::bits::out out(serial);
-  out(callTrace).or_throw();
-  blocksDb_.put(txHash, serial, DBPrefix::txToCallTrace);
+  std::lock_guard lock(this->pendingMutex_);
+  this->staged_.callTraces.emplace_back(txHash, callTrace);
 }
 
 std::optional<trace::Call> Storage::getCallTrace(const Hash& txHash) const {
+  {
+    std::lock_guard lock(this->pendingMutex_);
+    if (auto it = this->pendingCallTraces_.find(txHash); it != this->pendingCallTraces_.end()) return it->second;
+  }
   Bytes serial = blocksDb_.get(txHash, DBPrefix::txToCallTrace);
   if (serial.empty()) return std::nullopt;
 
@@ -238,14 +673,44 @@ std::optional<trace::Call> Storage::getCallTrace(const Hash& txHash) const {
   return callTrace;
 }
 
+std::vector<std::optional<trace::Call>> Storage::getCallTraces(std::span<const Hash> txHashes) const {
+  std::vector<std::optional<trace::Call>> ret(txHashes.size());
+  std::vector<size_t> missing;
+  {
+    std::lock_guard lock(this->pendingMutex_);
+    for (size_t i = 0; i < txHashes.size(); i++) {
+      if (auto it = this->pendingCallTraces_.find(txHashes[i]); it != this->pendingCallTraces_.end()) {
+        ret[i] = it->second;
+      } else {
+        missing.push_back(i);
+      }
+    }
+  }
+  if (missing.empty()) return ret;
+  std::vector<Hash> keys;
+  keys.reserve(missing.size());
+  for (size_t i : missing) keys.push_back(txHashes[i]);
+  const std::vector<Bytes> serials = blocksDb_.multiGet(keys, DBPrefix::txToCallTrace);
+  for (size_t i = 0; i < missing.size(); i++) {
+    if (serials[i].empty()) continue;
+    trace::Call callTrace;
+    zpp::bits::in in(serials[i]);
+    in(callTrace).or_throw();
+    ret[missing[i]] = std::move(callTrace);
+  }
+  return ret;
+}
+
 void Storage::putTxAdditionalData(const TxAdditionalData& txData) {
-  Bytes serialized;
-  zpp::bits::out out(serialized);
-  out(txData).or_throw();
-  blocksDb_.put(txData.hash, serialized, DBPrefix::txToAdditionalData);
+  std::lock_guard lock(this->pendingMutex_);
+  this->staged_.txData.emplace_back(txData);
 }
 
 std::optional<TxAdditionalData> Storage::getTxAdditionalData(const Hash& txHash) const {
+  {
+    std::lock_guard lock(this->pendingMutex_);
+    if (auto it = this->pendingTxData_.find(txHash); it != this->pendingTxData_.end()) return it->second;
+  }
   Bytes serialized = blocksDb_.get(txHash, DBPrefix::txToAdditionalData);
   if (serialized.empty()) return std::nullopt;
 
@@ -255,6 +720,21 @@ std::optional<TxAdditionalData> Storage::getTxAdditionalData(const Hash& txHash)
   return txData;
 }
 
+void Storage::putEvents(const std::vector<Event>& events) {
+  std::lock_guard lock(this->pendingMutex_);
+  this->staged_.events.insert(this->staged_.events.end(), events.begin(), events.end());
+}
+
+EventsDB& Storage::events() {
+  if (!this->waitPersisted()) throw DynamicException("Failed to write the latest blocks, their events are unavailable");
+  return this->eventsDb_;
+}
+
+const EventsDB& Storage::events() const {
+  if (!this->waitPersisted()) throw DynamicException("Failed to write the latest blocks, their events are unavailable");
+  return this->eventsDb_;
+}
+
 std::vector<Event> Storage::getEventsLegacy(const DB& legacyEventsDB, uint64_t fromBlock, uint64_t toBlock, const Address& address, const std::vector<Hash>& topics) const {
   if (toBlock < fromBlock) std::swap(fromBlock, toBlock);
 
@@ -8,6 +8,12 @@ See the LICENSE.txt file in the project root for more information.
 #ifndef STORAGE_H
 #define STORAGE_H
 
+#include <condition_variable>
+#include <deque>
+
+#include "blockcache.h"
+#include "blocksegments.h"
+
 #include "../utils/db.h"
 #include "../utils/eventsdb.h"
 #include "../utils/randomgen.h" // utils.h
@@ -21,24 +27,180 @@ See the LICENSE.txt file in the project root for more information.
  * Abstraction of the blockchain history.
  * Used to store blocks in memory and on disk, and helps the State process
  * new blocks, transactions and RPC queries.
+ * New blocks are published to readers right away and written to disk by a background writer,
+ * so the node can execute and broadcast the next block while the previous one is persisted.
+ * Until then, reads are answered from memory, so readers never tell the difference.
+ * Blocks deep enough in the chain (see Options::getColdBlockDepth()) are moved out of the
+ * database into append-only block segments (see BlockSegments), so compactions stop
+ * rewriting them. Reads find blocks in either place.
  */
 class Storage : public Log::LogicalLocationProvider {
   // TODO: possibly replace `std::shared_ptr<const Block>` with a better solution.
   private:
+    /// A block published to readers but not written to the database yet, along with the data of its transactions.
+    struct PendingBlock {
+      std::shared_ptr<const FinalizedBlock> block; ///< The block.
+      std::vector<TxAdditionalData> txData; ///< Additional data of the block's transactions.
+      std::vector<std::pair<Hash, trace::Call>> callTraces; ///< Call traces of the block's transactions.
+      std::vector<Event> events; ///< Events emitted by the block's transactions.
+    };
+
+    /// The bytes of a stored block, read from the database or from the block segments.
+    struct StoredBlock {
+      DBPinnedValue block; ///< The block, if the block is in the database.
+      DBPinnedValue sidecar; ///< The block's sidecar, if the block is in the database.
+      std::optional<BlockSegments::Record> cold; ///< The block and its sidecar, if the block is in the block segments.
+
+      /// Check if the block was not found.
+      bool empty() const { return !this->cold && this->block.empty(); }
+
+      /// Get a view of the block.
+      View<Bytes> blockView() const { return this->cold ? this->cold->block : this->block.view(); }
+
+      /// Get a view of the block's sidecar.
+      View<Bytes> sidecarView() const { return this->cold ? this->cold->sidecar : this->sidecar.view(); }
+    };
+
     std::atomic<std::shared_ptr<const FinalizedBlock>> latest_; ///< Pointer to the latest block in the blockchain.
     DB blocksDb_;  ///< Database object that contains all the blockchain blocks
+    BlockSegments segments_; ///< Blocks moved out of the database, oldest first.
     EventsDB eventsDb_; ///< DB exclusive to events
     const Options& options_;  ///< Reference to the options singleton.
+    const uint64_t coldBlockDepth_; ///< How deep in the chain blocks are moved to the segments (see Options::getColdBlockDepth()).
     const std::string instanceIdStr_; ///< Identifier for logging
+    mutable BlockCache blockCache_; ///< Recently used blocks, already decoded.
+
+    mutable std::mutex pendingMutex_; ///< Mutex for managing access to the pending blocks and staged data.
+    std::condition_variable writerCv_; ///< Wakes up the writer when a block is published or the writer has to stop.
+    mutable std::condition_variable persistedCv_; ///< Wakes up threads waiting for pending blocks to be written.
+    std::deque<PendingBlock> pending_; ///< Published blocks not written to the database yet, oldest first.
+    boost::unordered_flat_map<Hash, std::pair<std::shared_ptr<const FinalizedBlock>, uint32_t>, SafeHash, SafeCompare> pendingTxs_; ///< Transactions of the pending blocks (tx hash -> block, index).
+    boost::unordered_flat_map<Hash, TxAdditionalData, SafeHash, SafeCompare> pendingTxData_; ///< Additional data of the pending blocks' transactions.
+    boost::unordered_flat_map<Hash, trace::Call, SafeHash, SafeCompare> pendingCallTraces_; ///< Call traces of the pending blocks' transactions.
+    PendingBlock staged_; ///< Data of the transactions being executed, published along with their block.
+    bool stopWriter_ = false; ///< Flag for stopping the writer once every pending block is written.
+    bool writeFailed_ = false; ///< Whether the last write of pending blocks failed (the writer keeps retrying it).
+    std::future<void> writerFuture_; ///< Future object holding the thread for the writer loop.
+    std::atomic<bool> stopArchiver_ = false; ///< Flag for stopping the archiver.
+    std::future<void> archiverFuture_; ///< Future object holding the thread for the archiver.
+
+    /// Maximum number of pending blocks. Publishing blocks blocks while the writer is this far behind.
+    static constexpr size_t maxPendingBlocks_ = 64;
+
+    /// Time the writer waits before retrying a failed write.
+    static constexpr std::chrono::milliseconds writeRetryDelay_{1000};
+
+    /// Number of blocks the archiver reads or rewrites in each database operation.
+    static constexpr uint64_t archiverBatchBlocks_ = 256;
+
+    /// Time the archiver waits before retrying a failed conversion or move.
+    static constexpr std::chrono::seconds archiverRetryDelay_{10};
+
+    /// Key (under DBPrefix::metadata) of the height up to which every block is stored in the v2 format.
+    static inline const Bytes convertedHeightKey_ = DB::keyFromStr("convertedHeight");
+
+    /// Key (under DBPrefix::metadata) of the height up to which every block was moved to the block segments.
+    static inline const Bytes coldHeightKey_ = DB::keyFromStr("coldHeight");
 
     void initializeBlockchain(); ///< Initialize the blockchain.
 
+    /// Writes pending blocks to the database, in order, until stopped. Failed writes are retried.
+    void writerLoop();
+
+    /**
+     * Rewrite the blocks stored in the v1 format in the v2 format (see FinalizedBlock::serializeBlockV2()),
+     * along with their sidecars, oldest first and in batches, until done or stopped.
+     * Progress is saved with each batch, so a restart resumes where it stopped.
+     * Readers support both formats, so they see no difference while blocks are being converted.
+     * Blocks stored without a sidecar go through the full validation (signatures included) once more
+     * to build it, so on a node upgraded with a long chain this costs about as much CPU as syncing
+     * the chain again, spread over the archiver's batches in the background.
+     * @param toHeight Height of the last block to convert. Later blocks are already written in the v2 format.
+     * @return `true` if every block up to `toHeight` is converted, `false` if stopped or failed.
+     */
+    bool convertBlocks(uint64_t toHeight);
+
+    /**
+     * Background maintenance of the stored blocks, until stopped. Converts the blocks to the v2
+     * format (see convertBlocks()), then, if enabled, moves every segment's worth of blocks
+     * that is deep enough in the chain to the block segments (see moveToSegments()).
+     * Failed steps are retried after a while (see archiverRetryDelay_), the archiver never gives up.
+     * @param convertToHeight Height of the last block to convert.
+     */
+    void archiverLoop(uint64_t convertToHeight);
+
+    /**
+     * Move the next segment's worth of blocks (see BlockSegments::endHeight()) from the database
+     * to the block segments. Blocks must be written to the database and in the v2 format.
+     * @throw DynamicException if a block is missing or the segment can't be written.
+     */
+    void moveToSegments();
+
+    /**
+     * Remove the database entries of blocks already in the block segments, indexing their heights
+     * by hash instead (in DBPrefix::coldBlocks), so blocks can still be found by hash.
+     * @param fromHeight Height of the first block.
+     * @param toHeight Height of the last block.
+     */
+    void stubColdBlocks(uint64_t fromHeight, uint64_t toHeight);
+
+    /**
+     * Stub the blocks of the segments that were written while their blocks are still in the database
+     * (see stubColdBlocks()), which happens if the node stops or the database write fails right after
+     * a segment is written.
+     * @throw DynamicException if writing to the database fails.
+     */
+    void stubUnfinishedSegments();
+
+    /**
+     * Get the height of the latest block written to the database. Must be called with pendingMutex_ locked.
+     * @return The height.
+     */
+    uint64_t persistedHeight() const;
+
+    /**
+     * Read a stored block from either the database or the block segments.
+     * @param hash The block's hash.
+     * @return The block's bytes, empty if the block is not stored.
+     * @throw DynamicException if the block was moved to missing or corrupted block segments.
+     */
+    StoredBlock readBlock(const Hash& hash) const;
+
+    /**
+     * Find a pending block. Must be called with pendingMutex_ locked.
+     * @param pred Condition the block must meet.
+     * @return A pointer to the block, or `nullptr` if no pending block meets the condition.
+     */
+    template <typename Pred> std::shared_ptr<const FinalizedBlock> findPendingBlock(Pred&& pred) const {
+      for (const PendingBlock& pending : this->pending_) if (pred(*pending.block)) return pending.block;
+      return nullptr;
+    }
+
+    /**
+     * Add the database entries of a block to a batch.
+     * @param batch The batch to add the entries to.
+     * @param block The block to store.
+     * @param indexingEnabled Whether the node has indexing enabled or not.
+     */
+    static void appendBlock(DBBatch& batch, const FinalizedBlock& block, bool indexingEnabled);
+
     /**
      * Get a transaction from a block based on a given transaction index.
-     * @param blockData The raw block string.
+     * @param blockData The raw block string, in either format.
+     * @param sidecar The block's sidecar (see FinalizedBlock::serializeSidecar()),
+     *                empty if the block was stored without one.
      * @param txIndex The index of the transaction to get.
      */
-    TxBlock getTxFromBlockWithIndex(View<Bytes> blockData, uint64_t txIndex) const;
+    TxBlock getTxFromBlockWithIndex(View<Bytes> blockData, View<Bytes> sidecar, uint64_t txIndex) const;
+
+    /**
+     * Decode a block read from the database. Blocks are validated before being stored,
+     * so blocks stored with a sidecar skip the cryptography (see FinalizedBlock::fromTrustedBytes()).
+     * @param blockData The raw block string.
+     * @param sidecar The block's sidecar, empty if the block was stored without one.
+     * @return The decoded block.
+     */
+    std::shared_ptr<const FinalizedBlock> decodeBlock(View<Bytes> blockData, View<Bytes> sidecar) const;
 
   public:
     /**
@@ -49,12 +211,40 @@ class Storage : public Log::LogicalLocationProvider {
      */
     Storage(std::string instanceIdStr, const Options& options);
 
+    /// Destructor. Writes every pending block before returning, giving up on them if the write keeps failing.
+    ~Storage();
+
     /// Log instance (provided in ctor).
     std::string getLogicalLocation() const override { return instanceIdStr_; }
 
-    /// Wrapper for `pushBackInternal()`. Use this as it properly locks `chainLock_`.
+    /**
+     * Append a block to the chain. The block becomes the latest one and is visible to
+     * every read right away, and is written to the database in the background along with
+     * the data staged by its transactions (see putTxAdditionalData(), putCallTrace() and putEvents()).
+     * @param block The block to append.
+     * @throw DynamicException if the block doesn't follow the latest block.
+     */
     void pushBlock(FinalizedBlock block);
 
+    /**
+     * Block until every published block, and the data of its transactions, is written to the database.
+     * @return `true` if every block is written, `false` if writing them failed (the writer keeps retrying).
+     */
+    bool waitPersisted() const;
+
+    /**
+     * Block until every published block is written to the database, then sync the database's
+     * write-ahead log so the blocks survive an OS crash or power loss, not just a process crash.
+     * @return `true` if every block is written and synced, `false` if writing or syncing them failed.
+     */
+    bool waitDurable() const;
+
+    /// Get the height after the last block moved to the block segments (see Options::getColdBlockDepth()).
+    uint64_t getSegmentsEndHeight() const { return this->segments_.endHeight(); }
+
+    /// Get the cache of decoded blocks, e.g. to check its hit and miss counters.
+    const BlockCache& getBlockCache() const { return this->blockCache_; }
+
     /**
      * Check if a block exists anywhere in storage (memory/chain, then cache, then database).
      * Locks `chainLock_` and `cacheLock_`, to be used by external actors.
@@ -84,6 +274,14 @@ class Storage : public Log::LogicalLocationProvider {
      */
     std::shared_ptr<const FinalizedBlock> getBlock(uint64_t height) const;
 
+    /**
+     * Get a range of blocks from the chain, with batched database lookups.
+     * @param fromHeight The height of the first block to get.
+     * @param toHeight The height of the last block to get (inclusive).
+     * @return The blocks in order, up to (and excluding) the first one that is not found.
+     */
+    std::vector<std::shared_ptr<const FinalizedBlock>> getBlocks(uint64_t fromHeight, uint64_t toHeight) const;
+
     /**
      * Check if a transaction exists anywhere in storage (memory/chain, then cache, then database).
      * @param tx The transaction to check.
@@ -129,7 +327,8 @@ class Storage : public Log::LogicalLocationProvider {
     uint64_t currentChainSize() const;
 
     /**
-     * Stores additional transaction data
+     * Stores additional transaction data.
+     * Staged until the block holding the transaction is pushed.
      * @param txData The additional transaction data
      */
     void putTxAdditionalData(const TxAdditionalData& txData);
@@ -143,6 +342,7 @@ class Storage : public Log::LogicalLocationProvider {
 
     /**
      * Store a transaction call trace.
+     * Staged until the block holding the transaction is pushed.
      * @param txHash The transaction hash.
      * @param callTrace The call trace of the transaction.
      */
@@ -155,6 +355,13 @@ class Storage : public Log::LogicalLocationProvider {
      */
     std::optional<trace::Call> getCallTrace(const Hash& txHash) const;
 
+    /**
+     * Retrieve the stored call traces of several transactions, with batched database lookups.
+     * @param txHashes The target transaction hashes.
+     * @return The call traces, in the same order as the hashes, each empty if not existent.
+     */
+    std::vector<std::optional<trace::Call>> getCallTraces(std::span<const Hash> txHashes) const;
+
     
     /**
      * Reindex transactions to the DB
@@ -164,9 +371,21 @@ class Storage : public Log::LogicalLocationProvider {
     
     void dumpToDisk(DBBatch& batch);
 
-    EventsDB& events() { return eventsDb_; }
+    /**
+     * Store the events emitted by a transaction.
+     * Staged until the block holding the transaction is pushed.
+     * @param events The events to store.
+     */
+    void putEvents(const std::vector<Event>& events);
 
-    const EventsDB& events() const { return eventsDb_; }
+    ///@{
+    /**
+     * Get the events database. Waits for pending blocks to be written first, so queries see the events of every published block.
+     * @throw DynamicException if writing the pending blocks failed, as their events would be missing.
+     */
+    EventsDB& events();
+    const EventsDB& events() const;
+    ///@}
 
     std::vector<Event> getEventsLegacy(const DB& legacyEventsDB, uint64_t fromBlock, uint64_t toBlock, const Address& address, const std::vector<Hash>& topics) const;
 
@@ -367,6 +367,12 @@ json eth_sendRawTransaction(const json& request, uint64_t chainId, State& state,
       case TxStatus::InvalidBalance:
         message = "Invalid balance";
         break;
+      case TxStatus::InvalidUnderpriced:
+        message = "Transaction underpriced";
+        break;
+      case TxStatus::InvalidPoolLimit:
+        message = "Transaction pool limit reached";
+        break;
     }
     throw Error(-32000, std::move(message));
   }
@@ -487,18 +493,19 @@ json eth_getUncleByBlockHashAndIndex() {
 
 json txpool_content(const json& request, const State& state) {
   forbidParams(request);
-  json result;
-  result["queued"] = json::array();
-  json& pending = result["pending"];
-
-  pending = json::array();
-
-  for (const auto& [hash, tx] : state.getPendingTxs()) {
-    json accountJson;
-    accountJson[tx.getFrom().hex(true)][tx.getNonce().str()] = getEIP1559TransactionJson(tx, nullptr, nullptr, nullptr);
-    pending.push_back(std::move(accountJson));
-  }
+  const auto toJson = [](const std::vector<TxBlock>& txs) {
+    json txsJson = json::array();
+    for (const auto& tx : txs) {
+      json accountJson;
+      accountJson[tx.getFrom().hex(true)][tx.getNonce().str()] = getEIP1559TransactionJson(tx, nullptr, nullptr, nullptr);
+      txsJson.push_back(std::move(accountJson));
+    }
+    return txsJson;
+  };
 
+  json result;
+  result["pending"] = toJson(state.getPendingTxs());
+  result["queued"] = toJson(state.getQueuedTxs());
   return result;
 }
 
@@ -519,15 +526,20 @@ json debug_traceBlockByNumber(const json& request, const Storage& storage) {
   if (!block)
     throw Error(-32000, std::string("block ") + std::to_string(blockNumber) + " not found");
 
-  for (const auto& tx : block->getTxs()) {
+  std::vector<Hash> txHashes;
+  txHashes.reserve(block->getTxs().size());
+  for (const auto& tx : block->getTxs()) txHashes.push_back(tx.hash());
+  const auto callTraces = storage.getCallTraces(txHashes);
+
+  for (size_t i = 0; i < txHashes.size(); i++) {
     json txTrace;
 
-    auto callTrace = storage.getCallTrace(tx.hash());
+    const auto& callTrace = callTraces[i];
 
     if (!callTrace)
       continue;
 
-    txTrace["txHash"] = tx.hash().hex(true);
+    txTrace["txHash"] = txHashes[i].hex(true);
     txTrace["result"] = callTrace->toJson();
 
     res.push_back(std::move(txTrace));
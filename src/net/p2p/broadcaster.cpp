@@ -9,6 +9,7 @@ See the LICENSE.txt file in the project root for more information.
 #include "managernormal.h"
 
 #include "../../core/blockchain.h"
+#include "../../utils/txdecoder.h"
 
 namespace P2P {
 
@@ -36,6 +37,18 @@ namespace P2P {
     const NodeID &nodeId, const std::shared_ptr<const Message>& message
   ) {
     try {
+      // Only the message is checked here, the transaction itself is decoded by the decoder thread
+      BroadcastDecoder::broadcastTxBytes(*message);
+      {
+        std::unique_lock lock(this->txBatchMutex_);
+        if (this->txBatch_.size() < maxBatchedTxs_) {
+          this->txBatch_.emplace_back(nodeId, message);
+          lock.unlock();
+          this->txBatchCv_.notify_one();
+          return;
+        }
+      }
+      // Batch is full, so hold back this connection by decoding its transaction right here
       auto tx = BroadcastDecoder::broadcastTx(*message, getOptions().getChainID());
       // Rebroadcast only when the transaction was relevant to this node, i.e. absorbed into our data model.
       if (this->state_.addTx(std::move(tx)) == TxStatus::ValidNew) {
@@ -46,6 +59,64 @@ namespace P2P {
     }
   }
 
+  void Broadcaster::decoderLoop() {
+    const uint64_t chainId = getOptions().getChainID();
+    while (true) {
+      std::vector<std::pair<NodeID, std::shared_ptr<const Message>>> batch;
+      {
+        std::unique_lock lock(this->txBatchMutex_);
+        this->txBatchCv_.wait(lock, [this]() { return this->stopDecoder_ || !this->txBatch_.empty(); });
+        if (this->stopDecoder_) return;
+        batch.swap(this->txBatch_);
+      }
+      try {
+        std::vector<View<Bytes>> rawTxs;
+        rawTxs.reserve(batch.size());
+        for (const auto& [nodeId, message] : batch) rawTxs.emplace_back(message->message());
+        std::vector<std::optional<TxBlock>> txs = TxDecoder::shared().decode(rawTxs, chainId);
+        for (size_t i = 0; i < batch.size(); ++i) {
+          const auto& [nodeId, message] = batch[i];
+          if (!txs[i]) {
+            SLOGDEBUG("Closing session to " + toString(nodeId) + ": invalid txBroadcast");
+            this->manager_.disconnectSession(nodeId);
+            continue;
+          }
+          try {
+            // Rebroadcast only when the transaction was relevant to this node, i.e. absorbed into our data model.
+            if (this->state_.addTx(std::move(*txs[i])) == TxStatus::ValidNew) {
+              this->broadcastMessage(message, nodeId);
+            }
+          } catch (std::exception const& ex) {
+            SLOGERROR("Failed to add broadcast transaction: " + std::string(ex.what()));
+          }
+        }
+      } catch (std::exception const& ex) {
+        SLOGERROR("Failed to decode broadcast transactions: " + std::string(ex.what()));
+      }
+    }
+  }
+
+  void Broadcaster::start() {
+    if (this->decoderFuture_.valid()) return;
+    {
+      std::lock_guard lock(this->txBatchMutex_);
+      this->stopDecoder_ = false;
+    }
+    this->decoderFuture_ = std::async(std::launch::async, &Broadcaster::decoderLoop, this);
+  }
+
+  void Broadcaster::stop() {
+    if (!this->decoderFuture_.valid()) return;
+    {
+      std::lock_guard lock(this->txBatchMutex_);
+      this->stopDecoder_ = true;
+      this->txBatch_.clear();
+    }
+    this->txBatchCv_.notify_all();
+    this->decoderFuture_.wait();
+    this->decoderFuture_.get();
+  }
+
   void Broadcaster::handleBlockBroadcast(
     const NodeID &nodeId, const std::shared_ptr<const Message>& message
   ) {
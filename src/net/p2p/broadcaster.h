@@ -8,6 +8,9 @@ See the LICENSE.txt file in the project root for more information.
 #ifndef BROADCASTER_H
 #define BROADCASTER_H
 
+#include <condition_variable>
+#include <future>
+
 #include "encoding.h" // NodeID, NodeInfo, utils/safehash.h
 
 // Forward declarations.
@@ -30,6 +33,14 @@ namespace P2P {
       ManagerNormal& manager_; ///< Reference to the P2P engine object that owns this.
       const Storage& storage_; ///< Reference to the blockchain's storage.
       State& state_; ///< Reference to the blockchain's state.
+      std::mutex txBatchMutex_; ///< Mutex for managing access to the transaction batch.
+      std::condition_variable txBatchCv_; ///< Wakes up the decoder when broadcasts are batched or it has to stop.
+      std::vector<std::pair<NodeID, std::shared_ptr<const Message>>> txBatch_; ///< Transaction broadcasts waiting to be decoded, with their senders.
+      bool stopDecoder_ = false; ///< Flag for stopping the decoder.
+      std::future<void> decoderFuture_; ///< Future object holding the thread for the decoder loop.
+
+      /// Maximum number of transaction broadcasts waiting in the batch. Past it, receiving threads decode their own.
+      static constexpr size_t maxBatchedTxs_ = 4096;
 
       const Options& getOptions(); ///< Get the Options object from the P2P engine that owns this Broadcaster.
 
@@ -54,6 +65,14 @@ namespace P2P {
        */
       void handleTxBroadcast(const NodeID &nodeId, const std::shared_ptr<const Message>& message);
 
+      /**
+       * Decode the batched transaction broadcasts through the shared TxDecoder, add them
+       * to the mempool and rebroadcast the new ones, until stopped. Runs on its own thread,
+       * so the network threads that receive the broadcasts only have to queue them.
+       * Sessions that sent invalid transactions are closed.
+       */
+      void decoderLoop();
+
       /**
        * Handle a block broadcast message.
        * @param nodeId The ID of the node that sent the broadcast.
@@ -79,6 +98,12 @@ namespace P2P {
         : manager_(manager), storage_(storage), state_(state)
       {}
 
+      /// Ensure the decoder is stopped if the Broadcaster is being destroyed.
+      ~Broadcaster() { stop(); }
+
+      void start(); ///< Start the transaction decoder thread if necessary.
+      void stop(); ///< Stop the transaction decoder thread if any, dropping the broadcasts still waiting.
+
       /**
        * Handle a broadcast from a node.
        * @param nodeId The ID of the node that sent the broadcast.
@@ -434,10 +434,14 @@ namespace P2P {
   }
 
   TxBlock BroadcastDecoder::broadcastTx(const P2P::Message &message, const uint64_t &requiredChainId) {
+    return TxBlock(broadcastTxBytes(message), requiredChainId);
+  }
+
+  View<Bytes> BroadcastDecoder::broadcastTxBytes(const P2P::Message &message) {
     if (message.type() != Broadcasting) { throw DynamicException("Invalid message type."); }
     if (message.id().toUint64() != FNVHash()(message.message())) { throw DynamicException("Invalid message id."); }
     if (message.command() != BroadcastTx) { throw DynamicException("Invalid command."); }
-    return TxBlock(message.message(), requiredChainId);
+    return message.message();
   }
 
   FinalizedBlock BroadcastDecoder::broadcastBlock(const P2P::Message &message, const uint64_t &requiredChainId) {
@@ -507,6 +507,13 @@ namespace P2P {
        */
       static TxBlock broadcastTx(const Message& message, const uint64_t& requiredChainId);
 
+      /**
+       * Check a broadcasted message for a block transaction, without decoding the transaction.
+       * @param message The message that was broadcast.
+       * @return The raw transaction within the message.
+       */
+      static View<Bytes> broadcastTxBytes(const Message& message);
+
       /**
        * Parse a broadcasted message for a whole block.
        * @param message The message that was broadcast.
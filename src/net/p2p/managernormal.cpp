@@ -11,9 +11,10 @@ See the LICENSE.txt file in the project root for more information.
 #include "../core/state.h"
 
 namespace P2P{
-  void ManagerNormal::start() { ManagerBase::start(); nodeConns_.start(); }
+  void ManagerNormal::start() { broadcaster_.start(); ManagerBase::start(); nodeConns_.start(); }
 
-  void ManagerNormal::stop() { nodeConns_.stop(); ManagerBase::stop(); }
+  // The broadcaster's decoder thread hands transactions to sessions, so it stops after they're closed
+  void ManagerNormal::stop() { nodeConns_.stop(); ManagerBase::stop(); broadcaster_.stop(); }
 
   void ManagerNormal::sendMessageToAll(const std::shared_ptr<const Message> message, const std::optional<NodeID>& originalSender) {
     std::unordered_set<NodeID, SafeHash> peerMap;
@@ -207,13 +208,25 @@ namespace P2P{
     RequestDecoder::requestBlock(*message, height, heightEnd, bytesLimit);
     std::vector<std::shared_ptr<const FinalizedBlock>> requestedBlocks;
     uint64_t bytesSpent = 0;
-    for (uint64_t heightToAdd = height; heightToAdd <= heightEnd; ++heightToAdd) {
-      if (!this->storage_.blockExists(heightToAdd)) break; // Stop at first block in the requested range that we don't have.
-      requestedBlocks.push_back(this->storage_.getBlock(heightToAdd));
-      bytesSpent += requestedBlocks.back()->getSize();
-      LOGDEBUG("Uploading block " + std::to_string(heightToAdd) + " to " + toString(nodeId)
-                         + " (" + std::to_string(bytesSpent) + "/" + std::to_string(bytesLimit) + " bytes)");
-      if (bytesSpent >= bytesLimit) break; // bytesLimit reached so stop appending blocks to the answer
+    // Blocks are read in batches sized to about what still fits in bytesLimit, judging by the
+    // average size of the blocks read so far (starting with a single block to get a first size)
+    uint64_t batchSize = 1;
+    while (height <= heightEnd) {
+      const uint64_t batchEnd = (heightEnd - height < batchSize) ? heightEnd : height + batchSize - 1;
+      const auto blocks = this->storage_.getBlocks(height, batchEnd);
+      for (const auto& block : blocks) {
+        requestedBlocks.push_back(block);
+        bytesSpent += block->getSize();
+        LOGDEBUG("Uploading block " + std::to_string(block->getNHeight()) + " to " + toString(nodeId)
+                           + " (" + std::to_string(bytesSpent) + "/" + std::to_string(bytesLimit) + " bytes)");
+        if (bytesSpent >= bytesLimit) break; // bytesLimit reached so stop appending blocks to the answer
+      }
+      if (bytesSpent >= bytesLimit) break;
+      // Stop at first block in the requested range that we don't have.
+      if (blocks.size() < batchEnd - height + 1 || batchEnd == heightEnd) break;
+      height = batchEnd + 1;
+      const uint64_t averageSize = std::max<uint64_t>(bytesSpent / requestedBlocks.size(), 1);
+      batchSize = std::clamp<uint64_t>((bytesLimit - bytesSpent) / averageSize, 1, 64);
     }
     this->answerSession(nodeId, std::make_shared<const Message>(AnswerEncoder::requestBlock(*message, requestedBlocks)));
   }
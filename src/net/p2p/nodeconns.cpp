@@ -65,6 +65,7 @@ namespace P2P {
           this->nodeInfoTime_.erase(nodeId);
           this->nodeType_.erase(nodeId);
         } else {
+          this->checkHeightChange(nodeId, newNodeInfo);
           this->nodeInfo_[nodeId] = newNodeInfo;
           this->nodeInfoTime_[nodeId] = Utils::getCurrentTimeMillisSinceEpoch(); // Good enough; postpones some timeouts
         }
@@ -74,11 +75,33 @@ namespace P2P {
 
   void NodeConns::incomingInfo(const NodeID& sender, const NodeInfo& info, const NodeType& nodeType) {
     std::scoped_lock lock(this->stateMutex_);
+    this->checkHeightChange(sender, info);
     this->nodeInfo_[sender] = info;
     this->nodeInfoTime_[sender] = Utils::getCurrentTimeMillisSinceEpoch();
     this->nodeType_[sender] = nodeType;
   }
 
+  void NodeConns::checkHeightChange(const NodeID& nodeId, const NodeInfo& info) {
+    auto it = this->nodeInfo_.find(nodeId);
+    if (it != this->nodeInfo_.end() && it->second.latestBlockHeight() >= info.latestBlockHeight()) return;
+    {
+      std::scoped_lock lock(this->heightMutex_);
+      ++this->heightChanges_;
+    }
+    this->heightCv_.notify_all();
+  }
+
+  uint64_t NodeConns::getHeightChanges() {
+    std::scoped_lock lock(this->heightMutex_);
+    return this->heightChanges_;
+  }
+
+  uint64_t NodeConns::waitForHeightChange(uint64_t seen, std::chrono::milliseconds timeout) {
+    std::unique_lock lock(this->heightMutex_);
+    this->heightCv_.wait_for(lock, timeout, [&]() { return this->heightChanges_ != seen; });
+    return this->heightChanges_;
+  }
+
   boost::unordered_flat_map<NodeID, NodeInfo, SafeHash> NodeConns::getConnected() {
     std::scoped_lock lock(this->stateMutex_);
     return this->nodeInfo_;
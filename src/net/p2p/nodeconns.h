@@ -8,6 +8,7 @@ See the LICENSE.txt file in the project root for more information.
 #ifndef NODECONNS_H
 #define NODECONNS_H
 
+#include <condition_variable>
 #include <shared_mutex>
 
 #include "../../utils/safehash.h" // tx.h -> ecdsa.h -> utils.h -> libs/json.hpp -> algorithm (std::find in .cpp), boost/unordered/unordered_flat_map.hpp
@@ -39,6 +40,18 @@ namespace P2P {
 
       mutable std::shared_mutex stateMutex_; ///< Mutex for serializing all inner state and requests to it.
 
+      std::mutex heightMutex_; ///< Mutex for managing access to the height change counter.
+      std::condition_variable heightCv_; ///< Wakes up threads waiting for a peer to report a higher block.
+      uint64_t heightChanges_ = 0; ///< Number of times a peer reported a higher block than it had before.
+
+      /**
+       * Check if a peer's new info reports a higher block than its previous one, and if so
+       * wake up the threads waiting in waitForHeightChange(). Must be called with stateMutex_ locked.
+       * @param nodeId The peer.
+       * @param info The new info, not stored yet.
+       */
+      void checkHeightChange(const NodeID& nodeId, const NodeInfo& info);
+
       std::future<void> loopFuture_;  ///< Future object holding the thread for the nodeconns loop.
       std::atomic<bool> stop_ = false; ///< Flag for stopping nodeconns processing.
 
@@ -68,6 +81,18 @@ namespace P2P {
        */
       std::optional<NodeInfo> getNodeInfo(const NodeID& nodeId);
 
+      /// Get the number of times a peer reported a higher block so far (see waitForHeightChange()).
+      uint64_t getHeightChanges();
+
+      /**
+       * Block until a peer reports a higher block than it had before, or until a timeout.
+       * @param seen The number of height changes the caller already knows about (from getHeightChanges()
+       *             or a previous call), so changes made before the call are not missed.
+       * @param timeout How long to wait at most.
+       * @return The current number of height changes.
+       */
+      uint64_t waitForHeightChange(uint64_t seen, std::chrono::milliseconds timeout);
+
       void forceRefresh(); ///< Caller synchronously forces a refresh of the nodeInfos of all currently connected nodes.
       void loop(); ///< NodeConns loop (sends node info to peers and times out remote peer node info as needed).
       void start(); ///< Start the NodeConns worker thread if necessary.
@@ -7,40 +7,259 @@ See the LICENSE.txt file in the project root for more information.
 
 #include "db.h"
 
+#include <rocksdb/cache.h>
+#include <rocksdb/comparator.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/slice_transform.h>
+#include <rocksdb/table.h>
+
 #include "dynamicexception.h"
 
-DB::DB(const std::filesystem::path& path, bool compress) {
+namespace {
+  /// Column family of a DBPrefix.
+  struct PrefixFamily {
+    const Bytes& prefix;  ///< The prefix whose entries live in the family.
+    const char* name;     ///< Name of the family.
+    size_t prefixLength;  ///< Length of the keys' fixed prefix (for prefix bloom filters), 0 if none.
+  };
+
+  /// Column families of every DBPrefix. Contract storage is keyed by prefix + address (+ slot or name),
+  /// so those families also filter by address, making lookups on contracts with no data skip files entirely.
+  const std::array<PrefixFamily, 16> prefixFamilies = {{
+    { DBPrefix::blocks, "blocks", 0 },
+    { DBPrefix::heightToBlock, "heightToBlock", 0 },
+    { DBPrefix::nativeAccounts, "nativeAccounts", 0 },
+    { DBPrefix::txToBlock, "txToBlock", 0 },
+    { DBPrefix::rdPoS, "rdPoS", 0 },
+    { DBPrefix::contracts, "contracts", 2 + 20 },
+    { DBPrefix::contractManager, "contractManager", 0 },
+    { DBPrefix::events, "events", 0 },
+    { DBPrefix::vmStorage, "vmStorage", 2 + 20 },
+    { DBPrefix::txToAdditionalData, "txToAdditionalData", 0 },
+    { DBPrefix::txToCallTrace, "txToCallTrace", 0 },
+    { DBPrefix::evmContracts, "evmContracts", 0 },
+    { DBPrefix::stateDump, "stateDump", 0 },
+    { DBPrefix::blockSidecars, "blockSidecars", 0 },
+    { DBPrefix::metadata, "metadata", 0 },
+    { DBPrefix::coldBlocks, "coldBlocks", 0 }
+  }};
+
+  /// Size of each atomic write when moving entries out of the default family.
+  constexpr size_t migrationChunkBytes = 16 * 1024 * 1024;
+
+  /**
+   * Build the options of a column family.
+   * @param settings The database settings.
+   * @param table The table options shared by all families (block cache, bloom filters).
+   * @param name The family's name.
+   * @param prefixLength The length of the keys' fixed prefix, 0 if none.
+   * @return The family's options.
+   */
+  rocksdb::ColumnFamilyOptions familyOptions(
+    const DBSettings& settings, const rocksdb::BlockBasedTableOptions& table,
+    const std::string& name, size_t prefixLength
+  ) {
+    rocksdb::ColumnFamilyOptions opts;
+    opts.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table));
+    if (prefixLength != 0) opts.prefix_extractor.reset(rocksdb::NewCappedPrefixTransform(prefixLength));
+    DBSettings::Family family;
+    if (auto it = settings.families.find(name); it != settings.families.end()) family = it->second;
+    switch (family.compression) {
+      case DBSettings::Compression::NONE: opts.compression = rocksdb::kNoCompression; break;
+      case DBSettings::Compression::LZ4: opts.compression = rocksdb::kLZ4Compression; break;
+      case DBSettings::Compression::ZSTD: opts.compression = rocksdb::kZSTD; break;
+    }
+    if (family.compressionLevel) opts.compression_opts.level = *family.compressionLevel;
+    if (family.compression == DBSettings::Compression::ZSTD && family.dictionaryBytes != 0) {
+      opts.compression_opts.max_dict_bytes = family.dictionaryBytes;
+      opts.compression_opts.zstd_max_train_bytes = (family.dictionaryTrainBytes != 0)
+        ? family.dictionaryTrainBytes : uint64_t(family.dictionaryBytes) * 100;
+    }
+    switch (family.compaction) {
+      case DBSettings::Compaction::LEVEL: opts.compaction_style = rocksdb::kCompactionStyleLevel; break;
+      case DBSettings::Compaction::UNIVERSAL: opts.compaction_style = rocksdb::kCompactionStyleUniversal; break;
+    }
+    return opts;
+  }
+}
+
+DB::DB(const std::filesystem::path& path, const DBSettings& settings) {
   this->opts_.create_if_missing = true; // Create database folder in disk if it doesn't exist
-  if (compress) this->opts_.compression = rocksdb::kLZ4Compression; // Activate LZ4 compression for database entries if requested
+  this->opts_.create_missing_column_families = true; // Same for the families, on new or single-family databases
   if (!std::filesystem::exists(path)) { // Ensure the database path can actually be found
     std::filesystem::create_directories(path);
   }
-  auto status = rocksdb::DB::Open(this->opts_, path, &this->db_);
+
+  // All families share the same block cache, so its size bounds the whole database's read cache.
+  // Index and filter blocks are also kept in it, so they count towards that bound
+  rocksdb::BlockBasedTableOptions table;
+  table.block_cache = rocksdb::NewLRUCache(settings.blockCacheSize);
+  table.cache_index_and_filter_blocks = true;
+  table.pin_l0_filter_and_index_blocks_in_cache = true;
+  if (settings.bloomBitsPerKey != 0) {
+    table.filter_policy.reset(rocksdb::NewBloomFilterPolicy(settings.bloomBitsPerKey, false));
+  }
+
+  // RocksDB requires opening every existing family, including ones this version doesn't know about.
+  // Listing fails on databases that don't exist yet, which is fine as they start with none
+  std::vector<std::string> existing;
+  rocksdb::DB::ListColumnFamilies(this->opts_, path.string(), &existing);
+  std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+  descriptors.emplace_back(rocksdb::kDefaultColumnFamilyName,
+    familyOptions(settings, table, rocksdb::kDefaultColumnFamilyName, 0)
+  );
+  for (const PrefixFamily& family : prefixFamilies) {
+    descriptors.emplace_back(family.name, familyOptions(settings, table, family.name, family.prefixLength));
+  }
+  for (const std::string& name : existing) {
+    if (std::ranges::none_of(descriptors, [&](const auto& d) { return d.name == name; })) {
+      descriptors.emplace_back(name, familyOptions(settings, table, name, 0));
+    }
+  }
+  for (const auto& [name, family] : settings.families) {
+    if (std::ranges::none_of(descriptors, [&](const auto& d) { return d.name == name; })) {
+      LOGWARNING("Ignoring settings for unknown DB column family: " + name);
+    }
+  }
+
+  auto status = rocksdb::DB::Open(this->opts_, path.string(), descriptors, &this->handles_, &this->db_);
   if (!status.ok()) {
     LOGERROR("Failed to open DB: " + status.ToString());
     throw DynamicException("Failed to open DB: " + status.ToString());
   }
+  this->routes_.fill(Route{this->handles_[0], 0});
+  for (size_t i = 0; i < prefixFamilies.size(); i++) {
+    this->routes_[prefixFamilies[i].prefix[1]] = Route{this->handles_[i + 1], prefixFamilies[i].prefixLength};
+  }
+  this->migrateDefaultFamily();
+}
+
+void DB::migrateDefaultFamily() {
+  rocksdb::ColumnFamilyHandle* defaultFamily = this->handles_[0];
+  rocksdb::ReadOptions readOpts;
+  readOpts.total_order_seek = true;
+  uint64_t moved = 0;
+  auto write = [&](rocksdb::WriteBatch& wb) {
+    if (wb.Count() == 0) return;
+    if (auto status = this->db_->Write(rocksdb::WriteOptions(), &wb); !status.ok()) {
+      LOGERROR("Failed to migrate DB entries: " + status.ToString());
+      throw DynamicException("Failed to migrate DB entries: " + status.ToString());
+    }
+    wb.Clear();
+  };
+  for (const PrefixFamily& family : prefixFamilies) {
+    rocksdb::Slice pfx(reinterpret_cast<const char*>(family.prefix.data()), family.prefix.size());
+    rocksdb::ColumnFamilyHandle* target = this->routeFor(pfx).handle;
+    std::unique_ptr<rocksdb::Iterator> it(this->db_->NewIterator(readOpts, defaultFamily));
+    rocksdb::WriteBatch wb;
+    for (it->Seek(pfx); it->Valid() && it->key().starts_with(pfx); it->Next()) {
+      wb.Put(target, it->key(), it->value());
+      wb.Delete(defaultFamily, it->key());
+      moved++;
+      if (wb.GetDataSize() >= migrationChunkBytes) write(wb);
+    }
+    write(wb);
+  }
+  if (moved == 0) return;
+  // Drop the deleted entries from the default family right away instead of on later compactions
+  this->db_->CompactRange(rocksdb::CompactRangeOptions(), defaultFamily, nullptr, nullptr);
+  LOGINFO("Moved " + std::to_string(moved) + " DB entries to their column families");
+}
+
+bool DB::close() const {
+  // Handles must be released before the database is closed
+  for (rocksdb::ColumnFamilyHandle* handle : this->handles_) this->db_->DestroyColumnFamilyHandle(handle);
+  this->handles_.clear();
+  this->db_->Close();
+  return true;
+}
+
+bool DB::syncWAL() const {
+  if (auto status = this->db_->SyncWAL(); !status.ok()) {
+    LOGERROR("Failed to sync DB write-ahead log: " + status.ToString());
+    return false;
+  }
+  return true;
+}
+
+bool DB::flush() const {
+  if (auto status = this->db_->Flush(rocksdb::FlushOptions(), this->handles_); !status.ok()) {
+    LOGERROR("Failed to flush DB: " + status.ToString());
+    return false;
+  }
+  return true;
+}
+
+rocksdb::ReadOptions DB::scanOptions(const Route& route, size_t pfxSize) {
+  rocksdb::ReadOptions opts;
+  if (route.prefixLength != 0 && pfxSize >= route.prefixLength) {
+    opts.prefix_same_as_start = true;
+  } else {
+    opts.total_order_seek = true;
+  }
+  return opts;
 }
 
 bool DB::putBatch(const DBBatch& batch) {
   std::lock_guard lock(this->batchLock_);
   rocksdb::WriteBatch wb;
-  for (const auto& dels : batch.getDels())
-    wb.Delete(rocksdb::Slice(reinterpret_cast<const char*>(dels.data()), dels.size()));
-  for (const auto& puts : batch.getPuts())
-    wb.Put(rocksdb::Slice(reinterpret_cast<const char*>(puts.key.data()), puts.key.size()),
+  for (const auto& dels : batch.getDels()) {
+    rocksdb::Slice keySlice(reinterpret_cast<const char*>(dels.data()), dels.size());
+    wb.Delete(this->routeFor(keySlice).handle, keySlice);
+  }
+  for (const auto& puts : batch.getPuts()) {
+    rocksdb::Slice keySlice(reinterpret_cast<const char*>(puts.key.data()), puts.key.size());
+    wb.Put(this->routeFor(keySlice).handle, keySlice,
            rocksdb::Slice(reinterpret_cast<const char*>(puts.value.data()), puts.value.size()));
+  }
+  rocksdb::Status s = this->db_->Write(rocksdb::WriteOptions(), &wb);
+  return s.ok();
+}
+
+bool DB::putBatches(const std::vector<DBBatch>& batches) {
+  std::lock_guard lock(this->batchLock_);
+  rocksdb::WriteBatch wb;
+  for (const auto& batch : batches) {
+    for (const auto& dels : batch.getDels()) {
+      rocksdb::Slice keySlice(reinterpret_cast<const char*>(dels.data()), dels.size());
+      wb.Delete(this->routeFor(keySlice).handle, keySlice);
+    }
+    for (const auto& puts : batch.getPuts()) {
+      rocksdb::Slice keySlice(reinterpret_cast<const char*>(puts.key.data()), puts.key.size());
+      wb.Put(this->routeFor(keySlice).handle, keySlice,
+             rocksdb::Slice(reinterpret_cast<const char*>(puts.value.data()), puts.value.size()));
+    }
+  }
   rocksdb::Status s = this->db_->Write(rocksdb::WriteOptions(), &wb);
   return s.ok();
 }
 
+std::vector<Bytes> DB::multiGetKeys(const std::vector<Bytes>& keys) const {
+  std::vector<rocksdb::Slice> slices;
+  std::vector<rocksdb::ColumnFamilyHandle*> families;
+  slices.reserve(keys.size());
+  families.reserve(keys.size());
+  for (const Bytes& key : keys) {
+    families.push_back(this->routeFor(slices.emplace_back(reinterpret_cast<const char*>(key.data()), key.size())).handle);
+  }
+  std::vector<rocksdb::PinnableSlice> values(keys.size());
+  std::vector<rocksdb::Status> statuses(keys.size());
+  this->db_->MultiGet(rocksdb::ReadOptions(), keys.size(), families.data(), slices.data(), values.data(), statuses.data());
+  std::vector<Bytes> ret(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (statuses[i].ok()) ret[i].assign(values[i].data(), values[i].data() + values[i].size());
+  }
+  return ret;
+}
+
 std::vector<DBEntry> DB::getBatch(
   const Bytes& bytesPfx, const std::vector<Bytes>& keys
 ) const {
   std::lock_guard lock(this->batchLock_);
   std::vector<DBEntry> ret;
-  std::unique_ptr<rocksdb::Iterator> it(this->db_->NewIterator(rocksdb::ReadOptions()));
   rocksdb::Slice pfx(reinterpret_cast<const char*>(bytesPfx.data()), bytesPfx.size());
+  const Route& route = this->routeFor(pfx);
+  std::unique_ptr<rocksdb::Iterator> it(this->db_->NewIterator(scanOptions(route, pfx.size()), route.handle));
 
   // Search for all entries
   if (keys.empty()) {
@@ -69,7 +288,8 @@ std::vector<DBEntry> DB::getBatch(
 
 std::vector<Bytes> DB::getKeys(const Bytes& pfx, const Bytes& start, const Bytes& end) const {
   std::vector<Bytes> ret;
-  std::unique_ptr<rocksdb::Iterator> it(this->db_->NewIterator(rocksdb::ReadOptions()));
+  const Route& route = this->routeFor(rocksdb::Slice(reinterpret_cast<const char*>(pfx.data()), pfx.size()));
+  std::unique_ptr<rocksdb::Iterator> it(this->db_->NewIterator(scanOptions(route, pfx.size()), route.handle));
   Bytes startBytes = pfx;
   Bytes endBytes = pfx;
   if (!start.empty()) Utils::appendBytes(startBytes, start);
@@ -77,7 +297,7 @@ std::vector<Bytes> DB::getKeys(const Bytes& pfx, const Bytes& start, const Bytes
   rocksdb::Slice startSlice(reinterpret_cast<const char*>(startBytes.data()), startBytes.size());
   rocksdb::Slice endSlice(reinterpret_cast<const char*>(endBytes.data()), endBytes.size());
   for (it->Seek(startSlice); it->Valid(); it->Next()) {
-    if (this->opts_.comparator->Compare(it->key(), endSlice) > 0) {
+    if (rocksdb::BytewiseComparator()->Compare(it->key(), endSlice) > 0) {
       if (!it->key().starts_with(endSlice)) break;
     }
     rocksdb::Slice keySlice = it->key();
@@ -89,7 +309,11 @@ std::vector<Bytes> DB::getKeys(const Bytes& pfx, const Bytes& start, const Bytes
 }
 
 Bytes DB::getLastByPrefix(const Bytes& pfx) const {
-  std::unique_ptr<rocksdb::Iterator> it(this->db_->NewIterator(rocksdb::ReadOptions()));
+  // Seeks past the prefix, so it can't be confined to it
+  rocksdb::ReadOptions readOpts;
+  readOpts.total_order_seek = true;
+  const Route& route = this->routeFor(rocksdb::Slice(reinterpret_cast<const char*>(pfx.data()), pfx.size()));
+  std::unique_ptr<rocksdb::Iterator> it(this->db_->NewIterator(readOpts, route.handle));
   Bytes nextPfx = pfx;
 
   bool overflow;
@@ -8,6 +8,10 @@ See the LICENSE.txt file in the project root for more information.
 #ifndef DB_H
 #define DB_H
 
+#include <array>
+#include <map>
+#include <optional>
+
 #include <rocksdb/db.h> // rocksdb/transaction_log.h -> rocksdb/write_batch.h, includes mutex somewhere in there too
 
 #include "utils.h" // libs/json.hpp -> (cstring, filesystem, string, vector)
@@ -26,6 +30,41 @@ namespace DBPrefix {
   const Bytes txToAdditionalData = { 0x00, 0x0A }; ///< "txToAdditionalData" = "000A"
   const Bytes txToCallTrace =      { 0x00, 0x0B }; ///< "txToCallTrace" = "000B"
   const Bytes evmContracts =       { 0x00, 0x0C }; ///< "evmContracts" = "000C"
+  const Bytes stateDump =          { 0x00, 0x0D }; ///< "stateDump" = "000D"
+  const Bytes blockSidecars =      { 0x00, 0x0E }; ///< "blockSidecars" = "000E"
+  const Bytes metadata =           { 0x00, 0x0F }; ///< "metadata" = "000F"
+  const Bytes coldBlocks =         { 0x00, 0x10 }; ///< "coldBlocks" = "0010"
+};
+
+/**
+ * Tuning for a database, loaded from the "db" object in options.json. @see Options::getDBSettings()
+ * Each DBPrefix lives in its own column family, named after the prefix (e.g. "blocks", "vmStorage"),
+ * and keys without a known prefix live in the "default" family.
+ */
+struct DBSettings {
+  /// Compression applied to a column family's files.
+  enum class Compression { NONE, LZ4, ZSTD };
+
+  /// Compaction style of a column family.
+  enum class Compaction { LEVEL, UNIVERSAL };
+
+  /**
+   * Settings for a single column family.
+   * With a dictionary, compression first trains one from samples of the data being written to each
+   * file (e.g. the addresses, selectors and zero padding most txs share) and stores it in that file,
+   * so every file is read with the dictionary it was written with, and compactions train new ones.
+   */
+  struct Family {
+    Compression compression = Compression::NONE;  ///< Compression of the family's files.
+    Compaction compaction = Compaction::LEVEL;    ///< Compaction style of the family.
+    std::optional<int> compressionLevel;          ///< Compression level, the library's default if empty.
+    uint32_t dictionaryBytes = 0;                 ///< Maximum size of each file's dictionary (ZSTD only), 0 disables it.
+    uint64_t dictionaryTrainBytes = 0;            ///< Data sampled to train each dictionary, 0 for 100x dictionaryBytes.
+  };
+
+  uint64_t blockCacheSize = 64 * 1024 * 1024; ///< Size of the LRU block cache shared by all families, in bytes.
+  uint32_t bloomBitsPerKey = 10; ///< Bits per key of the bloom filters (~1% false positives at 10), 0 disables them.
+  std::map<std::string, Family> families; ///< Settings for each family, by name. Families not listed use the defaults.
 };
 
 /// Struct for a database connection/endpoint.
@@ -123,30 +162,98 @@ class DBBatch {
     inline const std::vector<Bytes>& getDels() const { return dels_; }
 };
 
+/**
+ * A value read from the database without copying it.
+ * The data stays pinned in the database's block cache (or memtable) for as long
+ * as the object lives, so views of it are only valid until it's destroyed.
+ */
+class DBPinnedValue {
+  private:
+    rocksdb::PinnableSlice slice_; ///< The pinned value.
+    friend class DB;
+
+  public:
+    /// Get a view of the value.
+    View<Bytes> view() const { return View<Bytes>(reinterpret_cast<const Byte*>(this->slice_.data()), this->slice_.size()); }
+
+    /// Check if the value is empty (which is also the case for keys that don't exist).
+    bool empty() const { return this->slice_.empty(); }
+
+    /// Get the size of the value.
+    size_t size() const { return this->slice_.size(); }
+};
+
 /**
  * Abstraction of a [Speedb](https://github.com/speedb-io/speedb) database (RocksDB drop-in replacement).
  * Keys begin with prefixes that separate entries in several categories. @see DBPrefix
+ * Each prefix is stored in its own column family, with its own memtable, bloom filters
+ * and compression/compaction settings, all sharing one block cache. Keys are stored whole
+ * (prefix included) within their family, so the public interface is the same as with
+ * a single keyspace. Keys that don't start with a known prefix go to the default family.
+ * Prefix queries only look within the family of the queried prefix, so they must
+ * include the whole two-byte DBPrefix to find that prefix's entries.
  */
 class DB {
   private:
+    /// Column family that a key is stored in.
+    struct Route {
+      rocksdb::ColumnFamilyHandle* handle = nullptr; ///< Handle of the family.
+      size_t prefixLength = 0; ///< Length of the family's fixed key prefix (for prefix bloom filters), 0 if none.
+    };
+
     rocksdb::DB* db_;               ///< Pointer to the database object itself.
-    rocksdb::Options opts_;         ///< Struct with options for managing the database.
+    rocksdb::DBOptions opts_;       ///< Struct with options for managing the database.
+    mutable std::vector<rocksdb::ColumnFamilyHandle*> handles_; ///< Handles of all open column families, default first.
+    std::array<Route, 256> routes_; ///< Family of each DBPrefix, indexed by its second byte. Entry 0 is the default family.
     mutable std::mutex batchLock_;  ///< Mutex for managing read/write access to batch operations.
 
+    /**
+     * Get the column family a key (or key prefix) belongs to.
+     * @param key The key.
+     * @return The route to the key's family.
+     */
+    const Route& routeFor(const rocksdb::Slice& key) const {
+      return (key.size() >= 2 && key[0] == 0x00) ? this->routes_[uint8_t(key[1])] : this->routes_[0];
+    }
+
+    /**
+     * Get the read options for iterating over keys that start with a given prefix.
+     * Iterations within a family's fixed prefix use its prefix bloom filters, all others see the whole family.
+     * @param route The route to the family being iterated.
+     * @param pfxSize The size of the prefix being iterated.
+     * @return The read options.
+     */
+    static rocksdb::ReadOptions scanOptions(const Route& route, size_t pfxSize);
+
+    /**
+     * Move the entries of a database created with a single column family to their own families.
+     * Entries are moved in atomic chunks, so an interrupted migration resumes on the next opening.
+     * @throw DynamicException if writing to the database fails.
+     */
+    void migrateDefaultFamily();
+
+    /**
+     * Get the values of several keys in one go. @see multiGet()
+     * @param keys The keys to search for, prefixes included.
+     * @return The requested values, in the same order as the keys.
+     */
+    std::vector<Bytes> multiGetKeys(const std::vector<Bytes>& keys) const;
+
   public:
     /**
-     * Constructor. Automatically creates the database if it doesn't exist.
+     * Constructor. Automatically creates the database and its column families if they don't exist,
+     * and moves entries of databases created with a single column family to their own families.
      * @param path The database's filesystem path (relative to the binary's current working directory).
-     * @param compress (optional) If `true`, activates compression on the database. Defaults to `false`.
+     * @param settings (optional) Cache, filter and column family settings. Defaults to DBSettings' defaults.
      * @throw DynamicException if database opening fails.
      */
-    explicit DB(const std::filesystem::path& path, bool compress = false);
+    explicit DB(const std::filesystem::path& path, const DBSettings& settings = {});
 
     /// Destructor. Automatically closes the database so it doesn't leave a LOCK file behind.
     ~DB() { this->close(); delete this->db_; this->db_ = nullptr; }
 
-    /// Close the database connection.
-    inline bool close() const { this->db_->Close(); return true; }
+    /// Close the database connection. The database can't be used afterwards.
+    bool close() const;
 
     /**
      * Check if a key exists in the database.
@@ -156,17 +263,14 @@ class DB {
      * @return `true` if the key exists, `false` otherwise.
      */
     template <typename BytesContainer> bool has(const BytesContainer& key, const Bytes& pfx = {}) const {
-      std::unique_ptr<rocksdb::Iterator> it(this->db_->NewIterator(rocksdb::ReadOptions()));
       Bytes keyTmp = pfx;
       keyTmp.reserve(pfx.size() + key.size());
       keyTmp.insert(keyTmp.end(), key.begin(), key.end());
       rocksdb::Slice keySlice(reinterpret_cast<const char*>(keyTmp.data()), keyTmp.size());
-      it->Seek(keySlice);
-      if (it->Valid()) {
-        if (it->key() == keySlice) { it.reset(); return true; }
-      }
-      it.reset();
-      return false;
+      // A point lookup checks the bloom filters before touching any file, unlike an iterator seek,
+      // and pinning the value avoids copying it just to throw it away
+      rocksdb::PinnableSlice value;
+      return this->db_->Get(rocksdb::ReadOptions(), this->routeFor(keySlice).handle, keySlice, &value).ok();
     }
 
     /**
@@ -176,8 +280,9 @@ class DB {
      * @return `true` if the prefix has entries, `false` otherwise.
      */
     template <typename BytesContainer> bool hasPrefix(const BytesContainer& pfx) const {
-      std::unique_ptr<rocksdb::Iterator> it(this->db_->NewIterator(rocksdb::ReadOptions()));
       rocksdb::Slice pfxSlice(reinterpret_cast<const char*>(pfx.data()), pfx.size());
+      const Route& route = this->routeFor(pfxSlice);
+      std::unique_ptr<rocksdb::Iterator> it(this->db_->NewIterator(scanOptions(route, pfxSlice.size()), route.handle));
       it->Seek(pfxSlice);
       if (it->Valid()) {
         if (it->key().starts_with(pfxSlice)) { it.reset(); return true; }
@@ -195,13 +300,49 @@ class DB {
      * @return The requested value, or an empty Bytes object if the key doesn't exist.
      */
     template <typename BytesContainer> Bytes get(const BytesContainer& key, const Bytes& pfx = {}) const {
+      const DBPinnedValue value = this->getPinned(key, pfx);
+      const View<Bytes> view = value.view();
+      return Bytes(view.begin(), view.end());
+    }
+
+    /**
+     * Get a value from a given key in the database without copying it.
+     * Meant for values that are decoded right away, like blocks.
+     * @tparam BytesContainer Any container that stores Bytes.
+     * @param key The key to search for.
+     * @param pfx (optional) The prefix to search for. Defaults to none.
+     * @return The requested value, or an empty value if the key doesn't exist.
+     */
+    template <typename BytesContainer> DBPinnedValue getPinned(const BytesContainer& key, const Bytes& pfx = {}) const {
       Bytes keyTmp = pfx;
       keyTmp.reserve(pfx.size() + key.size());
       keyTmp.insert(keyTmp.end(), key.cbegin(), key.cend());
       rocksdb::Slice keySlice(reinterpret_cast<const char*>(keyTmp.data()), keyTmp.size());
-      std::string ret; // std::string is used to avoid copying the value.
-      this->db_->Get(rocksdb::ReadOptions(), keySlice, &ret);
-      return Bytes(ret.begin(), ret.end());
+      DBPinnedValue ret;
+      if (!this->db_->Get(rocksdb::ReadOptions(), this->routeFor(keySlice).handle, keySlice, &ret.slice_).ok()) {
+        ret.slice_.Reset();
+      }
+      return ret;
+    }
+
+    /**
+     * Get the values of several keys in one go.
+     * Lookups are batched, so they share index and filter block reads, and
+     * the ones that need to read files do it in parallel.
+     * @tparam KeyRange Any range of containers that store Bytes.
+     * @param keys The keys to search for.
+     * @param pfx (optional) The prefix of all the keys. Defaults to none.
+     * @return The requested values, in the same order as the keys. Keys that don't exist get an empty Bytes object.
+     */
+    template <typename KeyRange> std::vector<Bytes> multiGet(const KeyRange& keys, const Bytes& pfx = {}) const {
+      std::vector<Bytes> fullKeys;
+      fullKeys.reserve(std::ranges::size(keys));
+      for (const auto& key : keys) {
+        Bytes& keyTmp = fullKeys.emplace_back(pfx);
+        keyTmp.reserve(pfx.size() + key.size());
+        keyTmp.insert(keyTmp.end(), key.begin(), key.end());
+      }
+      return this->multiGetKeys(fullKeys);
     }
 
     /**
@@ -220,7 +361,7 @@ class DB {
       keyTmp.insert(keyTmp.end(), key.begin(), key.end());
       rocksdb::Slice keySlice(reinterpret_cast<const char*>(keyTmp.data()), keyTmp.size());
       rocksdb::Slice valueSlice(reinterpret_cast<const char*>(value.data()), value.size());
-      if (auto status = this->db_->Put(rocksdb::WriteOptions(), keySlice, valueSlice); !status.ok()) {
+      if (auto status = this->db_->Put(rocksdb::WriteOptions(), this->routeFor(keySlice).handle, keySlice, valueSlice); !status.ok()) {
         LOGERROR("Failed to put key: " + Hex::fromBytes(keyTmp).get());
         return false;
       }
@@ -239,13 +380,26 @@ class DB {
       keyTmp.reserve(pfx.size() + key.size());
       keyTmp.insert(keyTmp.end(), key.begin(), key.end());
       rocksdb::Slice keySlice(reinterpret_cast<const char*>(keyTmp.data()), keyTmp.size());
-      if (auto status = this->db_->Delete(rocksdb::WriteOptions(), keySlice); !status.ok()) {
+      if (auto status = this->db_->Delete(rocksdb::WriteOptions(), this->routeFor(keySlice).handle, keySlice); !status.ok()) {
         LOGERROR("Failed to delete key: " + Hex::fromBytes(keyTmp).get());
         return false;
       }
       return true;
     }
 
+    /**
+     * Make every write done so far durable, by syncing the write-ahead log to disk.
+     * Writes are otherwise only guaranteed to survive a process crash, not an OS crash or power loss.
+     * @return `true` if the sync is successful, `false` otherwise.
+     */
+    bool syncWAL() const;
+
+    /**
+     * Flush the memtables of every column family to table files, waiting for it to finish.
+     * @return `true` if the flush is successful, `false` otherwise.
+     */
+    bool flush() const;
+
     /**
      * Get the last value of a given prefix.
      * @param pfx The prefix to query.
@@ -281,6 +435,14 @@ class DB {
      */
     bool putBatch(const DBBatch& batch);
 
+    /**
+     * Do several put/delete operations in one single atomic write.
+     * Each batch has its deletions applied before its puts, and batches are applied in order.
+     * @param batches The batches to write.
+     * @return `true` if all operations were successful, `false` otherwise.
+     */
+    bool putBatches(const std::vector<DBBatch>& batches);
+
     /**
      * Get all entries from a given prefix.
      * @param bytesPfx The prefix to search for.
@@ -6,20 +6,15 @@ See the LICENSE.txt file in the project root for more information.
 */
 
 #include "evmcconv.h"
-#include "uintconv.h"
+#include "uint256.h" // uintconv.h
 
 uint256_t EVMCConv::evmcUint256ToUint256(const evmc::uint256be& x) {
-  // We can use the uint256ToBytes directly as it is std::span and we can create a span from an array
-  return UintConv::bytesToUint256(View<Bytes>(x.bytes, 32));
+  return uint256_t(Uint256::fromEvmc(x));
 }
 
 evmc::uint256be EVMCConv::uint256ToEvmcUint256(const uint256_t& x) {
-  // Convert the uint256_t to BytesArr<32> then copy it to evmc::uint256be
   // evmc::uint256be is a struct with a single member, bytes, which holds a uint256 value in *big-endian* order
-  evmc::uint256be ret;
-  BytesArr<32> bytes = UintConv::uint256ToBytes(x);
-  std::copy(bytes.begin(), bytes.end(), ret.bytes);
-  return ret;
+  return Uint256(x).toEvmc();
 }
 
 BytesArr<32> EVMCConv::evmcUint256ToBytes(const evmc::uint256be& x) {
@@ -10,8 +10,81 @@ See the LICENSE.txt file in the project root for more information.
 #include "../core/rdpos.h" // net/p2p/managernormal.h -> net/p2p/nodeconns.h (and broadcaster.h) -> thread
 
 #include "../utils/uintconv.h"
+#include "../utils/txdecoder.h"
+
+namespace {
+  /// Raw txs of a serialized block, in either format, plus the block's size in the v1 format.
+  struct RawTxs {
+    std::vector<View<Bytes>> txs;          ///< Raw block txs.
+    std::vector<View<Bytes>> txValidators; ///< Raw Validator txs.
+    uint64_t size;                         ///< Size of the block in the v1 format.
+  };
+
+  /// Read the format of a serialized block (the v1 header has the offset of the Validator txs there).
+  uint64_t blockFormat(const View<Bytes> bytes) {
+    const uint64_t field = UintConv::bytesToUint64(bytes.subspan(209, 8));
+    return (field < 217) ? field : 1;
+  }
+
+  /// Read a v2 offset table entry.
+  uint64_t offsetAt(const View<Bytes> bytes, uint64_t i) {
+    return UintConv::bytesToUint32(bytes.subspan(225 + i * 4, 4));
+  }
+
+  /// Split a serialized block (of at least 217 bytes) in its raw txs.
+  RawTxs splitTxs(const View<Bytes> bytes) {
+    RawTxs ret;
+    ret.size = 217;
+    const uint64_t format = blockFormat(bytes);
+    if (format == 1) {
+      const uint64_t txValidatorStart = UintConv::bytesToUint64(bytes.subspan(209, 8));
+      if (txValidatorStart < 217 || txValidatorStart > bytes.size()) {
+        throw std::length_error("Invalid Validator txs offset");
+      }
+      uint64_t index = 217; // Start of block tx range
+      while (index < bytes.size()) {
+        if (index + 4 > bytes.size()) throw std::length_error("Invalid tx size - too short");
+        uint64_t txSize = UintConv::bytesToUint32(bytes.subspan(index, 4));
+        if (index + 4 + txSize > bytes.size()) throw std::length_error("Invalid tx size - too long");
+        auto& list = (index < txValidatorStart) ? ret.txs : ret.txValidators;
+        list.emplace_back(bytes.subspan(index + 4, txSize));
+        index += txSize + 4;
+      }
+    } else if (format == FinalizedBlock::formatV2) {
+      if (bytes.size() < 225) throw std::length_error("Invalid v2 block size - too short");
+      const uint64_t txCount = UintConv::bytesToUint32(bytes.subspan(217, 4));
+      const uint64_t total = txCount + UintConv::bytesToUint32(bytes.subspan(221, 4));
+      if (225 + (total + 1) * 4 > bytes.size()) throw std::length_error("Invalid v2 block offset table");
+      if (offsetAt(bytes, 0) != 225 + (total + 1) * 4 || offsetAt(bytes, total) != bytes.size()) {
+        throw std::length_error("Invalid v2 block offset table bounds");
+      }
+      ret.txs.reserve(txCount);
+      ret.txValidators.reserve(total - txCount);
+      for (uint64_t i = 0; i < total; i++) {
+        const uint64_t begin = offsetAt(bytes, i), end = offsetAt(bytes, i + 1);
+        if (end < begin) throw std::length_error("Invalid v2 block offset table order");
+        auto& list = (i < txCount) ? ret.txs : ret.txValidators;
+        list.emplace_back(bytes.subspan(begin, end - begin));
+      }
+    } else {
+      throw std::invalid_argument("Unknown block format " + std::to_string(format));
+    }
+    for (const auto& tx : ret.txs) ret.size += tx.size() + 4;
+    for (const auto& tx : ret.txValidators) ret.size += tx.size() + 4;
+    return ret;
+  }
+}
 
 FinalizedBlock FinalizedBlock::fromBytes(const View<Bytes> bytes, const uint64_t& requiredChainId) {
+  // Blocks from the network are always in the v1 format, the v2 format is only for storage
+  if (bytes.size() >= 217 && blockFormat(bytes) != 1) {
+    SLOGERROR("Error when deserializing a FinalizedBlock: not in the v1 format");
+    throw std::domain_error("Error when deserializing a FinalizedBlock: not in the v1 format");
+  }
+  return fromStorageBytes(bytes, requiredChainId);
+}
+
+FinalizedBlock FinalizedBlock::fromStorageBytes(const View<Bytes> bytes, const uint64_t& requiredChainId) {
   try {
     // Verify minimum size for a valid block
     SLOGTRACE("Deserializing block...");
@@ -25,102 +98,30 @@ FinalizedBlock FinalizedBlock::fromBytes(const View<Bytes> bytes, const uint64_t
     auto txMerkleRoot = Hash(bytes.subspan(161, 32));
     uint64_t timestamp = UintConv::bytesToUint64(bytes.subspan(193, 8));
     uint64_t nHeight = UintConv::bytesToUint64(bytes.subspan(201, 8));
-    uint64_t txValidatorStart = UintConv::bytesToUint64(bytes.subspan(209, 8));
+    RawTxs rawTxs = splitTxs(bytes);
 
     SLOGTRACE("Deserializing transactions...");
 
     std::vector<TxBlock> txs;
     std::vector<TxValidator> txValidators;
 
-    // Count how many block txs are in the block
-    uint64_t txCount = 0;
-    uint64_t index = 217; // Start of block tx range
-    while (index < txValidatorStart) {
-      uint64_t txSize = UintConv::bytesToUint32(bytes.subspan(index, 4));
-      index += txSize + 4;
-      txCount++;
-    }
-
-    // Count how many Validator txs are in the block
-    uint64_t valTxCount = 0;
-    index = txValidatorStart;
-    while (index < bytes.size()) {
-      uint64_t txSize = UintConv::bytesToUint32(bytes.subspan(index, 4));
-      index += txSize + 4;
-      valTxCount++;
-    }
-    index = 217;  // Rewind to start of block tx range
-
-    // If we have up to X block txs or only one physical thread
-    // for some reason, deserialize normally.
-    // Otherwise, parallelize into threads/asyncs.
-    if (
-      unsigned int thrNum = std::thread::hardware_concurrency();
-      thrNum <= 1 || txCount <= 2000
-    ) {
-      for (uint64_t i = 0; i < txCount; i++) {
-        uint64_t txSize = UintConv::bytesToUint32(bytes.subspan(index, 4));
-        index += 4;
-        txs.emplace_back(bytes.subspan(index, txSize), requiredChainId);
-        index += txSize;
-      }
-    } else {
-      // Logically divide txs equally into one-time hardware threads/asyncs.
-      // Division reminder always goes to the LAST thread (e.g. 11/4 = 2+2+2+5)
-      std::vector<uint64_t> txsPerThr(thrNum, txCount / thrNum);
-      txsPerThr.back() += txCount % thrNum;
-
-      // Deserialize the txs with parallelized asyncs
-      std::vector<std::future<std::vector<TxBlock>>> f;
-      f.reserve(thrNum);
-      uint64_t thrOff = index;
-      for (uint64_t i = 0; i < txsPerThr.size(); i++) {
-        // Find out how many txs this thread will work with,
-        // then update offset for next thread
-        uint64_t startIdx = thrOff;
-        uint64_t nTxs = txsPerThr[i];
-
-        std::future<std::vector<TxBlock>> txF = std::async(
-          [&bytes, requiredChainId, startIdx, nTxs](){
-            std::vector<TxBlock> txVec;
-            uint64_t idx = startIdx;
-            for (uint64_t ii = 0; ii < nTxs; ii++) {
-              uint64_t len = UintConv::bytesToUint32(bytes.subspan(idx, 4));
-              idx += 4;
-              txVec.emplace_back(bytes.subspan(idx, len), requiredChainId);
-              idx += len;
-            }
-            return txVec;
-          }
-        );
-        f.emplace_back(std::move(txF));
-
-        // Update offset, skip if this is the last thread
-        if (i >= txsPerThr.size() - 1) continue;
-        for (uint64_t ii = 0; ii < nTxs; ii++) {
-          uint64_t len = UintConv::bytesToUint32(bytes.subspan(thrOff, 4));
-          thrOff += len + 4;
-        }
-      }
-
-      // Wait for asyncs and fill the block tx vector
-      for (int i = 0; i < f.size(); i++) {
-        f[i].wait();
-        for (const TxBlock& tx : f[i].get()) txs.emplace_back(tx);
-      }
+    // Decode the block txs (and recover their senders) in parallel
+    std::vector<std::string> decodeErrors;
+    std::vector<std::optional<TxBlock>> decodedTxs = TxDecoder::shared().decode(rawTxs.txs, requiredChainId, &decodeErrors);
+    txs.reserve(decodedTxs.size());
+    for (uint64_t i = 0; i < decodedTxs.size(); i++) {
+      if (!decodedTxs[i]) throw DynamicException("Invalid block tx at index " + std::to_string(i) + ": " + decodeErrors[i]);
+      txs.emplace_back(std::move(*decodedTxs[i]));
     }
 
     // Deserialize the Validator transactions normally, no need to thread
-    index = txValidatorStart;
-    for (uint64_t i = 0; i < valTxCount; ++i) {
-      uint64_t txSize = UintConv::bytesToUint32(bytes.subspan(index, 4));
-      index += 4;
-      txValidators.emplace_back(bytes.subspan(index, txSize), requiredChainId);
+    txValidators.reserve(rawTxs.txValidators.size());
+    for (const View<Bytes>& rawTx : rawTxs.txValidators) {
+      txValidators.emplace_back(rawTx, requiredChainId);
       if (txValidators.back().getNHeight() != nHeight) {
         SLOGERROR("Invalid validator tx height");
         throw DynamicException("Invalid validator tx height");
       }
-      index += txSize;
     }
 
     // Sanity check the Merkle roots, block randomness and signature
@@ -147,7 +148,7 @@ FinalizedBlock FinalizedBlock::fromBytes(const View<Bytes> bytes, const uint64_t
       std::move(txValidators),
       std::move(txs),
       std::move(hash),
-      bytes.size()
+      rawTxs.size
     };
   } catch (const std::exception &e) {
     SLOGERROR("Error when deserializing a FinalizedBlock: " + std::string(e.what()));
@@ -155,6 +156,98 @@ FinalizedBlock FinalizedBlock::fromBytes(const View<Bytes> bytes, const uint64_t
   }
 }
 
+FinalizedBlock FinalizedBlock::fromTrustedBytes(
+  const View<Bytes> bytes, const View<Bytes> sidecar, const uint64_t&
+) {
+  try {
+    if (bytes.size() < 217) throw std::length_error("Invalid block size - too short");
+    if (sidecar.size() < 65 || (sidecar.size() - 65) % 52 != 0) {
+      throw std::length_error("Invalid block sidecar size");
+    }
+    auto validatorSig = Signature(bytes.subspan(0, 65));
+    auto prevBlockHash = Hash(bytes.subspan(65, 32));
+    auto blockRandomness = Hash(bytes.subspan(97, 32));
+    auto validatorMerkleRoot = Hash(bytes.subspan(129, 32));
+    auto txMerkleRoot = Hash(bytes.subspan(161, 32));
+    uint64_t timestamp = UintConv::bytesToUint64(bytes.subspan(193, 8));
+    uint64_t nHeight = UintConv::bytesToUint64(bytes.subspan(201, 8));
+    UPubKey validatorPubKey(sidecar.subspan(0, 65));
+    RawTxs rawTxs = splitTxs(bytes);
+
+    // Each tx takes its hash and sender from its sidecar entry
+    if ((sidecar.size() - 65) / 52 != rawTxs.txs.size() + rawTxs.txValidators.size()) {
+      throw std::length_error("Block sidecar doesn't have one entry per tx");
+    }
+    uint64_t entry = 0;
+    auto nextEntry = [&]() {
+      const View<Bytes> data = sidecar.subspan(65 + entry++ * 52, 52);
+      return std::make_pair(Hash(data.subspan(0, 32)), Address(data.subspan(32, 20)));
+    };
+
+    std::vector<TxBlock> txs;
+    txs.reserve(rawTxs.txs.size());
+    for (const View<Bytes>& rawTx : rawTxs.txs) {
+      const auto [hash, from] = nextEntry();
+      txs.emplace_back(rawTx, hash, from);
+    }
+
+    std::vector<TxValidator> txValidators;
+    txValidators.reserve(rawTxs.txValidators.size());
+    for (const View<Bytes>& rawTx : rawTxs.txValidators) {
+      const auto [hash, from] = nextEntry();
+      txValidators.emplace_back(rawTx, hash, from);
+      if (txValidators.back().getNHeight() != nHeight) throw DynamicException("Invalid validator tx height");
+    }
+
+    // The header hash is a single Keccak-256, and it's what ties the block to its database key
+    Hash hash = Utils::sha3(bytes.subspan(65, 144));
+    return {
+      std::move(validatorSig),
+      std::move(validatorPubKey),
+      std::move(prevBlockHash),
+      std::move(blockRandomness),
+      std::move(validatorMerkleRoot),
+      std::move(txMerkleRoot),
+      timestamp,
+      nHeight,
+      std::move(txValidators),
+      std::move(txs),
+      std::move(hash),
+      rawTxs.size
+    };
+  } catch (const std::exception &e) {
+    SLOGERROR("Error when deserializing a trusted FinalizedBlock: " + std::string(e.what()));
+    throw std::domain_error(std::string("Error when deserializing a trusted FinalizedBlock: ") + e.what());
+  }
+}
+
+uint64_t FinalizedBlock::getFormat(const View<Bytes> bytes) {
+  if (bytes.size() < 217) throw DynamicException("Invalid block size - too short");
+  return blockFormat(bytes);
+}
+
+View<Bytes> FinalizedBlock::getRawTx(const View<Bytes> bytes, uint64_t txIndex) {
+  if (getFormat(bytes) == formatV2) {
+    // The offset table gives any tx right away
+    if (bytes.size() < 225 || txIndex >= UintConv::bytesToUint32(bytes.subspan(217, 4))) {
+      throw DynamicException("Tx index " + std::to_string(txIndex) + " out of range");
+    }
+    const uint64_t begin = offsetAt(bytes, txIndex), end = offsetAt(bytes, txIndex + 1);
+    if (end < begin || end > bytes.size()) throw DynamicException("Invalid v2 block offset table");
+    return bytes.subspan(begin, end - begin);
+  }
+  // The v1 format has to be walked up to the tx
+  const uint64_t txValidatorStart = UintConv::bytesToUint64(bytes.subspan(209, 8));
+  uint64_t index = 217; // Start of block tx range
+  for (uint64_t currentTx = 0; index < txValidatorStart; currentTx++) {
+    const uint64_t txSize = UintConv::bytesToUint32(bytes.subspan(index, 4));
+    if (index + 4 + txSize > bytes.size()) break;
+    if (currentTx == txIndex) return bytes.subspan(index + 4, txSize);
+    index += txSize + 4;
+  }
+  throw DynamicException("Tx index " + std::to_string(txIndex) + " out of range");
+}
+
 FinalizedBlock FinalizedBlock::createNewValidBlock(
   std::vector<TxBlock>&& txs,
   std::vector<TxValidator>&& txValidators,
@@ -239,3 +332,42 @@ Bytes FinalizedBlock::serializeBlock() const {
   return ret;
 }
 
+Bytes FinalizedBlock::serializeBlockV2() const {
+  std::vector<Bytes> rawTxs;
+  rawTxs.reserve(this->txs_.size() + this->txValidators_.size());
+  for (const auto &tx : this->txs_) rawTxs.emplace_back(tx.rlpSerialize());
+  for (const auto &tx : this->txValidators_) rawTxs.emplace_back(tx.rlpSerialize());
+
+  Bytes ret;
+  ret.reserve(this->size_ + 12);
+  ret.insert(ret.end(), this->validatorSig_.cbegin(), this->validatorSig_.cend());
+  Utils::appendBytes(ret, this->serializeHeader());
+  Utils::appendBytes(ret, UintConv::uint64ToBytes(formatV2));
+  Utils::appendBytes(ret, UintConv::uint32ToBytes(this->txs_.size()));
+  Utils::appendBytes(ret, UintConv::uint32ToBytes(this->txValidators_.size()));
+
+  // Offset table: where each tx starts, then where the last one ends
+  uint64_t offset = 225 + (rawTxs.size() + 1) * 4;
+  for (const Bytes& rawTx : rawTxs) {
+    Utils::appendBytes(ret, UintConv::uint32ToBytes(offset));
+    offset += rawTx.size();
+  }
+  Utils::appendBytes(ret, UintConv::uint32ToBytes(offset));
+  for (const Bytes& rawTx : rawTxs) Utils::appendBytes(ret, rawTx);
+  return ret;
+}
+
+Bytes FinalizedBlock::serializeSidecar() const {
+  Bytes ret;
+  ret.reserve(65 + (this->txs_.size() + this->txValidators_.size()) * 52);
+  ret.insert(ret.end(), this->validatorPubKey_.cbegin(), this->validatorPubKey_.cend());
+  for (const auto &tx : this->txs_) {
+    Utils::appendBytes(ret, tx.hash());
+    Utils::appendBytes(ret, tx.getFrom());
+  }
+  for (const auto &tx : this->txValidators_) {
+    Utils::appendBytes(ret, tx.hash());
+    Utils::appendBytes(ret, tx.getFrom());
+  }
+  return ret;
+}
@@ -34,6 +34,13 @@ class FinalizedBlock {
     Bytes serializeHeader() const;
 
   public:
+    /**
+     * Format version of blocks serialized with serializeBlockV2(). It's stored where the v1 format
+     * has the offset of the Validator txs, which is never lower than 217 (the header's size),
+     * so both formats can be told apart and read by the same storage functions.
+     */
+    static constexpr uint64_t formatV2 = 2;
+
     /**
      * Move Constructor.
      * Only the move constructor is declared, simply because there is no reason
@@ -115,19 +122,80 @@ class FinalizedBlock {
 
     /**
      * Deserialize a given raw bytes string and turn it into a FinalizedBlock.
+     * Only accepts the v1 format (see serializeBlock()), the one blocks travel in over the network.
      * @param bytes The raw bytes string to de-serialize.
      * @param requiredChainId The chain ID to which the block belongs.
      * @return A FinalizedBlock instance.
-     * @throw std::domain_error if deserialization fails for some reason.
+     * @throw std::domain_error if deserialization fails for some reason, or the block is in another format.
      */
     static FinalizedBlock fromBytes(const View<Bytes> bytes, const uint64_t& requiredChainId);
 
+    /**
+     * Deserialize a block read from our own database, with the same checks as fromBytes().
+     * Accepts both the v1 and the v2 formats (see serializeBlock() and serializeBlockV2()).
+     * @param bytes The raw bytes string to de-serialize.
+     * @param requiredChainId The chain ID to which the block belongs.
+     * @return A FinalizedBlock instance.
+     * @throw std::domain_error if deserialization fails for some reason.
+     */
+    static FinalizedBlock fromStorageBytes(const View<Bytes> bytes, const uint64_t& requiredChainId);
+
+    /**
+     * Deserialize a block that was already validated before being stored locally, using
+     * the sidecar produced by serializeSidecar() at the time. Skips all the cryptography
+     * done by fromBytes() (validator signature, tx sender recovery, tx hashing and Merkle roots).
+     * NEVER use this for blocks that come from anywhere else than our own database.
+     * @param bytes The raw bytes string to de-serialize.
+     * @param sidecar The block's sidecar.
+     * @param requiredChainId The chain ID to which the block belongs.
+     * @return A FinalizedBlock instance.
+     * @throw std::domain_error if deserialization fails or the sidecar doesn't match the block.
+     */
+    static FinalizedBlock fromTrustedBytes(
+      const View<Bytes> bytes, const View<Bytes> sidecar, const uint64_t& requiredChainId
+    );
+
     /**
      * Serialize the entire block (including the header) to a raw bytes string.
      * @return The serialized block.
      */
     Bytes serializeBlock() const;
 
+    /**
+     * Serialize the entire block in the v2 format, used for storage. Same as the v1 format up to the
+     * header, then the format version (8 bytes), the number of block txs and of Validator txs (4 bytes each),
+     * a table with the offset of each tx plus the end of the last one (4 bytes each), and the raw txs.
+     * Any tx can then be sliced out without walking the txs before it (see getRawTx()).
+     * @return The serialized block.
+     */
+    Bytes serializeBlockV2() const;
+
+    /**
+     * Get the format of a serialized block.
+     * @param bytes The serialized block.
+     * @return 1 or formatV2 for known formats.
+     * @throw DynamicException if the block is too short.
+     */
+    static uint64_t getFormat(const View<Bytes> bytes);
+
+    /**
+     * Get a raw block tx from a serialized block, in either format, without deserializing the block.
+     * Direct for the v2 format, while the v1 format has to be walked up to the tx.
+     * @param bytes The serialized block.
+     * @param txIndex The index of the tx within the block txs.
+     * @return The raw tx.
+     * @throw DynamicException if the index is out of range.
+     */
+    static View<Bytes> getRawTx(const View<Bytes> bytes, uint64_t txIndex);
+
+    /**
+     * Serialize what fromBytes() has to compute on top of parsing the block, so it can be
+     * loaded back with fromTrustedBytes(): the validator's public key (65 bytes), followed by
+     * the hash and sender (32 + 20 bytes) of each block tx, then of each Validator tx.
+     * @return The serialized sidecar.
+     */
+    Bytes serializeSidecar() const;
+
     /**
      * Create a new valid block given the arguments.
      * `std::move()` MUST be used when passing the txs and txValidators vectors.
@@ -0,0 +1,214 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "keccak.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define KECCAK_SIMD 1
+#endif
+
+#ifdef KECCAK_SIMD
+// The vector helpers are always inlined into the target-specific functions below,
+// so the ABI of passing vectors without AVX enabled never comes into play
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace {
+  constexpr size_t rate = 136; ///< Keccak-256 absorbs 136 bytes (17 lanes) per permutation.
+  constexpr size_t rateLanes = rate / 8; ///< Lanes absorbed per permutation.
+
+  constexpr uint64_t roundConstants[24] = {
+    0x0000000000000001, 0x0000000000008082, 0x800000000000808A, 0x8000000080008000,
+    0x000000000000808B, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
+    0x000000000000008A, 0x0000000000000088, 0x0000000080008009, 0x000000008000000A,
+    0x000000008000808B, 0x800000000000008B, 0x8000000000008089, 0x8000000000008003,
+    0x8000000000008002, 0x8000000000000080, 0x000000000000800A, 0x800000008000000A,
+    0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+  };
+
+  /// Rotation offset of each lane (indexed by x + 5y) in the rho step.
+  constexpr int rotations[25] = {
+     0,  1, 62, 28, 27,
+    36, 44,  6, 55, 20,
+     3, 10, 43, 25, 39,
+    41, 45, 15, 21,  8,
+    18,  2, 61, 56, 14
+  };
+
+  /// Destination of each lane (indexed by x + 5y) in the pi step.
+  constexpr int piLanes[25] = {
+     0, 10, 20,  5, 15,
+    16,  1, 11, 21,  6,
+     7, 17,  2, 12, 22,
+    23,  8, 18,  3, 13,
+    14, 24,  9, 19,  4
+  };
+
+  using Lanes4 = uint64_t __attribute__((vector_size(32)));
+  using Lanes8 = uint64_t __attribute__((vector_size(64)));
+
+  /// Rotate every lane left. Works both for plain integers and for GCC vectors.
+  template <typename V> [[gnu::always_inline]] inline V rotl(const V& v, int n) {
+    return (v << n) | (v >> ((64 - n) & 63));
+  }
+
+  /// Keccak-f[1600] on one independent state per vector lane.
+  template <typename V> [[gnu::always_inline]] inline void permute(V (&a)[25]) {
+    for (int round = 0; round < 24; ++round) {
+      // Theta
+      V c[5];
+      for (int x = 0; x < 5; ++x) c[x] = a[x] ^ a[x + 5] ^ a[x + 10] ^ a[x + 15] ^ a[x + 20];
+      for (int x = 0; x < 5; ++x) {
+        const V d = c[(x + 4) % 5] ^ rotl(c[(x + 1) % 5], 1);
+        for (int y = 0; y < 25; y += 5) a[x + y] ^= d;
+      }
+      // Rho and pi
+      V b[25];
+      for (int i = 0; i < 25; ++i) b[piLanes[i]] = rotl(a[i], rotations[i]);
+      // Chi
+      for (int y = 0; y < 25; y += 5) {
+        for (int x = 0; x < 5; ++x) a[x + y] = b[x + y] ^ (~b[(x + 1) % 5 + y] & b[(x + 2) % 5 + y]);
+      }
+      // Iota
+      a[0] ^= roundConstants[round];
+    }
+  }
+
+  /// Number of permutations needed to absorb an input of the given size, padding included.
+  size_t blockCount(size_t size) { return size / rate + 1; }
+
+  /// Read the `lane`-th 64-bit word of the padded input (Ethereum Keccak padding, 0x01 ... 0x80).
+  uint64_t paddedWord(const View<Bytes>& input, size_t lane) {
+    const size_t offset = lane * 8;
+    uint64_t word = 0;
+    if (offset + 8 <= input.size()) {
+      std::memcpy(&word, input.data() + offset, 8);
+      return word;
+    }
+    const size_t last = blockCount(input.size()) * rate - 1;
+    for (size_t i = 0; i < 8; ++i) {
+      const size_t pos = offset + i;
+      uint64_t byte = (pos < input.size()) ? input[pos] : 0;
+      if (pos == input.size()) byte ^= 0x01;
+      if (pos == last) byte ^= 0x80;
+      word |= byte << (8 * i);
+    }
+    return word;
+  }
+
+  /**
+   * Hash a group of up to `N` inputs, one per vector lane.
+   * Inputs may need different numbers of permutations: lanes whose input is fully
+   * absorbed stop taking data, and their hash is taken right after their last block.
+   */
+  template <typename V, size_t N> [[gnu::always_inline]] inline void hashGroup(
+    const View<Bytes>* const* inputs, Hash* const* outputs, size_t count
+  ) {
+    size_t blocks[N] = {};
+    size_t maxBlocks = 0;
+    for (size_t j = 0; j < count; ++j) {
+      blocks[j] = blockCount(inputs[j]->size());
+      maxBlocks = std::max(maxBlocks, blocks[j]);
+    }
+    V a[25] = {};
+    for (size_t block = 0; block < maxBlocks; ++block) {
+      for (size_t lane = 0; lane < rateLanes; ++lane) {
+        V words = {};
+        for (size_t j = 0; j < count; ++j) {
+          if (block < blocks[j]) words[j] = paddedWord(*inputs[j], block * rateLanes + lane);
+        }
+        a[lane] ^= words;
+      }
+      permute(a);
+      for (size_t j = 0; j < count; ++j) {
+        if (blocks[j] != block + 1) continue;
+        for (size_t lane = 0; lane < 4; ++lane) {
+          const uint64_t word = a[lane][j];
+          std::memcpy(outputs[j]->begin() + lane * 8, &word, 8);
+        }
+      }
+    }
+  }
+
+  /// Hash all inputs in groups of `N`, grouping inputs of similar size so lanes finish together.
+  template <typename V, size_t N> [[gnu::always_inline]] inline void hashAll(
+    std::span<const View<Bytes>> inputs, std::span<Hash> outputs
+  ) {
+    // Batches of same-sized inputs (e.g. Merkle nodes) are already grouped, and are hashed
+    // without allocating. Only batches of mixed sizes are reordered
+    bool grouped = true;
+    for (size_t i = 1; i < inputs.size() && grouped; ++i) {
+      grouped = blockCount(inputs[i - 1].size()) <= blockCount(inputs[i].size());
+    }
+    std::vector<size_t> order;
+    if (!grouped) {
+      order.resize(inputs.size());
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(), [&](size_t l, size_t r) {
+        return blockCount(inputs[l].size()) < blockCount(inputs[r].size());
+      });
+    }
+    for (size_t first = 0; first < inputs.size(); first += N) {
+      const size_t count = std::min(N, inputs.size() - first);
+      const View<Bytes>* groupInputs[N];
+      Hash* groupOutputs[N];
+      for (size_t j = 0; j < count; ++j) {
+        const size_t index = grouped ? first + j : order[first + j];
+        groupInputs[j] = &inputs[index];
+        groupOutputs[j] = &outputs[index];
+      }
+      hashGroup<V, N>(groupInputs, groupOutputs, count);
+    }
+  }
+
+  __attribute__((target("avx2")))
+  void hashAllAvx2(std::span<const View<Bytes>> inputs, std::span<Hash> outputs) {
+    hashAll<Lanes4, 4>(inputs, outputs);
+  }
+
+  __attribute__((target("avx512f")))
+  void hashAllAvx512(std::span<const View<Bytes>> inputs, std::span<Hash> outputs) {
+    hashAll<Lanes8, 8>(inputs, outputs);
+  }
+}
+#endif
+
+Keccak::Impl Keccak::bestImpl() {
+#ifdef KECCAK_SIMD
+  static const Impl impl = []() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return Impl::AVX512;
+    if (__builtin_cpu_supports("avx2")) return Impl::AVX2;
+    return Impl::SCALAR;
+  }();
+  return impl;
+#else
+  return Impl::SCALAR;
+#endif
+}
+
+void Keccak::hash256(std::span<const View<Bytes>> inputs, std::span<Hash> outputs, Impl impl) {
+  impl = std::min(impl, bestImpl());
+  // A lone input gains nothing from vector lanes
+  if (inputs.size() < 2) impl = Impl::SCALAR;
+  switch (impl) {
+#ifdef KECCAK_SIMD
+    case Impl::AVX512: hashAllAvx512(inputs, outputs); break;
+    case Impl::AVX2: hashAllAvx2(inputs, outputs); break;
+#endif
+    default: for (size_t i = 0; i < inputs.size(); ++i) outputs[i] = Utils::sha3(inputs[i]); break;
+  }
+}
+
+std::vector<Hash> Keccak::hash256(std::span<const View<Bytes>> inputs) {
+  std::vector<Hash> ret(inputs.size());
+  hash256(inputs, ret);
+  return ret;
+}
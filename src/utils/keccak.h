@@ -0,0 +1,51 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef KECCAK_H
+#define KECCAK_H
+
+#include <span>
+
+#include "utils.h"
+
+/**
+ * Namespace for batched Keccak-256 hashing.
+ * Hashing many small inputs one at a time (Merkle tree nodes, transaction bytes) leaves most
+ * of the CPU's vector units idle, since the Keccak-f permutation works on 64-bit lanes.
+ * The functions here run the permutation for 4 (AVX2) or 8 (AVX-512) inputs at once,
+ * one input per vector lane, picking the widest implementation the CPU supports at runtime.
+ * Results are always the same as calling Utils::sha3() on each input.
+ */
+namespace Keccak {
+  /// Implementations of the batched hash, from narrowest to widest.
+  enum class Impl {
+    SCALAR, ///< One input at a time, through Utils::sha3().
+    AVX2,   ///< Four inputs at a time, in 256-bit vectors.
+    AVX512  ///< Eight inputs at a time, in 512-bit vectors.
+  };
+
+  /// Get the widest implementation supported by the running CPU. Detected once and cached.
+  Impl bestImpl();
+
+  /**
+   * Hash a batch of inputs with Keccak-256.
+   * @param inputs The inputs to hash.
+   * @param outputs Where to write the hashes, one per input, in the same order.
+   *                Must be at least as large as `inputs`.
+   * @param impl The implementation to use. Falls back to bestImpl() if the CPU does not support it.
+   */
+  void hash256(std::span<const View<Bytes>> inputs, std::span<Hash> outputs, Impl impl = bestImpl());
+
+  /**
+   * Hash a batch of inputs with Keccak-256.
+   * @param inputs The inputs to hash.
+   * @return The hashes, one per input, in the same order.
+   */
+  std::vector<Hash> hash256(std::span<const View<Bytes>> inputs);
+}
+
+#endif // KECCAK_H
@@ -7,47 +7,110 @@ See the LICENSE.txt file in the project root for more information.
 
 #include "merkle.h"
 
-std::vector<Hash> Merkle::newLayer(const std::vector<Hash>& layer) const {
-  std::vector<Hash> ret;
-  for (uint64_t i = 0; i < layer.size(); i += 2) ret.emplace_back((
-    (i + 1 < layer.size())
-      ? Utils::sha3(
-        // Lambda to concatenate
-        Bytes([&]() {
-          return Utils::makeBytes(bytes::join(
-            std::min(layer[i], layer[i + 1]),
-            std::max(layer[i], layer[i + 1])
-          ));
-        }()
-      ))
-      : layer[i]
-  ));
-  return ret;
+#include <future>
+#include <thread>
+
+#include "keccak.h"
+
+namespace {
+  /// Nodes staged on the stack and hashed per Keccak::hash256() call.
+  constexpr size_t batchSize = 64;
+
+  /// Layers with fewer nodes than this per extra thread are hashed by the calling thread alone.
+  constexpr size_t minNodesPerThread = 2048;
+
+  /**
+   * Hash a range of nodes of a layer, without allocating.
+   * @param begin, end The range of nodes to hash.
+   * @param out Where the layer's hashes go.
+   * @param input Function that writes the bytes to hash for a node in a 64-byte scratch buffer
+   *              and returns a view of them.
+   */
+  template <typename Input> void hashRange(size_t begin, size_t end, Hash* out, const Input& input) {
+    std::array<Byte, batchSize * 64> scratch;
+    std::array<View<Bytes>, batchSize> views;
+    for (size_t first = begin; first < end; first += batchSize) {
+      const size_t count = std::min(batchSize, end - first);
+      for (size_t i = 0; i < count; ++i) views[i] = input(first + i, scratch.data() + (i * 64));
+      Keccak::hash256(std::span(views).first(count), std::span(out + first, count));
+    }
+  }
+
+  /// Hash a whole layer, splitting it between threads if it is large enough to pay off.
+  template <typename Input> void hashLayer(size_t count, Hash* out, const Input& input) {
+    const size_t threads = std::min<size_t>(std::thread::hardware_concurrency(), count / minNodesPerThread);
+    if (threads < 2) return hashRange(0, count, out, input);
+    const size_t perThread = (count + threads - 1) / threads;
+    std::vector<std::future<void>> helpers;
+    helpers.reserve(threads - 1);
+    for (size_t begin = perThread; begin < count; begin += perThread) {
+      helpers.emplace_back(std::async(std::launch::async, [&, begin]() {
+        hashRange(begin, std::min(count, begin + perThread), out, input);
+      }));
+    }
+    hashRange(0, perThread, out, input);
+    for (auto& helper : helpers) helper.get();
+  }
 }
 
-Merkle::Merkle(const std::vector<Hash>& leaves) {
-  // Mount the base leaves
-  std::vector<Hash> tmp;
-  for (const Hash& leaf : leaves) {
-    Hash leafHash = Utils::sha3(leaf);
-    tmp.emplace_back(std::move(leafHash));
+void Merkle::allocate(size_t leafCount) {
+  // The leaf layer is always there, even if empty, so layer(0) is valid for any tree
+  this->layers_ = {0, leafCount};
+  for (size_t size = leafCount; size > 1;) {
+    size = (size + 1) / 2;
+    this->layers_.emplace_back(this->layers_.back() + size);
   }
-  this->tree_.emplace_back(tmp);
-  // Make the layers up to root
-  while (this->tree_.back().size() > 1) this->tree_.emplace_back(newLayer(this->tree_.back()));
+  this->nodes_.resize(this->layers_.back());
+}
+
+void Merkle::build() {
+  if (this->nodes_.empty()) return;
+  // Leaves are hashed in place, each one is staged in the scratch buffer before being overwritten
+  Hash* leaves = this->nodes_.data();
+  hashLayer(this->layers_[1], leaves, [leaves](size_t i, Byte* scratch) {
+    std::ranges::copy(leaves[i], scratch);
+    return View<Bytes>(scratch, 32);
+  });
+  // Each parent is the hash of its children sorted and concatenated, an odd node out goes up as is
+  for (size_t i = 1; i + 1 < this->layers_.size(); ++i) {
+    const Hash* children = this->nodes_.data() + this->layers_[i - 1];
+    const size_t childCount = this->layers_[i] - this->layers_[i - 1];
+    Hash* parents = this->nodes_.data() + this->layers_[i];
+    hashLayer(childCount / 2, parents, [children](size_t j, Byte* scratch) {
+      const Hash& left = children[2 * j];
+      const Hash& right = children[2 * j + 1];
+      std::ranges::copy(std::min(left, right), scratch);
+      std::ranges::copy(std::max(left, right), scratch + 32);
+      return View<Bytes>(scratch, 64);
+    });
+    if (childCount % 2 != 0) parents[childCount / 2] = children[childCount - 1];
+  }
+}
+
+Merkle::Merkle(const std::vector<Hash>& leaves) {
+  this->allocate(leaves.size());
+  std::ranges::copy(leaves, this->nodes_.begin());
+  this->build();
+}
+
+std::vector<std::span<const Hash>> Merkle::getTree() const {
+  std::vector<std::span<const Hash>> ret;
+  for (size_t i = 0; i + 1 < this->layers_.size(); ++i) ret.emplace_back(this->layer(i));
+  return ret;
 }
 
 std::vector<Hash> Merkle::getProof(const uint64_t leafIndex) const {
-  if (leafIndex > this->tree_.front().size() - 1) return {};
+  if (leafIndex >= this->getLeaves().size()) return {};
   std::vector<Hash> ret;
   uint64_t pos = leafIndex;
   // Check if left (even) or right (odd) child, pick its sibling,
-  // move to the next layer, repeat until root layer then skip it
-  for (std::vector<Hash> layer : this->tree_) {
-    if (layer.size() == 1) break;
-    pos = (pos % 2 == 0) ? pos + 1 : pos - 1;
-    ret.push_back(layer[pos]);
-    pos = std::ceil(pos / 2);
+  // move to the next layer, repeat until root layer then skip it.
+  // An odd node out has no sibling, it goes up as is
+  for (size_t i = 0; i + 2 < this->layers_.size(); ++i) {
+    const std::span<const Hash> nodes = this->layer(i);
+    const uint64_t sibling = (pos % 2 == 0) ? pos + 1 : pos - 1;
+    if (sibling < nodes.size()) ret.push_back(nodes[sibling]);
+    pos /= 2;
   }
   return ret;
 }
@@ -8,6 +8,8 @@ See the LICENSE.txt file in the project root for more information.
 #ifndef MERKLE_H
 #define MERKLE_H
 
+#include <span>
+
 #include "tx.h" // ecdsa.h -> utils.h -> strings.h, bytes/join.h
 
 /**
@@ -17,14 +19,30 @@ See the LICENSE.txt file in the project root for more information.
  */
 class Merkle {
   private:
-    std::vector<std::vector<Hash>> tree_;  ///< The %Merkle tree itself.
+    /**
+     * Every node of the %Merkle tree, one layer after the other, from the leaves up to the root.
+     * Allocated once, with the size of the whole tree, before any hashing is done.
+     */
+    std::vector<Hash> nodes_;
+    std::vector<size_t> layers_; ///< Offset of each layer in `nodes_`, plus the end of the last one.
+
+    /**
+     * Allocate `nodes_` and `layers_` for a tree with the given number of leaves.
+     * @param leafCount The number of leaves.
+     */
+    void allocate(size_t leafCount);
+
+    /// Hash the leaves written to the first layer in place, then every layer up to the root.
+    void build();
 
     /**
-     * Insert a new layer in the %Merkle tree.
-     * @param layer The list of hashes to convert into a layer.
-     * @return The newly created layer.
+     * Get one of the layers of the tree.
+     * @param index The index of the layer, starting from the leaves.
+     * @return A view of the layer's nodes.
      */
-    std::vector<Hash> newLayer(const std::vector<Hash>& layer) const;
+    std::span<const Hash> layer(size_t index) const {
+      return std::span(this->nodes_).subspan(this->layers_[index], this->layers_[index + 1] - this->layers_[index]);
+    }
 
   public:
     /**
@@ -39,25 +57,22 @@ class Merkle {
      * @param txs The list of transactions to create the %Merkle tree from.
      */
     template <typename TxType> explicit Merkle(const std::vector<TxType>& txs) {
-      // Mount the base leaves
-      std::vector<Hash> tmp;
-      for (auto tx : txs) tmp.emplace_back(Utils::sha3(tx.hash()));
-      this->tree_.emplace_back(tmp);
-      // Make the layers up to root
-      while (this->tree_.back().size() > 1) this->tree_.emplace_back(newLayer(this->tree_.back()));
+      this->allocate(txs.size());
+      for (size_t i = 0; i < txs.size(); ++i) this->nodes_[i] = txs[i].hash();
+      this->build();
     }
 
-    /// Getter for `tree_`.
-    inline const std::vector<std::vector<Hash>>& getTree() const { return this->tree_; }
+    /// Getter for the tree, as a list of views of each layer, from the leaves up to the root.
+    std::vector<std::span<const Hash>> getTree() const;
 
-    /// Getter for `tree_`, but returns only the root.
+    /// Getter for the tree, but returns only the root.
     inline Hash getRoot() const {
-      if (this->tree_.back().size() == 0) return Hash();
-      return this->tree_.back().front();
+      if (this->nodes_.empty()) return Hash();
+      return this->nodes_.back();
     }
 
-    /// Getter for `tree_`, but returns only the leaves.
-    inline const std::vector<Hash>& getLeaves() const { return this->tree_.front(); }
+    /// Getter for the tree, but returns only the leaves.
+    inline std::span<const Hash> getLeaves() const { return this->layer(0); }
 
     /**
      * Get the proof for a given leaf in the %Merkle tree.
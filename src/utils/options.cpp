@@ -7,6 +7,7 @@ See the LICENSE.txt file in the project root for more information.
 
 #include "options.h"
 
+#include "db.h"
 #include "dynamicexception.h"
 
 IndexingMode::IndexingMode(std::string_view mode) {
@@ -213,6 +214,214 @@ std::unique_ptr<std::string> Options::getRPCAdminPassword() const {
   return password;
 }
 
+bool Options::getParallelExecution() const {
+  // Optional setting, stored within the options.json as "parallelExecution".
+  // Disabled by default so block execution stays strictly sequential unless requested.
+  json options;
+  std::ifstream i(this->rootPath_ + "/options.json");
+  i >> options;
+  i.close();
+  if (options.contains("parallelExecution") && options.at("parallelExecution").is_boolean()) {
+    return options["parallelExecution"].get<bool>();
+  }
+  return false;
+}
+
+EvmInterpreter Options::getEvmInterpreter() const {
+  // Optional setting, stored within the options.json as "evmInterpreter" ("baseline" or "advanced").
+  json options;
+  std::ifstream i(this->rootPath_ + "/options.json");
+  i >> options;
+  i.close();
+  if (!options.contains("evmInterpreter") || !options.at("evmInterpreter").is_string()) {
+    return EvmInterpreter::BASELINE;
+  }
+  const std::string interpreter = options["evmInterpreter"].get<std::string>();
+  if (interpreter == "baseline") return EvmInterpreter::BASELINE;
+  if (interpreter == "advanced") return EvmInterpreter::ADVANCED;
+  throw DynamicException("Invalid EVM interpreter value: \"" + interpreter + "\"");
+}
+
+uint64_t Options::getEvmCodeCacheSize() const {
+  // Optional setting, stored within the options.json as "evmCodeCacheSize".
+  // Number of analyzed EVM contracts kept in memory, 0 disables the cache.
+  json options;
+  std::ifstream i(this->rootPath_ + "/options.json");
+  i >> options;
+  i.close();
+  if (options.contains("evmCodeCacheSize") && options.at("evmCodeCacheSize").is_number_unsigned()) {
+    return options["evmCodeCacheSize"].get<uint64_t>();
+  }
+  return 1024;
+}
+
+uint64_t Options::getMempoolMaxTxs() const {
+  // Optional setting, stored within the options.json as "mempoolMaxTxs".
+  // Once the mempool is full, cheaper transactions are evicted to make room for better paying ones.
+  json options;
+  std::ifstream i(this->rootPath_ + "/options.json");
+  i >> options;
+  i.close();
+  if (options.contains("mempoolMaxTxs") && options.at("mempoolMaxTxs").is_number_unsigned()) {
+    return options["mempoolMaxTxs"].get<uint64_t>();
+  }
+  return 16384;
+}
+
+uint64_t Options::getMempoolMaxTxsPerSender() const {
+  // Optional setting, stored within the options.json as "mempoolMaxTxsPerSender".
+  // Maximum number of transactions a single sender can have in the mempool.
+  json options;
+  std::ifstream i(this->rootPath_ + "/options.json");
+  i >> options;
+  i.close();
+  if (options.contains("mempoolMaxTxsPerSender") && options.at("mempoolMaxTxsPerSender").is_number_unsigned()) {
+    return options["mempoolMaxTxsPerSender"].get<uint64_t>();
+  }
+  return 64;
+}
+
+uint64_t Options::getMempoolMaxNonceGap() const {
+  // Optional setting, stored within the options.json as "mempoolMaxNonceGap".
+  // How far ahead of the account nonce a transaction can be to be kept in the mempool.
+  json options;
+  std::ifstream i(this->rootPath_ + "/options.json");
+  i >> options;
+  i.close();
+  if (options.contains("mempoolMaxNonceGap") && options.at("mempoolMaxNonceGap").is_number_unsigned()) {
+    return options["mempoolMaxNonceGap"].get<uint64_t>();
+  }
+  return 64;
+}
+
+uint64_t Options::getBlockGasLimit() const {
+  // Optional setting, stored within the options.json as "blockGasLimit".
+  // Maximum sum of the gas limits of the transactions a validator puts in a block.
+  json options;
+  std::ifstream i(this->rootPath_ + "/options.json");
+  i >> options;
+  i.close();
+  if (options.contains("blockGasLimit") && options.at("blockGasLimit").is_number_unsigned()) {
+    return options["blockGasLimit"].get<uint64_t>();
+  }
+  return 30000000;
+}
+
+uint64_t Options::getBlockMaxBytes() const {
+  // Optional setting, stored within the options.json as "blockMaxBytes".
+  // Maximum sum of the serialized sizes of the transactions a validator puts in a block.
+  json options;
+  std::ifstream i(this->rootPath_ + "/options.json");
+  i >> options;
+  i.close();
+  if (options.contains("blockMaxBytes") && options.at("blockMaxBytes").is_number_unsigned()) {
+    return options["blockMaxBytes"].get<uint64_t>();
+  }
+  return 8388608;
+}
+
+uint64_t Options::getBlockBuildTimeMs() const {
+  // Optional setting, stored within the options.json as "blockBuildTimeMs".
+  // Time a validator can spend selecting the transactions of a block, in milliseconds.
+  json options;
+  std::ifstream i(this->rootPath_ + "/options.json");
+  i >> options;
+  i.close();
+  if (options.contains("blockBuildTimeMs") && options.at("blockBuildTimeMs").is_number_unsigned()) {
+    return options["blockBuildTimeMs"].get<uint64_t>();
+  }
+  return 100;
+}
+
+DBSettings Options::getDBSettings() const {
+  // Optional setting, stored within the options.json as "db".
+  // Block cache size and bloom filter bits shared by all column families, plus each
+  // family's compression ("none", "lz4" or "zstd") and compaction ("level" or "universal"),
+  // and optionally its compression level and ZSTD dictionary sizes, in bytes.
+  json options;
+  std::ifstream i(this->rootPath_ + "/options.json");
+  i >> options;
+  i.close();
+  DBSettings settings;
+  if (!options.contains("db") || !options.at("db").is_object()) return settings;
+  const json& db = options.at("db");
+  if (db.contains("blockCacheSize") && db.at("blockCacheSize").is_number_unsigned()) {
+    settings.blockCacheSize = db.at("blockCacheSize").get<uint64_t>();
+  }
+  if (db.contains("bloomBitsPerKey") && db.at("bloomBitsPerKey").is_number_unsigned()) {
+    settings.bloomBitsPerKey = db.at("bloomBitsPerKey").get<uint32_t>();
+  }
+  if (!db.contains("families") || !db.at("families").is_object()) return settings;
+  for (const auto& item : db.at("families").items()) {
+    const json& family = item.value();
+    DBSettings::Family& ret = settings.families[item.key()];
+    if (family.contains("compression") && family.at("compression").is_string()) {
+      const std::string compression = family.at("compression").get<std::string>();
+      if (compression == "none") ret.compression = DBSettings::Compression::NONE;
+      else if (compression == "lz4") ret.compression = DBSettings::Compression::LZ4;
+      else if (compression == "zstd") ret.compression = DBSettings::Compression::ZSTD;
+      else throw DynamicException("Invalid DB compression value: \"" + compression + "\"");
+    }
+    if (family.contains("compaction") && family.at("compaction").is_string()) {
+      const std::string compaction = family.at("compaction").get<std::string>();
+      if (compaction == "level") ret.compaction = DBSettings::Compaction::LEVEL;
+      else if (compaction == "universal") ret.compaction = DBSettings::Compaction::UNIVERSAL;
+      else throw DynamicException("Invalid DB compaction value: \"" + compaction + "\"");
+    }
+    if (family.contains("compressionLevel") && family.at("compressionLevel").is_number_integer()) {
+      ret.compressionLevel = family.at("compressionLevel").get<int>();
+    }
+    if (family.contains("dictionaryBytes") && family.at("dictionaryBytes").is_number_unsigned()) {
+      ret.dictionaryBytes = family.at("dictionaryBytes").get<uint32_t>();
+    }
+    if (family.contains("dictionaryTrainBytes") && family.at("dictionaryTrainBytes").is_number_unsigned()) {
+      ret.dictionaryTrainBytes = family.at("dictionaryTrainBytes").get<uint64_t>();
+    }
+    if (ret.dictionaryBytes != 0 && ret.compression != DBSettings::Compression::ZSTD) {
+      throw DynamicException("DB compression dictionaries require \"zstd\" compression");
+    }
+  }
+  return settings;
+}
+
+uint64_t Options::getBlockCacheBytes() const {
+  // Optional setting, stored within the options.json as "blockCacheBytes".
+  // Total serialized size of the decoded blocks Storage keeps in memory, 0 disables it.
+  json options;
+  std::ifstream i(this->rootPath_ + "/options.json");
+  i >> options;
+  i.close();
+  if (options.contains("blockCacheBytes") && options.at("blockCacheBytes").is_number_unsigned()) {
+    return options["blockCacheBytes"].get<uint64_t>();
+  }
+  return 268435456;
+}
+
+uint64_t Options::getColdBlockDepth() const {
+  // Optional setting, stored within the options.json as "coldBlockDepth".
+  // Blocks this far behind the latest one are moved out of the database into block segments, 0 disables it.
+  json options;
+  std::ifstream i(this->rootPath_ + "/options.json");
+  i >> options;
+  i.close();
+  if (options.contains("coldBlockDepth") && options.at("coldBlockDepth").is_number_unsigned()) {
+    return options["coldBlockDepth"].get<uint64_t>();
+  }
+  return 0;
+}
+
+uint64_t Options::getColdSegmentBlocks() const {
+  // Optional setting, stored within the options.json as "coldSegmentBlocks".
+  // Number of blocks in each block segment, can't be changed once segments were written.
+  json options;
+  std::ifstream i(this->rootPath_ + "/options.json");
+  i >> options;
+  i.close();
+  if (options.contains("coldSegmentBlocks") && options.at("coldSegmentBlocks").is_number_unsigned()) {
+    return options["coldSegmentBlocks"].get<uint64_t>();
+  }
+  return 8192;
+}
 
 Options Options::fromFile(const std::string& rootPath) {
   try {
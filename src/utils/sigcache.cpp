@@ -0,0 +1,54 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "sigcache.h"
+
+SigCache::SigCache(size_t capacity)
+  : shardCapacity_(std::max<size_t>(1, capacity / shardCount_))
+{}
+
+SigCache& SigCache::shared() {
+  // Enough for several full mempools and the blocks being synced at the same time
+  static SigCache cache(1 << 18);
+  return cache;
+}
+
+std::optional<SigCache::Entry> SigCache::get(const Hash& key) const {
+  const Shard& shard = this->shardFor(key);
+  std::lock_guard lock(shard.mutex);
+  auto it = shard.entries.find(key);
+  if (it == shard.entries.end()) return std::nullopt;
+  return it->second;
+}
+
+void SigCache::put(const Hash& key, const Entry& entry) {
+  Shard& shard = this->shardFor(key);
+  std::lock_guard lock(shard.mutex);
+  if (!shard.entries.try_emplace(key, entry).second) return;
+  shard.order.emplace_back(key);
+  if (shard.order.size() > this->shardCapacity_) {
+    shard.entries.erase(shard.order.front());
+    shard.order.pop_front();
+  }
+}
+
+size_t SigCache::size() const {
+  size_t total = 0;
+  for (const Shard& shard : this->shards_) {
+    std::lock_guard lock(shard.mutex);
+    total += shard.entries.size();
+  }
+  return total;
+}
+
+void SigCache::clear() {
+  for (Shard& shard : this->shards_) {
+    std::lock_guard lock(shard.mutex);
+    shard.entries.clear();
+    shard.order.clear();
+  }
+}
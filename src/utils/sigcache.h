@@ -0,0 +1,83 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef SIGCACHE_H
+#define SIGCACHE_H
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+#include <boost/unordered/unordered_flat_map.hpp>
+
+#include "safehash.h" // tx.h -> ecdsa.h -> utils.h -> strings.h
+
+/**
+ * Bounded, thread-safe cache of transaction signature checks.
+ * The same transaction is usually decoded several times (when it arrives through RPC,
+ * when peers broadcast it, and when the block holding it is decoded and loaded from storage),
+ * and recovering its sender from the signature is by far the most expensive part of decoding it.
+ * Entries are keyed by the hash of the raw signed transaction, so a hit can only come from
+ * the exact same bytes, and hold the recovered sender or the fact that the signature is invalid.
+ * The cache is split in shards with their own locks, each evicting its oldest entries once full.
+ */
+class SigCache {
+  public:
+    /// Result of a previous signature check.
+    struct Entry {
+      Address from; ///< The recovered sender. Empty if the signature is invalid.
+      bool valid;   ///< Whether the signature is valid.
+    };
+
+    /**
+     * Constructor.
+     * @param capacity Maximum number of entries held by the cache, split evenly among the shards.
+     */
+    explicit SigCache(size_t capacity);
+
+    /// Get the process-wide cache used by the transaction constructors.
+    static SigCache& shared();
+
+    /**
+     * Look up a previous signature check.
+     * @param key The hash of the raw signed transaction.
+     * @return The cached result, or an empty optional if there is none.
+     */
+    std::optional<Entry> get(const Hash& key) const;
+
+    /**
+     * Record the result of a signature check. Does nothing if the key is already cached.
+     * @param key The hash of the raw signed transaction.
+     * @param entry The result of the check.
+     */
+    void put(const Hash& key, const Entry& entry);
+
+    /// Get the number of cached entries.
+    size_t size() const;
+
+    /// Remove all cached entries.
+    void clear();
+
+  private:
+    /// A slice of the cache with its own lock and eviction order.
+    struct Shard {
+      mutable std::mutex mutex; ///< Mutex for managing read/write access to the shard.
+      boost::unordered_flat_map<Hash, Entry, SafeHash, SafeCompare> entries; ///< Cached entries.
+      std::deque<Hash> order; ///< Cached keys, oldest first.
+    };
+
+    static constexpr size_t shardCount_ = 16; ///< Number of shards. Must be a power of two.
+    const size_t shardCapacity_; ///< Maximum number of entries per shard.
+    std::array<Shard, shardCount_> shards_; ///< The shards.
+
+    /// Get the shard responsible for a key. Keys are hashes, so any of their bytes is evenly spread.
+    Shard& shardFor(const Hash& key) { return this->shards_[key[0] & (shardCount_ - 1)]; }
+    const Shard& shardFor(const Hash& key) const { return this->shards_[key[0] & (shardCount_ - 1)]; }
+};
+
+#endif // SIGCACHE_H
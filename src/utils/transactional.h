@@ -45,33 +45,6 @@ private:
   Revert revert_;
 };
 
-class AnyTransactional {
-public:
-  template<typename T>
-  explicit AnyTransactional(T transactional) : impl_(std::make_unique<Derived<T>>(std::move(transactional))) {}
-
-  void commit() { impl_->commit(); }
-
-  void revert() { impl_->revert(); }
-
-private:
-  struct Base {
-    virtual ~Base() = default;
-    virtual void commit() = 0;
-    virtual void revert() = 0;
-  };
-
-  template<typename T>
-  struct Derived : Base {
-    explicit Derived(T impl) : impl_(std::move(impl)) {}
-    void commit() override { impl_.commit(); }
-    void revert() override { impl_.revert(); }
-    T impl_;
-  };
-
-  std::unique_ptr<Base> impl_;
-};
-
 template<typename... Ts>
 class Group {
 public:
@@ -9,8 +9,50 @@ See the LICENSE.txt file in the project root for more information.
 #include "bytes/cast.h"
 #include "dynamicexception.h"
 #include "evmcconv.h"
+#include "sigcache.h"
 
-TxBlock::TxBlock(const View<Bytes> bytes, const uint64_t&) {
+TxBlock::TxBlock(const View<Bytes> bytes, const uint64_t& requiredChainId)
+  : TxBlock(bytes, requiredChainId, Utils::sha3(bytes))
+{}
+
+TxBlock::TxBlock(const View<Bytes> bytes, const uint64_t&, const Hash& rawHash) {
+  this->parse(bytes);
+
+  // Skip signature validation if these exact bytes were already checked
+  if (const auto cached = SigCache::shared().get(rawHash)) {
+    if (!cached->valid) throw DynamicException("Invalid tx signature - cannot recover public key");
+    this->from_ = cached->from;
+    this->hash_ = rawHash;
+    return;
+  }
+
+  // Validate signature
+  if (!Secp256k1::verifySig(this->r_, this->s_, this->v_)) {
+    throw DynamicException("Invalid tx signature - doesn't fit elliptic curve verification");
+  }
+  Signature sig = Secp256k1::makeSig(this->r_, this->s_, this->v_);
+  Hash msgHash = Utils::sha3(this->rlpSerialize(false)); // Do not include signature in hash
+  UPubKey key = Secp256k1::recover(sig, msgHash);
+  if (!key) {
+    SigCache::shared().put(rawHash, {Address(), false});
+    throw DynamicException("Invalid tx signature - cannot recover public key");
+  }
+  this->from_ = Secp256k1::toAddress(key);
+  // Include signature in hash. A canonical encoding is the raw bytes themselves, already hashed
+  const Bytes serialized = this->rlpSerialize(true);
+  const bool canonical = std::ranges::equal(serialized, bytes);
+  this->hash_ = canonical ? rawHash : Utils::sha3(serialized);
+  // Only cache canonical encodings, so a hit can reuse the raw hash as the tx hash
+  if (canonical) SigCache::shared().put(rawHash, {this->from_, true});
+}
+
+TxBlock::TxBlock(const View<Bytes> bytes, const Hash& hash, const Address& from) {
+  this->parse(bytes);
+  this->from_ = from;
+  this->hash_ = hash;
+}
+
+void TxBlock::parse(const View<Bytes> bytes) {
   uint64_t index = 0;
   View<Bytes> txData = bytes.subspan(1);
 
@@ -42,17 +84,6 @@ TxBlock::TxBlock(const View<Bytes> bytes, const uint64_t&) {
   this->parseData(txData, index);
   this->parseAccessList(txData, index);
   this->parseVRS(txData, index);
-
-  // Validate signature
-  if (!Secp256k1::verifySig(this->r_, this->s_, this->v_)) {
-    throw DynamicException("Invalid tx signature - doesn't fit elliptic curve verification");
-  }
-  Signature sig = Secp256k1::makeSig(this->r_, this->s_, this->v_);
-  Hash msgHash = Utils::sha3(this->rlpSerialize(false)); // Do not include signature in hash
-  UPubKey key = Secp256k1::recover(sig, msgHash);
-  if (!key) throw DynamicException("Invalid tx signature - cannot recover public key");
-  this->from_ = Secp256k1::toAddress(key);
-  this->hash_ = Utils::sha3(this->rlpSerialize(true)); // Include signature in hash
 }
 
 TxBlock::TxBlock(
@@ -497,6 +528,43 @@ EncodedMessageVariant TxBlock::toMessage(Gas& gas) const {
 }
 
 TxValidator::TxValidator(const View<Bytes> bytes, const uint64_t&) {
+  this->parse(bytes);
+
+  // Skip signature validation if these exact bytes were already checked
+  const Hash rawHash = Utils::sha3(bytes);
+  if (const auto cached = SigCache::shared().get(rawHash)) {
+    if (!cached->valid) throw DynamicException("Invalid tx signature - cannot recover public key");
+    this->from_ = cached->from;
+    this->hash_ = rawHash;
+    return;
+  }
+
+  // Validate signature
+  // Get recoveryId - calculated from v and chainId
+  auto recoveryId = uint8_t{this->v_ - (uint256_t(this->chainId_) * 2 + 35)};
+  if (!Secp256k1::verifySig(this->r_, this->s_, recoveryId)) {
+    throw DynamicException("Invalid tx signature - doesn't fit elliptic curve verification");
+  }
+  Signature sig = Secp256k1::makeSig(this->r_, this->s_, recoveryId);
+  Hash msgHash = Utils::sha3(this->rlpSerialize(false)); // Do not include signature
+  UPubKey key = Secp256k1::recover(sig, msgHash);
+  if (key == UPubKey()) {
+    SigCache::shared().put(rawHash, {Address(), false});
+    throw DynamicException("Invalid tx signature - cannot recover public key");
+  }
+  this->from_ = Secp256k1::toAddress(key);
+  this->hash_ = Utils::sha3(this->rlpSerialize(true)); // Include signature
+  // Only cache canonical encodings, so a hit can reuse the raw hash as the tx hash
+  if (this->hash_ == rawHash) SigCache::shared().put(rawHash, {this->from_, true});
+}
+
+TxValidator::TxValidator(const View<Bytes> bytes, const Hash& hash, const Address& from) {
+  this->parse(bytes);
+  this->from_ = from;
+  this->hash_ = hash;
+}
+
+void TxValidator::parse(const View<Bytes> bytes) {
   uint64_t index = 0;
 
   // Check if first byte is equal or higher than 0xf7, meaning it is a list
@@ -528,19 +596,6 @@ TxValidator::TxValidator(const View<Bytes> bytes, const uint64_t&) {
     throw DynamicException("Invalid tx signature - v is not 27 or 28, v is "
       + boost::lexical_cast<std::string>(this->v_));
   }
-
-  // Validate signature
-  // Get recoveryId - calculated from v and chainId
-  auto recoveryId = uint8_t{this->v_ - (uint256_t(this->chainId_) * 2 + 35)};
-  if (!Secp256k1::verifySig(this->r_, this->s_, recoveryId)) {
-    throw DynamicException("Invalid tx signature - doesn't fit elliptic curve verification");
-  }
-  Signature sig = Secp256k1::makeSig(this->r_, this->s_, recoveryId);
-  Hash msgHash = Utils::sha3(this->rlpSerialize(false)); // Do not include signature
-  UPubKey key = Secp256k1::recover(sig, msgHash);
-  if (key == UPubKey()) throw DynamicException("Invalid tx signature - cannot recover public key");
-  this->from_ = Secp256k1::toAddress(key);
-  this->hash_ = Utils::sha3(this->rlpSerialize(true)); // Include signature
 }
 
 TxValidator::TxValidator(
@@ -54,6 +54,14 @@ class TxBlock {
     void parseVRS(View<Bytes> txData, uint64_t& index);
     ///@}
 
+    /**
+     * Parse every tx element from the raw bytes, without checking the signature.
+     * Used exclusively by the raw constructors.
+     * @param bytes The raw tx bytes to parse.
+     * @throw DynamicException on any parsing failure.
+     */
+    void parse(const View<Bytes> bytes);
+
     ///@{
     /**
      * Serialize the specified tx element to a raw byte string.
@@ -95,6 +103,26 @@ class TxBlock {
      */
     TxBlock(const View<Bytes> bytes, const uint64_t& requiredChainId);
 
+    /**
+     * Raw constructor, for when the hash of the raw bytes is already known
+     * (e.g. when a batch of transactions is hashed at once with Keccak::hash256()).
+     * @param bytes The raw tx bytes to parse.
+     * @param requiredChainId The chain ID of the transaction.
+     * @param rawHash The Keccak-256 hash of `bytes`.
+     * @throw DynamicException on any parsing failure.
+     */
+    TxBlock(const View<Bytes> bytes, const uint64_t& requiredChainId, const Hash& rawHash);
+
+    /**
+     * Trusted raw constructor, for transactions that were already validated before being stored
+     * locally. Only parses the fields, skipping signature verification, sender recovery and hashing.
+     * @param bytes The raw tx bytes to parse.
+     * @param hash The transaction's hash, as computed when it was validated.
+     * @param from The transaction's sender, as recovered when it was validated.
+     * @throw DynamicException on any parsing failure.
+     */
+    TxBlock(const View<Bytes> bytes, const Hash& hash, const Address& from);
+
     /**
      * Manual constructor. Leave fields blank ("" or 0) if they're not required.
      * @param to The receiver address.
@@ -254,6 +282,14 @@ class TxValidator {
     void parseVRS(View<Bytes> bytes, uint64_t& index);
     ///@}
 
+    /**
+     * Parse every tx element from the raw bytes, without checking the signature.
+     * Used exclusively by the raw constructors.
+     * @param bytes The raw tx bytes to parse.
+     * @throw DynamicException on any parsing failure.
+     */
+    void parse(const View<Bytes> bytes);
+
     ///@{
     /**
      * Serialize the specified tx element to a raw byte string.
@@ -285,6 +321,16 @@ class TxValidator {
      */
     TxValidator(const View<Bytes> bytes, const uint64_t& requiredChainId);
 
+    /**
+     * Trusted raw constructor, for transactions that were already validated before being stored
+     * locally. Only parses the fields, skipping signature verification, sender recovery and hashing.
+     * @param bytes The raw tx bytes to parse.
+     * @param hash The transaction's hash, as computed when it was validated.
+     * @param from The transaction's sender, as recovered when it was validated.
+     * @throw DynamicException on any parsing failure.
+     */
+    TxValidator(const View<Bytes> bytes, const Hash& hash, const Address& from);
+
     /**
      * Manual constructor. Leave fields blank ("" or 0) if they're not required.
      * @param from The sender address.
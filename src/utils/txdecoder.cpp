@@ -0,0 +1,108 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "txdecoder.h"
+#include "keccak.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+struct TxDecoder::Batch {
+  const std::vector<View<Bytes>>& raws;
+  const uint64_t chainId;
+  const size_t chunkSize;
+  const size_t chunks;
+  std::vector<std::optional<TxBlock>> results;
+  std::vector<std::string>* errors;
+  std::atomic<size_t> nextChunk = 0;
+  size_t doneChunks = 0;
+  std::mutex mutex;
+  std::condition_variable done;
+
+  Batch(const std::vector<View<Bytes>>& raws, uint64_t chainId, size_t chunkSize, std::vector<std::string>* errors)
+    : raws(raws), chainId(chainId), chunkSize(chunkSize),
+      chunks((raws.size() + chunkSize - 1) / chunkSize), results(raws.size()), errors(errors)
+  {
+    if (this->errors != nullptr) this->errors->assign(raws.size(), std::string());
+  }
+
+  /// Decode chunks until none are left. Only touches the raw txs after claiming a chunk,
+  /// so a worker that gets here after the batch is over never reads them.
+  void run() {
+    for (size_t chunk = this->nextChunk++; chunk < this->chunks; chunk = this->nextChunk++) {
+      const size_t begin = chunk * this->chunkSize;
+      const size_t end = std::min(this->raws.size(), begin + this->chunkSize);
+      // Hash the whole chunk at once, filling the vector lanes, instead of once per constructor
+      const std::vector<Hash> rawHashes = Keccak::hash256(std::span(this->raws).subspan(begin, end - begin));
+      for (size_t i = begin; i < end; ++i) {
+        try {
+          this->results[i].emplace(this->raws[i], this->chainId, rawHashes[i - begin]);
+        } catch (const std::exception& e) {
+          // Left empty, the caller decides what an invalid transaction means
+          if (this->errors != nullptr) (*this->errors)[i] = e.what();
+        }
+      }
+      std::lock_guard lock(this->mutex);
+      if (++this->doneChunks == this->chunks) this->done.notify_all();
+    }
+  }
+};
+
+TxDecoder::TxDecoder(unsigned int threads) {
+  this->workers_.reserve(threads);
+  for (unsigned int i = 0; i < threads; ++i) this->workers_.emplace_back(&TxDecoder::workerLoop, this);
+}
+
+TxDecoder::~TxDecoder() {
+  {
+    std::lock_guard lock(this->jobsMutex_);
+    this->stop_ = true;
+  }
+  this->jobsCv_.notify_all();
+  for (auto& worker : this->workers_) worker.join();
+}
+
+TxDecoder& TxDecoder::shared() {
+  static TxDecoder decoder(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+  return decoder;
+}
+
+void TxDecoder::workerLoop() {
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock lock(this->jobsMutex_);
+      this->jobsCv_.wait(lock, [this]() { return this->stop_ || !this->jobs_.empty(); });
+      if (this->stop_) return;
+      job = std::move(this->jobs_.front());
+      this->jobs_.pop_front();
+    }
+    job();
+  }
+}
+
+std::vector<std::optional<TxBlock>> TxDecoder::decode(
+  const std::vector<View<Bytes>>& raws, const uint64_t& requiredChainId, std::vector<std::string>* errors
+) {
+  const size_t helpers = std::min<size_t>(this->workers_.size(), raws.size() / minParallelTxs_);
+  // A few chunks per thread, so threads that finish early pick up the slack of slower ones
+  const size_t chunkSize = std::max<size_t>(1, raws.size() / ((helpers + 1) * 4));
+  auto batch = std::make_shared<Batch>(raws, requiredChainId, chunkSize, errors);
+  if (helpers != 0) {
+    {
+      std::lock_guard lock(this->jobsMutex_);
+      for (size_t i = 0; i < helpers; ++i) this->jobs_.emplace_back([batch]() { batch->run(); });
+    }
+    this->jobsCv_.notify_all();
+  }
+  batch->run();
+  std::unique_lock lock(batch->mutex);
+  batch->done.wait(lock, [&batch]() { return batch->doneChunks == batch->chunks; });
+  return std::move(batch->results);
+}
@@ -0,0 +1,77 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef TXDECODER_H
+#define TXDECODER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "tx.h" // ecdsa.h -> utils.h -> strings.h, bytes/view.h
+
+/**
+ * Fixed pool of worker threads that decode raw block transactions.
+ * Decoding a TxBlock is dominated by the ECDSA public key recovery of its signature,
+ * so batches of raw transactions (the ones in a block, or the ones received from peers
+ * while the previous batch was decoding) are split in chunks and spread over the workers.
+ * The calling thread also decodes chunks while it waits, so a batch never waits on a busy
+ * pool, and the pool never spawns threads on the hot path.
+ */
+class TxDecoder {
+  public:
+    /**
+     * Constructor. Starts the workers.
+     * @param threads Number of worker threads. With 0, batches are decoded by the calling thread only.
+     */
+    explicit TxDecoder(unsigned int threads);
+
+    ~TxDecoder(); ///< Destructor. Stops and joins the workers.
+
+    TxDecoder(const TxDecoder&) = delete;
+    TxDecoder& operator=(const TxDecoder&) = delete;
+
+    /// Get the process-wide pool, with one worker per hardware thread besides the caller's.
+    static TxDecoder& shared();
+
+    /// Get the number of worker threads.
+    unsigned int getThreads() const { return static_cast<unsigned int>(this->workers_.size()); }
+
+    /**
+     * Decode a batch of raw transactions, blocking until the whole batch is done.
+     * @param raws The raw transactions. Must stay valid until the call returns.
+     * @param requiredChainId The chain ID the transactions must be signed for.
+     * @param errors (optional) Filled with one entry per raw transaction, holding why it failed
+     *               to decode, or an empty string if it didn't.
+     * @return One entry per raw transaction, in the same order. Transactions that failed to
+     *         decode (bad encoding, signature or chain ID) are left empty.
+     */
+    std::vector<std::optional<TxBlock>> decode(
+      const std::vector<View<Bytes>>& raws, const uint64_t& requiredChainId,
+      std::vector<std::string>* errors = nullptr
+    );
+
+  private:
+    struct Batch; ///< State of a batch being decoded, shared by the threads working on it.
+
+    /// Batches with fewer transactions than this are decoded by the calling thread alone.
+    static constexpr size_t minParallelTxs_ = 32;
+
+    std::vector<std::thread> workers_; ///< The worker threads.
+    std::mutex jobsMutex_; ///< Mutex for managing access to the job queue.
+    std::condition_variable jobsCv_; ///< Wakes up idle workers when jobs are queued or the pool stops.
+    std::deque<std::function<void()>> jobs_; ///< Queued jobs.
+    bool stop_ = false; ///< Whether the workers must exit.
+
+    void workerLoop(); ///< Body of each worker thread.
+};
+
+#endif // TXDECODER_H
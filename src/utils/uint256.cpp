@@ -0,0 +1,161 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "uint256.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "dynamicexception.h"
+
+static_assert(sizeof(boost::multiprecision::limb_type) == sizeof(uint64_t), "cpp_int limbs must be 64-bit");
+
+Uint256::Uint256(const uint256_t& value) : limbs_{} {
+  // cpp_int keeps 64-bit limbs, least significant first, and only as many as needed
+  const auto& backend = value.backend();
+  std::copy(backend.limbs(), backend.limbs() + backend.size(), this->limbs_.begin());
+}
+
+Uint256::operator uint256_t() const {
+  uint256_t ret;
+  auto& backend = ret.backend();
+  backend.resize(4, 4);
+  std::copy(this->limbs_.begin(), this->limbs_.end(), backend.limbs());
+  backend.normalize();
+  return ret;
+}
+
+Uint256 Uint256::fromBigEndian(const View<Bytes> bytes) {
+  if (bytes.size() > 32) throw DynamicException(std::string(__func__)
+    + ": Invalid bytes size - expected up to 32, got " + std::to_string(bytes.size())
+  );
+  // Left-pad to a full word, then read each limb from the end
+  std::array<Byte, 32> word{};
+  std::copy(bytes.begin(), bytes.end(), word.end() - bytes.size());
+  Uint256 ret;
+  for (size_t i = 0; i < 4; ++i) {
+    uint64_t limb;
+    std::memcpy(&limb, word.data() + (24 - i * 8), 8);
+    ret.limbs_[i] = (std::endian::native == std::endian::little) ? __builtin_bswap64(limb) : limb;
+  }
+  return ret;
+}
+
+BytesArr<32> Uint256::toBigEndian() const {
+  BytesArr<32> ret;
+  for (size_t i = 0; i < 4; ++i) {
+    const uint64_t limb = (std::endian::native == std::endian::little)
+      ? __builtin_bswap64(this->limbs_[i]) : this->limbs_[i];
+    std::memcpy(ret.data() + (24 - i * 8), &limb, 8);
+  }
+  return ret;
+}
+
+evmc::uint256be Uint256::toEvmc() const {
+  evmc::uint256be ret;
+  const BytesArr<32> bytes = this->toBigEndian();
+  std::copy(bytes.begin(), bytes.end(), ret.bytes);
+  return ret;
+}
+
+std::string Uint256::str() const {
+  // Peel off 19 decimal digits at a time, the most that fit in a limb
+  constexpr uint64_t chunk = 10000000000000000000ULL;
+  std::string ret;
+  Uint256 value = *this;
+  do {
+    Uint256 digits;
+    divMod(value, chunk, value, digits);
+    std::string part = std::to_string(digits.limbs_[0]);
+    if (value) part.insert(0, 19 - part.size(), '0');
+    ret.insert(0, part);
+  } while (value);
+  return ret;
+}
+
+void Uint256::divMod(const Uint256& u, const Uint256& v, Uint256& quotient, Uint256& remainder) {
+  if (!v) throw std::overflow_error("Uint256 division by zero");
+  // Read everything from the inputs first, as the outputs may alias them
+  const std::array<uint64_t, 4> dividend = u.limbs_;
+  const std::array<uint64_t, 4> divisor = v.limbs_;
+  const int m = u.significantLimbs();
+  const int n = v.significantLimbs();
+  const bool smaller = u < v;
+  quotient = Uint256();
+  remainder = Uint256();
+  if (smaller) {
+    remainder.limbs_ = dividend;
+    return;
+  }
+
+  // Single-limb divisor: schoolbook division, one native 128/64 division per limb
+  if (n == 1) {
+    uint128 rem = 0;
+    for (int i = m - 1; i >= 0; --i) {
+      const uint128 cur = (rem << 64) | dividend[i];
+      quotient.limbs_[i] = uint64_t(cur / divisor[0]);
+      rem = cur % divisor[0];
+    }
+    remainder.limbs_[0] = uint64_t(rem);
+    return;
+  }
+
+  // Normalize so the divisor's top limb has its highest bit set, which keeps each
+  // quotient limb estimate at most two off (Knuth, TAOCP vol. 2, 4.3.1, algorithm D)
+  const int shift = std::countl_zero(divisor[n - 1]);
+  std::array<uint64_t, 4> vn{};
+  std::array<uint64_t, 5> un{};
+  for (int i = n - 1; i > 0; --i) {
+    vn[i] = (divisor[i] << shift) | (shift ? divisor[i - 1] >> (64 - shift) : 0);
+  }
+  vn[0] = divisor[0] << shift;
+  un[m] = shift ? dividend[m - 1] >> (64 - shift) : 0;
+  for (int i = m - 1; i > 0; --i) {
+    un[i] = (dividend[i] << shift) | (shift ? dividend[i - 1] >> (64 - shift) : 0);
+  }
+  un[0] = dividend[0] << shift;
+
+  for (int j = m - n; j >= 0; --j) {
+    // Estimate the quotient limb from the top two limbs, then correct it with the next one
+    const uint128 top = (uint128(un[j + n]) << 64) | un[j + n - 1];
+    uint128 qhat = top / vn[n - 1];
+    uint128 rhat = top % vn[n - 1];
+    while ((qhat >> 64) != 0 || qhat * vn[n - 2] > ((rhat << 64) | un[j + n - 2])) {
+      --qhat;
+      rhat += vn[n - 1];
+      if ((rhat >> 64) != 0) break;
+    }
+    // Multiply and subtract
+    __int128 borrow = 0;
+    __int128 t = 0;
+    for (int i = 0; i < n; ++i) {
+      const uint128 p = qhat * vn[i];
+      t = __int128(un[i + j]) - borrow - __int128(uint64_t(p));
+      un[i + j] = uint64_t(t);
+      borrow = __int128(p >> 64) - (t >> 64);
+    }
+    t = __int128(un[j + n]) - borrow;
+    un[j + n] = uint64_t(t);
+    quotient.limbs_[j] = uint64_t(qhat);
+    // The estimate was one too high, add the divisor back
+    if (t < 0) {
+      --quotient.limbs_[j];
+      uint128 carry = 0;
+      for (int i = 0; i < n; ++i) {
+        carry += uint128(un[i + j]) + vn[i];
+        un[i + j] = uint64_t(carry);
+        carry >>= 64;
+      }
+      un[j + n] += uint64_t(carry);
+    }
+  }
+
+  // Denormalize the remainder
+  for (int i = 0; i < n; ++i) {
+    remainder.limbs_[i] = (un[i] >> shift) | (shift ? un[i + 1] << (64 - shift) : 0);
+  }
+}
@@ -0,0 +1,256 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef UINT256_H
+#define UINT256_H
+
+#include <array>
+#include <bit>
+#include <compare>
+#include <stdexcept>
+#include <string>
+
+#include <evmc/evmc.hpp>
+
+#include "uintconv.h" // uint256_t, BytesArr, bytes/view.h
+
+/**
+ * Fixed-width unsigned 256-bit integer, stored as four native 64-bit limbs.
+ * Behaves like `uint256_t` (a checked boost `cpp_int`): results that do not fit throw
+ * `std::overflow_error`, results that would be negative throw `std::range_error`,
+ * and dividing by zero throws `std::overflow_error`. Unlike `cpp_int`, it never tracks
+ * a variable number of limbs, so arithmetic compiles down to a few carry-propagating
+ * native instructions, and converting to or from big-endian bytes is a byte swap per limb.
+ * Converts losslessly to and from `uint256_t`, so it can be used on hot paths of code
+ * that otherwise deals with `uint256_t` (e.g. account balances and value transfers).
+ */
+class Uint256 {
+  private:
+    std::array<uint64_t, 4> limbs_; ///< The limbs, least significant first.
+
+    using uint128 = unsigned __int128; ///< Double-width limb, for carries and products.
+
+    /**
+     * Divide two numbers, getting both the quotient and the remainder (Knuth's algorithm D).
+     * @param u The dividend.
+     * @param v The divisor.
+     * @param quotient Output for the quotient.
+     * @param remainder Output for the remainder.
+     * @throw std::overflow_error if the divisor is zero.
+     */
+    static void divMod(const Uint256& u, const Uint256& v, Uint256& quotient, Uint256& remainder);
+
+    /// Get the number of significant limbs (0 for zero).
+    constexpr int significantLimbs() const {
+      for (int i = 3; i >= 0; --i) if (this->limbs_[i] != 0) return i + 1;
+      return 0;
+    }
+
+  public:
+    /// Default constructor, equals to zero.
+    constexpr Uint256() : limbs_{} {}
+
+    /**
+     * Constructor from a native integer.
+     * @param value The value.
+     */
+    constexpr Uint256(uint64_t value) : limbs_{value, 0, 0, 0} {}
+
+    /**
+     * Constructor from limbs.
+     * @param limbs The limbs, least significant first.
+     */
+    constexpr explicit Uint256(const std::array<uint64_t, 4>& limbs) : limbs_(limbs) {}
+
+    /**
+     * Constructor from a boost 256-bit integer, copying its limbs directly.
+     * Implicit, so mixing a `uint256_t` operand into an expression goes through
+     * Uint256's own operators (the conversion back stays explicit, which keeps
+     * boost's mixed-type operators from being picked instead).
+     * @param value The value.
+     */
+    Uint256(const uint256_t& value);
+
+    /// Conversion to a boost 256-bit integer, copying the limbs directly.
+    explicit operator uint256_t() const;
+
+    /**
+     * Create a number from big-endian bytes (e.g. an ABI word or a serialized balance).
+     * @param bytes The bytes. Shorter inputs are left-padded with zeroes.
+     * @return The number.
+     * @throw DynamicException if there are more than 32 bytes.
+     */
+    static Uint256 fromBigEndian(const View<Bytes> bytes);
+
+    /// Get the number as 32 big-endian bytes.
+    BytesArr<32> toBigEndian() const;
+
+    /**
+     * Create a number from an EVMC 256-bit big-endian value.
+     * @param value The value.
+     * @return The number.
+     */
+    static Uint256 fromEvmc(const evmc::uint256be& value) { return fromBigEndian(View<Bytes>(value.bytes, 32)); }
+
+    /// Get the number as an EVMC 256-bit big-endian value.
+    evmc::uint256be toEvmc() const;
+
+    /// Get the number as a decimal string, the same as `uint256_t::str()`.
+    std::string str() const;
+
+    /**
+     * Get one of the limbs.
+     * @param index The index of the limb, 0 being the least significant one.
+     * @return The limb.
+     */
+    constexpr uint64_t limb(size_t index) const { return this->limbs_[index]; }
+
+    /// Get the limbs, least significant first.
+    constexpr const std::array<uint64_t, 4>& limbs() const { return this->limbs_; }
+
+    /// Whether the number is not zero.
+    constexpr explicit operator bool() const {
+      return (this->limbs_[0] | this->limbs_[1] | this->limbs_[2] | this->limbs_[3]) != 0;
+    }
+
+    ///@{
+    /** Comparison operator. Compares the most significant limbs first. */
+    constexpr bool operator==(const Uint256& other) const = default;
+    constexpr std::strong_ordering operator<=>(const Uint256& other) const {
+      for (int i = 3; i >= 0; --i) {
+        if (auto cmp = this->limbs_[i] <=> other.limbs_[i]; cmp != 0) return cmp;
+      }
+      return std::strong_ordering::equal;
+    }
+    ///@}
+
+    ///@{
+    /**
+     * Checked arithmetic operator.
+     * @throw std::overflow_error if the result does not fit in 256 bits or on division by zero.
+     * @throw std::range_error if the result would be negative.
+     */
+    constexpr Uint256& operator+=(const Uint256& other) {
+      uint128 carry = 0;
+      for (size_t i = 0; i < 4; ++i) {
+        carry += uint128(this->limbs_[i]) + other.limbs_[i];
+        this->limbs_[i] = uint64_t(carry);
+        carry >>= 64;
+      }
+      if (carry != 0) throw std::overflow_error("Uint256 addition overflows 256 bits");
+      return *this;
+    }
+
+    constexpr Uint256& operator-=(const Uint256& other) {
+      bool borrow = false;
+      for (size_t i = 0; i < 4; ++i) {
+        uint64_t diff;
+        const bool borrowA = __builtin_sub_overflow(this->limbs_[i], other.limbs_[i], &diff);
+        const bool borrowB = __builtin_sub_overflow(diff, uint64_t(borrow), &this->limbs_[i]);
+        borrow = borrowA || borrowB;
+      }
+      if (borrow) throw std::range_error("Uint256 subtraction results in a negative value");
+      return *this;
+    }
+
+    constexpr Uint256& operator*=(const Uint256& other) {
+      // Full 512-bit product, which must fit in the lower half
+      std::array<uint64_t, 8> product{};
+      for (size_t i = 0; i < 4; ++i) {
+        if (this->limbs_[i] == 0) continue;
+        uint128 carry = 0;
+        for (size_t j = 0; j < 4; ++j) {
+          carry += uint128(this->limbs_[i]) * other.limbs_[j] + product[i + j];
+          product[i + j] = uint64_t(carry);
+          carry >>= 64;
+        }
+        product[i + 4] = uint64_t(carry);
+      }
+      if ((product[4] | product[5] | product[6] | product[7]) != 0) {
+        throw std::overflow_error("Uint256 multiplication overflows 256 bits");
+      }
+      std::copy(product.begin(), product.begin() + 4, this->limbs_.begin());
+      return *this;
+    }
+
+    Uint256& operator/=(const Uint256& other) {
+      Uint256 remainder;
+      divMod(*this, other, *this, remainder);
+      return *this;
+    }
+
+    Uint256& operator%=(const Uint256& other) {
+      Uint256 quotient;
+      divMod(*this, other, quotient, *this);
+      return *this;
+    }
+
+    friend constexpr Uint256 operator+(Uint256 a, const Uint256& b) { return a += b; }
+    friend constexpr Uint256 operator-(Uint256 a, const Uint256& b) { return a -= b; }
+    friend constexpr Uint256 operator*(Uint256 a, const Uint256& b) { return a *= b; }
+    friend Uint256 operator/(Uint256 a, const Uint256& b) { return a /= b; }
+    friend Uint256 operator%(Uint256 a, const Uint256& b) { return a %= b; }
+    ///@}
+
+    ///@{
+    /** Bitwise operator. */
+    constexpr Uint256& operator&=(const Uint256& other) {
+      for (size_t i = 0; i < 4; ++i) this->limbs_[i] &= other.limbs_[i];
+      return *this;
+    }
+    constexpr Uint256& operator|=(const Uint256& other) {
+      for (size_t i = 0; i < 4; ++i) this->limbs_[i] |= other.limbs_[i];
+      return *this;
+    }
+    constexpr Uint256& operator^=(const Uint256& other) {
+      for (size_t i = 0; i < 4; ++i) this->limbs_[i] ^= other.limbs_[i];
+      return *this;
+    }
+    constexpr Uint256 operator~() const {
+      return Uint256({~this->limbs_[0], ~this->limbs_[1], ~this->limbs_[2], ~this->limbs_[3]});
+    }
+    friend constexpr Uint256 operator&(Uint256 a, const Uint256& b) { return a &= b; }
+    friend constexpr Uint256 operator|(Uint256 a, const Uint256& b) { return a |= b; }
+    friend constexpr Uint256 operator^(Uint256 a, const Uint256& b) { return a ^= b; }
+    ///@}
+
+    /**
+     * Checked left shift operator.
+     * @param shift The number of bits to shift.
+     * @throw std::overflow_error if any set bit is shifted out.
+     */
+    constexpr Uint256 operator<<(unsigned shift) const {
+      if (!*this) return *this;
+      if (shift >= 256 || (*this >> (256 - shift)) != 0) {
+        throw std::overflow_error("Uint256 left shift overflows 256 bits");
+      }
+      Uint256 ret;
+      const int limbShift = shift / 64, bitShift = shift % 64;
+      for (int i = 3; i >= limbShift; --i) {
+        ret.limbs_[i] = this->limbs_[i - limbShift] << bitShift;
+        if (bitShift != 0 && i > limbShift) ret.limbs_[i] |= this->limbs_[i - limbShift - 1] >> (64 - bitShift);
+      }
+      return ret;
+    }
+
+    /**
+     * Right shift operator.
+     * @param shift The number of bits to shift.
+     */
+    constexpr Uint256 operator>>(unsigned shift) const {
+      Uint256 ret;
+      if (shift >= 256) return ret;
+      const int limbShift = shift / 64, bitShift = shift % 64;
+      for (int i = 0; i + limbShift < 4; ++i) {
+        ret.limbs_[i] = this->limbs_[i + limbShift] >> bitShift;
+        if (bitShift != 0 && i + limbShift + 1 < 4) ret.limbs_[i] |= this->limbs_[i + limbShift + 1] << (64 - bitShift);
+      }
+      return ret;
+    }
+};
+
+#endif // UINT256_H
@@ -8,19 +8,14 @@ See the LICENSE.txt file in the project root for more information.
 #include "uintconv.h"
 
 #include "dynamicexception.h"
+#include "uint256.h"
 
 // ==========================================================================
 // UINT TO BYTES
 // ==========================================================================
 
 BytesArr<32> UintConv::uint256ToBytes(const uint256_t& i) {
-  BytesArr<32> ret = {0};
-  Bytes tmp;
-  tmp.reserve(32);
-  ret.fill(0x00);
-  boost::multiprecision::export_bits(i, std::back_inserter(tmp), 8);
-  for (unsigned ii = 0; ii < tmp.size(); ii++) ret[31 - ii] = tmp[tmp.size() - ii - 1];
-  return ret;
+  return Uint256(i).toBigEndian();
 }
 
 BytesArr<31> UintConv::uint248ToBytes(const uint248_t &i) {
@@ -308,9 +303,7 @@ uint256_t UintConv::bytesToUint256(const View<Bytes> b) {
   if (b.size() != 32) throw DynamicException(std::string(__func__)
     + ": Invalid bytes size - expected 32, got " + std::to_string(b.size())
   );
-  uint256_t ret;
-  boost::multiprecision::import_bits(ret, b.begin(), b.end(), 8);
-  return ret;
+  return uint256_t(Uint256::fromBigEndian(b));
 }
 
 uint248_t UintConv::bytesToUint248(const View<Bytes> b) {
@@ -53,7 +53,7 @@ Hash Utils::sha3(const View<Bytes> input) {
 
 Account::Account(const View<Bytes>& bytes) {
   if (bytes.size() < 73) throw DynamicException(std::string(__func__) + ": Invalid bytes size");
-  this->balance = UintConv::bytesToUint256(bytes.subspan(0,32));
+  this->balance = Uint256::fromBigEndian(bytes.subspan(0,32));
   this->nonce = UintConv::bytesToUint64(bytes.subspan(32,8));
   this->codeHash = Hash(bytes.subspan(40,32));
   if (bytes[72] > 2) throw DynamicException(std::string(__func__) + ": Invalid contract type");
@@ -63,7 +63,7 @@ Account::Account(const View<Bytes>& bytes) {
 Bytes Account::serialize() const {
   // TODO: this could be optimized with bytes::join()?
   Bytes ret;
-  Utils::appendBytes(ret, UintConv::uint256ToBytes(this->balance));
+  Utils::appendBytes(ret, this->balance.toBigEndian());
   Utils::appendBytes(ret, UintConv::uint64ToBytes(this->nonce));
   Utils::appendBytes(ret, this->codeHash);
   ret.insert(ret.end(), char(this->contractType));
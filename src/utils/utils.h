@@ -37,6 +37,7 @@ using cpp_float = boost::multiprecision::number<boost::multiprecision::cpp_dec_f
 #include "dynamicexception.h" // included by strings.h, leave it for now to avoid AddressSanitizer runtime errors - TODO: see create_view_span()
 #include "logger.h"
 #include "strings.h" // hex.h, openssl/rand.h, libs/zpp_bits.h -> algorithm, array, span, variant
+#include "uint256.h"
 
 /// Localhost IPv4 address constant
 inline const boost::asio::ip::address LOCALHOST = boost::asio::ip::address::from_string("127.0.0.1");
@@ -134,7 +135,7 @@ enum class ContractType { NOT_A_CONTRACT, EVM, CPP };
  * @see State
  */
 struct Account {
-  uint256_t balance = 0;                       ///< Account balance.
+  Uint256 balance = 0;                         ///< Account balance.
   uint64_t nonce = 0;                          ///< Account nonce.
   Hash codeHash = Hash();                      ///< Account code hash (if any)
   std::shared_ptr<Bytes> code = nullptr;                        ///< Account code (if any)
@@ -144,10 +145,10 @@ struct Account {
   Account() = default;
 
   /// Copy constructor.
-  Account(const uint256_t& balance, const uint64_t& nonce) : balance(balance), nonce(nonce) {}
+  Account(const Uint256& balance, const uint64_t& nonce) : balance(balance), nonce(nonce) {}
 
   /// Move constructor.
-  Account(uint256_t&& balance, uint64_t&& nonce) : balance(std::move(balance)), nonce(std::move(nonce)) {}
+  Account(Uint256&& balance, uint64_t&& nonce) : balance(std::move(balance)), nonce(std::move(nonce)) {}
 
   /// Deserialize constructor.
   Account(const View<Bytes>& bytes);
@@ -0,0 +1,39 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "allocations.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Only built along with the benchmarks, so regular test runs keep the default allocator.
+// The array and nothrow forms forward to these by default.
+
+namespace {
+  std::atomic<uint64_t> allocations = 0;
+
+  void* allocate(std::size_t size, std::size_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    void* ptr = (alignment <= alignof(std::max_align_t))
+      ? std::malloc(size)
+      : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+  }
+}
+
+uint64_t BenchmarkAllocations::count() { return allocations.load(std::memory_order_relaxed); }
+
+void* operator new(std::size_t size) { return allocate(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate(size, static_cast<std::size_t>(alignment)); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
@@ -0,0 +1,19 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef BENCHMARK_ALLOCATIONS_HPP
+#define BENCHMARK_ALLOCATIONS_HPP
+
+#include <cstdint>
+
+/// Heap allocation counter for the benchmarks, fed by the global operator new replaced in allocations.cpp.
+namespace BenchmarkAllocations {
+  /// Get the number of heap allocations made by the whole process so far.
+  uint64_t count();
+}
+
+#endif // BENCHMARK_ALLOCATIONS_HPP
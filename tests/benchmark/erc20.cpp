@@ -14,6 +14,8 @@
 
 #include "../src/bytes/random.h"
 
+#include "allocations.hpp"
+
 namespace TERC20BENCHMARK {
   /*
    *
@@ -107,19 +109,27 @@ contract MappingManager {
       auto& state = sdk.getState();
       uint64_t iterations = 2500000;
 
-      auto start = std::chrono::high_resolution_clock::now();
-      for (uint64_t i = 0; i < iterations; i++) {
-        state.call(transferTx);
+      // Undo journal allocated for every call, then reused across calls like State does for a block
+      ExecutionContext::Journal journal;
+      for (const bool reuseJournal : {false, true}) {
+        const uint64_t allocationsBefore = BenchmarkAllocations::count();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+          state.call(transferTx, reuseJournal ? &journal : nullptr);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        long double durationInMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        long double microSecsPerCall = durationInMicroseconds / iterations;
+        long double allocationsPerCall = static_cast<long double>(BenchmarkAllocations::count() - allocationsBefore) / iterations;
+        const std::string journalMode = reuseJournal ? "reused journal" : "journal per call";
+        std::cout << "CPP ERC20 transfer (" << journalMode << ") took " << microSecsPerCall << " microseconds per call, "
+          << allocationsPerCall << " allocations per call" << std::endl;
+        std::cout << "CPP Total Time (" << journalMode << "): " << durationInMicroseconds / 1000000 << " seconds" << std::endl;
       }
-      auto end = std::chrono::high_resolution_clock::now();
-
-      long double durationInMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-      long double microSecsPerCall = durationInMicroseconds / iterations;
-      std::cout << "CPP ERC20 transfer took " << microSecsPerCall << " microseconds per call" << std::endl;
-      std::cout << "CPP Total Time: " << durationInMicroseconds / 1000000 << " seconds" << std::endl;
 
       // Check if we actually transferred the tokens.
-      uint256_t expectedToBalance = uint256_t(100) * iterations;
+      uint256_t expectedToBalance = uint256_t(100) * iterations * 2;
       uint256_t transferredToBalance = sdk.callViewFunction(erc20Address, &ERC20::balanceOf, to);
       uint256_t expectedFromBalance = uint256_t("10000000000000000000000") - expectedToBalance;
       uint256_t transferredFromBalance = sdk.callViewFunction(erc20Address, &ERC20::balanceOf, sdk.getChainOwnerAccount().address);
@@ -327,19 +337,27 @@ contract MappingManager {
       auto& state = sdk.getState();
       uint64_t iterations = 250000;
 
-      auto start = std::chrono::high_resolution_clock::now();
-      for (uint64_t i = 0; i < iterations; i++) {
-        state.call(transferTx);
+      // Undo journal allocated for every call, then reused across calls like State does for a block
+      ExecutionContext::Journal journal;
+      for (const bool reuseJournal : {false, true}) {
+        const uint64_t allocationsBefore = BenchmarkAllocations::count();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+          state.call(transferTx, reuseJournal ? &journal : nullptr);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        long double durationInMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        long double microSecsPerCall = durationInMicroseconds / iterations;
+        long double allocationsPerCall = static_cast<long double>(BenchmarkAllocations::count() - allocationsBefore) / iterations;
+        const std::string journalMode = reuseJournal ? "reused journal" : "journal per call";
+        std::cout << "EVM ERC20 transfer (" << journalMode << ") took " << microSecsPerCall << " microseconds per call, "
+          << allocationsPerCall << " allocations per call" << std::endl;
+        std::cout << "EVM Total Time (" << journalMode << "): " << durationInMicroseconds / 1000000 << " seconds" << std::endl;
       }
-      auto end = std::chrono::high_resolution_clock::now();
-
-      long double durationInMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-      long double microSecsPerCall = durationInMicroseconds / iterations;
-      std::cout << "EVM ERC20 transfer took " << microSecsPerCall << " microseconds per call" << std::endl;
-      std::cout << "EVM Total Time: " << durationInMicroseconds / 1000000 << " seconds" << std::endl;
 
       // Check if we actually transferred the tokens.
-      uint256_t expectedToBalance = uint256_t(100) * iterations;
+      uint256_t expectedToBalance = uint256_t(100) * iterations * 2;
       uint256_t transferredToBalance = sdk.callViewFunction(erc20Address, &ERC20::balanceOf, to);
       uint256_t expectedFromBalance = uint256_t("10000000000000000000000") - expectedToBalance;
       uint256_t transferredFromBalance = sdk.callViewFunction(erc20Address, &ERC20::balanceOf, sdk.getChainOwnerAccount().address);
@@ -0,0 +1,57 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef BENCHMARK_EVMENVIRONMENT_HPP
+#define BENCHMARK_EVMENVIRONMENT_HPP
+
+#include "../sdktestsuite.hpp"
+
+/// EVM settings compared by the benchmarks.
+struct EvmBenchmarkSettings {
+  std::string interpreter;  ///< "baseline" or "advanced".
+  uint64_t codeCacheSize;   ///< Number of analyses kept by the code cache, 0 disables it.
+
+  /// Describe the settings for the benchmark output.
+  std::string describe() const {
+    return this->interpreter + ", code cache " + (this->codeCacheSize != 0 ? "on" : "off");
+  }
+};
+
+/// Every combination of interpreter and code cache.
+inline const std::vector<EvmBenchmarkSettings> evmBenchmarkSettings = {
+  {"baseline", 1024}, {"baseline", 0}, {"advanced", 1024}, {"advanced", 0}
+};
+
+/**
+ * Create a new benchmark environment whose EVM uses the given settings.
+ * The state reads them from options.json when it's built, so the environment
+ * is created, closed, given the settings and loaded again.
+ * @param sdkPath Path to the environment.
+ * @param settings The EVM settings.
+ * @return The environment.
+ */
+inline SDKTestSuite createEvmBenchmarkEnvironment(const std::string& sdkPath, const EvmBenchmarkSettings& settings) {
+  std::unique_ptr<Options> options;
+  {
+    SDKTestSuite sdk = SDKTestSuite::createNewEnvironment(sdkPath, {}, nullptr, IndexingMode::DISABLED);
+    options = std::make_unique<Options>(sdk.getOptions());
+  }
+  json optionsJson;
+  {
+    std::ifstream i(sdkPath + "/options.json");
+    i >> optionsJson;
+  }
+  optionsJson["evmInterpreter"] = settings.interpreter;
+  optionsJson["evmCodeCacheSize"] = settings.codeCacheSize;
+  {
+    std::ofstream o(sdkPath + "/options.json");
+    o << optionsJson.dump(2) << std::endl;
+  }
+  return SDKTestSuite(*options);
+}
+
+#endif // BENCHMARK_EVMENVIRONMENT_HPP
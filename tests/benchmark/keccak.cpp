@@ -0,0 +1,56 @@
+/*
+  Copyright (c) [2023-2024] [AppLayer Developers]
+  This software is distributed under the MIT License.
+  See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../src/libs/catch2/catch_amalgamated.hpp"
+
+#include "../src/utils/keccak.h"
+#include "../src/utils/merkle.h"
+
+namespace TKECCAKBENCHMARK {
+  TEST_CASE("Keccak Benchmark", "[benchmark][keccak]") {
+    SECTION("Hash 200000 inputs one at a time and in batches") {
+      const uint64_t inputCount = 200000;
+      // 64 bytes is a Merkle node, ~110 bytes a simple transfer
+      for (const size_t inputSize : {32, 64, 110, 300}) {
+        std::vector<Bytes> data;
+        data.reserve(inputCount);
+        for (uint64_t i = 0; i < inputCount; i++) data.emplace_back(Utils::randBytes(inputSize));
+        std::vector<View<Bytes>> inputs(data.cbegin(), data.cend());
+
+        std::vector<Hash> expected(inputCount);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint64_t i = 0; i < inputCount; i++) expected[i] = Utils::sha3(inputs[i]);
+        auto end = std::chrono::high_resolution_clock::now();
+        long double seconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000000.0L;
+        std::cout << inputSize << " bytes, Utils::sha3: " << inputCount / seconds << " hashes/s" << std::endl;
+
+        for (const auto& [impl, name] : std::vector<std::pair<Keccak::Impl, std::string>>{
+          {Keccak::Impl::SCALAR, "scalar"}, {Keccak::Impl::AVX2, "AVX2"}, {Keccak::Impl::AVX512, "AVX-512"}
+        }) {
+          if (impl > Keccak::bestImpl()) continue;
+          std::vector<Hash> outputs(inputCount);
+          start = std::chrono::high_resolution_clock::now();
+          Keccak::hash256(inputs, outputs, impl);
+          end = std::chrono::high_resolution_clock::now();
+          seconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000000.0L;
+          std::cout << inputSize << " bytes, Keccak::hash256 (" << name << "): " << inputCount / seconds << " hashes/s" << std::endl;
+          REQUIRE(outputs == expected);
+        }
+      }
+    }
+
+    SECTION("Build a Merkle tree of 200000 leaves") {
+      std::vector<Hash> leaves;
+      for (uint64_t i = 0; i < 200000; i++) leaves.emplace_back(Utils::randBytes(32));
+      auto start = std::chrono::high_resolution_clock::now();
+      Merkle tree(leaves);
+      auto end = std::chrono::high_resolution_clock::now();
+      long double seconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000000.0L;
+      std::cout << "Merkle tree of " << leaves.size() << " leaves: " << seconds * 1000 << " ms" << std::endl;
+      REQUIRE(tree.getLeaves().size() == leaves.size());
+    }
+  }
+}
@@ -0,0 +1,46 @@
+/*
+  Copyright (c) [2023-2024] [AppLayer Developers]
+  This software is distributed under the MIT License.
+  See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../src/libs/catch2/catch_amalgamated.hpp"
+
+#include "../src/utils/txdecoder.h"
+
+namespace TTXDECODERBENCHMARK {
+  TEST_CASE("TxDecoder Benchmark", "[benchmark][txdecoder]") {
+    SECTION("Decode and recover 20000 block transactions") {
+      const uint64_t txCount = 20000;
+      const uint64_t chainId = 8080;
+      std::vector<Bytes> serializedTxs;
+      serializedTxs.reserve(txCount);
+      for (uint64_t i = 0; i < txCount; i++) {
+        const PrivKey privKey(Utils::randBytes(32));
+        const Address from = Secp256k1::toAddress(Secp256k1::toUPub(privKey));
+        serializedTxs.emplace_back(TxBlock(
+          Address(Utils::randBytes(20)), from, Bytes(), chainId, 0, 1000000000000000000, 1000000000, 1000000000, 21000, privKey
+        ).rlpSerialize());
+      }
+      std::vector<View<Bytes>> rawTxs(serializedTxs.cbegin(), serializedTxs.cend());
+
+      auto start = std::chrono::high_resolution_clock::now();
+      for (const View<Bytes> raw : rawTxs) {
+        TxBlock tx(raw, chainId);
+      }
+      auto end = std::chrono::high_resolution_clock::now();
+      long double sequentialSeconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000000.0L;
+      std::cout << "Sequential decoding: " << txCount / sequentialSeconds << " txs/s" << std::endl;
+
+      TxDecoder& decoder = TxDecoder::shared();
+      start = std::chrono::high_resolution_clock::now();
+      const auto decoded = decoder.decode(rawTxs, chainId);
+      end = std::chrono::high_resolution_clock::now();
+      long double poolSeconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000000.0L;
+      std::cout << "TxDecoder (" << decoder.getThreads() << " workers + caller): " << txCount / poolSeconds << " txs/s" << std::endl;
+
+      REQUIRE(decoded.size() == txCount);
+      for (const auto& tx : decoded) REQUIRE(tx.has_value());
+    }
+  }
+}
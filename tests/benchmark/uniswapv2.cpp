@@ -13,6 +13,13 @@ See the LICENSE.txt file in the project root for more information.
 
 #include "../sdktestsuite.hpp"
 
+#include "allocations.hpp"
+#include "evmenvironment.hpp"
+
+namespace TERC20BENCHMARK {
+  extern Bytes erc20bytecode; ///< OpenZeppelin ERC20 minting 10000 tokens to the deployer, defined in erc20.cpp.
+}
+
 // TODO: test events if/when implemented
 
 namespace TDEXV2 {
@@ -62,18 +69,71 @@ namespace TDEXV2 {
       REQUIRE(swapTx != Hash());
       TxBlock tx = sdk.getStorage().latest()->getTxs()[0];
       uint64_t iterations = 250000;
-
-      auto start = std::chrono::high_resolution_clock::now();
       auto& state = sdk.getState();
-      for (uint64_t i = 0; i < iterations; i++) {
-        state.call(tx);
+
+      // Undo journal allocated for every call, then reused across calls like State does for a block
+      ExecutionContext::Journal journal;
+      for (const bool reuseJournal : {false, true}) {
+        const uint64_t allocationsBefore = BenchmarkAllocations::count();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+          state.call(tx, reuseJournal ? &journal : nullptr);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        long double durationInMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        long double microSecsPerCall = durationInMicroseconds / iterations;
+        long double allocationsPerCall = static_cast<long double>(BenchmarkAllocations::count() - allocationsBefore) / iterations;
+        const std::string journalMode = reuseJournal ? "reused journal" : "journal per call";
+        std::cout << "DEXV2 Swap Token to Token (" << journalMode << ") " << microSecsPerCall << " microseconds per call, "
+          << allocationsPerCall << " allocations per call" << std::endl;
+        std::cout << "CPP Total Time (" << journalMode << "): " << durationInMicroseconds / 1000000 << " seconds" << std::endl;
       }
-      auto end = std::chrono::high_resolution_clock::now();
+    }
 
-      long double durationInMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
-      long double microSecsPerCall = durationInMicroseconds / iterations;
-      std::cout << "DEXV2 Swap Token to Token " << microSecsPerCall << " microseconds per call" << std::endl;
-      std::cout << "CPP Total Time: " << durationInMicroseconds / 1000000 << " seconds" << std::endl;
+    SECTION("EVM token DEXV2 Swap Benchmark") {
+      // The pair's second token is an EVM contract, so every swap runs EVM code (transfer and balanceOf)
+      uint64_t iterations = 100000;
+      for (const EvmBenchmarkSettings& settings : evmBenchmarkSettings) {
+        SDKTestSuite sdk = createEvmBenchmarkEnvironment("testDEXV2EvmTokenBenchmark", settings);
+        Address tokenA = sdk.deployContract<ERC20>(std::string("TokenA"), std::string("TKNA"), uint8_t(18), uint256_t("10000000000000000000000"));
+        Address tokenB = sdk.deployBytecode(TERC20BENCHMARK::erc20bytecode);
+        Address wrapped = sdk.deployContract<NativeWrapper>(std::string("WSPARQ"), std::string("WSPARQ"), uint8_t(18));
+        Address factory = sdk.deployContract<DEXV2Factory>(Address());
+        Address router = sdk.deployContract<DEXV2Router02>(factory, wrapped);
+        Address owner = sdk.getChainOwnerAccount().address;
+
+        sdk.callFunction(tokenA, &ERC20::approve, router, uint256_t("10000000000000000000000"));
+        sdk.callFunction(tokenB, &ERC20::approve, router, uint256_t("10000000000000000000000"));
+        REQUIRE(sdk.callViewFunction(tokenB, &ERC20::allowance, owner, router) == uint256_t("10000000000000000000000"));
+
+        uint256_t deadline = std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch()
+        ).count() + 60000000000;  // 60000 seconds
+        sdk.callFunction(router, &DEXV2Router02::addLiquidity,
+          tokenA, tokenB, uint256_t("100000000000000000000"), uint256_t("250000000000000000000"),
+          uint256_t(0), uint256_t(0), owner, deadline
+        );
+        REQUIRE(sdk.callViewFunction(tokenB, &ERC20::balanceOf, owner) == uint256_t("9750000000000000000000"));
+
+        Hash swapTx = sdk.callFunction(router, &DEXV2Router02::swapExactTokensForTokens,
+          uint256_t("10000"), uint256_t(0), std::vector<Address>({ tokenA, tokenB }), owner, deadline
+        );
+        REQUIRE(swapTx != Hash());
+        TxBlock tx = sdk.getStorage().latest()->getTxs()[0];
+        auto& state = sdk.getState();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) {
+          state.call(tx);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+
+        long double durationInMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        long double microSecsPerCall = durationInMicroseconds / iterations;
+        std::cout << "DEXV2 Swap Token to EVM Token (" << settings.describe() << ") " << microSecsPerCall << " microseconds per call" << std::endl;
+        std::cout << "Total Time (" << settings.describe() << "): " << durationInMicroseconds / 1000000 << " seconds" << std::endl;
+      }
     }
   }
 }
@@ -34,7 +34,7 @@ struct TestBlockchainWrapper {
   explicit TestBlockchainWrapper(const Options& options_) :
     options(options_),
     p2p(LOCALHOST, options, storage, state),
-    db(std::get<0>(DumpManager::getBestStateDBPath(options))),
+    db(std::get<0>(DumpManager::getBestStateDBPath(options)), options.getDBSettings()),
     storage(p2p.getLogicalLocation(), options),
     state(db, storage, p2p, std::get<1>(DumpManager::getBestStateDBPath(options)), options),
     http(state, storage, p2p, options),
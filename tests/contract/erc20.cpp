@@ -14,6 +14,8 @@ See the LICENSE.txt file in the project root for more information.
 #include "bytes/hex.h"
 #include "contract/templates/standards/ierc721receiver.hpp"
 
+#include <future>
+
 // TODO: test events if/when implemented
 
 namespace TERC20 {
@@ -130,6 +132,113 @@ namespace TERC20 {
       REQUIRE(balanceMe == uint256_t("500000000000000000"));
       REQUIRE(balanceTo == uint256_t("500000000000000000"));
     }
+
+    SECTION("ERC20 concurrent eth_call and eth_estimateGas") {
+      SDKTestSuite sdk = SDKTestSuite::createNewEnvironment("testERC20ConcurrentSimulations");
+      Address erc20 = sdk.deployContract<ERC20>(
+        std::string("TestToken"), std::string("TST"), uint8_t(18), uint256_t("1000000000000000000")
+      );
+      Address owner = sdk.getChainOwnerAccount().address;
+      Address to(Utils::randBytes(20));
+
+      Bytes balanceOfData;
+      Utils::appendBytes(balanceOfData, UintConv::uint32ToBytes(ABI::FunctorEncoder::encode<Address>("balanceOf").value));
+      Utils::appendBytes(balanceOfData, ABI::Encoder::encodeData<Address>(owner));
+      Bytes transferData;
+      Utils::appendBytes(transferData, UintConv::uint32ToBytes(ABI::FunctorEncoder::encode<Address, uint256_t>("transfer").value));
+      Utils::appendBytes(transferData, ABI::Encoder::encodeData<Address, uint256_t>(to, uint256_t("1000")));
+
+      Gas expectedGasLimit(10'000'000);
+      const int64_t expectedGas = sdk.getState().estimateGas(EncodedCallMessage(owner, erc20, expectedGasLimit, 0, transferData));
+
+      // Simulations run under a shared lock, none of them may leak into the state or into each other
+      std::vector<std::future<bool>> futures;
+      for (int t = 0; t < 8; t++) {
+        futures.emplace_back(std::async(std::launch::async, [&] () {
+          for (int i = 0; i < 50; i++) {
+            Gas callGas(10'000'000);
+            EncodedStaticCallMessage callMsg(owner, erc20, callGas, balanceOfData);
+            const Bytes result = sdk.getState().ethCall(callMsg);
+            if (std::get<0>(ABI::Decoder::decodeData<uint256_t>(result)) != uint256_t("1000000000000000000")) return false;
+            Gas estimateGas(10'000'000);
+            if (sdk.getState().estimateGas(EncodedCallMessage(owner, erc20, estimateGas, 0, transferData)) != expectedGas) return false;
+          }
+          return true;
+        }));
+      }
+      for (auto& future : futures) REQUIRE(future.get());
+
+      REQUIRE(sdk.callViewFunction(erc20, &ERC20::balanceOf, owner) == uint256_t("1000000000000000000"));
+      REQUIRE(sdk.callViewFunction(erc20, &ERC20::balanceOf, to) == uint256_t(0));
+    }
+
+    SECTION("ERC20 delta dumps across several saves") {
+      Address erc20;
+      Address to(Utils::randBytes(20));
+      Address spender(Utils::randBytes(20));
+      std::unique_ptr<Options> options;
+      {
+        SDKTestSuite sdk = SDKTestSuite::createNewEnvironment("testERC20DeltaDumps");
+        erc20 = sdk.deployContract<ERC20>(
+          std::string("TestToken"), std::string("TST"), uint8_t(18), uint256_t("1000000000000000000")
+        );
+        options = std::make_unique<Options>(sdk.getOptions());
+        // First save writes the whole contract, the following ones only what changed since
+        sdk.getState().saveToDB();
+        sdk.callFunction(erc20, &ERC20::transfer, to, uint256_t("250000000000000000"));
+        sdk.getState().saveToDB();
+        sdk.callFunction(erc20, &ERC20::approve, spender, uint256_t("100000000000000000"));
+        sdk.callFunction(erc20, &ERC20::transfer, to, uint256_t("250000000000000000"));
+        sdk.getState().saveToDB();
+      }
+      SDKTestSuite sdk(*options);
+      Address owner = sdk.getChainOwnerAccount().address;
+      REQUIRE(sdk.callViewFunction(erc20, &ERC20::name) == "TestToken");
+      REQUIRE(sdk.callViewFunction(erc20, &ERC20::totalSupply) == uint256_t("1000000000000000000"));
+      REQUIRE(sdk.callViewFunction(erc20, &ERC20::balanceOf, owner) == uint256_t("500000000000000000"));
+      REQUIRE(sdk.callViewFunction(erc20, &ERC20::balanceOf, to) == uint256_t("500000000000000000"));
+      REQUIRE(sdk.callViewFunction(erc20, &ERC20::allowance, owner, spender) == uint256_t("100000000000000000"));
+    }
+
+    SECTION("ERC20 state dump concurrent with eth_estimateGas") {
+      SDKTestSuite sdk = SDKTestSuite::createNewEnvironment("testERC20DumpConcurrentSimulations");
+      Address erc20 = sdk.deployContract<ERC20>(
+        std::string("TestToken"), std::string("TST"), uint8_t(18), uint256_t("1000000000000000000")
+      );
+      Address owner = sdk.getChainOwnerAccount().address;
+      Address to(Utils::randBytes(20));
+      Bytes transferData;
+      Utils::appendBytes(transferData, UintConv::uint32ToBytes(ABI::FunctorEncoder::encode<Address, uint256_t>("transfer").value));
+      Utils::appendBytes(transferData, ABI::Encoder::encodeData<Address, uint256_t>(to, uint256_t("1000000000000000000")));
+
+      // What a dump of the committed contract writes
+      const Bytes prefix = sdk.getState().markContractDirty(erc20);
+      sdk.getState().saveToDB();
+      const std::vector<DBEntry> expected = sdk.getDB().getBatch(prefix);
+      REQUIRE(!expected.empty());
+
+      // Simulated transfers write the contract's balances in place until they're done,
+      // dumps taken in the meantime must never see them
+      std::atomic<bool> stop = false;
+      auto simulations = std::async(std::launch::async, [&]() {
+        while (!stop) {
+          Gas gas(10'000'000);
+          sdk.getState().estimateGas(EncodedCallMessage(owner, erc20, gas, 0, transferData));
+        }
+      });
+      bool consistent = true;
+      for (int i = 0; i < 50 && consistent; i++) {
+        sdk.getState().markContractDirty(erc20);
+        sdk.getState().saveToDB();
+        const std::vector<DBEntry> dumped = sdk.getDB().getBatch(prefix);
+        consistent = std::ranges::equal(dumped, expected, [](const DBEntry& a, const DBEntry& b) {
+          return a.key == b.key && a.value == b.value;
+        });
+      }
+      stop = true;
+      simulations.get();
+      REQUIRE(consistent);
+    }
   }
 }
 
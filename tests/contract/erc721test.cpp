@@ -67,28 +67,45 @@ namespace TERC721Test {
         sdk.getState().saveToDB();
       }
 
-      // SDKTestSuite should automatically load the state from the DB if we construct it with an Options object
-      // (The createNewEnvironment DELETES the DB if any is found)
-      SDKTestSuite sdk(*options);
-      auto owner = sdk.callViewFunction(ERC721Address, &ERC721Test::ownerOf, uint256_t(0));
-      REQUIRE(owner == sdk.getChainOwnerAccount().address);
-      REQUIRE(sdk.callViewFunction(ERC721Address, &ERC721Test::balanceOf, sdk.getChainOwnerAccount().address) == 1);
-      REQUIRE(sdk.callViewFunction(ERC721Address, &ERC721Test::totalSupply) == 1);
+      {
+        // SDKTestSuite should automatically load the state from the DB if we construct it with an Options object
+        // (The createNewEnvironment DELETES the DB if any is found)
+        SDKTestSuite sdk(*options);
+        auto owner = sdk.callViewFunction(ERC721Address, &ERC721Test::ownerOf, uint256_t(0));
+        REQUIRE(owner == sdk.getChainOwnerAccount().address);
+        REQUIRE(sdk.callViewFunction(ERC721Address, &ERC721Test::balanceOf, sdk.getChainOwnerAccount().address) == 1);
+        REQUIRE(sdk.callViewFunction(ERC721Address, &ERC721Test::totalSupply) == 1);
 
-      // For coverage
-      // Try minting to zero address
-      REQUIRE_THROWS(sdk.callFunction(ERC721Address, &ERC721Test::mint, Address()));
+        // For coverage
+        // Try minting to zero address
+        REQUIRE_THROWS(sdk.callFunction(ERC721Address, &ERC721Test::mint, Address()));
 
-      // Try transferring to zero address and from wrong owner
-      Address add1(bytes::hex("0x1234567890123456789012345678901234567890"));
-      Address add2(bytes::hex("0x0987654321098765432109876543210987654321"));
-      REQUIRE_THROWS(sdk.callFunction(ERC721Address, &ERC721Test::transferFrom, sdk.getChainOwnerAccount().address, Address(), uint256_t(0)));
-      REQUIRE_THROWS(sdk.callFunction(ERC721Address, &ERC721Test::transferFrom, add1, add2, uint256_t(0)));
+        // Try transferring to zero address and from wrong owner
+        Address add1(bytes::hex("0x1234567890123456789012345678901234567890"));
+        Address add2(bytes::hex("0x0987654321098765432109876543210987654321"));
+        REQUIRE_THROWS(sdk.callFunction(ERC721Address, &ERC721Test::transferFrom, sdk.getChainOwnerAccount().address, Address(), uint256_t(0)));
+        REQUIRE_THROWS(sdk.callFunction(ERC721Address, &ERC721Test::transferFrom, add1, add2, uint256_t(0)));
 
-      // Burn the token and try to burn it again then transfer it
-      REQUIRE_NOTHROW(sdk.callFunction(ERC721Address, &ERC721Test::burn, uint256_t(0)));
-      REQUIRE_THROWS(sdk.callFunction(ERC721Address, &ERC721Test::burn, uint256_t(0))); // Already burnt
-      REQUIRE_THROWS(sdk.callFunction(ERC721Address, &ERC721Test::transferFrom, sdk.getChainOwnerAccount().address, add1, uint256_t(0)));
+        // Burn the token and try to burn it again then transfer it
+        REQUIRE_NOTHROW(sdk.callFunction(ERC721Address, &ERC721Test::burn, uint256_t(0)));
+        REQUIRE_THROWS(sdk.callFunction(ERC721Address, &ERC721Test::burn, uint256_t(0))); // Already burnt
+        REQUIRE_THROWS(sdk.callFunction(ERC721Address, &ERC721Test::transferFrom, sdk.getChainOwnerAccount().address, add1, uint256_t(0)));
+
+        // The first dump after loading finds the keys of burned tokens in the DB,
+        // the next ones compare with the keys the contract wrote last time
+        sdk.getState().saveToDB();
+        REQUIRE_NOTHROW(sdk.callFunction(ERC721Address, &ERC721Test::mint, sdk.getChainOwnerAccount().address));
+        sdk.getState().saveToDB();
+        REQUIRE_NOTHROW(sdk.callFunction(ERC721Address, &ERC721Test::burn, uint256_t(1)));
+        sdk.getState().saveToDB();
+      }
+
+      // Burned tokens must not come back from the DB
+      SDKTestSuite sdk(*options);
+      REQUIRE_THROWS(sdk.callViewFunction(ERC721Address, &ERC721Test::ownerOf, uint256_t(0)));
+      REQUIRE_THROWS(sdk.callViewFunction(ERC721Address, &ERC721Test::ownerOf, uint256_t(1)));
+      REQUIRE(sdk.callViewFunction(ERC721Address, &ERC721Test::balanceOf, sdk.getChainOwnerAccount().address) == 0);
+      REQUIRE(sdk.callViewFunction(ERC721Address, &ERC721Test::totalSupply) == 0);
     }
 
     SECTION("ERC721Test Mint 100 Token Same Address") {
@@ -0,0 +1,77 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include <evmc/mocked_host.hpp>
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+
+#include "../../src/contract/evmcodecache.h"
+
+#include "bytes/hex.h"
+#include "utils/utils.h"
+
+// PUSH1 <n> PUSH1 0 MSTORE PUSH1 32 PUSH1 0 RETURN, returns <n> as a 32-byte word
+static Bytes returnWordCode(uint8_t n) {
+  return Bytes{0x60, n, 0x60, 0x00, 0x52, 0x60, 0x20, 0x60, 0x00, 0xf3};
+}
+
+static uint8_t executeCode(EvmCodeCache& cache, evmc_vm* vm, const Bytes& code) {
+  evmc::MockedHost host;
+  evmc_message msg{};
+  msg.kind = EVMC_CALL;
+  msg.gas = 1'000'000;
+  const evmc::Result result = cache.execute(
+    vm, &evmc::Host::get_interface(), host.to_context(), EVMC_PRAGUE, msg, Utils::sha3(code), code
+  );
+  REQUIRE(result.status_code == EVMC_SUCCESS);
+  REQUIRE(result.output_size == 32);
+  return result.output_data[31];
+}
+
+namespace TEvmCodeCache {
+  TEST_CASE("EvmCodeCache Tests", "[contract][evmcodecache]") {
+    SECTION("EvmCodeCache executes the same way with both interpreters") {
+      for (const EvmInterpreter interpreter : {EvmInterpreter::BASELINE, EvmInterpreter::ADVANCED}) {
+        EvmCodeCache cache(interpreter, 16);
+        std::unique_ptr<evmc_vm, void(*)(evmc_vm*)> vm(EvmCodeCache::createVm(interpreter), evmc_destroy);
+        REQUIRE(cache.getInterpreter() == interpreter);
+        REQUIRE(executeCode(cache, vm.get(), returnWordCode(42)) == 42);
+        REQUIRE(executeCode(cache, vm.get(), returnWordCode(42)) == 42);
+        REQUIRE(executeCode(cache, vm.get(), returnWordCode(7)) == 7);
+#ifdef BDK_EVMONE_ANALYSIS
+        REQUIRE(cache.size() == 2);
+        REQUIRE(cache.getMisses() == 2);
+        REQUIRE(cache.getHits() == 1);
+#else
+        REQUIRE(cache.size() == 0);
+#endif
+      }
+    }
+
+    SECTION("EvmCodeCache evicts the least recently used code") {
+      EvmCodeCache cache(EvmInterpreter::BASELINE, 2);
+      std::unique_ptr<evmc_vm, void(*)(evmc_vm*)> vm(EvmCodeCache::createVm(EvmInterpreter::BASELINE), evmc_destroy);
+      for (uint8_t i = 1; i <= 3; i++) REQUIRE(executeCode(cache, vm.get(), returnWordCode(i)) == i);
+      // 1 was evicted when 3 was added, 3 is still cached
+      REQUIRE(executeCode(cache, vm.get(), returnWordCode(3)) == 3);
+      REQUIRE(executeCode(cache, vm.get(), returnWordCode(1)) == 1);
+#ifdef BDK_EVMONE_ANALYSIS
+      REQUIRE(cache.size() == 2);
+      REQUIRE(cache.getHits() == 1);
+      REQUIRE(cache.getMisses() == 4);
+#endif
+    }
+
+    SECTION("EvmCodeCache with no capacity caches nothing") {
+      EvmCodeCache cache(EvmInterpreter::BASELINE, 0);
+      std::unique_ptr<evmc_vm, void(*)(evmc_vm*)> vm(EvmCodeCache::createVm(EvmInterpreter::BASELINE), evmc_destroy);
+      REQUIRE(executeCode(cache, vm.get(), returnWordCode(42)) == 42);
+      REQUIRE(cache.size() == 0);
+      REQUIRE(cache.getHits() == 0);
+    }
+  }
+}
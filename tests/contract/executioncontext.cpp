@@ -9,6 +9,8 @@ See the LICENSE.txt file in the project root for more information.
 #include "bytes/hex.h"
 #include "contract/executioncontext.h"
 
+#include <mutex>
+
 static inline void addAccount(ExecutionContext& context, View<Address> address, const Account& account) {
   auto pointer = context.getAccount(address);
   pointer.setBalance(account.balance);
@@ -349,4 +351,106 @@ TEST_CASE("Execution Context Test Cases", "[executioncontext]") {
     REQUIRE(context.retrieve(addr[5], slots[5]) == Hash());
     REQUIRE(context.retrieve(addr[6], slots[6]) == Hash());
   }
+
+  SECTION("Overlay context writes are discarded") {
+    ExecutionContext::Accounts accounts;
+    ExecutionContext::Storage storage;
+    ExecutionContext::Contracts contracts;
+    ExecutionContext::EVMContracts evmContracts;
+    std::mutex contractsMutex;
+
+    const Address existing = bytes::hex("0xa29F7649159DBF66daaa6D03F9ed5733c85BDc27");
+    const Address created = bytes::hex("0x87e42c3307c79334e4A22EF406BDe0A004D9c8C7");
+    const Hash slot = bytes::hex("0x0000000000000000000000000000000000000000000000000000000000000001");
+    const Hash data = bytes::hex("0xc89a747ae61fb49aeefadaa8d6fce73ab2f61b444a196c026d46cbe550b90b5b");
+    const Hash newData = bytes::hex("0x044475f2cb0876a477b9f7fb401162317ea6ae98c5a7fc84b84cda820c864541");
+    const Hash codeHash = bytes::hex("0xac7dbb9fd2bf03c58b61664bf453bf7760de39edd91cf812f4b8d49763d29a03");
+
+    accounts.emplace(existing, Account(1000, 5));
+    storage.emplace(StorageKeyView(existing, slot), data);
+
+    {
+      ExecutionContext context = ExecutionContext::Builder()
+        .storage(storage)
+        .accounts(accounts)
+        .contracts(contracts)
+        .evmContracts(evmContracts)
+        .overlay(contractsMutex)
+        .build();
+
+      REQUIRE(context.isOverlay());
+      REQUIRE(context.getAccount(existing).getBalance() == 1000);
+      REQUIRE(context.retrieve(existing, slot) == data);
+
+      context.transferBalance(existing, created, 400);
+      context.store(existing, slot, newData);
+      context.checkEVMContract(codeHash, Utils::makeBytes(bytes::hex("0x6000")));
+
+      REQUIRE(context.getAccount(existing).getBalance() == 600);
+      REQUIRE(context.getAccount(created).getBalance() == 400);
+      REQUIRE(context.accountExists(created));
+      REQUIRE(context.retrieve(existing, slot) == newData);
+
+      context.commit();
+    }
+
+    REQUIRE(accounts.size() == 1);
+    REQUIRE(accounts.at(existing)->balance == 1000);
+    REQUIRE(storage.size() == 1);
+    REQUIRE(storage.at(StorageKeyView(existing, slot)) == data);
+    REQUIRE(evmContracts.empty());
+    REQUIRE(contractsMutex.try_lock()); // No contract was touched, so the lock was never taken
+    contractsMutex.unlock();
+  }
+
+  SECTION("Contexts sharing a journal") {
+    ExecutionContext::Accounts accounts;
+    ExecutionContext::Storage storage;
+    ExecutionContext::Journal journal;
+
+    const Address from = bytes::hex("0xa29F7649159DBF66daaa6D03F9ed5733c85BDc27");
+    const Address to = bytes::hex("0x87e42c3307c79334e4A22EF406BDe0A004D9c8C7");
+    const Hash slot = bytes::hex("0x0000000000000000000000000000000000000000000000000000000000000001");
+    const Hash data = bytes::hex("0xc89a747ae61fb49aeefadaa8d6fce73ab2f61b444a196c026d46cbe550b90b5b");
+
+    accounts.emplace(from, Account(1000, 5));
+
+    {
+      ExecutionContext context = ExecutionContext::Builder().storage(storage).accounts(accounts).journal(journal).build();
+      context.transferBalance(from, to, 100);
+      REQUIRE(journal.size() == 2);
+      context.commit();
+      REQUIRE(journal.size() == 0);
+    }
+
+    REQUIRE(accounts.at(from)->balance == 900);
+    REQUIRE(accounts.at(to)->balance == 100);
+
+    {
+      ExecutionContext outer = ExecutionContext::Builder().storage(storage).accounts(accounts).journal(journal).build();
+      outer.store(from, slot, data);
+
+      {
+        // A context built on top of another only commits or reverts its own entries
+        ExecutionContext inner = ExecutionContext::Builder().storage(storage).accounts(accounts).journal(journal).build();
+        inner.transferBalance(to, from, 50);
+        REQUIRE(journal.size() == 3);
+        inner.commit();
+        REQUIRE(journal.size() == 1);
+      }
+
+      {
+        ExecutionContext inner = ExecutionContext::Builder().storage(storage).accounts(accounts).journal(journal).build();
+        inner.transferBalance(from, to, 500);
+      }
+
+      REQUIRE(journal.size() == 1);
+      REQUIRE(outer.retrieve(from, slot) == data);
+    }
+
+    REQUIRE(journal.size() == 0);
+    REQUIRE(storage.empty());
+    REQUIRE(accounts.at(from)->balance == 950);
+    REQUIRE(accounts.at(to)->balance == 50);
+  }
 }
@@ -680,6 +680,37 @@ namespace TSafeUnorderedMap {
       map.commit();
       REQUIRE(map.size() == 50);
     }
+
+    SECTION("SafeUnorderedMap change tracking") {
+      Address add1(Utils::randBytes(20));
+      Address add2(Utils::randBytes(20));
+      Address add3(Utils::randBytes(20));
+      uint256_t bal1("19283815712031512");
+      uint256_t bal2("96482364197823643");
+      SafeUnorderedMap<Address, uint256_t> map({{add1,bal1},{add2,bal2}});
+      // Nothing is tracked until enabled
+      map[add1] = bal2;
+      map.commit();
+      REQUIRE(map.takeChanges().empty());
+
+      map.enableChangeTracking();
+      map[add1] = bal1;
+      map.erase(add2);
+      map.commit();
+      map[add3] = bal1; // Reverted, so not a change
+      map.revert();
+      auto changes = map.takeChanges();
+      std::ranges::sort(changes, [](const auto& a, const auto& b) { return a.first < b.first; });
+      auto expected = std::vector<std::pair<Address, std::optional<uint256_t>>>{{add1, bal1}, {add2, std::nullopt}};
+      std::ranges::sort(expected, [](const auto& a, const auto& b) { return a.first < b.first; });
+      REQUIRE(changes == expected);
+      // Taken changes are forgotten
+      REQUIRE(map.takeChanges().empty());
+      map[add3] = bal2;
+      map.commit();
+      map.clearChanges();
+      REQUIRE(map.takeChanges().empty());
+    }
   }
 }
 
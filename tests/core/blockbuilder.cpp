@@ -0,0 +1,134 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+
+#include "../../src/core/blockbuilder.h"
+#include "../../src/core/comet.h"
+
+static const uint256_t gwei = 1000000000;
+
+static TxBlock makeTx(const PrivKey& privKey, uint64_t nonce, const uint256_t& fee, uint64_t gasLimit = 21000) {
+  const Address from = Secp256k1::toAddress(Secp256k1::toUPub(privKey));
+  return TxBlock(Address(Utils::randBytes(20)), from, Bytes(), 8080, nonce, 1, fee, fee, gasLimit, privKey);
+}
+
+static std::vector<Hash> selectedHashes(const std::vector<TxBlock>& txs, const std::vector<size_t>& selected) {
+  std::vector<Hash> hashes;
+  for (const size_t i : selected) hashes.emplace_back(txs[i].hash());
+  return hashes;
+}
+
+/// Listener that selects its proposals with BlockBuilder, the way a node with a State would.
+class ProposalListener : public CometListener {
+  public:
+    BlockBuilder::AccountLookup account; ///< Lookup for the senders' nonces and balances.
+    uint64_t maxGas = 100'000'000; ///< Gas budget of the proposals.
+
+    void getProposalLimits(CometProposalLimits& limits) override {
+      limits.chainId = 8080;
+      limits.account = this->account;
+      limits.maxGas = this->maxGas;
+      limits.maxTime = std::chrono::seconds(10);
+    }
+};
+
+namespace TBlockBuilder {
+  TEST_CASE("BlockBuilder Tests", "[core][blockbuilder]") {
+    const PrivKey keyA(Utils::randBytes(32));
+    const PrivKey keyB(Utils::randBytes(32));
+    const BlockBuilder::Limits unlimited{100'000'000, 100'000'000, std::chrono::seconds(10)};
+    const BlockBuilder::AccountLookup richAccounts = [](const Address&) {
+      return std::make_pair(uint64_t(0), uint256_t("1000000000000000000000"));
+    };
+
+    SECTION("BlockBuilder merges sender chains by fee, keeping each sender's nonce order") {
+      std::vector<TxBlock> txs{
+        makeTx(keyA, 2, 2 * gwei), makeTx(keyB, 1, 1 * gwei), makeTx(keyA, 0, 2 * gwei),
+        makeTx(keyB, 0, 3 * gwei), makeTx(keyA, 1, 2 * gwei)
+      };
+      const auto selected = BlockBuilder::select(txs, richAccounts, unlimited);
+      REQUIRE(selectedHashes(txs, selected) == std::vector<Hash>{
+        txs[3].hash(), txs[2].hash(), txs[4].hash(), txs[0].hash(), txs[1].hash()
+      });
+    }
+
+    SECTION("BlockBuilder cuts chains at nonce gaps, used nonces and unpaid transactions") {
+      std::vector<TxBlock> txs{
+        makeTx(keyA, 0, gwei), makeTx(keyA, 2, gwei), // Gap at nonce 1
+        makeTx(keyB, 4, gwei), makeTx(keyB, 5, gwei), makeTx(keyB, 6, gwei), makeTx(keyB, 7, gwei)
+      };
+      const Address addrB = Secp256k1::toAddress(Secp256k1::toUPub(keyB));
+      const uint256_t txCost = 1 + 21000 * gwei;
+      const auto selected = BlockBuilder::select(txs, [&](const Address& sender) {
+        // B already used nonce 4, and can only pay for two more transactions
+        if (sender == addrB) return std::make_pair(uint64_t(5), 2 * txCost);
+        return std::make_pair(uint64_t(0), 10 * txCost);
+      }, unlimited);
+      REQUIRE(selected.size() == 3);
+      REQUIRE(std::ranges::count(selected, 0) == 1);
+      REQUIRE(std::ranges::count(selected, 3) == 1);
+      REQUIRE(std::ranges::count(selected, 4) == 1);
+    }
+
+    SECTION("BlockBuilder takes the best paying transaction out of repeated nonces") {
+      std::vector<TxBlock> txs{makeTx(keyA, 0, gwei), makeTx(keyA, 0, 2 * gwei), makeTx(keyA, 1, gwei)};
+      const auto selected = BlockBuilder::select(txs, richAccounts, unlimited);
+      REQUIRE(selected == std::vector<size_t>{1, 2});
+    }
+
+    SECTION("BlockBuilder respects the gas and byte budgets") {
+      std::vector<TxBlock> txs{
+        makeTx(keyA, 0, 3 * gwei, 50000), makeTx(keyA, 1, 3 * gwei, 50000), makeTx(keyB, 0, 2 * gwei), makeTx(keyB, 1, gwei)
+      };
+      // A1 doesn't fit after A0, which also keeps out the rest of A's chain
+      const auto byGas = BlockBuilder::select(txs, richAccounts, {50000 + 21000 * 2, 100'000'000, std::chrono::seconds(10)});
+      REQUIRE(byGas == std::vector<size_t>{0, 2, 3});
+      const auto byBytes = BlockBuilder::select(txs, richAccounts, {100'000'000, txs[0].rlpSize(), std::chrono::seconds(10)});
+      REQUIRE(byBytes == std::vector<size_t>{0});
+    }
+
+    SECTION("BlockBuilder stops at the deadline") {
+      std::vector<TxBlock> txs{makeTx(keyA, 0, gwei), makeTx(keyB, 0, gwei)};
+      REQUIRE(BlockBuilder::select(txs, richAccounts, {100'000'000, 100'000'000, std::chrono::microseconds(0)}).empty());
+    }
+
+    SECTION("BlockBuilder selects raw transactions and skips undecodable ones") {
+      std::vector<TxBlock> txs{makeTx(keyA, 0, gwei), makeTx(keyB, 0, 2 * gwei)};
+      std::vector<Bytes> raw{txs[0].rlpSerialize(), Bytes{0xde, 0xad, 0xbe, 0xef}, txs[1].rlpSerialize()};
+      REQUIRE(BlockBuilder::selectRaw(raw, 8080, richAccounts, unlimited) == std::vector<size_t>{2, 0});
+    }
+
+    SECTION("CometListener proposes the transactions BlockBuilder selects within maxTxBytes and the gas budget") {
+      std::vector<TxBlock> txs{makeTx(keyA, 0, gwei), makeTx(keyB, 0, 2 * gwei), makeTx(keyB, 1, 2 * gwei)};
+      CometBlock block;
+      block.txs = {txs[0].rlpSerialize(), Bytes{0xde, 0xad, 0xbe, 0xef}, txs[1].rlpSerialize(), txs[2].rlpSerialize()};
+      ProposalListener listener;
+      listener.account = richAccounts;
+      bool noChange = true;
+      std::vector<size_t> txIds;
+      std::vector<Bytes> injectTxs;
+      listener.buildBlockProposal(100'000'000, block, noChange, txIds, injectTxs);
+      REQUIRE_FALSE(noChange);
+      REQUIRE(txIds == std::vector<size_t>{2, 3, 0});
+      // Only B's chain fits the bytes CometBFT allows
+      listener.buildBlockProposal(txs[1].rlpSize() + txs[2].rlpSize(), block, noChange, txIds, injectTxs);
+      REQUIRE(txIds == std::vector<size_t>{2, 3});
+      // Only B0 fits the gas budget
+      listener.maxGas = 21000;
+      listener.buildBlockProposal(100'000'000, block, noChange, txIds, injectTxs);
+      REQUIRE(txIds == std::vector<size_t>{2});
+      REQUIRE(injectTxs.empty());
+
+      // Without an account lookup, CometBFT's transactions are forwarded as they are
+      CometListener plainListener;
+      noChange = false;
+      plainListener.buildBlockProposal(100'000'000, block, noChange, txIds, injectTxs);
+      REQUIRE(noChange);
+    }
+  }
+}
@@ -60,6 +60,91 @@ namespace TDumpManager {
       );
       REQUIRE(bestBlockHash == blockchainWrapper.storage.latest()->getHash());
     }
+
+    SECTION("DumpManager State snapshot is a point-in-time view of the entries not stored yet") {
+      auto blockchainWrapper = initialize(
+        validatorPrivKeysState,
+        validatorPrivKeysState[0],
+        8080,
+        true,
+        testDumpPath + "/dumpManagerSnapshotTests"
+      );
+      auto toMap = [](const DBBatch& batch) {
+        std::map<Bytes, Bytes> entries;
+        for (const auto& entry : batch.getPuts()) entries.emplace(entry.key, entry.value);
+        return entries;
+      };
+      const Address addr(Utils::randBytes(20));
+      blockchainWrapper.state.addBalance(addr);
+      const DBBatch expected = blockchainWrapper.state.dump();
+      auto snapshot = blockchainWrapper.state.snapshot();
+      // Changes made after the snapshot was captured must not show up in it
+      blockchainWrapper.state.addBalance(addr);
+      blockchainWrapper.state.addBalance(Address(Utils::randBytes(20)));
+      // Nothing was stored yet (genesis included), so it holds every entry
+      const DBBatch captured = snapshot();
+      REQUIRE(toMap(captured) == toMap(expected));
+      REQUIRE(blockchainWrapper.state.dump().getPuts().size() == expected.getPuts().size() + 1);
+
+      // Entries of a dump that wasn't stored are captured again, until one is
+      REQUIRE(blockchainWrapper.state.snapshotDelta()().getPuts().size() == expected.getPuts().size() + 1);
+      blockchainWrapper.state.dumpStored();
+      REQUIRE(blockchainWrapper.state.snapshotDelta()().getPuts().empty());
+      blockchainWrapper.state.addBalance(addr);
+      const DBBatch delta = blockchainWrapper.state.snapshot()();
+      REQUIRE(delta.getPuts().size() == 1);
+      const auto& entry = delta.getPuts()[0];
+      REQUIRE(Address(Bytes(entry.key.begin() + DBPrefix::nativeAccounts.size(), entry.key.end())) == addr);
+      REQUIRE(toMap(blockchainWrapper.state.dump()).at(entry.key) == entry.value);
+    }
+
+    SECTION("DumpManager writes changes in place into the loaded state DB") {
+      const std::string folder = testDumpPath + "/dumpManagerIncrementalTests";
+      const Address firstAddr(Utils::randBytes(20));
+      const Address secondAddr(Utils::randBytes(20));
+      DBBatch expected;
+      {
+        auto blockchainWrapper = initialize(validatorPrivKeysState, validatorPrivKeysState[0], 8080, true, folder);
+        for (uint64_t i = 0; i < 5; ++i) {
+          auto block = createValidBlock(validatorPrivKeysState, blockchainWrapper.state, blockchainWrapper.storage);
+          REQUIRE(blockchainWrapper.state.tryProcessNextBlock(std::move(block)) == BlockValidationStatus::valid);
+        }
+        // Nothing was dumped into the DB yet, so the first dump writes everything
+        REQUIRE(!DumpManager::getDumpHeight(blockchainWrapper.db).has_value());
+        REQUIRE(std::get<0>(blockchainWrapper.state.saveToDB()) == 5);
+        REQUIRE(DumpManager::getDumpHeight(blockchainWrapper.db) == uint64_t(5));
+
+        // Only the changed accounts (and rdPoS) are written by the next dump
+        blockchainWrapper.state.addBalance(firstAddr);
+        for (uint64_t i = 0; i < 5; ++i) {
+          auto block = createValidBlock(validatorPrivKeysState, blockchainWrapper.state, blockchainWrapper.storage);
+          REQUIRE(blockchainWrapper.state.tryProcessNextBlock(std::move(block)) == BlockValidationStatus::valid);
+        }
+        blockchainWrapper.state.addBalance(firstAddr);
+        blockchainWrapper.state.addBalance(secondAddr);
+        REQUIRE(std::get<0>(blockchainWrapper.state.saveToDB()) == 10);
+        REQUIRE(DumpManager::getDumpHeight(blockchainWrapper.db) == uint64_t(10));
+
+        // The DB must hold exactly what a full dump would have written
+        expected = blockchainWrapper.state.dump();
+        uint64_t accountsInExpected = 0;
+        for (const auto& entry : expected.getPuts()) {
+          REQUIRE(blockchainWrapper.db.get(entry.key) == entry.value);
+          if (Bytes(entry.key.begin(), entry.key.begin() + DBPrefix::nativeAccounts.size()) == DBPrefix::nativeAccounts) {
+            ++accountsInExpected;
+          }
+        }
+        REQUIRE(blockchainWrapper.db.getKeys(DBPrefix::nativeAccounts).size() == accountsInExpected);
+      }
+      // The directory keeps its creation height as name, the height it holds is read from the DB itself
+      auto blockchainWrapper = initialize(validatorPrivKeysState, validatorPrivKeysState[0], 8080, false, folder);
+      REQUIRE(std::get<0>(DumpManager::getBestStateDBPath(blockchainWrapper.options)) == folder + "/stateDb/0");
+      REQUIRE(DumpManager::getDumpHeight(blockchainWrapper.db) == uint64_t(10));
+      REQUIRE(blockchainWrapper.state.getNativeBalance(firstAddr) == uint256_t("2000000000000000000000"));
+      REQUIRE(blockchainWrapper.state.getNativeBalance(secondAddr) == uint256_t("1000000000000000000000"));
+      const DBBatch reloaded = blockchainWrapper.state.dump();
+      REQUIRE(reloaded.getPuts().size() == expected.getPuts().size());
+    }
   }
 }
 
@@ -0,0 +1,127 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+
+#include "../../src/core/mempool.h"
+
+static const uint256_t gwei = 1000000000;
+
+static TxBlock makeTx(const PrivKey& privKey, uint64_t nonce, const uint256_t& fee) {
+  const Address from = Secp256k1::toAddress(Secp256k1::toUPub(privKey));
+  return TxBlock(Address(Utils::randBytes(20)), from, Bytes(), 8080, nonce, 1, fee, fee, 21000, privKey);
+}
+
+namespace TMempool {
+  TEST_CASE("Mempool Tests", "[core][mempool]") {
+    const PrivKey keyA(Utils::randBytes(32));
+    const PrivKey keyB(Utils::randBytes(32));
+    const PrivKey keyC(Utils::randBytes(32));
+
+    SECTION("Mempool evicts the cheapest sender tail when full") {
+      Mempool mempool(Mempool::Limits{4, 64, 10});
+      const TxBlock a0 = makeTx(keyA, 0, 5 * gwei);
+      const TxBlock a1 = makeTx(keyA, 1, 2 * gwei);
+      const TxBlock b0 = makeTx(keyB, 0, 3 * gwei);
+      const TxBlock b1 = makeTx(keyB, 1, 4 * gwei);
+      for (const TxBlock& tx : {a0, a1, b0, b1}) REQUIRE(mempool.add(tx, 0) == TxStatus::ValidNew);
+
+      // Only the last transaction of each sender can go, and A's pays less than B's
+      REQUIRE(mempool.add(makeTx(keyC, 0, 2 * gwei), 0) == TxStatus::InvalidUnderpriced);
+      const TxBlock c0 = makeTx(keyC, 0, 3 * gwei);
+      REQUIRE(mempool.add(c0, 0) == TxStatus::ValidNew);
+      REQUIRE(!mempool.contains(a1.hash()));
+      REQUIRE(mempool.contains(a0.hash()));
+      REQUIRE(mempool.size() == 4);
+
+      // C's tail now pays the least, then B's once C's is gone
+      const TxBlock a2 = makeTx(keyA, 1, 6 * gwei);
+      REQUIRE(mempool.add(a2, 0) == TxStatus::ValidNew);
+      REQUIRE(!mempool.contains(c0.hash()));
+      REQUIRE(mempool.add(makeTx(keyC, 0, 5 * gwei), 0) == TxStatus::ValidNew);
+      REQUIRE(!mempool.contains(b1.hash()));
+      REQUIRE(mempool.contains(b0.hash()));
+    }
+
+    SECTION("Mempool keeps the eviction order up to date when transactions change") {
+      Mempool mempool(Mempool::Limits{3, 64, 10});
+      const TxBlock a0 = makeTx(keyA, 0, 2 * gwei);
+      const TxBlock a1 = makeTx(keyA, 1, 1 * gwei);
+      const TxBlock b0 = makeTx(keyB, 0, 3 * gwei);
+      for (const TxBlock& tx : {a0, a1, b0}) REQUIRE(mempool.add(tx, 0) == TxStatus::ValidNew);
+
+      // Replacing A's tail makes it pay more than B's
+      const TxBlock a1Bump = makeTx(keyA, 1, 4 * gwei);
+      REQUIRE(mempool.add(a1Bump, 0) == TxStatus::ValidNew);
+      REQUIRE(mempool.add(makeTx(keyC, 0, 3500000000), 0) == TxStatus::ValidNew);
+      REQUIRE(!mempool.contains(b0.hash()));
+      REQUIRE(mempool.contains(a1Bump.hash()));
+
+      // Erasing A's tail exposes the cheaper transaction before it
+      REQUIRE(mempool.erase(a1Bump.hash()));
+      REQUIRE(mempool.add(makeTx(keyB, 0, 3 * gwei), 0) == TxStatus::ValidNew);
+      REQUIRE(mempool.add(makeTx(keyB, 1, 3 * gwei), 0) == TxStatus::ValidNew);
+      REQUIRE(!mempool.contains(a0.hash()));
+
+      // Senders that left the pool are no longer candidates
+      mempool.clear();
+      REQUIRE(mempool.add(makeTx(keyA, 0, 1 * gwei), 0) == TxStatus::ValidNew);
+      mempool.setAccountNonce(Secp256k1::toAddress(Secp256k1::toUPub(keyA)), 1);
+      REQUIRE(mempool.size() == 0);
+      for (const PrivKey& key : {keyA, keyB, keyC}) REQUIRE(mempool.add(makeTx(key, 1, 5 * gwei), 1) == TxStatus::ValidNew);
+      REQUIRE(mempool.add(makeTx(keyB, 2, 2 * gwei), 1) == TxStatus::InvalidUnderpriced);
+      REQUIRE(mempool.size() == 3);
+    }
+
+    SECTION("Mempool never evicts the transaction an incoming one follows") {
+      Mempool mempool(Mempool::Limits{3, 64, 10});
+      const TxBlock a0 = makeTx(keyA, 0, 1 * gwei);
+      const TxBlock b0 = makeTx(keyB, 0, 2 * gwei);
+      const TxBlock c0 = makeTx(keyC, 0, 3 * gwei);
+      for (const TxBlock& tx : {a0, b0, c0}) REQUIRE(mempool.add(tx, 0) == TxStatus::ValidNew);
+
+      // A's tail is the cheapest, but it's the one A's new transaction needs to be executable
+      const TxBlock a1 = makeTx(keyA, 1, 5 * gwei);
+      REQUIRE(mempool.add(a1, 0) == TxStatus::ValidNew);
+      REQUIRE(mempool.contains(a0.hash()));
+      REQUIRE(!mempool.contains(b0.hash()));
+      REQUIRE(mempool.pendingSize() == 3);
+
+      // Without another sender to evict from, the transaction is rejected
+      mempool.clear();
+      REQUIRE(mempool.add(a0, 0) == TxStatus::ValidNew);
+      REQUIRE(mempool.add(makeTx(keyA, 1, 1 * gwei), 0) == TxStatus::ValidNew);
+      REQUIRE(mempool.add(makeTx(keyA, 2, 1 * gwei), 0) == TxStatus::ValidNew);
+      REQUIRE(mempool.add(makeTx(keyA, 3, 5 * gwei), 0) == TxStatus::InvalidUnderpriced);
+      REQUIRE(mempool.size() == 3);
+    }
+
+    SECTION("Mempool limits the transactions per sender and the nonce gap separately") {
+      Mempool mempool(Mempool::Limits{.maxTxsPerSender = 2, .maxNonceGap = 8});
+      REQUIRE(mempool.add(makeTx(keyA, 0, gwei), 0) == TxStatus::ValidNew);
+      REQUIRE(mempool.add(makeTx(keyA, 7, gwei), 0) == TxStatus::ValidNew);
+      REQUIRE(mempool.add(makeTx(keyA, 8, gwei), 0) == TxStatus::InvalidPoolLimit);
+      REQUIRE(mempool.add(makeTx(keyA, 3, gwei), 0) == TxStatus::InvalidPoolLimit);
+      // Replacements don't add a transaction, and stale ones no longer count
+      REQUIRE(mempool.add(makeTx(keyA, 7, 2 * gwei), 0) == TxStatus::ValidNew);
+      REQUIRE(mempool.add(makeTx(keyA, 3, gwei), 1) == TxStatus::ValidNew);
+      REQUIRE(mempool.size() == 2);
+      REQUIRE(mempool.add(makeTx(keyB, 0, gwei), 0) == TxStatus::ValidNew);
+    }
+
+    SECTION("Mempool sums the cost of a sender's transactions before a nonce") {
+      Mempool mempool;
+      const Address from = Secp256k1::toAddress(Secp256k1::toUPub(keyA));
+      const uint256_t txCost = 1 + 21000 * gwei;
+      for (uint64_t nonce = 0; nonce < 3; ++nonce) REQUIRE(mempool.add(makeTx(keyA, nonce, gwei), 0) == TxStatus::ValidNew);
+      REQUIRE(mempool.getCostBefore(from, 0) == 0);
+      REQUIRE(mempool.getCostBefore(from, 2) == 2 * txCost);
+      REQUIRE(mempool.getCostBefore(from, 5) == 3 * txCost);
+      REQUIRE(mempool.getCostBefore(Secp256k1::toAddress(Secp256k1::toUPub(keyB)), 5) == 0);
+    }
+  }
+}
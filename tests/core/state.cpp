@@ -302,6 +302,143 @@ namespace TState {
 
     }
 
+    SECTION("Test State mempool nonce queues") {
+      PrivKey privkey(Utils::randBytes(32));
+      Address me = Secp256k1::toAddress(Secp256k1::toUPub(privkey));
+      Address targetOfTransactions = Address(Utils::randBytes(20));
+      {
+        auto blockchainWrapper = initialize(validatorPrivKeysState, validatorPrivKeysState[0], 8080, true, testDumpPath + "/stateSimpleBlockTest");
+        blockchainWrapper.state.addBalance(me);
+        auto makeTx = [&](uint64_t nonce, uint64_t fee) {
+          return TxBlock(targetOfTransactions, me, Bytes(), 8080, nonce, 1000000000000000000, fee, fee, 21000, privkey);
+        };
+
+        // Future nonces are parked until the gap is filled
+        REQUIRE(blockchainWrapper.state.addTx(makeTx(2, 1000000000)) == TxStatus::ValidNew);
+        REQUIRE(blockchainWrapper.state.addTx(makeTx(1, 1000000000)) == TxStatus::ValidNew);
+        REQUIRE(blockchainWrapper.state.getPendingTxs().empty());
+        REQUIRE(blockchainWrapper.state.getQueuedTxs().size() == 2);
+        REQUIRE(blockchainWrapper.state.addTx(makeTx(0, 1000000000)) == TxStatus::ValidNew);
+        REQUIRE(blockchainWrapper.state.getPendingTxs().size() == 3);
+        REQUIRE(blockchainWrapper.state.getQueuedTxs().empty());
+
+        // Same sender and nonce only replaces the pooled tx with a high enough fee bump
+        TxBlock tx0 = makeTx(0, 1000000000);
+        REQUIRE(blockchainWrapper.state.addTx(TxBlock(tx0)) == TxStatus::ValidExisting);
+        REQUIRE(blockchainWrapper.state.addTx(makeTx(0, 1050000000)) == TxStatus::InvalidUnderpriced);
+        TxBlock replacement = makeTx(0, 2000000000);
+        REQUIRE(blockchainWrapper.state.addTx(TxBlock(replacement)) == TxStatus::ValidNew);
+        REQUIRE(!blockchainWrapper.state.isTxInMempool(tx0.hash()));
+        REQUIRE(blockchainWrapper.state.isTxInMempool(replacement.hash()));
+        REQUIRE(blockchainWrapper.state.getMempoolSize() == 3);
+
+        // Consecutive nonces of the same sender can go in the same block, the rest stays pending
+        TxBlock tx1 = makeTx(1, 1000000000);
+        auto newBestBlock = createValidBlock(validatorPrivKeysState, blockchainWrapper.state, blockchainWrapper.storage, {replacement, tx1});
+        REQUIRE(blockchainWrapper.state.tryProcessNextBlock(std::move(newBestBlock)) == BlockValidationStatus::valid);
+        REQUIRE(blockchainWrapper.state.getNativeNonce(me) == 2);
+        REQUIRE(blockchainWrapper.state.getMempoolSize() == 1);
+        auto pending = blockchainWrapper.state.getPendingTxs();
+        REQUIRE(pending.size() == 1);
+        REQUIRE(pending[0].getNonce() == 2);
+        REQUIRE(blockchainWrapper.state.addTx(makeTx(1, 3000000000)) == TxStatus::InvalidNonce);
+
+        // The balance has to cover every transaction of the sender up to the new one
+        PrivKey otherPrivkey(Utils::randBytes(32));
+        Address other = Secp256k1::toAddress(Secp256k1::toUPub(otherPrivkey));
+        blockchainWrapper.state.addBalance(other);
+        auto makeLargeTx = [&](uint64_t nonce) {
+          return TxBlock(targetOfTransactions, other, Bytes(), 8080, nonce, uint256_t("400000000000000000000"), 1000000000, 1000000000, 21000, otherPrivkey);
+        };
+        REQUIRE(blockchainWrapper.state.addTx(makeLargeTx(0)) == TxStatus::ValidNew);
+        REQUIRE(blockchainWrapper.state.addTx(makeLargeTx(2)) == TxStatus::ValidNew);
+        TxBlock other1 = makeLargeTx(1);
+        REQUIRE(blockchainWrapper.state.addTx(TxBlock(other1)) == TxStatus::ValidNew);
+        // Filling the gap left the last one unaffordable
+        REQUIRE(blockchainWrapper.state.getMempoolSize() == 3);
+        REQUIRE(blockchainWrapper.state.isTxInMempool(other1.hash()));
+        REQUIRE(blockchainWrapper.state.addTx(makeLargeTx(2)) == TxStatus::InvalidBalance);
+      }
+    }
+
+    SECTION("Test State catching up with a range of blocks") {
+      PrivKey privkey(Utils::randBytes(32));
+      Address me = Secp256k1::toAddress(Secp256k1::toUPub(privkey));
+      Address targetOfTransactions = Address(Utils::randBytes(20));
+      auto producer = initialize(validatorPrivKeysState, validatorPrivKeysState[0], 8080, true, testDumpPath + "/stateCatchUpProducerTest");
+      auto follower = initialize(validatorPrivKeysState, PrivKey(), 8081, true, testDumpPath + "/stateCatchUpFollowerTest");
+      producer.state.addBalance(me);
+      follower.state.addBalance(me);
+      auto makeTx = [&](uint64_t nonce) {
+        return TxBlock(targetOfTransactions, me, Bytes(), 8080, nonce, 1000000000000000000, 1000000000, 1000000000, 21000, privkey);
+      };
+
+      // The producer makes three blocks, with one transaction each
+      std::vector<FinalizedBlock> blocks;
+      for (uint64_t nonce = 0; nonce < 3; nonce++) {
+        auto block = createValidBlock(validatorPrivKeysState, producer.state, producer.storage, {makeTx(nonce)});
+        blocks.emplace_back(block);
+        REQUIRE(producer.state.tryProcessNextBlock(std::move(block)) == BlockValidationStatus::valid);
+      }
+
+      // The follower has the first transaction pending and a later one queued behind the gap
+      REQUIRE(follower.state.addTx(makeTx(0)) == TxStatus::ValidNew);
+      REQUIRE(follower.state.addTx(makeTx(3)) == TxStatus::ValidNew);
+      REQUIRE(follower.state.getPendingTxsSize() == 1);
+
+      // The first block arrives on its own, the range is then processed at once
+      REQUIRE(follower.state.tryProcessNextBlock(FinalizedBlock(blocks[0])) == BlockValidationStatus::valid);
+      REQUIRE(follower.state.tryProcessNextBlocks(std::vector<FinalizedBlock>(blocks)) == 3);
+      REQUIRE(follower.storage.latest()->getHash() == producer.storage.latest()->getHash());
+      REQUIRE(follower.state.getNativeNonce(me) == 3);
+      REQUIRE(follower.state.getNativeBalance(me) == producer.state.getNativeBalance(me));
+      REQUIRE(follower.state.getMempoolSize() == 1);
+      REQUIRE(follower.state.getPendingTxsSize() == 1); // Nonce 3 was promoted by the refresh at the end
+
+      // A block that doesn't follow the chain stops the range
+      auto skipped = createValidBlock(validatorPrivKeysState, producer.state, producer.storage);
+      REQUIRE(producer.state.tryProcessNextBlock(std::move(skipped)) == BlockValidationStatus::valid);
+      std::vector<FinalizedBlock> gappedRange{blocks[2], createValidBlock(validatorPrivKeysState, producer.state, producer.storage)};
+      REQUIRE(follower.state.tryProcessNextBlocks(std::move(gappedRange)) == 1);
+      REQUIRE(follower.storage.latest()->getHash() == blocks[2].getHash());
+
+      // A block already in the chain is only skipped if it is the same block
+      auto fork = initialize(validatorPrivKeysState, PrivKey(), 8082, true, testDumpPath + "/stateCatchUpForkTest");
+      std::vector<FinalizedBlock> conflicting{createValidBlock(validatorPrivKeysState, fork.state, fork.storage)};
+      REQUIRE(conflicting[0].getNHeight() == blocks[0].getNHeight());
+      REQUIRE(conflicting[0].getHash() != blocks[0].getHash());
+      REQUIRE(follower.state.tryProcessNextBlocks(std::move(conflicting)) == 0);
+      REQUIRE(follower.storage.latest()->getHash() == blocks[2].getHash());
+    }
+
+    SECTION("Test State change notifications") {
+      PrivKey privkey(Utils::randBytes(32));
+      Address me = Secp256k1::toAddress(Secp256k1::toUPub(privkey));
+      {
+        auto blockchainWrapper = initialize(validatorPrivKeysState, validatorPrivKeysState[0], 8080, true, testDumpPath + "/stateChangeNotificationsTest");
+        blockchainWrapper.state.addBalance(me);
+        auto hasPendingTx = [&]() { return blockchainWrapper.state.getPendingTxsSize() >= 1; };
+
+        // Nothing happens, the wait times out
+        REQUIRE(!blockchainWrapper.state.waitForChange(hasPendingTx, std::chrono::milliseconds(50)));
+
+        // A transaction accepted by another thread wakes up the waiter
+        auto adder = std::async(std::launch::async, [&]() {
+          std::this_thread::sleep_for(std::chrono::milliseconds(50));
+          return blockchainWrapper.state.addTx(TxBlock(
+            Address(Utils::randBytes(20)), me, Bytes(), 8080, 0, 1000000000000000000, 1000000000, 1000000000, 21000, privkey
+          ));
+        });
+        auto start = std::chrono::steady_clock::now();
+        REQUIRE(blockchainWrapper.state.waitForChange(hasPendingTx, std::chrono::seconds(10)));
+        REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+        REQUIRE(adder.get() == TxStatus::ValidNew);
+
+        // A condition that already holds doesn't wait at all
+        REQUIRE(blockchainWrapper.state.waitForChange(hasPendingTx, std::chrono::milliseconds(0)));
+      }
+    }
+
     SECTION("Test 10 blocks forward on State (100 Transactions per block)") {
       std::unordered_map<PrivKey, std::pair<uint256_t, uint64_t>, SafeHash> randomAccounts;
       for (uint64_t i = 0; i < 100; ++i) {
@@ -369,6 +506,69 @@ namespace TState {
       REQUIRE(blockchainWrapper.state.getNativeBalance(targetOfTransactions) == targetExpectedValue);
     }
 
+    SECTION("Test parallel execution of independent transfers matches sequential execution") {
+      // Each sender transfers to a fresh address, except every 4th sender which transfers
+      // to the next sender, so the block contains both independent and conflicting transfers.
+      std::vector<PrivKey> senders;
+      for (uint64_t i = 0; i < 400; ++i) senders.emplace_back(Utils::randBytes(32));
+      std::vector<Address> recipients;
+      for (uint64_t i = 0; i < senders.size(); ++i) {
+        recipients.emplace_back((i % 4 == 0 && i + 1 < senders.size())
+          ? Secp256k1::toAddress(Secp256k1::toUPub(senders[i + 1])) : Address(Utils::randBytes(20))
+        );
+      }
+
+      // Parallel execution is enabled through options.json, written before the node creates its own
+      const std::string parallelPath = testDumpPath + "/stateParallelExecutionTest";
+      if (std::filesystem::exists(parallelPath)) std::filesystem::remove_all(parallelPath);
+      std::filesystem::create_directories(parallelPath);
+      {
+        json parallelOptions;
+        parallelOptions["privKey"] = validatorPrivKeysState[0].hex().get();
+        parallelOptions["parallelExecution"] = true;
+        std::ofstream o(parallelPath + "/options.json");
+        o << parallelOptions.dump(2) << std::endl;
+      }
+
+      auto sequential = initialize(validatorPrivKeysState, validatorPrivKeysState[0], 8080, true, testDumpPath + "/stateSequentialExecutionTest", IndexingMode::RPC);
+      auto parallel = initialize(validatorPrivKeysState, validatorPrivKeysState[0], 8081, false, parallelPath, IndexingMode::RPC);
+
+      std::vector<TxBlock> txs;
+      for (uint64_t i = 0; i < senders.size(); ++i) {
+        Address me = Secp256k1::toAddress(Secp256k1::toUPub(senders[i]));
+        sequential.state.addBalance(me);
+        parallel.state.addBalance(me);
+        txs.emplace_back(recipients[i], me, Bytes(), 8080, 0, 1000000000000000000, 1000000000, 1000000000, 21000 + i, senders[i]);
+      }
+      const auto txsCopy = txs;
+
+      auto block = createValidBlock(validatorPrivKeysState, sequential.state, sequential.storage, std::move(txs));
+      FinalizedBlock blockCopy(block);
+      REQUIRE(sequential.state.tryProcessNextBlock(std::move(block)) == BlockValidationStatus::valid);
+      REQUIRE(parallel.state.tryProcessNextBlock(std::move(blockCopy)) == BlockValidationStatus::valid);
+      // The block must really have taken the parallel path, or this only compares two sequential runs
+      REQUIRE(sequential.state.getParallelExecutedTxs() == 0);
+      REQUIRE(parallel.state.getParallelExecutedTxs() == senders.size());
+
+      for (uint64_t i = 0; i < senders.size(); ++i) {
+        Address me = Secp256k1::toAddress(Secp256k1::toUPub(senders[i]));
+        REQUIRE(sequential.state.getNativeBalance(me) == parallel.state.getNativeBalance(me));
+        REQUIRE(sequential.state.getNativeNonce(me) == parallel.state.getNativeNonce(me));
+        REQUIRE(sequential.state.getNativeBalance(recipients[i]) == parallel.state.getNativeBalance(recipients[i]));
+        REQUIRE(sequential.state.getNativeNonce(recipients[i]) == parallel.state.getNativeNonce(recipients[i]));
+      }
+      for (const auto& tx : txsCopy) {
+        auto seqData = sequential.storage.getTxAdditionalData(tx.hash());
+        auto parData = parallel.storage.getTxAdditionalData(tx.hash());
+        REQUIRE(seqData.has_value());
+        REQUIRE(parData.has_value());
+        REQUIRE(seqData->gasUsed == parData->gasUsed);
+        REQUIRE(seqData->succeeded == parData->succeeded);
+        REQUIRE(seqData->contractAddress == parData->contractAddress);
+      }
+      REQUIRE(sequential.state.dump().getPuts().size() == parallel.state.dump().getPuts().size());
+    }
+
     SECTION("State test with networking capabilities, 8 nodes, rdPoS fully active, test Tx Broadcast") {
       // Initialize 8 different node instances, with different ports and DBs.
       std::vector<PrivKey> randomAccounts;
@@ -162,6 +162,239 @@ namespace TStorage {
       }
     }
 
+    SECTION("Storage publishes blocks before writing them") {
+      auto blockchainWrapper = initialize(validatorPrivKeysStorage, PrivKey(), 8080, true, "StoragePublishBeforeWrite");
+      std::vector<FinalizedBlock> blocks;
+      for (uint64_t i = 0; i < 5; ++i) {
+        auto latest = blockchainWrapper.storage.latest();
+        FinalizedBlock newBlock = createRandomBlock(10, 16, latest->getNHeight() + 1, latest->getHash(), blockchainWrapper.options.getChainID());
+        // Staged data is only visible once its block is pushed
+        const Hash txHash = newBlock.getTxs()[3].hash();
+        blockchainWrapper.storage.putTxAdditionalData({.hash = txHash, .gasUsed = 21000 + i, .succeeded = true});
+        REQUIRE(!blockchainWrapper.storage.getTxAdditionalData(txHash).has_value());
+        REQUIRE(!blockchainWrapper.storage.txExists(txHash));
+        blocks.emplace_back(newBlock);
+        blockchainWrapper.storage.pushBlock(std::move(newBlock));
+        // Every read sees the block right away, whether it was written yet or not
+        REQUIRE(blockchainWrapper.storage.blockExists(blocks.back().getHash()));
+        REQUIRE(blockchainWrapper.storage.blockExists(blocks.back().getNHeight()));
+        REQUIRE(blockchainWrapper.storage.txExists(txHash));
+        REQUIRE(blockchainWrapper.storage.getTxAdditionalData(txHash)->gasUsed == 21000 + i);
+      }
+      auto checkBlocks = [&]() {
+        for (uint64_t i = 0; i < blocks.size(); i++) {
+          REQUIRE(*blockchainWrapper.storage.getBlock(blocks[i].getNHeight()) == blocks[i]);
+          REQUIRE(*blockchainWrapper.storage.getBlock(blocks[i].getHash()) == blocks[i]);
+          const TxBlock& tx = blocks[i].getTxs()[3];
+          const auto [foundTx, blockHash, blockIndex, blockHeight] = blockchainWrapper.storage.getTx(tx.hash());
+          REQUIRE(*foundTx == tx);
+          REQUIRE(blockHash == blocks[i].getHash());
+          REQUIRE(blockIndex == 3);
+          REQUIRE(blockHeight == blocks[i].getNHeight());
+          REQUIRE(*std::get<0>(blockchainWrapper.storage.getTxByBlockHashAndIndex(blocks[i].getHash(), 3)) == tx);
+          REQUIRE(*std::get<0>(blockchainWrapper.storage.getTxByBlockNumberAndIndex(blocks[i].getNHeight(), 3)) == tx);
+          REQUIRE(blockchainWrapper.storage.getTxAdditionalData(tx.hash())->gasUsed == 21000 + i);
+        }
+        // Ranges stop at the first block that doesn't exist
+        const auto range = blockchainWrapper.storage.getBlocks(blocks.front().getNHeight(), blocks.back().getNHeight() + 3);
+        REQUIRE(range.size() == blocks.size());
+        for (uint64_t i = 0; i < blocks.size(); i++) REQUIRE(*range[i] == blocks[i]);
+      };
+      checkBlocks();
+      blockchainWrapper.storage.waitPersisted();
+      checkBlocks();
+    }
+
+    SECTION("Storage caches decoded blocks") {
+      auto blockchainWrapper = initialize(validatorPrivKeysStorage, PrivKey(), 8080, true, "StorageBlockCache");
+      std::vector<FinalizedBlock> blocks;
+      for (uint64_t i = 0; i < 3; ++i) {
+        auto latest = blockchainWrapper.storage.latest();
+        FinalizedBlock newBlock = createRandomBlock(10, 16, latest->getNHeight() + 1, latest->getHash(), blockchainWrapper.options.getChainID());
+        blocks.emplace_back(newBlock);
+        blockchainWrapper.storage.pushBlock(std::move(newBlock));
+      }
+      blockchainWrapper.storage.waitPersisted();
+      // Written blocks are served from the cache, as the same decoded instance
+      const BlockCache& cache = blockchainWrapper.storage.getBlockCache();
+      const uint64_t hits = cache.getHits();
+      auto byHash = blockchainWrapper.storage.getBlock(blocks[1].getHash());
+      auto byHeight = blockchainWrapper.storage.getBlock(blocks[1].getNHeight());
+      REQUIRE(*byHash == blocks[1]);
+      REQUIRE(byHash == byHeight);
+      REQUIRE(cache.getHits() == hits + 2);
+      REQUIRE(*std::get<0>(blockchainWrapper.storage.getTx(blocks[2].getTxs()[5].hash())) == blocks[2].getTxs()[5]);
+      REQUIRE(cache.getHits() == hits + 3);
+
+      // Least recently used blocks are evicted first, once their total size exceeds the capacity
+      BlockCache small(blocks[0].getSize() + blocks[1].getSize() + blocks[2].getSize() - 1);
+      for (const auto& block : blocks) small.put(std::make_shared<const FinalizedBlock>(block));
+      REQUIRE(small.size() == 2);
+      REQUIRE(small.bytes() == blocks[1].getSize() + blocks[2].getSize());
+      REQUIRE(small.get(blocks[0].getHash()) == nullptr);
+      REQUIRE(small.get(blocks[0].getNHeight()) == nullptr);
+      REQUIRE(small.getMisses() == 2);
+      REQUIRE(*small.get(blocks[1].getNHeight()) == blocks[1]);
+      REQUIRE(small.getHits() == 1);
+      BlockCache disabled(0);
+      disabled.put(std::make_shared<const FinalizedBlock>(blocks[0]));
+      REQUIRE(disabled.size() == 0);
+    }
+
+    SECTION("Storage block segments") {
+      const std::filesystem::path dir = Utils::getTestDumpPath() + "/StorageBlockSegments";
+      if (std::filesystem::exists(dir)) std::filesystem::remove_all(dir);
+      std::vector<FinalizedBlock> blocks;
+      Hash prevHash;
+      for (uint64_t i = 0; i < 4; ++i) {
+        blocks.emplace_back(createRandomBlock(5, 16, i, prevHash, 8080));
+        prevHash = blocks.back().getHash();
+      }
+      std::vector<std::pair<Bytes, Bytes>> serialized;
+      for (const auto& block : blocks) serialized.emplace_back(block.serializeBlockV2(), block.serializeSidecar());
+      const auto read = [&](uint64_t height) {
+        return BlockSegments::Record{serialized[height].first, serialized[height].second};
+      };
+      {
+        BlockSegments segments(dir, 2);
+        REQUIRE(segments.endHeight() == 0);
+        REQUIRE(!segments.get(0).has_value());
+        segments.append(read);
+        segments.append(read);
+        REQUIRE(segments.endHeight() == 4);
+      }
+
+      // Segments are mapped again on startup, and unfinished ones are dropped
+      std::ofstream(dir / "00000000000000000004.seg.tmp") << "partial";
+      {
+        BlockSegments segments(dir, 2);
+        REQUIRE(segments.endHeight() == 4);
+        REQUIRE(!std::filesystem::exists(dir / "00000000000000000004.seg.tmp"));
+        for (uint64_t i = 0; i < 4; ++i) {
+          const auto record = segments.get(i);
+          REQUIRE(record.has_value());
+          REQUIRE(FinalizedBlock::fromTrustedBytes(record->block, record->sidecar, 8080) == blocks[i]);
+        }
+        REQUIRE(!segments.get(4).has_value());
+      }
+      REQUIRE_THROWS(BlockSegments(dir, 4));
+
+      // Corrupted records are caught by their checksum
+      {
+        std::fstream file(dir / "00000000000000000002.seg", std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(-1, std::ios::end);
+        const char last = char(file.get());
+        file.seekp(-1, std::ios::end);
+        file.put(char(last ^ 0xFF));
+      }
+      BlockSegments segments(dir, 2);
+      REQUIRE(segments.get(2).has_value());
+      REQUIRE_THROWS(segments.get(3));
+    }
+
+    SECTION("Storage moves old blocks to the block segments") {
+      // Small segments, moved as soon as they are 2 blocks deep, and no cache so reads go to storage
+      const std::string path = "StorageColdBlocks";
+      if (std::filesystem::exists(path)) std::filesystem::remove_all(path);
+      std::filesystem::create_directories(path);
+      {
+        json coldOptions;
+        coldOptions["coldBlockDepth"] = 2;
+        coldOptions["coldSegmentBlocks"] = 4;
+        coldOptions["blockCacheBytes"] = 0;
+        std::ofstream o(path + "/options.json");
+        o << coldOptions.dump(2) << std::endl;
+      }
+      std::vector<FinalizedBlock> blocks;
+      std::optional<Options> options;
+      {
+        auto blockchainWrapper = initialize(validatorPrivKeysStorage, PrivKey(), 8080, false, path);
+        options.emplace(blockchainWrapper.options);
+        blocks.emplace_back(*blockchainWrapper.storage.latest());
+        for (uint64_t i = 0; i < 12; ++i) {
+          auto latest = blockchainWrapper.storage.latest();
+          blocks.emplace_back(createRandomBlock(10, 16, latest->getNHeight() + 1, latest->getHash(), blockchainWrapper.options.getChainID()));
+          blockchainWrapper.storage.pushBlock(blocks.back());
+        }
+        REQUIRE(blockchainWrapper.storage.waitPersisted());
+        // Blocks 0 to 7 are deep enough, block 11 isn't yet
+        for (int i = 0; i < 200 && blockchainWrapper.storage.getSegmentsEndHeight() < 8; ++i) {
+          std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        REQUIRE(blockchainWrapper.storage.getSegmentsEndHeight() == 8);
+      }
+
+      // Moved blocks only leave their height behind in the database
+      auto checkStubs = [&]() {
+        DB db(path + "/blocksDb/");
+        for (uint64_t i = 0; i < blocks.size(); ++i) {
+          const Bytes stored = db.get(blocks[i].getHash(), DBPrefix::blocks);
+          if (i < 8) {
+            REQUIRE(stored.empty());
+            REQUIRE(db.get(blocks[i].getHash(), DBPrefix::coldBlocks) == UintConv::uint64ToBytes(i));
+            REQUIRE(!db.has(blocks[i].getHash(), DBPrefix::blockSidecars));
+          } else {
+            REQUIRE(stored == blocks[i].serializeBlockV2());
+            REQUIRE(!db.has(blocks[i].getHash(), DBPrefix::coldBlocks));
+            REQUIRE(db.has(blocks[i].getHash(), DBPrefix::blockSidecars));
+          }
+        }
+        REQUIRE(db.close());
+      };
+      checkStubs();
+
+      // Every read finds the blocks in either tier
+      {
+        Storage storage("StorageColdBlocks", *options);
+        REQUIRE(storage.getSegmentsEndHeight() == 8);
+        for (uint64_t i = 0; i < blocks.size(); ++i) {
+          REQUIRE(storage.blockExists(blocks[i].getHash()));
+          REQUIRE(storage.blockExists(i));
+          REQUIRE(*storage.getBlock(blocks[i].getHash()) == blocks[i]);
+          REQUIRE(*storage.getBlock(i) == blocks[i]);
+          if (i == 0) continue; // Genesis has no transactions
+          const TxBlock& tx = blocks[i].getTxs()[3];
+          const auto [foundTx, blockHash, blockIndex, blockHeight] = storage.getTx(tx.hash());
+          REQUIRE(*foundTx == tx);
+          REQUIRE(blockHash == blocks[i].getHash());
+          REQUIRE(blockIndex == 3);
+          REQUIRE(blockHeight == i);
+          const auto byBlockHash = storage.getTxByBlockHashAndIndex(blocks[i].getHash(), 3);
+          REQUIRE(*std::get<0>(byBlockHash) == tx);
+          REQUIRE(std::get<3>(byBlockHash) == i);
+          const auto byHeight = storage.getTxByBlockNumberAndIndex(i, 3);
+          REQUIRE(*std::get<0>(byHeight) == tx);
+          REQUIRE(std::get<1>(byHeight) == blocks[i].getHash());
+        }
+        const auto range = storage.getBlocks(2, 14);
+        REQUIRE(range.size() == 11);
+        for (uint64_t i = 0; i < range.size(); ++i) REQUIRE(*range[i] == blocks[i + 2]);
+      }
+
+      // A node that stopped right after writing a segment stubs its blocks on the next startup
+      {
+        DB db(path + "/blocksDb/");
+        DBBatch batch;
+        for (uint64_t i = 4; i < 8; ++i) {
+          batch.push_back(blocks[i].getHash(), blocks[i].serializeBlockV2(), DBPrefix::blocks);
+          batch.push_back(blocks[i].getHash(), blocks[i].serializeSidecar(), DBPrefix::blockSidecars);
+          batch.delete_key(blocks[i].getHash(), DBPrefix::coldBlocks);
+        }
+        batch.push_back(DB::keyFromStr("coldHeight"), UintConv::uint64ToBytes(3), DBPrefix::metadata);
+        REQUIRE(db.putBatch(batch));
+        REQUIRE(db.close());
+      }
+      {
+        Storage storage("StorageColdBlocks", *options);
+        REQUIRE(*storage.getBlock(blocks[5].getHash()) == blocks[5]);
+      }
+      checkStubs();
+
+      // Blocks moved out of the database can't be found without their segments
+      std::filesystem::remove_all(path + "/blockSegments/");
+      REQUIRE_THROWS(Storage("StorageColdBlocks", *options));
+    }
+
     SECTION("10 Blocks forward with destructor test") {
       // Create 10 Blocks, each with 100 dynamic transactions and 16 validator transactions
       std::vector<FinalizedBlock> blocks;
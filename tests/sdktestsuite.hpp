@@ -110,7 +110,7 @@ class SDKTestSuite {
      */
     explicit SDKTestSuite(const Options& options) :
       options_(options),
-      db_(std::get<0>(DumpManager::getBestStateDBPath(this->options_))),
+      db_(std::get<0>(DumpManager::getBestStateDBPath(this->options_)), this->options_.getDBSettings()),
       storage_(p2p_.getLogicalLocation(), options_),
       state_(db_, storage_, p2p_, std::get<1>(DumpManager::getBestStateDBPath(this->options_)), options_),
       p2p_(LOCALHOST, options_, storage_, state_),
@@ -23,12 +23,22 @@ See the LICENSE.txt file in the project root for more information.
 class StateTest : public State {
   public:
     // StateTest has the same constructor as State
-    StateTest(const DB& db, Storage& storage, P2P::ManagerNormal& p2pManager, const uint64_t& snapshotHeight, const Options& options) :
+    StateTest(DB& db, Storage& storage, P2P::ManagerNormal& p2pManager, const uint64_t& snapshotHeight, const Options& options) :
       State(db, storage, p2pManager, snapshotHeight, options) {};
 
-    void call(const TxBlock& tx) {
+    /**
+     * Execute a transaction directly on the state, without a block.
+     * @param tx The transaction to execute.
+     * @param journal The undo journal to record the changes in, reused across calls
+     *                like State does for a block's transactions. If `nullptr`,
+     *                the context uses a journal of its own, allocated for every call.
+     */
+    void call(const TxBlock& tx, ExecutionContext::Journal* journal = nullptr) {
       std::unique_lock lock(this->stateMutex_);
-      ExecutionContext context = ExecutionContext::Builder{}
+      this->dumpManager_.markDirty(*this);
+      ExecutionContext::Builder builder;
+      if (journal != nullptr) builder.journal(*journal);
+      ExecutionContext context = builder
       .storage(this->vmStorage_)
       .accounts(this->accounts_)
       .contracts(this->contracts_)
@@ -43,14 +53,18 @@ class StateTest : public State {
       .blockGasLimit(100'000'000)
       .txGasPrice(tx.getMaxFeePerGas())
       .chainId(this->options_.getChainID())
+      .dirtyKeys(this->dirtyKeys_)
       .build();
 
+      // Same code cache as block processing, so benchmarks see its effect
       ContractHost host(
         this->vm_,
         this->dumpManager_,
         this->storage_,
         Hash(),
-        context);
+        context,
+        nullptr,
+        &this->evmCodeCache_);
 
       Gas gas(uint64_t(tx.getGasLimit()));
 
@@ -58,6 +72,18 @@ class StateTest : public State {
         host.execute(std::forward<decltype(msg)>(msg));
       }, tx.toMessage(gas));
     };
+
+    /**
+     * Mark a C++ contract as changed, so the next dump writes it again.
+     * @param address The contract's address.
+     * @return The contract's dump prefix.
+     */
+    Bytes markContractDirty(const Address& address) {
+      std::unique_lock lock(this->stateMutex_);
+      const BaseContract& contract = *this->contracts_.at(address);
+      this->dumpManager_.markDirty(contract);
+      return contract.getDumpPrefix();
+    }
 };
 
 #endif // STATETEST_HPP
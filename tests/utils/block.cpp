@@ -149,6 +149,48 @@ namespace TBlock {
       for (uint64_t i = 0; i < 64; ++i) REQUIRE(finalizedNewBlock.getTxs()[i] == tx);
       for (uint64_t i = 0; i < 16; ++i) REQUIRE(finalizedNewBlock.getTxValidators()[i] == txValidatorsCopy[i]);
 
+      // Trusted decoding gives back the same block as the full validation, senders included
+      const Bytes serialized = finalizedNewBlock.serializeBlock();
+      const Bytes sidecar = finalizedNewBlock.serializeSidecar();
+      REQUIRE(sidecar.size() == 65 + (64 + 16) * 52);
+      FinalizedBlock trustedBlock = FinalizedBlock::fromTrustedBytes(serialized, sidecar, 8080);
+      REQUIRE(trustedBlock == finalizedNewBlock);
+      REQUIRE(trustedBlock.getValidatorPubKey() == finalizedNewBlock.getValidatorPubKey());
+      REQUIRE(trustedBlock.getSize() == serialized.size());
+      for (uint64_t i = 0; i < 64; ++i) {
+        REQUIRE(trustedBlock.getTxs()[i].hash() == tx.hash());
+        REQUIRE(trustedBlock.getTxs()[i].getFrom() == tx.getFrom());
+        REQUIRE(trustedBlock.getTxs()[i].getValue() == tx.getValue());
+      }
+      for (uint64_t i = 0; i < 16; ++i) {
+        REQUIRE(trustedBlock.getTxValidators()[i].getFrom() == validatorAddress);
+        REQUIRE(trustedBlock.getTxValidators()[i].getData() == txValidatorsCopy[i].getData());
+      }
+      // A sidecar that doesn't cover every tx of the block is rejected
+      REQUIRE_THROWS(FinalizedBlock::fromTrustedBytes(serialized, View<Bytes>(sidecar).subspan(0, sidecar.size() - 52), 8080));
+      REQUIRE_THROWS(FinalizedBlock::fromTrustedBytes(serialized, View<Bytes>(sidecar).subspan(0, 64), 8080));
+
+      // The v2 format decodes to the same block, and any tx can be sliced out of either format
+      const Bytes serializedV2 = finalizedNewBlock.serializeBlockV2();
+      REQUIRE(serializedV2.size() == serialized.size() + 12);
+      REQUIRE(FinalizedBlock::getFormat(serialized) == 1);
+      REQUIRE(FinalizedBlock::getFormat(serializedV2) == FinalizedBlock::formatV2);
+      FinalizedBlock blockV2 = FinalizedBlock::fromStorageBytes(serializedV2, 8080);
+      // Only the storage path reads the v2 format, blocks from the network must be v1
+      REQUIRE_THROWS_AS(FinalizedBlock::fromBytes(serializedV2, 8080), std::domain_error);
+      REQUIRE(FinalizedBlock::fromStorageBytes(serialized, 8080) == finalizedNewBlock);
+      REQUIRE(blockV2 == finalizedNewBlock);
+      REQUIRE(blockV2.getSize() == finalizedNewBlock.getSize());
+      REQUIRE(blockV2.getTxs().size() == 64);
+      REQUIRE(blockV2.getTxValidators().size() == 16);
+      REQUIRE(FinalizedBlock::fromTrustedBytes(serializedV2, sidecar, 8080) == finalizedNewBlock);
+      const Bytes rawTx = tx.rlpSerialize();
+      for (uint64_t i : {uint64_t(0), uint64_t(31), uint64_t(63)}) {
+        REQUIRE(Utils::makeBytes(FinalizedBlock::getRawTx(serialized, i)) == rawTx);
+        REQUIRE(Utils::makeBytes(FinalizedBlock::getRawTx(serializedV2, i)) == rawTx);
+      }
+      REQUIRE_THROWS(FinalizedBlock::getRawTx(serialized, 64));
+      REQUIRE_THROWS(FinalizedBlock::getRawTx(serializedV2, 64));
     }
 
     SECTION("Block with 500 dynamically created transactions and 64 dynamically created validator transactions") {
@@ -50,6 +50,7 @@ namespace TDB {
       // Create
       REQUIRE(db.put(key, value, pfx));
       REQUIRE(db.has(key, pfx));
+      REQUIRE(db.syncWAL());
 
       // Read
       REQUIRE(StrConv::bytesToString(db.get(key, pfx)) == value);
@@ -163,6 +164,167 @@ namespace TDB {
       REQUIRE(db.close());
     }
 
+    SECTION("Point lookups (has + getPinned + multiGet)") {
+      DB db("testDB");
+      std::vector<Bytes> keys;
+      for (int i = 0; i < 16; i++) {
+        keys.push_back(Utils::makeBytes(bytes::random(32)));
+        REQUIRE(db.put(keys.back(), Bytes(i + 1, uint8_t(i)), DBPrefix::txToBlock));
+      }
+      const Bytes missingKey = Utils::makeBytes(bytes::random(32));
+      REQUIRE(db.has(keys[0], DBPrefix::txToBlock));
+      REQUIRE(!db.has(missingKey, DBPrefix::txToBlock));
+      REQUIRE(!db.has(keys[0], DBPrefix::txToAdditionalData));
+
+      // Pinned values are the same as copied ones
+      const DBPinnedValue pinned = db.getPinned(keys[5], DBPrefix::txToBlock);
+      REQUIRE(pinned.size() == 6);
+      REQUIRE(Bytes(pinned.view().begin(), pinned.view().end()) == db.get(keys[5], DBPrefix::txToBlock));
+      REQUIRE(db.getPinned(missingKey, DBPrefix::txToBlock).empty());
+
+      // Values come back in the order of the keys, missing ones empty
+      std::vector<Bytes> query = {keys[3], missingKey, keys[0], keys[15]};
+      std::vector<Bytes> values = db.multiGet(query, DBPrefix::txToBlock);
+      REQUIRE(values.size() == 4);
+      REQUIRE(values[0] == Bytes(4, 3));
+      REQUIRE(values[1].empty());
+      REQUIRE(values[2] == Bytes(1, 0));
+      REQUIRE(values[3] == Bytes(16, 15));
+
+      // Full keys from different families can be mixed in one lookup
+      REQUIRE(db.put(StrConv::stringToBytes("dummy"), StrConv::stringToBytes("value")));
+      Bytes fullKey = DBPrefix::txToBlock;
+      Utils::appendBytes(fullKey, keys[7]);
+      values = db.multiGet(std::vector<Bytes>{StrConv::stringToBytes("dummy"), fullKey});
+      REQUIRE(values[0] == StrConv::stringToBytes("value"));
+      REQUIRE(values[1] == Bytes(8, 7));
+      REQUIRE(db.close());
+    }
+
+    SECTION("Column families (routing + migration from a single family)") {
+      // Write a database the way older versions did, with every prefix in the default family
+      std::filesystem::remove_all(std::filesystem::current_path().string() + "/testDB");
+      Bytes vmPfx = DBPrefix::vmStorage;
+      Utils::appendBytes(vmPfx, Bytes(20, 0xaa));
+      Bytes otherVmPfx = DBPrefix::vmStorage;
+      Utils::appendBytes(otherVmPfx, Bytes(20, 0xab));
+      {
+        rocksdb::Options opts;
+        opts.create_if_missing = true;
+        rocksdb::DB* legacy;
+        REQUIRE(rocksdb::DB::Open(opts, "testDB", &legacy).ok());
+        for (uint8_t i = 0; i < 100; i++) {
+          Bytes heightKey = DBPrefix::heightToBlock;
+          heightKey.push_back(i);
+          Bytes vmKey = vmPfx;
+          Utils::appendBytes(vmKey, Bytes(32, i));
+          REQUIRE(legacy->Put(rocksdb::WriteOptions(),
+            rocksdb::Slice(reinterpret_cast<const char*>(heightKey.data()), heightKey.size()), rocksdb::Slice("x")
+          ).ok());
+          REQUIRE(legacy->Put(rocksdb::WriteOptions(),
+            rocksdb::Slice(reinterpret_cast<const char*>(vmKey.data()), vmKey.size()), rocksdb::Slice("y")
+          ).ok());
+        }
+        REQUIRE(legacy->Put(rocksdb::WriteOptions(), rocksdb::Slice("\xbb\xbb"), rocksdb::Slice("z")).ok());
+        legacy->Close();
+        delete legacy;
+      }
+
+      // Opening moves the entries to their families, where every query still finds them
+      for (int reopen = 0; reopen < 2; reopen++) {
+        DB db("testDB");
+        REQUIRE(db.getBatch(DBPrefix::heightToBlock).size() == 100);
+        REQUIRE(db.getLastByPrefix(DBPrefix::heightToBlock) == StrConv::stringToBytes("x"));
+        REQUIRE(db.getKeys(vmPfx).size() == 100);
+        REQUIRE(db.getBatch(vmPfx, {Bytes(32, 0x05), Bytes(32, 0xff)}).size() == 1);
+        REQUIRE(db.hasPrefix(vmPfx));
+        REQUIRE(!db.hasPrefix(otherVmPfx));
+        REQUIRE(db.get(Bytes{0xbb, 0xbb}) == StrConv::stringToBytes("z"));
+        REQUIRE(db.close());
+      }
+
+      // Only the key without a known prefix is left in the default family
+      std::vector<std::string> names;
+      REQUIRE(rocksdb::DB::ListColumnFamilies(rocksdb::DBOptions(), "testDB", &names).ok());
+      REQUIRE(std::ranges::find(names, "heightToBlock") != names.end());
+      REQUIRE(std::ranges::find(names, "vmStorage") != names.end());
+      std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+      for (const std::string& name : names) descriptors.emplace_back(name, rocksdb::ColumnFamilyOptions());
+      std::vector<rocksdb::ColumnFamilyHandle*> handles;
+      rocksdb::DB* raw;
+      REQUIRE(rocksdb::DB::OpenForReadOnly(rocksdb::DBOptions(), "testDB", descriptors, &handles, &raw).ok());
+      for (size_t i = 0; i < names.size(); i++) {
+        size_t count = 0;
+        std::unique_ptr<rocksdb::Iterator> it(raw->NewIterator(rocksdb::ReadOptions(), handles[i]));
+        for (it->SeekToFirst(); it->Valid(); it->Next()) count++;
+        if (names[i] == rocksdb::kDefaultColumnFamilyName) REQUIRE(count == 1);
+        if (names[i] == "heightToBlock" || names[i] == "vmStorage") REQUIRE(count == 100);
+      }
+      for (rocksdb::ColumnFamilyHandle* handle : handles) raw->DestroyColumnFamilyHandle(handle);
+      delete raw;
+    }
+
+    SECTION("Dictionary compression (ZSTD)") {
+      std::filesystem::remove_all(std::filesystem::current_path().string() + "/testDB");
+      DBSettings settings;
+      settings.families["blocks"] = {
+        .compression = DBSettings::Compression::ZSTD, .compressionLevel = 3, .dictionaryBytes = 4096
+      };
+      // Values sharing most of their bytes, like the txs of different blocks
+      const Bytes common = Utils::makeBytes(bytes::random(256));
+      std::vector<std::pair<Bytes, Bytes>> entries;
+      for (int i = 0; i < 1000; i++) {
+        Bytes value = common;
+        Utils::appendBytes(value, Utils::makeBytes(bytes::random(16)));
+        entries.emplace_back(Utils::makeBytes(bytes::random(32)), std::move(value));
+      }
+      // Write the entries to table files and get the properties of the "blocks" family's tables
+      auto writeTables = [&](const DBSettings& dbSettings) {
+        std::filesystem::remove_all(std::filesystem::current_path().string() + "/testDB");
+        {
+          DB db("testDB", dbSettings);
+          for (const auto& [key, value] : entries) REQUIRE(db.put(key, value, DBPrefix::blocks));
+          REQUIRE(db.flush());
+          REQUIRE(db.close());
+        }
+        std::vector<std::string> names;
+        REQUIRE(rocksdb::DB::ListColumnFamilies(rocksdb::DBOptions(), "testDB", &names).ok());
+        std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+        for (const std::string& name : names) descriptors.emplace_back(name, rocksdb::ColumnFamilyOptions());
+        std::vector<rocksdb::ColumnFamilyHandle*> handles;
+        rocksdb::DB* raw;
+        REQUIRE(rocksdb::DB::OpenForReadOnly(rocksdb::DBOptions(), "testDB", descriptors, &handles, &raw).ok());
+        rocksdb::TablePropertiesCollection props;
+        for (size_t i = 0; i < names.size(); i++) {
+          if (names[i] == "blocks") REQUIRE(raw->GetPropertiesOfAllTables(handles[i], &props).ok());
+        }
+        for (rocksdb::ColumnFamilyHandle* handle : handles) raw->DestroyColumnFamilyHandle(handle);
+        delete raw;
+        return props;
+      };
+
+      DBSettings noDictSettings = settings;
+      noDictSettings.families["blocks"].dictionaryBytes = 0;
+      uint64_t noDictSize = 0;
+      for (const auto& [file, table] : writeTables(noDictSettings)) noDictSize += table->data_size;
+
+      // Tables were compressed with ZSTD and a dictionary, which makes them smaller
+      const rocksdb::TablePropertiesCollection props = writeTables(settings);
+      REQUIRE(!props.empty());
+      uint64_t dictSize = 0;
+      for (const auto& [file, table] : props) {
+        REQUIRE(table->compression_name == "ZSTD");
+        REQUIRE(table->compression_options.find("max_dict_bytes=4096") != std::string::npos);
+        dictSize += table->data_size;
+      }
+      REQUIRE(dictSize < noDictSize);
+
+      // Files are read back with the dictionary they were written with
+      DB db("testDB", settings);
+      for (const auto& [key, value] : entries) REQUIRE(db.get(key, DBPrefix::blocks) == value);
+      REQUIRE(db.close());
+    }
+
     // Clean up last test so DB creation can be properly tested next time
     std::filesystem::remove_all(std::filesystem::current_path().string() + "/testDB");
   }
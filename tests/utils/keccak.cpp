@@ -0,0 +1,46 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+
+#include "../../src/utils/keccak.h" // utils.h
+
+#include "../../src/utils/strconv.h"
+
+using Catch::Matchers::Equals;
+
+namespace TKeccak {
+  const std::vector<Keccak::Impl> impls = { Keccak::Impl::SCALAR, Keccak::Impl::AVX2, Keccak::Impl::AVX512 };
+
+  TEST_CASE("Keccak Tests", "[utils][keccak]") {
+    SECTION("Keccak batches match Utils::sha3") {
+      // Sizes around the 136-byte block boundaries, so lanes in a group need different block counts
+      std::vector<Bytes> data;
+      for (size_t size = 0; size <= 300; size++) data.emplace_back(Utils::randBytes(size));
+      std::vector<View<Bytes>> inputs(data.cbegin(), data.cend());
+      for (const Keccak::Impl impl : impls) {
+        for (size_t count : {0, 1, 2, 3, 4, 5, 7, 8, 9, 17, 301}) {
+          std::vector<Hash> outputs(count);
+          Keccak::hash256(std::span(inputs).first(count), outputs, impl);
+          for (size_t i = 0; i < count; i++) REQUIRE(outputs[i] == Utils::sha3(inputs[i]));
+        }
+      }
+    }
+
+    SECTION("Keccak known hashes") {
+      const Bytes empty;
+      const Bytes abc = StrConv::stringToBytes("abc");
+      const std::vector<View<Bytes>> inputs = { empty, abc, empty, abc };
+      const std::vector<Hash> outputs = Keccak::hash256(inputs);
+      REQUIRE(outputs.size() == 4);
+      REQUIRE_THAT(outputs[0].hex(), Equals("c5d2460186f7233c927e7db2dcc703c0e500b653ca82273b7bfad8045d85a470"));
+      REQUIRE_THAT(outputs[1].hex(), Equals("4e03657aea45a94fc7d47ba826c8d667c0d1e6e33a64a036ec44f58fa12d6c45"));
+      REQUIRE(outputs[2] == outputs[0]);
+      REQUIRE(outputs[3] == outputs[1]);
+    }
+  }
+}
@@ -40,6 +40,20 @@ namespace TMerkle {
       REQUIRE(tree.getProof(999).empty());
     }
 
+    SECTION("Empty Merkle Tree") {
+      Merkle tree(std::vector<Hash>{});
+      REQUIRE(tree.getLeaves().empty());
+      REQUIRE(tree.getProof(0).empty());
+      REQUIRE(tree.getRoot() == Hash());
+      REQUIRE(tree.getTree().size() == 1);
+      REQUIRE(tree.getTree()[0].empty());
+
+      Merkle txTree(std::vector<TxBlock>{});
+      REQUIRE(txTree.getLeaves().empty());
+      REQUIRE(txTree.getProof(0).empty());
+      REQUIRE(txTree.getRoot() == Hash());
+    }
+
     SECTION("Random Merkle Tree") {
       std::vector<Hash> hashedLeafs {
         bytes::random(), bytes::random(), bytes::random(), bytes::random(),
@@ -58,6 +72,39 @@ namespace TMerkle {
       REQUIRE(!Merkle::verify(proof, badLeaf, root));
     }
 
+    SECTION("Merkle Tree matches a layer by layer reference") {
+      // Large enough for the layers to be split between threads
+      for (const uint64_t leafCount : {1, 2, 3, 5, 64, 65, 129, 10001}) {
+        std::vector<Hash> leaves;
+        for (uint64_t i = 0; i < leafCount; i++) leaves.emplace_back(Utils::randBytes(32));
+        std::vector<std::vector<Hash>> reference(1);
+        for (const Hash& leaf : leaves) reference.back().emplace_back(Utils::sha3(leaf));
+        while (reference.back().size() > 1) {
+          const std::vector<Hash>& children = reference.back();
+          std::vector<Hash> parents;
+          for (uint64_t i = 0; i < children.size(); i += 2) parents.emplace_back((i + 1 < children.size())
+            ? Utils::sha3(Utils::makeBytes(bytes::join(
+              std::min(children[i], children[i + 1]), std::max(children[i], children[i + 1])
+            )))
+            : children[i]
+          );
+          reference.emplace_back(std::move(parents));
+        }
+
+        Merkle tree(leaves);
+        const auto layers = tree.getTree();
+        REQUIRE(layers.size() == reference.size());
+        for (uint64_t i = 0; i < layers.size(); i++) {
+          REQUIRE(std::ranges::equal(layers[i], reference[i]));
+        }
+        REQUIRE(tree.getRoot() == reference.back().front());
+        for (const uint64_t index : {uint64_t(0), leafCount / 2, leafCount - 1}) {
+          REQUIRE(Merkle::verify(tree.getProof(index), tree.getLeaves()[index], tree.getRoot()));
+        }
+      }
+      REQUIRE(Merkle(std::vector<Hash>()).getRoot() == Hash());
+    }
+
     SECTION("TxBlock Merkle Tree") {
       std::vector<TxBlock> txs {
         TxBlock(Hex::toBytes("02f8f2048697292f15c01784020833138605bde3949c038407b5432c94dd9bada36d88dac984e6d10a96061b65bc034a668617521be83d4cb8776129345086fa05e37c56ea3a9a24e102f3519b92f16f8f20281dcb28ef36eef04dd23f355693a24c4ce7de4ae663bfd5a47670092efefde1e612ff6fb380e3fe272121fb4c689454edb24d7287a8e4797f85934ab9514d20e77fb7a7c6a7e4921c614934ea2bb26737c34d8995a6d5505644d020f16d6ac001a0c806640faf85b1d0d1e5ffce56e037e7cc7d5e852cbc02e5c7318629de9eb3daa024c9e1bd51bb961dce5bb25ee834129f51e2f8c23fcee796b388cced5cae170e"), 1),
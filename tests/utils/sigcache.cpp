@@ -0,0 +1,60 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+
+#include "../../src/utils/sigcache.h" // safehash.h -> tx.h -> ecdsa.h -> utils.h
+
+namespace TSigCache {
+  TEST_CASE("SigCache", "[utils][sigcache]") {
+    SECTION("SigCache stores valid and invalid entries") {
+      SigCache cache(1024);
+      const Hash validKey(Utils::randBytes(32));
+      const Hash invalidKey(Utils::randBytes(32));
+      const Address from(Utils::randBytes(20));
+      REQUIRE(!cache.get(validKey).has_value());
+      cache.put(validKey, {from, true});
+      cache.put(invalidKey, {Address(), false});
+      REQUIRE(cache.size() == 2);
+      REQUIRE(cache.get(validKey)->valid);
+      REQUIRE(cache.get(validKey)->from == from);
+      REQUIRE(!cache.get(invalidKey)->valid);
+      cache.put(validKey, {Address(Utils::randBytes(20)), true}); // Already cached, kept as is
+      REQUIRE(cache.size() == 2);
+      REQUIRE(cache.get(validKey)->from == from);
+      cache.clear();
+      REQUIRE(cache.size() == 0);
+      REQUIRE(!cache.get(validKey).has_value());
+    }
+
+    SECTION("SigCache evicts the oldest entries once full") {
+      SigCache cache(16); // One entry per shard
+      std::vector<Hash> keys;
+      for (int i = 0; i < 1000; i++) {
+        keys.emplace_back(Utils::randBytes(32));
+        cache.put(keys.back(), {Address(Utils::randBytes(20)), true});
+      }
+      REQUIRE(cache.size() <= 16);
+      REQUIRE(cache.get(keys.back()).has_value());
+    }
+
+    SECTION("SigCache is filled and reused by TxBlock decoding") {
+      const PrivKey privKey(Utils::randBytes(32));
+      const Address from = Secp256k1::toAddress(Secp256k1::toUPub(privKey));
+      const TxBlock tx(Address(Utils::randBytes(20)), from, Bytes(), 8080, 0, 1, 1000000000, 1000000000, 21000, privKey);
+      const Bytes raw = tx.rlpSerialize();
+      REQUIRE(!SigCache::shared().get(tx.hash()).has_value());
+      const TxBlock decoded(raw, 8080);
+      REQUIRE(SigCache::shared().get(tx.hash())->from == from);
+      const TxBlock cached(raw, 8080);
+      REQUIRE(cached == tx);
+      REQUIRE(cached.getFrom() == from);
+      REQUIRE(cached.getNonce() == tx.getNonce());
+      REQUIRE(cached.getMaxFeePerGas() == tx.getMaxFeePerGas());
+    }
+  }
+}
@@ -0,0 +1,66 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+
+#include "../../src/utils/txdecoder.h" // tx.h -> ecdsa.h -> utils.h
+
+static std::vector<TxBlock> randomTxs(uint64_t count, uint64_t chainId) {
+  std::vector<TxBlock> txs;
+  for (uint64_t i = 0; i < count; i++) {
+    const PrivKey privKey(Utils::randBytes(32));
+    const Address from = Secp256k1::toAddress(Secp256k1::toUPub(privKey));
+    txs.emplace_back(Address(Utils::randBytes(20)), from, Bytes(), chainId, i, 1, 1000000000, 1000000000, 21000, privKey);
+  }
+  return txs;
+}
+
+namespace TTxDecoder {
+  TEST_CASE("TxDecoder", "[utils][txdecoder]") {
+    SECTION("TxDecoder decodes a batch in order, with or without workers") {
+      const std::vector<TxBlock> txs = randomTxs(200, 8080);
+      std::vector<Bytes> serializedTxs;
+      for (const auto& tx : txs) serializedTxs.emplace_back(tx.rlpSerialize());
+      const std::vector<View<Bytes>> rawTxs(serializedTxs.cbegin(), serializedTxs.cend());
+      for (const unsigned int threads : {0u, 1u, 4u}) {
+        TxDecoder decoder(threads);
+        REQUIRE(decoder.getThreads() == threads);
+        const auto decoded = decoder.decode(rawTxs, 8080);
+        REQUIRE(decoded.size() == txs.size());
+        for (uint64_t i = 0; i < txs.size(); i++) {
+          REQUIRE(decoded[i].has_value());
+          REQUIRE(*decoded[i] == txs[i]);
+          REQUIRE(decoded[i]->getFrom() == txs[i].getFrom());
+        }
+      }
+    }
+
+    SECTION("TxDecoder leaves invalid transactions empty") {
+      const std::vector<TxBlock> txs = randomTxs(64, 8080);
+      std::vector<Bytes> serializedTxs;
+      for (const auto& tx : txs) serializedTxs.emplace_back(tx.rlpSerialize());
+      serializedTxs[10] = Bytes{0xde, 0xad, 0xbe, 0xef};
+      serializedTxs.emplace_back(randomTxs(1, 1)[0].rlpSerialize()); // Signed for another chain
+      const std::vector<View<Bytes>> rawTxs(serializedTxs.cbegin(), serializedTxs.cend());
+      const auto decoded = TxDecoder(2).decode(rawTxs, 8080);
+      REQUIRE(decoded.size() == 65);
+      for (uint64_t i = 0; i < decoded.size(); i++) {
+        REQUIRE(decoded[i].has_value() == (i != 10 && i != 64));
+      }
+      // The reasons of the failures can be asked for
+      std::vector<std::string> errors;
+      const auto decodedWithErrors = TxDecoder(2).decode(rawTxs, 8080, &errors);
+      REQUIRE(errors.size() == 65);
+      for (uint64_t i = 0; i < decodedWithErrors.size(); i++) {
+        REQUIRE(decodedWithErrors[i].has_value() == errors[i].empty());
+      }
+      REQUIRE(!errors[10].empty());
+      REQUIRE(!errors[64].empty());
+      REQUIRE(TxDecoder(2).decode({}, 8080).empty());
+    }
+  }
+}
@@ -0,0 +1,102 @@
+/*
+Copyright (c) [2023-2024] [AppLayer Developers]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include <random>
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+
+#include "../../src/utils/uint256.h" // uintconv.h
+
+namespace TUint256 {
+  /// Random number with a random bit length, and limbs that are often all zeroes or all ones.
+  uint256_t randomUint256(std::mt19937_64& rng) {
+    uint256_t ret = 0;
+    for (unsigned i = 0; i < 4; i++) {
+      uint64_t limb = rng();
+      if (rng() % 4 == 0) limb = 0;
+      else if (rng() % 4 == 0) limb = ~uint64_t(0);
+      ret |= uint256_t(limb) << (64 * i);
+    }
+    if (const unsigned bits = rng() % 257; bits < 256) ret &= (uint256_t(1) << bits) - 1;
+    return ret;
+  }
+
+  /// Run an operation, returning its result as a string, or how it failed.
+  template <typename Op> std::string outcome(Op&& op) {
+    try {
+      return op();
+    } catch (const std::overflow_error&) {
+      return "overflow";
+    } catch (const std::range_error&) {
+      return "negative";
+    }
+  }
+
+  TEST_CASE("Uint256 Tests", "[utils][uint256]") {
+    SECTION("Uint256 matches uint256_t (differential fuzz)") {
+      std::mt19937_64 rng(256);
+      for (unsigned i = 0; i < 20000; i++) {
+        const uint256_t a = randomUint256(rng);
+        const uint256_t b = randomUint256(rng);
+        const unsigned shift = rng() % 300;
+        const Uint256 x(a);
+        const Uint256 y(b);
+        REQUIRE(uint256_t(x) == a);
+        REQUIRE(x.str() == a.str());
+        REQUIRE((x < y) == (a < b));
+        REQUIRE((x == y) == (a == b));
+        REQUIRE(outcome([&]() { return (x + y).str(); }) == outcome([&]() { return uint256_t(a + b).str(); }));
+        REQUIRE(outcome([&]() { return (x - y).str(); }) == outcome([&]() { return uint256_t(a - b).str(); }));
+        REQUIRE(outcome([&]() { return (x * y).str(); }) == outcome([&]() { return uint256_t(a * b).str(); }));
+        REQUIRE(outcome([&]() { return (x / y).str(); }) == outcome([&]() { return uint256_t(a / b).str(); }));
+        REQUIRE(outcome([&]() { return (x % y).str(); }) == outcome([&]() { return uint256_t(a % b).str(); }));
+        REQUIRE(outcome([&]() { return (x << shift).str(); }) == outcome([&]() { return uint256_t(a << shift).str(); }));
+        REQUIRE((x >> shift).str() == uint256_t(a >> shift).str());
+        REQUIRE(((x & y) | (~x ^ y)).str() == uint256_t((a & b) | (~a ^ b)).str());
+        // Serialization must stay the same as the boost-based conversions it replaced
+        Bytes exported;
+        boost::multiprecision::export_bits(a, std::back_inserter(exported), 8);
+        REQUIRE(Uint256::fromBigEndian(exported) == x);
+        const BytesArr<32> word = x.toBigEndian();
+        uint256_t imported;
+        boost::multiprecision::import_bits(imported, word.begin(), word.end(), 8);
+        REQUIRE(imported == a);
+        REQUIRE(Uint256::fromEvmc(x.toEvmc()) == x);
+      }
+    }
+
+    SECTION("Uint256 edge cases") {
+      const Uint256 max = ~Uint256();
+      REQUIRE(uint256_t(max) == std::numeric_limits<uint256_t>::max());
+      REQUIRE(Uint256(std::numeric_limits<uint256_t>::max()) == max);
+      REQUIRE(uint256_t(Uint256()) == 0);
+      REQUIRE(Uint256::fromBigEndian(Bytes(32, 0xFF)) == max);
+      REQUIRE(max.str() == "115792089237316195423570985008687907853269984665640564039457584007913129639935");
+      REQUIRE(Uint256().str() == "0");
+      REQUIRE_THROWS_AS(max + 1, std::overflow_error);
+      REQUIRE_THROWS_AS(Uint256(1) - 2, std::range_error);
+      REQUIRE_THROWS_AS(max * 2, std::overflow_error);
+      REQUIRE_THROWS_AS(max / Uint256(), std::overflow_error);
+      REQUIRE_THROWS_AS(Uint256(1) << 256, std::overflow_error);
+      REQUIRE_THROWS(Uint256::fromBigEndian(Bytes(33)));
+      Uint256 x(12345);
+      x /= x;
+      REQUIRE(x == 1);
+      x %= x;
+      REQUIRE(x == 0);
+      REQUIRE(Uint256::fromBigEndian(Bytes{0x01, 0x00}) == 256);
+      REQUIRE(Uint256::fromBigEndian(Bytes()) == 0);
+      REQUIRE(Uint256(256).toBigEndian()[30] == 0x01);
+      // Mixed with uint256_t operands, as on the balance paths
+      Uint256 balance(1000);
+      balance -= uint256_t(400);
+      REQUIRE(balance + uint256_t(1) == 601);
+      REQUIRE(uint256_t(600) == uint256_t(balance));
+      REQUIRE_THROWS_AS(balance -= uint256_t(601), std::range_error);
+    }
+  }
+}